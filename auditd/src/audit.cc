@@ -41,12 +41,16 @@
 #include <sstream>
 #include <string>
 
+/// The id of the next AuditImpl instance (0 is never used)
+static std::atomic<uint64_t> next_instance_id{1};
+
 AuditImpl::AuditImpl(std::string config_file,
                      ServerCookieIface* sapi,
                      const std::string& host)
     : Audit(),
       auditfile(host),
       configfile(std::move(config_file)),
+      instance_id(next_instance_id++),
       cookie_api(sapi),
       hostname(host) {
     if (!configfile.empty() && !configure()) {
@@ -337,11 +341,7 @@ bool AuditImpl::put_event(uint32_t event_id, cb::const_char_buffer payload) {
     //       event to the audit trail saying it is one in an illegal
     //       format (or missing fields)
     try {
-        auto new_event = std::make_unique<Event>(event_id, payload);
-        std::lock_guard<std::mutex> guard(producer_consumer_lock);
-        if (filleventqueue.size() < max_audit_queue) {
-            filleventqueue.push(std::move(new_event));
-            events_arrived.notify_all();
+        if (queue_event(std::make_unique<Event>(event_id, payload))) {
             return true;
         }
     } catch (const std::bad_alloc&) {
@@ -354,6 +354,103 @@ bool AuditImpl::put_event(uint32_t event_id, cb::const_char_buffer payload) {
     return false;
 }
 
+bool AuditImpl::put_event(uint32_t event_id,
+                          cb::audit::CompactEvent&& event) {
+    if (!config.is_auditd_enabled()) {
+        // Audit is disabled
+        return true;
+    }
+
+    try {
+        std::unique_ptr<Event> new_event =
+                std::make_unique<CompactAuditEvent>(event_id, std::move(event));
+        if (queue_event(std::move(new_event))) {
+            return true;
+        }
+        // Hand the event back so the caller can report it
+        event = static_cast<CompactAuditEvent&>(*new_event).takeEvent();
+    } catch (const std::bad_alloc&) {
+    }
+
+    dropped_events++;
+    LOG_WARNING("Audit: Dropping audit event {}", event_id);
+    return false;
+}
+
+AuditImpl::ProducerBuffer& AuditImpl::get_producer_buffer() {
+    // The calling thread's buffer, and the instance it belongs to (so a
+    // buffer isn't used after its AuditImpl has been destroyed)
+    static thread_local struct {
+        uint64_t instance_id = 0;
+        ProducerBuffer* buffer = nullptr;
+    } cached;
+
+    if (cached.instance_id != instance_id) {
+        auto buffer = std::make_unique<ProducerBuffer>();
+        cached.buffer = buffer.get();
+        cached.instance_id = instance_id;
+        std::lock_guard<std::mutex> guard(producer_buffers_mutex);
+        producer_buffers.push_back(std::move(buffer));
+    }
+    return *cached.buffer;
+}
+
+bool AuditImpl::queue_event(std::unique_ptr<Event>&& event) {
+    if (queued_events.load() >= max_audit_queue) {
+        return false;
+    }
+
+    auto& buffer = get_producer_buffer();
+    // Count the event before it's added to the buffer, so the consumer
+    // never removes more events from the count than were added.
+    const auto queued = queued_events.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(buffer.mutex);
+        buffer.events.push_back(std::move(event));
+    }
+
+    if (queued == 0) {
+        // The consumer may be waiting for events; wake it up. While there
+        // are queued events the consumer will process them once its current
+        // batch interval expires, so there is no need to notify it.
+        std::lock_guard<std::mutex> guard(producer_consumer_lock);
+        events_arrived.notify_one();
+    }
+    return true;
+}
+
+size_t AuditImpl::process_producer_buffers() {
+    std::vector<ProducerBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> guard(producer_buffers_mutex);
+        for (const auto& buffer : producer_buffers) {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    size_t processed = 0;
+    std::vector<std::unique_ptr<Event>> batch;
+    for (auto* buffer : buffers) {
+        {
+            // Swap in the (empty) batch so the buffer keeps its capacity
+            std::lock_guard<std::mutex> guard(buffer->mutex);
+            batch.swap(buffer->events);
+        }
+        if (batch.empty()) {
+            continue;
+        }
+        queued_events -= batch.size();
+        for (auto& event : batch) {
+            if (!event->process(*this)) {
+                dropped_events++;
+            }
+        }
+        processed += batch.size();
+        batch.clear();
+    }
+    return processed;
+}
+
 bool AuditImpl::configure_auditdaemon(const std::string& configfile,
                                       gsl::not_null<const void*> cookie) {
     auto new_event = std::make_unique<ConfigureEvent>(configfile, cookie.get());
@@ -410,17 +507,20 @@ void AuditImpl::consume_events() {
     events_arrived.notify_one();
 
     while (!stop_audit_consumer) {
-        if (filleventqueue.empty()) {
-            events_arrived.wait_for(
-                    lock,
-                    std::chrono::seconds(auditfile.get_seconds_to_rotation()));
-            if (filleventqueue.empty()) {
+        if (filleventqueue.empty() && queued_events.load() == 0) {
+            const auto timeout =
+                    std::min(auditfile.get_seconds_to_rotation(),
+                             auditfile.get_seconds_to_fsync());
+            events_arrived.wait_for(lock, std::chrono::seconds(timeout));
+            if (filleventqueue.empty() && queued_events.load() == 0) {
                 // We timed out, so just rotate the files
                 if (auditfile.maybe_rotate_files()) {
                     // If the file was rotated then we need to open a new
                     // audit.log file.
                     auditfile.ensure_open();
                 }
+                // and sync the file if it is due
+                auditfile.flush();
             }
         }
         /* now have producer_consumer lock!
@@ -430,6 +530,7 @@ void AuditImpl::consume_events() {
         lock.unlock();
         // Now outside of the producer_consumer_lock
 
+        process_producer_buffers();
         while (!processeventqueue.empty()) {
             auto& event = processeventqueue.front();
             if (!event->process(*this)) {
@@ -438,7 +539,27 @@ void AuditImpl::consume_events() {
             processeventqueue.pop();
         }
         auditfile.flush();
+
         lock.lock();
+        // Let the next batch of events build up (the producers don't notify
+        // us while there are queued events)
+        events_arrived.wait_for(lock, batch_interval, [this]() {
+            return stop_audit_consumer || !filleventqueue.empty();
+        });
+    }
+    lock.unlock();
+
+    // Process the events queued since the last batch (including the event
+    // logged by the destructor)
+    process_producer_buffers();
+    lock.lock();
+    processeventqueue.swap(filleventqueue);
+    lock.unlock();
+    while (!processeventqueue.empty()) {
+        if (!processeventqueue.front()->process(*this)) {
+            dropped_events++;
+        }
+        processeventqueue.pop();
     }
 
     // close the auditfile
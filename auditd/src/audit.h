@@ -25,17 +25,21 @@
 #include <platform/platform_thread.h>
 
 #include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
 class AuditImpl : public cb::audit::Audit {
 public:
     // Implementation of the public API
     bool put_event(uint32_t event_id, cb::const_char_buffer payload) override;
+    bool put_event(uint32_t event_id,
+                   cb::audit::CompactEvent&& event) override;
     void add_event_state_listener(
             cb::audit::EventStateListener listener) override;
     void notify_all_event_states() override;
@@ -103,6 +107,22 @@ protected:
      */
     void create_audit_event(uint32_t event_id, nlohmann::json& payload);
 
+    /**
+     * Add an event to the calling thread's event buffer
+     *
+     * @param event the event to add; only moved from if it is added
+     * @return true if success, false if the event was dropped because the
+     *              queue is full
+     */
+    bool queue_event(std::unique_ptr<Event>&& event);
+
+    /**
+     * Process all of the events in the producer buffers
+     *
+     * @return the number of events processed
+     */
+    size_t process_producer_buffers();
+
     void notify_event_state_changed(uint32_t id, bool enabled) const;
     struct {
         mutable std::mutex mutex;
@@ -127,9 +147,33 @@ protected:
     /// The consumer should run until this flag is set to true
     bool stop_audit_consumer = {false};
 
-    // We maintain two Event queues. At any one time one will be used to accept
-    // new events, and the other will be processed. The two queues are swapped
-    // periodically.
+    /**
+     * The audit events are queued by each producer thread into a buffer of
+     * its own, so that producers never contend with each other; the lock of
+     * a buffer is only contended when the consumer collects its events.
+     */
+    struct ProducerBuffer {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Event>> events;
+    };
+
+    /// @return the calling thread's producer buffer (created on first use)
+    ProducerBuffer& get_producer_buffer();
+
+    /// Identifies this instance in the producer threads' buffer cache
+    const uint64_t instance_id;
+
+    /// Every producer buffer created (buffers are never removed)
+    std::vector<std::unique_ptr<ProducerBuffer>> producer_buffers;
+    std::mutex producer_buffers_mutex;
+
+    /// The number of events in the producer buffers
+    std::atomic<size_t> queued_events{0};
+
+    // Control events (reconfigure requests) are queued separately, and
+    // processed after the events in the producer buffers. We maintain two
+    // queues; at any one time one will be used to accept new events, and the
+    // other will be processed. The two queues are swapped periodically.
     std::queue<std::unique_ptr<Event>> processeventqueue;
     std::queue<std::unique_ptr<Event>> filleventqueue;
     std::condition_variable events_arrived;
@@ -145,4 +189,12 @@ protected:
 
 private:
     const size_t max_audit_queue = 50000;
+
+    /**
+     * After processing a batch of events the consumer waits this long
+     * before collecting the next batch (unless it's asked to stop or
+     * reconfigure), so that under load the producers only wake the consumer
+     * once per batch rather than once per event.
+     */
+    const std::chrono::milliseconds batch_interval{10};
 };
@@ -0,0 +1,181 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+
+#include <mcbp/protocol/unsigned_leb128.h>
+#include <memcached/audit_compact_event.h>
+#include <memcached/isotime.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace cb {
+namespace audit {
+
+CompactEvent::CompactEvent() {
+    // Enough for the typical event generated by the core, so that it is
+    // built with a single allocation
+    data.reserve(256);
+}
+
+void CompactEvent::addTimestamp(const char* name) {
+    using namespace std::chrono;
+    addHeader(Type::Timestamp, name);
+    addLeb128(uint64_t(duration_cast<microseconds>(
+                               system_clock::now().time_since_epoch())
+                               .count()));
+}
+
+void CompactEvent::add(const char* name, cb::const_char_buffer value) {
+    addHeader(Type::String, name);
+    addLeb128(value.size());
+    data.append(value.data(), value.size());
+}
+
+void CompactEvent::add(const char* name, bool value) {
+    addHeader(Type::Boolean, name);
+    data.push_back(value ? 1 : 0);
+}
+
+void CompactEvent::add(const char* name, uint64_t value) {
+    addHeader(Type::Unsigned, name);
+    addLeb128(value);
+}
+
+void CompactEvent::beginObject(const char* name) {
+    addHeader(Type::BeginObject, name);
+}
+
+void CompactEvent::endObject() {
+    data.push_back(char(Type::EndObject));
+}
+
+void CompactEvent::addHeader(Type type, const char* name) {
+    data.push_back(char(type));
+    const auto length = std::strlen(name);
+    addLeb128(length);
+    data.append(name, length);
+}
+
+void CompactEvent::addLeb128(uint64_t value) {
+    cb::mcbp::unsigned_leb128<uint64_t> leb128(value);
+    data.append(reinterpret_cast<const char*>(leb128.data()), leb128.size());
+}
+
+/// Decodes the fields of a CompactEvent
+class CompactEventDecoder {
+public:
+    explicit CompactEventDecoder(const std::string& data)
+        : buffer(reinterpret_cast<const uint8_t*>(data.data()), data.size()) {
+    }
+
+    nlohmann::json decode() {
+        // The objects being built; the first is the event itself
+        std::vector<nlohmann::json> objects(1, nlohmann::json::object());
+        std::vector<std::string> names;
+        while (!buffer.empty()) {
+            const auto type = CompactEvent::Type(getByte());
+            if (type == CompactEvent::Type::EndObject) {
+                if (names.empty()) {
+                    throw std::invalid_argument(
+                            "CompactEventDecoder: unexpected EndObject");
+                }
+                auto object = std::move(objects.back());
+                objects.pop_back();
+                objects.back()[names.back()] = std::move(object);
+                names.pop_back();
+                continue;
+            }
+
+            auto name = getString();
+            auto& object = objects.back();
+            switch (type) {
+            case CompactEvent::Type::String:
+                object[name] = getString();
+                break;
+            case CompactEvent::Type::Boolean:
+                object[name] = getByte() != 0;
+                break;
+            case CompactEvent::Type::Unsigned:
+                object[name] = getLeb128();
+                break;
+            case CompactEvent::Type::Timestamp: {
+                const auto usec = getLeb128();
+                object[name] = ISOTime::generatetimestamp(
+                        time_t(usec / 1000000), uint32_t(usec % 1000000));
+                break;
+            }
+            case CompactEvent::Type::BeginObject:
+                objects.emplace_back(nlohmann::json::object());
+                names.emplace_back(std::move(name));
+                break;
+            default:
+                throw std::invalid_argument(
+                        "CompactEventDecoder: unknown type " +
+                        std::to_string(int(type)));
+            }
+        }
+
+        if (!names.empty()) {
+            throw std::invalid_argument(
+                    "CompactEventDecoder: missing EndObject");
+        }
+        return std::move(objects.front());
+    }
+
+private:
+    uint8_t getByte() {
+        if (buffer.empty()) {
+            throw std::invalid_argument("CompactEventDecoder: truncated event");
+        }
+        const auto ret = buffer[0];
+        buffer = {buffer.data() + 1, buffer.size() - 1};
+        return ret;
+    }
+
+    uint64_t getLeb128() {
+        if (buffer.empty()) {
+            throw std::invalid_argument("CompactEventDecoder: truncated event");
+        }
+        const auto decoded =
+                cb::mcbp::decode_unsigned_leb128<uint64_t>(buffer);
+        buffer = decoded.second;
+        return decoded.first;
+    }
+
+    std::string getString() {
+        const auto length = getLeb128();
+        if (length > buffer.size()) {
+            throw std::invalid_argument("CompactEventDecoder: truncated event");
+        }
+        std::string ret(reinterpret_cast<const char*>(buffer.data()), length);
+        buffer = {buffer.data() + length, buffer.size() - length};
+        return ret;
+    }
+
+    cb::const_byte_buffer buffer;
+};
+
+nlohmann::json CompactEvent::to_json() const {
+    return CompactEventDecoder(data).decode();
+}
+
+} // namespace audit
+} // namespace cb
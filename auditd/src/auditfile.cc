@@ -27,10 +27,17 @@
 #include <utilities/json_utilities.h>
 
 #include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 bool AuditFile::maybe_rotate_files() {
@@ -74,6 +81,17 @@ uint32_t AuditFile::get_seconds_to_rotation() const {
     }
 }
 
+uint32_t AuditFile::get_seconds_to_fsync() const {
+    if (fsync_interval == 0 || !unsynced || !is_open()) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    const auto elapsed = difftime(auditd_time(), last_fsync);
+    if (elapsed >= fsync_interval) {
+        return 0;
+    }
+    return fsync_interval - uint32_t(elapsed);
+}
+
 bool AuditFile::time_to_rotate_log() const {
     cb_assert(open_time != 0);
     time_t now = auditd_time();
@@ -113,12 +131,41 @@ bool AuditFile::open() {
 
     current_size = 0;
     open_time = auditd_time();
+    last_fsync = open_time;
+    unsynced = false;
+    return true;
+}
+
+bool AuditFile::fsync() {
+    if (!unsynced) {
+        return true;
+    }
+#ifdef WIN32
+    const auto ret = _commit(_fileno(file.get()));
+#else
+    int ret;
+    while ((ret = ::fsync(fileno(file.get()))) == -1 && errno == EINTR) {
+        // Retry
+    }
+#endif
+    if (ret != 0) {
+        LOG_WARNING("Audit: fsync error on file {}: {}",
+                    open_file_name,
+                    cb_strerror());
+        return false;
+    }
+    last_fsync = auditd_time();
+    unsynced = false;
     return true;
 }
 
 void AuditFile::close_and_rotate_log() {
     cb_assert(file);
+    if (fsync_interval != 0 && fflush(file.get()) == 0) {
+        fsync();
+    }
     file.reset();
+    unsynced = false;
     if (current_size == 0) {
         remove(open_file_name.c_str());
         return;
@@ -227,6 +274,7 @@ bool AuditFile::write_event_to_disk(nlohmann::json& output) {
     try {
         const auto content = output.dump();
         current_size += fprintf(file.get(), "%s\n", content.c_str());
+        unsynced = true;
         if (ferror(file.get())) {
             LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
             ret = false;
@@ -273,6 +321,7 @@ void AuditFile::reconfigure(const AuditConfig &config) {
     set_log_directory(config.get_log_directory());
     max_log_size = config.get_rotate_size();
     buffered = config.is_buffered();
+    fsync_interval = config.get_fsync_interval();
 }
 
 bool AuditFile::flush() {
@@ -282,6 +331,10 @@ bool AuditFile::flush() {
             close_and_rotate_log();
             return false;
         }
+        if (get_seconds_to_fsync() == 0 && !fsync()) {
+            close_and_rotate_log();
+            return false;
+        }
     }
 
     return true;
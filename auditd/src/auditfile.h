@@ -82,7 +82,8 @@ public:
     void reconfigure(const AuditConfig &config);
 
     /**
-     * Flush the buffers to the disk
+     * Flush the buffers to the disk, and fsync the file if the fsync
+     * interval has passed since it was last synced
      */
     bool flush();
 
@@ -91,8 +92,16 @@ public:
      */
     uint32_t get_seconds_to_rotation() const;
 
+    /**
+     * get the number of seconds until the data written to the file should
+     * be synced (UINT32_MAX if fsync is disabled or there is nothing to
+     * sync)
+     */
+    uint32_t get_seconds_to_fsync() const;
+
 private:
     bool open();
+    bool fsync();
     bool time_to_rotate_log() const;
     void close_and_rotate_log();
     void set_log_directory(const std::string &new_directory);
@@ -119,5 +128,11 @@ private:
     size_t max_log_size = 20 * 1024 * 1024;
     uint32_t rotate_interval = 900;
     bool buffered = true;
+    /// Seconds between fsyncs of the file (0 == never fsync)
+    uint32_t fsync_interval = 0;
+    /// When the file was last synced (or opened)
+    time_t last_fsync = 0;
+    /// Has data been written since the file was last synced?
+    bool unsynced = false;
 };
 
@@ -92,12 +92,8 @@ bool Event::process(AuditImpl& audit) {
         return true;
     }
 
-    // convert the event.payload into JSON
     nlohmann::json json_payload;
-    try {
-        json_payload = nlohmann::json::parse(payload);
-    } catch (const nlohmann::json::exception&) {
-        LOG_WARNING(R"(Audit: JSON parsing error on string "{}")", payload);
+    if (!get_json_payload(json_payload)) {
         return false;
     }
 
@@ -147,3 +143,24 @@ bool Event::process(AuditImpl& audit) {
     audit.auditfile.ensure_open();
     return false;
 }
+
+bool Event::get_json_payload(nlohmann::json& json) const {
+    // convert the event.payload into JSON
+    try {
+        json = nlohmann::json::parse(payload);
+    } catch (const nlohmann::json::exception&) {
+        LOG_WARNING(R"(Audit: JSON parsing error on string "{}")", payload);
+        return false;
+    }
+    return true;
+}
+
+bool CompactAuditEvent::get_json_payload(nlohmann::json& json) const {
+    try {
+        json = event.to_json();
+    } catch (const std::invalid_argument& e) {
+        LOG_WARNING("Audit: error decoding event {}: {}", id, e.what());
+        return false;
+    }
+    return true;
+}
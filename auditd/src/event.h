@@ -17,6 +17,7 @@
 #pragma once
 
 #include <inttypes.h>
+#include <memcached/audit_compact_event.h>
 #include <nlohmann/json_fwd.hpp>
 #include <platform/sized_buffer.h>
 #include <string>
@@ -64,4 +65,33 @@ public:
 
     virtual ~Event() {}
 
+protected:
+    /**
+     * Get the event's payload as JSON (by parsing the payload)
+     *
+     * @param json where to store the payload
+     * @return true if success, false if the payload isn't valid
+     */
+    virtual bool get_json_payload(nlohmann::json& json) const;
+};
+
+/**
+ * An event generated in the compact form (see cb::audit::CompactEvent),
+ * which is only converted to JSON when it is processed.
+ */
+class CompactAuditEvent : public Event {
+public:
+    CompactAuditEvent(uint32_t event_id, cb::audit::CompactEvent&& event)
+        : Event(event_id, {}), event(std::move(event)) {
+    }
+
+    /// Move the payload out of the event (e.g. when it couldn't be queued)
+    cb::audit::CompactEvent takeEvent() {
+        return std::move(event);
+    }
+
+protected:
+    bool get_json_payload(nlohmann::json& json) const override;
+
+    cb::audit::CompactEvent event;
 };
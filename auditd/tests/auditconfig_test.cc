@@ -249,6 +249,19 @@ TEST_F(AuditConfigTest, TestGetSetBuffered) {
     EXPECT_FALSE(config.is_buffered());
 }
 
+// fsync_interval
+
+TEST_F(AuditConfigTest, TestNoFsyncInterval) {
+    // fsync_interval is optional, and disabled unless specified
+    EXPECT_NO_THROW(config.initialize_config(json));
+    EXPECT_EQ(0u, config.get_fsync_interval());
+
+    json["fsync_interval"] = 5;
+    EXPECT_NO_THROW(config.initialize_config(json));
+    EXPECT_EQ(5u, config.get_fsync_interval());
+    EXPECT_EQ(5, config.to_json()["fsync_interval"].get<int>());
+}
+
 TEST_F(AuditConfigTest, TestIllegalDatatypeBuffered) {
     json["buffered"] = "foobar";
     EXPECT_THROW(config.initialize_config(json), nlohmann::json::exception);
@@ -24,6 +24,7 @@
 #include <atomic>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <map>
 
 using cb::io::findFilesWithPrefix;
@@ -81,6 +82,34 @@ TEST_F(AuditFileTest, TestFileCreation) {
     EXPECT_EQ(1, files.size());
 }
 
+/**
+ * Test that the data written is synced once the fsync interval has passed
+ */
+TEST_F(AuditFileTest, TestFsyncInterval) {
+    config.set_fsync_interval(10);
+    AuditFile auditfile("testing");
+    auditfile.reconfigure(config);
+
+    auditfile.ensure_open();
+    // Nothing to sync
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+              auditfile.get_seconds_to_fsync());
+
+    // Not synced until the interval has passed
+    auditfile.write_event_to_disk(event);
+    EXPECT_TRUE(auditfile.flush());
+    EXPECT_GE(10u, auditfile.get_seconds_to_fsync());
+    EXPECT_NE(0u, auditfile.get_seconds_to_fsync());
+
+    cb_timeofday_timetravel(11);
+    EXPECT_EQ(0u, auditfile.get_seconds_to_fsync());
+    EXPECT_TRUE(auditfile.flush());
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+              auditfile.get_seconds_to_fsync());
+
+    auditfile.close();
+}
+
  /**
  * Test that an empty file is properly rotated using ensure_open()
  * Seen issues in the past such as MB-32232
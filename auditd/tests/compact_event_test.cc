@@ -0,0 +1,74 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+
+#include <gtest/gtest.h>
+#include <memcached/audit_compact_event.h>
+#include <nlohmann/json.hpp>
+
+#include <stdexcept>
+
+using cb::audit::CompactEvent;
+
+TEST(CompactEventTest, ToJson) {
+    CompactEvent event;
+    event.add("peername", "127.0.0.1:6666");
+    event.beginObject("real_userid");
+    event.add("domain", "memcached");
+    event.add("user", std::string{"john"});
+    event.endObject();
+    event.add("enable", true);
+    event.add("count", uint64_t(1) << 40);
+    event.add("key", cb::const_char_buffer{"k\0y", 3});
+
+    const auto json = event.to_json();
+    EXPECT_EQ("127.0.0.1:6666", json["peername"].get<std::string>());
+    EXPECT_EQ("memcached",
+              json["real_userid"]["domain"].get<std::string>());
+    EXPECT_EQ("john", json["real_userid"]["user"].get<std::string>());
+    EXPECT_TRUE(json["enable"].get<bool>());
+    EXPECT_EQ(uint64_t(1) << 40, json["count"].get<uint64_t>());
+    EXPECT_EQ(std::string("k\0y", 3), json["key"].get<std::string>());
+    EXPECT_EQ(6u, json.size());
+}
+
+// The timestamp is formatted as the ISO-8601 timestamps the core used to
+// generate itself, e.g. 2019-06-21T10:21:46.123456+01:00
+TEST(CompactEventTest, Timestamp) {
+    CompactEvent event;
+    event.addTimestamp("timestamp");
+    const auto ts = event.to_json()["timestamp"].get<std::string>();
+    ASSERT_GE(ts.size(), 27u);
+    EXPECT_EQ('-', ts[4]);
+    EXPECT_EQ('T', ts[10]);
+    EXPECT_EQ('.', ts[19]);
+}
+
+TEST(CompactEventTest, Empty) {
+    CompactEvent event;
+    EXPECT_EQ(nlohmann::json::object(), event.to_json());
+}
+
+TEST(CompactEventTest, Invalid) {
+    CompactEvent unterminated;
+    unterminated.beginObject("real_userid");
+    EXPECT_THROW(unterminated.to_json(), std::invalid_argument);
+
+    CompactEvent unexpected;
+    unexpected.endObject();
+    EXPECT_THROW(unexpected.to_json(), std::invalid_argument);
+}
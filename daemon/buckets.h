@@ -25,6 +25,7 @@
 #include <memcached/server_callback_iface.h>
 #include <memcached/types.h>
 #include <nlohmann/json_fwd.hpp>
+#include <platform/cacheline_padded.h>
 
 #include <condition_variable>
 #include <memory>
@@ -134,9 +135,11 @@ public:
      */
 
     /**
-     * Statistics vector, one per front-end thread.
+     * Statistics vector, one per front-end thread. Each entry is padded to
+     * a cache line so threads updating their own counters do not contend on
+     * a line shared with a neighbouring thread's entry.
      */
-    std::vector<thread_stats> stats;
+    std::vector<cb::CachelinePadded<thread_stats>> stats;
 
     /**
      * Command timing data
@@ -51,6 +51,13 @@
 #include <netinet/tcp.h> // For TCP_NODELAY etc
 #endif
 
+/**
+ * DCP mutations where the key and value don't exceed this size are copied
+ * into the write buffer instead of being sent directly from the item
+ * (to reduce the number of IO vector entries for small documents).
+ */
+static const size_t DcpMaxInlineValueSize = 256;
+
 std::string to_string(Connection::Priority priority) {
     switch (priority) {
     case Connection::Priority::High:
@@ -233,6 +240,7 @@ nlohmann::json Connection::toJSON() const {
     ret["ssl"] = ssl.toJSON();
     ret["total_recv"] = totalRecv;
     ret["total_send"] = totalSend;
+    ret["total_sendmsg"] = totalSendmsg;
 
     ret["datatype"] = mcbp::datatype::to_string(datatype.getRaw()).c_str();
 
@@ -843,6 +851,7 @@ int Connection::recv(char* dest, size_t nbytes) {
 
 ssize_t Connection::sendmsg(struct msghdr* m) {
     ssize_t res = 0;
+    ++totalSendmsg;
     if (ssl.isEnabled()) {
         for (int ii = 0; ii < int(m->msg_iovlen); ++ii) {
             int n = sslWrite(reinterpret_cast<char*>(m->msg_iov[ii].iov_base),
@@ -1202,6 +1211,21 @@ void Connection::addIov(const void* buf, size_t len) {
 
     struct msghdr* m = &msglist.back();
 
+    // Extend the previous entry if the data directly follows it in the
+    // write buffer (which is the case for the headers of a batch of DCP
+    // messages) instead of using a new entry
+    if (m->msg_iovlen > 0 && write && !write->empty()) {
+        auto& last = m->msg_iov[m->msg_iovlen - 1];
+        const auto rbuf = write->rdata();
+        const auto* base = static_cast<const uint8_t*>(last.iov_base);
+        if (base >= rbuf.data() && base < rbuf.data() + rbuf.size() &&
+            base + last.iov_len == buf) {
+            last.iov_len += len;
+            msgbytes += len;
+            return;
+        }
+    }
+
     /* We may need to start a new msghdr if this one is full. */
     if (m->msg_iovlen == IOV_MAX) {
         addMsgHdr(false);
@@ -1973,6 +1997,22 @@ ENGINE_ERROR_CODE Connection::mutation(uint32_t opaque,
                       nextWbuf);
         }
 
+        // When batching DCP messages small documents are copied into the
+        // write buffer after the header so that a batch of them may be sent
+        // as a single chunk of memory. Larger values (and all values when
+        // every message is sent on its own) are sent directly from the item.
+        const auto inlineSize = key.size() + buffer.size();
+        if (settings.getDcpStepBatchSize() > 1 &&
+            inlineSize <= DcpMaxInlineValueSize &&
+            wbuf.size() >= headerSize + inlineSize) {
+            nextWbuf = std::copy(key.data(),
+                                 key.data() + key.size(),
+                                 wbuf.begin() + headerSize);
+            std::copy(buffer.begin(), buffer.end(), nextWbuf);
+            addIov(wbuf.data(), headerSize + inlineSize);
+            return headerSize + inlineSize;
+        }
+
         // Add the header (which includes extras, optional frame-extra and
         // optional nmeta)
         addIov(wbuf.data(), headerSize);
@@ -1251,6 +1251,8 @@ protected:
     size_t totalRecv = 0;
     // Total number of bytes sent to the network
     size_t totalSend = 0;
+    // Total number of times we tried to send data to the network
+    size_t totalSendmsg = 0;
 
     /**
      * The list of commands currently being processed. Currently we
@@ -23,6 +23,7 @@
 #include "mcbp.h"
 #include "mcbp_executors.h"
 #include "settings.h"
+#include "stage_profiler.h"
 
 #include <logger/logger.h>
 #include <mcbp/mcbp.h>
@@ -94,6 +95,28 @@ const std::string& Cookie::getErrorJson() {
 }
 
 bool Cookie::execute() {
+    if (isRecordingSpans()) {
+        addBackgroundSpansToTracer();
+    }
+
+    cb::tracing::Tracer::SpanId executeSpan = {};
+    if (profiled) {
+        const auto now = std::chrono::steady_clock::now();
+        if (ewouldblockStart) {
+            // Only the front-end thread may update the tracer, so the
+            // ewouldblock wait stage is added once we're executed again
+            const auto span = tracer.begin(cb::tracing::TraceCode::EWB_WAIT,
+                                           *ewouldblockStart);
+            tracer.end(span, now);
+            ewouldblockStart.reset();
+        } else {
+            // Close the parse stage
+            tracer.end(openStage, now);
+            openStage = cb::tracing::Tracer::invalidSpanId();
+        }
+        executeSpan = tracer.begin(cb::tracing::TraceCode::EXECUTE, now);
+    }
+
     // Reset ewouldblock state!
     setEwouldblock(false);
     const auto& header = getHeader();
@@ -105,6 +128,14 @@ bool Cookie::execute() {
         execute_request_packet(*this, header.getRequest());
     }
 
+    if (profiled) {
+        const auto now = std::chrono::steady_clock::now();
+        tracer.end(executeSpan, now);
+        if (isEwouldblock()) {
+            ewouldblockStart = now;
+        }
+    }
+
     return !isEwouldblock();
 }
 
@@ -497,15 +528,34 @@ Cookie::Cookie(Connection& conn) : connection(conn) {
 void Cookie::initialize(cb::const_byte_buffer header, bool tracing_enabled) {
     reset();
     enableTracing = tracing_enabled;
+    // The state machinery for DCP connections doesn't complete commands
+    // in the same way, so don't try to profile them
+    profiled = !connection.isDCP() && StageProfiler::shouldSample();
+    recordingSpans = enableTracing || profiled;
     setPacket(Cookie::PacketContent::Header, header);
     setCas(0);
     start = std::chrono::steady_clock::now();
     tracer.begin(cb::tracing::TraceCode::REQUEST, start);
+    if (profiled) {
+        openStage = tracer.begin(cb::tracing::TraceCode::PARSE, start);
+    }
     ewouldblock = false;
     openTracingContext.clear();
 }
 
 void Cookie::reset() {
+    if (profiled) {
+        recordProfiledStages();
+        profiled = false;
+    }
+    openStage = cb::tracing::Tracer::invalidSpanId();
+    profiledOpcode.reset();
+    ewouldblockStart.reset();
+    if (recordingSpans) {
+        std::lock_guard<std::mutex> guard(backgroundSpansMutex);
+        backgroundSpans.clear();
+    }
+    recordingSpans = enableTracing;
     event_id.clear();
     error_context.clear();
     json_message.clear();
@@ -518,6 +568,48 @@ void Cookie::reset() {
     openTracingContext.clear();
 }
 
+void Cookie::setProfiledCommandComplete(
+        cb::mcbp::ClientOpcode opcode,
+        std::chrono::steady_clock::time_point time) {
+    profiledOpcode = opcode;
+    openStage = tracer.begin(cb::tracing::TraceCode::SEND, time);
+}
+
+void Cookie::addBackgroundSpan(cb::tracing::TraceCode code,
+                               std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end) {
+    std::lock_guard<std::mutex> guard(backgroundSpansMutex);
+    backgroundSpans.emplace_back(
+            code,
+            start,
+            std::chrono::duration_cast<cb::tracing::Span::Duration>(end -
+                                                                     start));
+}
+
+void Cookie::addBackgroundSpansToTracer() {
+    std::vector<cb::tracing::Span> spans;
+    {
+        std::lock_guard<std::mutex> guard(backgroundSpansMutex);
+        spans.swap(backgroundSpans);
+    }
+    for (const auto& span : spans) {
+        const auto id = tracer.begin(span.code, span.start);
+        tracer.end(id, span.start + span.duration);
+    }
+}
+
+void Cookie::recordProfiledStages() {
+    // Commands which never completed (e.g. the connection was closed while
+    // it was blocked) aren't recorded
+    if (!profiledOpcode) {
+        return;
+    }
+    // The response has been sent by the time the cookie is reset for the
+    // next command
+    tracer.end(openStage);
+    stage_profiler.record(*profiledOpcode, tracer);
+}
+
 void Cookie::setOpenTracingContext(cb::const_byte_buffer context) {
     try {
         openTracingContext.assign(reinterpret_cast<const char*>(context.data()),
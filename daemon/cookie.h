@@ -19,13 +19,17 @@
 #include "dynamic_buffer.h"
 #include "tracing/tracer.h"
 
+#include <boost/optional/optional.hpp>
 #include <mcbp/protocol/datatype.h>
+#include <mcbp/protocol/opcode.h>
 #include <mcbp/protocol/status.h>
 #include <memcached/dockey.h>
 #include <memcached/engine_error.h>
 #include <nlohmann/json_fwd.hpp>
 #include <platform/sized_buffer.h>
 #include <chrono>
+#include <mutex>
+#include <vector>
 
 // Forward decls
 class Connection;
@@ -444,8 +448,46 @@ public:
 
     void setTracingEnabled(bool enable) {
         enableTracing = enable;
+        recordingSpans = enableTracing || profiled;
     }
 
+    /**
+     * Has this command been sampled for stage profiling? If so the stages
+     * of the command are recorded in the tracer (even if the client hasn't
+     * enabled tracing) and added to the StageProfiler once the response
+     * has been sent.
+     */
+    bool isProfiled() const {
+        return profiled;
+    }
+
+    /**
+     * Should Spans be recorded in the tracer for this command; either as
+     * the client enabled tracing or it is being profiled.
+     */
+    bool isRecordingSpans() const {
+        return recordingSpans;
+    }
+
+    /**
+     * Called once a profiled command has completed (and its response has
+     * been queued). Starts the "send" stage, and records the opcode the
+     * stages should be accounted to.
+     */
+    void setProfiledCommandComplete(
+            cb::mcbp::ClientOpcode opcode,
+            std::chrono::steady_clock::time_point time);
+
+    /**
+     * Record a completed Span for this command from a thread other than the
+     * front-end thread executing it (e.g. a background fetch). The Tracer
+     * is not thread-safe, so the Span is held by the cookie and added to the
+     * Tracer by the front-end thread when the command is next executed.
+     */
+    void addBackgroundSpan(cb::tracing::TraceCode code,
+                           std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end);
+
     cb::tracing::Tracer& getTracer() {
         return tracer;
     }
@@ -500,9 +542,38 @@ public:
     CookieTraceContext extractTraceContext();
 
 protected:
-    bool enableTracing = false;
+    /// Add the stages of a completed, profiled command to the StageProfiler
+    void recordProfiledStages();
+
+    /// Move the Spans recorded by addBackgroundSpan() into the tracer
+    void addBackgroundSpansToTracer();
+
+    /// Should Spans be recorded (see isRecordingSpans()). This and tracer
+    /// must be the first members, laid out as in cb::tracing::Traceable: the
+    /// trace helpers are also used with the Traceable cookies of the unit
+    /// tests.
+    bool recordingSpans = false;
     cb::tracing::Tracer tracer;
 
+    bool enableTracing = false;
+    /// Is this command being profiled (see isProfiled())
+    bool profiled = false;
+
+    /// The stage of a profiled command which is currently in progress
+    cb::tracing::Tracer::SpanId openStage =
+            cb::tracing::Tracer::invalidSpanId();
+
+    /// The opcode of a profiled command, set once it has completed
+    boost::optional<cb::mcbp::ClientOpcode> profiledOpcode;
+
+    /// When a profiled command returned EWOULDBLOCK; its ewouldblock wait
+    /// stage is added to the tracer when the command is executed again
+    boost::optional<std::chrono::steady_clock::time_point> ewouldblockStart;
+
+    /// Spans recorded by other threads, see addBackgroundSpan()
+    std::mutex backgroundSpansMutex;
+    std::vector<cb::tracing::Span> backgroundSpans;
+
     /// The tracing context provided by the client to use as the
     /// parent span
     std::string openTracingContext;
@@ -30,12 +30,11 @@
 
 #include <logger/logger.h>
 #include <memcached/audit_interface.h>
-#include <memcached/isotime.h>
-#include <platform/string_hex.h>
-
 #include <nlohmann/json.hpp>
+#include <platform/string_hex.h>
 
 #include <sstream>
+#include <stdexcept>
 
 static cb::audit::UniqueAuditPtr auditHandle;
 
@@ -88,37 +87,42 @@ void setEnabled(uint32_t id, bool enable) {
  * timestamp, the socket endpoints and the creds. Then each audit event
  * may add event-specific content.
  *
+ * The event is built in its compact form; it is only converted to JSON
+ * (and its timestamp formatted) by the audit daemon's thread.
+ *
  * @param c the connection object
- * @return the json object containing the basic information
+ * @return the event containing the basic information
  */
-static nlohmann::json create_memcached_audit_object(const Connection& c) {
-    nlohmann::json domain;
-    domain["domain"] = "memcached";
-    domain["user"] = c.getUsername();
-
-    nlohmann::json root;
-
-    root["timestamp"] = ISOTime::generatetimestamp();
-    root["peername"] = c.getPeername();
-    root["sockname"] = c.getSockname();
-    root["real_userid"] = domain;
-
+static cb::audit::CompactEvent create_memcached_audit_object(
+        const Connection& c) {
+    cb::audit::CompactEvent root;
+    root.addTimestamp("timestamp");
+    root.add("peername", c.getPeername());
+    root.add("sockname", c.getSockname());
+    root.beginObject("real_userid");
+    root.add("domain", "memcached");
+    root.add("user", c.getUsername());
+    root.endObject();
     return root;
 }
 
 /**
- * Convert the JSON object to text and send it to the audit framework
+ * Send the event to the audit framework
  *
  * @param id the audit identifier
  * @param event the payload of the audit description
  * @param warn what to log if we're failing to put the audit event
  */
 static void do_audit(uint32_t id,
-                     const nlohmann::json& event,
+                     cb::audit::CompactEvent event,
                      const char* warn) {
-    auto text = event.dump();
-    if (!auditHandle->put_event(id, text)) {
-        LOG_WARNING("{}: {}", warn, text);
+    if (!auditHandle->put_event(id, std::move(event))) {
+        // put_event leaves the event intact if it couldn't be queued
+        try {
+            LOG_WARNING("{}: {}", warn, event.to_json().dump());
+        } catch (const std::invalid_argument&) {
+            LOG_WARNING("{}", warn);
+        }
     }
 }
 
@@ -127,10 +131,10 @@ void audit_auth_failure(const Connection& c, const char* reason) {
         return;
     }
     auto root = create_memcached_audit_object(c);
-    root["reason"] = reason;
+    root.add("reason", reason);
 
     do_audit(MEMCACHED_AUDIT_AUTHENTICATION_FAILED,
-             root,
+             std::move(root),
              "Failed to send AUTH FAILED audit event");
 }
 
@@ -140,7 +144,7 @@ void audit_auth_success(const Connection& c) {
     }
     auto root = create_memcached_audit_object(c);
     do_audit(MEMCACHED_AUDIT_AUTHENTICATION_SUCCEEDED,
-             root,
+             std::move(root),
              "Failed to send AUTH SUCCESS audit event");
 }
 
@@ -152,9 +156,9 @@ void audit_bucket_selection(const Connection& c) {
     // Don't audit that we're jumping into the "no bucket"
     if (bucket.type != Bucket::Type::NoBucket) {
         auto root = create_memcached_audit_object(c);
-        root["bucket"] = c.getBucket().name;
+        root.add("bucket", c.getBucket().name);
         do_audit(MEMCACHED_AUDIT_SELECT_BUCKET,
-                 root,
+                 std::move(root),
                  "Failed to send SELECT BUCKET audit event");
     }
 }
@@ -164,10 +168,10 @@ void audit_bucket_flush(const Connection& c, const char* bucket) {
         return;
     }
     auto root = create_memcached_audit_object(c);
-    root["bucket"] = bucket;
+    root.add("bucket", bucket);
 
     do_audit(MEMCACHED_AUDIT_EXTERNAL_MEMCACHED_BUCKET_FLUSH,
-             root,
+             std::move(root),
              "Failed to send EXTERNAL_MEMCACHED_BUCKET_FLUSH audit event");
 }
 
@@ -179,10 +183,10 @@ void audit_dcp_open(const Connection& c) {
         LOG_INFO("Open DCP stream with admin credentials");
     } else {
         auto root = create_memcached_audit_object(c);
-        root["bucket"] = c.getBucket().name;
+        root.add("bucket", c.getBucket().name);
 
         do_audit(MEMCACHED_AUDIT_OPENED_DCP_CONNECTION,
-                 root,
+                 std::move(root),
                  "Failed to send DCP open connection "
                  "audit event to audit daemon");
     }
@@ -193,9 +197,9 @@ void audit_set_privilege_debug_mode(const Connection& c, bool enable) {
         return;
     }
     auto root = create_memcached_audit_object(c);
-    root["enable"] = enable;
+    root.add("enable", enable);
     do_audit(MEMCACHED_AUDIT_PRIVILEGE_DEBUG_CONFIGURED,
-             root,
+             std::move(root),
              "Failed to send modifications in privilege debug state "
              "audit event to audit daemon");
 }
@@ -209,13 +213,13 @@ void audit_privilege_debug(const Connection& c,
         return;
     }
     auto root = create_memcached_audit_object(c);
-    root["command"] = command;
-    root["bucket"] = bucket;
-    root["privilege"] = privilege;
-    root["context"] = context;
+    root.add("command", command);
+    root.add("bucket", bucket);
+    root.add("privilege", privilege);
+    root.add("context", context);
 
     do_audit(MEMCACHED_AUDIT_PRIVILEGE_DEBUG,
-             root,
+             std::move(root),
              "Failed to send privilege debug audit event to audit daemon");
 }
 
@@ -237,8 +241,8 @@ void audit_command_access_failed(const Cookie& cookie) {
                            "Access to command is not allowed:",
                            reinterpret_cast<const char*>(packet.data()),
                            packet.size());
-    root["packet"] = buffer;
-    do_audit(MEMCACHED_AUDIT_COMMAND_ACCESS_FAILURE, root, buffer);
+    root.add("packet", buffer);
+    do_audit(MEMCACHED_AUDIT_COMMAND_ACCESS_FAILURE, std::move(root), buffer);
 }
 
 void audit_invalid_packet(const Connection& c, cb::const_byte_buffer packet) {
@@ -256,8 +260,8 @@ void audit_invalid_packet(const Connection& c, cb::const_byte_buffer packet) {
     }
     ss << "Invalid packet: " << cb::to_hex(packet) << trunc;
     const auto message = ss.str();
-    root["packet"] = message.c_str() + strlen("Invalid packet: ");
-    do_audit(MEMCACHED_AUDIT_INVALID_PACKET, root, message.c_str());
+    root.add("packet", message.c_str() + strlen("Invalid packet: "));
+    do_audit(MEMCACHED_AUDIT_INVALID_PACKET, std::move(root), message.c_str());
 }
 
 bool mc_audit_event(uint32_t audit_eventid, cb::const_byte_buffer payload) {
@@ -302,28 +306,28 @@ void add(const Cookie& cookie, Operation operation) {
 
     const auto& connection = cookie.getConnection();
     auto root = create_memcached_audit_object(connection);
-    root["bucket"] = connection.getBucket().name;
-    root["key"] = cookie.getPrintableRequestKey();
+    root.add("bucket", connection.getBucket().name);
+    root.add("key", cookie.getPrintableRequestKey());
 
     switch (operation) {
     case Operation::Read:
         do_audit(MEMCACHED_AUDIT_DOCUMENT_READ,
-                 root,
+                 std::move(root),
                  "Failed to send document read audit event to audit daemon");
         break;
     case Operation::Lock:
         do_audit(MEMCACHED_AUDIT_DOCUMENT_LOCKED,
-                 root,
+                 std::move(root),
                  "Failed to send document locked audit event to audit daemon");
         break;
     case Operation::Modify:
         do_audit(MEMCACHED_AUDIT_DOCUMENT_MODIFY,
-                 root,
+                 std::move(root),
                  "Failed to send document modify audit event to audit daemon");
         break;
     case Operation::Delete:
         do_audit(MEMCACHED_AUDIT_DOCUMENT_DELETE,
-                 root,
+                 std::move(root),
                  "Failed to send document delete audit event to audit daemon");
         break;
     }
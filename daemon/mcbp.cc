@@ -275,6 +275,10 @@ void mcbp_collect_timings(Cookie& cookie) {
     // Log operations taking longer than the "slow" threshold for the opcode.
     cookie.maybeLogSlowCommand(elapsed);
 
+    if (cookie.isProfiled() && !cookie.isOpenTracingEnabled()) {
+        cookie.setProfiledCommandComplete(opcode, endTime);
+    }
+
     if (cookie.isOpenTracingEnabled()) {
         OpenTracing::pushTraceLog(std::move(cookie.extractTraceContext()));
     }
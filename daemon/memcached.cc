@@ -397,7 +397,7 @@ static void stats_init() {
 struct thread_stats* get_thread_stats(Connection* c) {
     cb_assert(c->getThread()->index < (settings.getNumWorkerThreads() + 1));
     auto& independent_stats = all_buckets[c->getBucketIndex()].stats;
-    return &independent_stats.at(c->getThread()->index);
+    return independent_stats.at(c->getThread()->index).get();
 }
 
 void stats_reset(Cookie& cookie) {
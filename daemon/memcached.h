@@ -5,6 +5,7 @@
 #include <memcached/engine_error.h>
 #include <memcached/server_callback_iface.h>
 #include <memcached/types.h>
+#include <platform/cacheline_padded.h>
 #include <platform/socket.h>
 #include <subdoc/operations.h>
 
@@ -80,7 +81,8 @@ void dispatch_conn_new(SOCKET sfd, in_port_t parent_port);
 /* Lock wrappers for cache functions that are called from main loop. */
 int is_listen_thread(void);
 
-void threadlocal_stats_reset(std::vector<thread_stats>& thread_stats);
+void threadlocal_stats_reset(
+        std::vector<cb::CachelinePadded<thread_stats>>& thread_stats);
 
 void notify_io_complete(gsl::not_null<const void*> cookie,
                         ENGINE_ERROR_CODE status);
@@ -0,0 +1,120 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+
+#include "packed_stats.h"
+
+#include <mcbp/protocol/unsigned_leb128.h>
+#include <platform/crc32c.h>
+#include <platform/string_hex.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+/// @return true if str from pos onwards is a non-empty sequence of digits
+static bool isDigits(const std::string& str, size_t pos) {
+    return pos < str.size() &&
+           str.find_first_not_of("0123456789", pos) == std::string::npos;
+}
+
+/// Parse a sequence of digits; return false if it doesn't fit in a uint64_t
+static bool parseUnsigned(const char* str, uint64_t& value) {
+    errno = 0;
+    value = std::strtoull(str, nullptr, 10);
+    return errno != ERANGE;
+}
+
+void PackedStats::add(cb::const_char_buffer key, cb::const_char_buffer value) {
+    const std::string str{value.data(), value.size()};
+    uint64_t number;
+    if (isDigits(str, 0)) {
+        if (!parseUnsigned(str.c_str(), number)) {
+            return;
+        }
+        addUnsigned(Type::Unsigned, number);
+    } else if (!str.empty() && str[0] == '-' && isDigits(str, 1)) {
+        if (!parseUnsigned(str.c_str() + 1, number)) {
+            return;
+        }
+        if (number == 0) {
+            addUnsigned(Type::Unsigned, 0);
+        } else {
+            addUnsigned(Type::Negative, number - 1);
+        }
+    } else if (str == "true") {
+        addUnsigned(Type::Unsigned, 1);
+    } else if (str == "false") {
+        addUnsigned(Type::Unsigned, 0);
+    } else {
+        // Only accept plain decimal notation; strtod would also accept
+        // "inf", "nan" and hex floats.
+        if (str.empty() ||
+            str.find_first_not_of("0123456789.eE+-") != std::string::npos) {
+            return;
+        }
+        char* end = nullptr;
+        errno = 0;
+        const double dbl = std::strtod(str.c_str(), &end);
+        if (end != str.c_str() + str.size() || errno == ERANGE ||
+            !std::isfinite(dbl)) {
+            return;
+        }
+        uint64_t bits;
+        static_assert(sizeof(bits) == sizeof(dbl), "Unexpected double size");
+        std::memcpy(&bits, &dbl, sizeof(bits));
+        bits = htonll(bits);
+        values.push_back(char(Type::Double));
+        values.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+
+    ++count;
+    schema.append(key.data(), key.size());
+    schema.push_back('\n');
+}
+
+AddStatFn PackedStats::getAddStatFn() {
+    return [this](const char* key,
+                  const uint16_t klen,
+                  const char* val,
+                  const uint32_t vlen,
+                  gsl::not_null<const void*>) {
+        add({key, klen}, {val, vlen});
+    };
+}
+
+std::string PackedStats::getSchemaId() const {
+    return cb::to_hex(
+            crc32c(reinterpret_cast<const unsigned char*>(schema.data()),
+                   schema.size(),
+                   0));
+}
+
+std::string PackedStats::getValues() const {
+    cb::mcbp::unsigned_leb128<uint64_t> leb128(count);
+    std::string ret{reinterpret_cast<const char*>(leb128.data()),
+                    leb128.size()};
+    ret.append(values);
+    return ret;
+}
+
+void PackedStats::addUnsigned(Type type, uint64_t value) {
+    cb::mcbp::unsigned_leb128<uint64_t> leb128(value);
+    values.push_back(char(type));
+    values.append(reinterpret_cast<const char*>(leb128.data()), leb128.size());
+}
@@ -0,0 +1,79 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/engine_common.h>
+#include <platform/sized_buffer.h>
+
+#include <cstdint>
+#include <string>
+
+/**
+ * PackedStats collects the numeric stats of a stat group and encodes them
+ * in a compact form, so that a monitoring agent can fetch a whole group in
+ * three response packets (see "stats packed") rather than one packet per
+ * stat, and without parsing a text value for every stat.
+ *
+ * The encoding is split in two:
+ *
+ *  - the schema: the names of the packed stats, each terminated by '\n', in
+ *    the order their values appear. Its id (a crc32c of the schema, see
+ *    getSchemaId()) only changes when the set of stats changes, so an agent
+ *    can cache the schema and only ask for the values ("stats packed_values").
+ *
+ *  - the values: the number of values as an unsigned LEB128, followed by
+ *    each value as a one byte Type and its payload:
+ *      Unsigned: the value as an unsigned LEB128
+ *      Negative: the value's magnitude minus one as an unsigned LEB128
+ *      Double:   the IEEE 754 bit pattern as a big-endian uint64
+ *
+ * Stats whose value isn't a number are skipped. Booleans ("true"/"false")
+ * are packed as Unsigned 1/0.
+ */
+class PackedStats {
+public:
+    enum class Type : uint8_t { Unsigned = 0, Negative = 1, Double = 2 };
+
+    /// Add the stat to the packed stats if its value is a number.
+    void add(cb::const_char_buffer key, cb::const_char_buffer value);
+
+    /// @return an AddStatFn which adds each stat to this object.
+    AddStatFn getAddStatFn();
+
+    /// @return the number of packed stats.
+    size_t size() const {
+        return count;
+    }
+
+    const std::string& getSchema() const {
+        return schema;
+    }
+
+    /// @return the id of the schema (as hex string)
+    std::string getSchemaId() const;
+
+    /// @return the encoded values (count followed by each value)
+    std::string getValues() const;
+
+private:
+    void addUnsigned(Type type, uint64_t value);
+
+    size_t count = 0;
+    std::string schema;
+    // The encoded values, without the leading count
+    std::string values;
+};
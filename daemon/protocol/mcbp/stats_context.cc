@@ -29,8 +29,10 @@
 #include <daemon/mc_time.h>
 #include <daemon/mcaudit.h>
 #include <daemon/memcached.h>
+#include <daemon/packed_stats.h>
 #include <daemon/runtime.h>
 #include <daemon/settings.h>
+#include <daemon/stage_profiler.h>
 #include <daemon/stats.h>
 #include <daemon/stats_tasks.h>
 #include <daemon/topkeys.h>
@@ -387,6 +389,9 @@ static ENGINE_ERROR_CODE stat_reset_executor(const std::string& arg,
         // Nuke the command timings section for the connected bucket
         all_buckets[cookie.getConnection().getBucketIndex()].timings.reset();
         return ENGINE_SUCCESS;
+    } else if (arg == "stage_timings") {
+        stage_profiler.reset();
+        return ENGINE_SUCCESS;
     } else {
         return ENGINE_EINVAL;
     }
@@ -602,6 +607,38 @@ static ENGINE_ERROR_CODE stat_subdoc_execute_executor(const std::string& arg,
     }
 }
 
+/**
+ * Handler for the <code>stats stage_timings</code> command used to retrieve
+ * the time spent in each stage of the commands sampled by the StageProfiler.
+ * A stat is added for each opcode which has been profiled, containing a
+ * JSON object with a summary of each stage.
+ *
+ * @param arg - should be empty
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_stage_timings_executor(const std::string& arg,
+                                                     Cookie& cookie) {
+    if (!arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+
+    for (int ii = 0; ii < MAX_NUM_OPCODES; ++ii) {
+        const auto opcode = cb::mcbp::ClientOpcode(ii);
+        const auto json = stage_profiler.to_json(opcode);
+        if (json.is_null()) {
+            continue;
+        }
+        const auto key = to_string(opcode);
+        const auto value = json.dump();
+        append_stats(key.data(),
+                     gsl::narrow<uint16_t>(key.size()),
+                     value.data(),
+                     gsl::narrow<uint32_t>(value.size()),
+                     &cookie);
+    }
+    return ENGINE_SUCCESS;
+}
+
 static ENGINE_ERROR_CODE stat_responses_json_executor(const std::string& arg,
                                                       Cookie& cookie) {
     try {
@@ -711,6 +748,88 @@ static ENGINE_ERROR_CODE stat_bucket_stats(const std::string& arg,
     return bucket_get_stats(cookie, arg, appendStatsFn);
 }
 
+/**
+ * Collect the numeric stats of the stat group in arg into a PackedStats.
+ * The group is requested from the bucket (as for an unknown stat key), with
+ * the server stats added for the default ("") group; the groups computed by
+ * the daemon (topkeys, connections etc) can't be packed.
+ */
+static ENGINE_ERROR_CODE collect_packed_stats(const std::string& arg,
+                                              Cookie& cookie,
+                                              PackedStats& packed) {
+    auto add_stat = packed.getAddStatFn();
+    if (arg.empty()) {
+        auto ret = bucket_get_stats(cookie, arg, add_stat);
+        if (ret == ENGINE_SUCCESS) {
+            ret = server_stats(add_stat, cookie);
+        }
+        return ret;
+    }
+    return bucket_get_stats(cookie, arg, add_stat);
+}
+
+static void append_packed_stat(const std::string& key,
+                               const std::string& value,
+                               Cookie& cookie) {
+    append_stats(key.data(),
+                 gsl::narrow<uint16_t>(key.size()),
+                 value.data(),
+                 gsl::narrow<uint32_t>(value.size()),
+                 &cookie);
+}
+
+/**
+ * Handler for the <code>stats packed [group]</code> command, which returns
+ * the numeric stats of a stat group as three stats: "schema_id", "schema"
+ * and "values" (see PackedStats for the format).
+ *
+ * @param arg the stat group to pack (empty for the default stats)
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_packed_executor(const std::string& arg,
+                                              Cookie& cookie) {
+    PackedStats packed;
+    auto ret = collect_packed_stats(arg, cookie, packed);
+    if (ret == ENGINE_SUCCESS) {
+        append_packed_stat("schema_id", packed.getSchemaId(), cookie);
+        append_packed_stat("schema", packed.getSchema(), cookie);
+        append_packed_stat("values", packed.getValues(), cookie);
+    }
+    return ret;
+}
+
+/**
+ * Handler for the <code>stats packed_values schema_id [group]</code>
+ * command. As "stats packed", except that the schema is only returned if
+ * its id differs from the given one (previously returned by the server),
+ * so a client which has cached the schema only receives the values.
+ *
+ * @param arg the schema id, optionally followed by a space and the stat group
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_packed_values_executor(const std::string& arg,
+                                                     Cookie& cookie) {
+    if (arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+    const auto index = arg.find(' ');
+    const auto schemaId = arg.substr(0, index);
+    const auto group =
+            index == std::string::npos ? std::string{} : arg.substr(index + 1);
+
+    PackedStats packed;
+    auto ret = collect_packed_stats(group, cookie, packed);
+    if (ret == ENGINE_SUCCESS) {
+        const auto currentId = packed.getSchemaId();
+        append_packed_stat("schema_id", currentId, cookie);
+        if (currentId != schemaId) {
+            append_packed_stat("schema", packed.getSchema(), cookie);
+        }
+        append_packed_stat("values", packed.getValues(), cookie);
+    }
+    return ret;
+}
+
 /***************************** STAT HANDLERS *****************************/
 
 struct command_stat_handler {
@@ -741,7 +860,10 @@ static std::unordered_map<std::string, struct command_stat_handler>
                 {"topkeys", {false, stat_topkeys_executor}},
                 {"topkeys_json", {false, stat_topkeys_json_executor}},
                 {"subdoc_execute", {false, stat_subdoc_execute_executor}},
+                {"stage_timings", {false, stat_stage_timings_executor}},
                 {"responses", {false, stat_responses_json_executor}},
+                {"packed", {false, stat_packed_executor}},
+                {"packed_values", {false, stat_packed_values_executor}},
                 {"tracing", {true, stat_tracing_executor}}};
 
 /**
@@ -450,6 +450,29 @@ static void handle_system_connections(Settings& s, const nlohmann::json& obj) {
     s.setSystemConnections(obj.get<size_t>());
 }
 
+static void handle_dcp_step_batch_size(Settings& s,
+                                       const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(
+                R"("dcp_step_batch_size" must be a positive number)");
+    }
+    const auto value = obj.get<size_t>();
+    if (value == 0) {
+        throw std::invalid_argument(
+                R"("dcp_step_batch_size" must be a positive number)");
+    }
+    s.setDcpStepBatchSize(value);
+}
+
+static void handle_stage_profiling_sample_rate(Settings& s,
+                                               const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(
+                R"("stage_profiling_sample_rate" must be an unsigned number)");
+    }
+    s.setStageProfilingSampleRate(obj.get<size_t>());
+}
+
 /**
  * Handle the "sasl_mechanisms" tag in the settings
  *
@@ -627,6 +650,9 @@ void Settings::reconfigure(const nlohmann::json& json) {
             {"max_packet_size", handle_max_packet_size},
             {"max_connections", handle_max_connections},
             {"system_connections", handle_system_connections},
+            {"dcp_step_batch_size", handle_dcp_step_batch_size},
+            {"stage_profiling_sample_rate",
+             handle_stage_profiling_sample_rate},
             {"sasl_mechanisms", handle_sasl_mechanisms},
             {"ssl_sasl_mechanisms", handle_ssl_sasl_mechanisms},
             {"stdin_listener", handle_stdin_listener},
@@ -916,6 +942,24 @@ void Settings::updateSettings(const Settings& other, bool apply) {
         }
     }
 
+    if (other.has.dcp_step_batch_size) {
+        if (other.dcp_step_batch_size != dcp_step_batch_size) {
+            LOG_INFO(R"(Change DCP step batch size from {} to {})",
+                     dcp_step_batch_size,
+                     other.dcp_step_batch_size);
+            setDcpStepBatchSize(other.dcp_step_batch_size);
+        }
+    }
+
+    if (other.has.stage_profiling_sample_rate) {
+        if (other.stage_profiling_sample_rate != stage_profiling_sample_rate) {
+            LOG_INFO(R"(Change stage profiling sample rate from {} to {})",
+                     stage_profiling_sample_rate,
+                     other.stage_profiling_sample_rate);
+            setStageProfilingSampleRate(other.stage_profiling_sample_rate);
+        }
+    }
+
     if (other.has.xattr_enabled) {
         if (other.xattr_enabled != xattr_enabled) {
             LOG_INFO("{} XATTR",
@@ -329,6 +329,50 @@ public:
         return getMaxConnections() - getSystemConnections();
     }
 
+    /**
+     * Get the maximum number of DCP messages to encode into the write
+     * buffer of a connection before it is flushed to the network.
+     */
+    size_t getDcpStepBatchSize() const {
+        return dcp_step_batch_size.load(std::memory_order_consume);
+    }
+
+    /**
+     * Set the maximum number of DCP messages to encode into the write
+     * buffer of a connection before it is flushed to the network.
+     *
+     * @param dcp_step_batch_size the new batch size (1 sends every message
+     *                            on its own)
+     */
+    void setDcpStepBatchSize(size_t dcp_step_batch_size) {
+        Settings::dcp_step_batch_size.store(dcp_step_batch_size,
+                                            std::memory_order_release);
+        has.dcp_step_batch_size = true;
+        notify_changed("dcp_step_batch_size");
+    }
+
+    /**
+     * Get the rate at which commands are sampled for stage profiling; one
+     * in every N commands on each front-end thread is profiled (0 disables
+     * stage profiling).
+     */
+    size_t getStageProfilingSampleRate() const {
+        return stage_profiling_sample_rate.load(std::memory_order_consume);
+    }
+
+    /**
+     * Set the rate at which commands are sampled for stage profiling
+     *
+     * @param stage_profiling_sample_rate profile one in every N commands
+     *                                    (0 disables stage profiling)
+     */
+    void setStageProfilingSampleRate(size_t stage_profiling_sample_rate) {
+        Settings::stage_profiling_sample_rate.store(
+                stage_profiling_sample_rate, std::memory_order_release);
+        has.stage_profiling_sample_rate = true;
+        notify_changed("stage_profiling_sample_rate");
+    }
+
     /**
      * Set the number of request to handle per notification from the
      * event library
@@ -965,6 +1009,12 @@ protected:
     /// The pool of connections reserved for system usage
     std::atomic<size_t> system_connections{5000};
 
+    /// The maximum number of DCP messages to encode per flush
+    std::atomic<size_t> dcp_step_batch_size{1};
+
+    /// Profile the stages of one in every N commands (0 = disabled)
+    std::atomic<size_t> stage_profiling_sample_rate{100};
+
     /// The configuration used by OpenTracing
     std::shared_ptr<OpenTracingConfig> opentracing_config;
 
@@ -1014,6 +1064,8 @@ public:
         bool active_external_users_push_interval = false;
         bool max_connections = false;
         bool system_connections = false;
+        bool dcp_step_batch_size = false;
+        bool stage_profiling_sample_rate = false;
         bool opentracing_config = false;
     } has;
 
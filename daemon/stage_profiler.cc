@@ -0,0 +1,118 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "stage_profiler.h"
+#include "settings.h"
+
+#include <nlohmann/json.hpp>
+#include <tracing/tracer.h>
+
+#include <memory>
+
+StageProfiler stage_profiler;
+
+constexpr size_t StageProfiler::NumStages;
+
+StageProfiler::StageProfiler() {
+    for (auto& histograms : opcodes) {
+        histograms.store(nullptr);
+    }
+}
+
+StageProfiler::~StageProfiler() {
+    for (auto& histograms : opcodes) {
+        delete histograms.load();
+    }
+}
+
+bool StageProfiler::shouldSample() {
+    const auto rate = settings.getStageProfilingSampleRate();
+    if (rate == 0) {
+        return false;
+    }
+    static thread_local size_t counter = 0;
+    return (++counter % rate) == 0;
+}
+
+void StageProfiler::record(cb::mcbp::ClientOpcode opcode,
+                           const cb::tracing::Tracer& tracer) {
+    const auto& spans = tracer.getDurations();
+    if (spans.empty()) {
+        return;
+    }
+
+    using Duration = cb::tracing::Span::Duration;
+    std::array<Duration, NumStages> durations{};
+    std::array<bool, NumStages> recorded{};
+    for (const auto& span : spans) {
+        if (span.duration == Duration::max()) {
+            // Never completed
+            continue;
+        }
+        const auto stage = size_t(span.code);
+        durations[stage] += span.duration;
+        recorded[stage] = true;
+    }
+
+    auto& histograms = getHistograms(opcode);
+    for (size_t stage = 0; stage < NumStages; ++stage) {
+        if (recorded[stage]) {
+            histograms[stage].add(durations[stage]);
+        }
+    }
+}
+
+nlohmann::json StageProfiler::to_json(cb::mcbp::ClientOpcode opcode) const {
+    const auto* histograms = opcodes[uint8_t(opcode)].load();
+    if (histograms == nullptr) {
+        return {};
+    }
+
+    nlohmann::json json;
+    for (size_t stage = 0; stage < NumStages; ++stage) {
+        const auto& histogram = (*histograms)[stage];
+        if (histogram.get_total() > 0) {
+            json[::to_string(cb::tracing::TraceCode(stage))] =
+                    histogram.getSummary();
+        }
+    }
+    return json;
+}
+
+void StageProfiler::reset() {
+    for (auto& entry : opcodes) {
+        auto* histograms = entry.load();
+        if (histograms) {
+            for (auto& histogram : *histograms) {
+                histogram.reset();
+            }
+        }
+    }
+}
+
+StageProfiler::StageHistograms& StageProfiler::getHistograms(
+        cb::mcbp::ClientOpcode opcode) {
+    auto& entry = opcodes[uint8_t(opcode)];
+    auto* histograms = entry.load();
+    if (histograms == nullptr) {
+        auto created = std::make_unique<StageHistograms>();
+        if (entry.compare_exchange_strong(histograms, created.get())) {
+            histograms = created.release();
+        }
+        // else another thread won the race; histograms now holds its copy
+    }
+    return *histograms;
+}
@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "timing_histogram.h"
+#include "timings.h"
+
+#include <mcbp/protocol/opcode.h>
+#include <nlohmann/json_fwd.hpp>
+#include <tracing/tracetypes.h>
+
+#include <array>
+#include <atomic>
+
+namespace cb {
+namespace tracing {
+class Tracer;
+} // namespace tracing
+} // namespace cb
+
+/**
+ * StageProfiler attributes the latency of commands to the stages they spend
+ * their time in (parsing, executing, waiting for the engine to notify
+ * completion, background fetches, waiting for durability, sending the
+ * response etc).
+ *
+ * Full tracing is only performed for clients which ask for it, so instead
+ * a sample of all commands (see Settings::getStageProfilingSampleRate) is
+ * profiled: the stages of a sampled command are recorded as Spans in the
+ * cookie's Tracer as if tracing was enabled, and once its response has
+ * been sent the duration of each stage is added to a per-opcode, per-stage
+ * TimingHistogram. The histograms are reported by "stats stage_timings".
+ * Stages may overlap; for example a background fetch or durability wait
+ * takes place while the command is in the ewouldblock wait stage.
+ *
+ * The histograms for an opcode are only allocated once a command with that
+ * opcode has been profiled.
+ */
+class StageProfiler {
+public:
+    StageProfiler();
+    ~StageProfiler();
+
+    StageProfiler(const StageProfiler&) = delete;
+    StageProfiler& operator=(const StageProfiler&) = delete;
+
+    /**
+     * Should the command about to be started on the calling thread be
+     * profiled? One in every N commands on each thread is sampled.
+     */
+    static bool shouldSample();
+
+    /**
+     * Add the duration of each stage recorded in tracer to the histograms
+     * of the given opcode. Stages recorded more than once (e.g. a command
+     * which blocked several times) are summed; stages which were never
+     * completed are ignored.
+     */
+    void record(cb::mcbp::ClientOpcode opcode,
+                const cb::tracing::Tracer& tracer);
+
+    /**
+     * Get a summary (see TimingHistogram::getSummary) of each stage of the
+     * given opcode, keyed by the name of the stage. Null if no command with
+     * the opcode has been profiled.
+     */
+    nlohmann::json to_json(cb::mcbp::ClientOpcode opcode) const;
+
+    /// Clear all of the histograms
+    void reset();
+
+    static constexpr size_t NumStages =
+            size_t(cb::tracing::TraceCode::SEND) + 1;
+
+private:
+    using StageHistograms = std::array<TimingHistogram, NumStages>;
+
+    /// Get the histograms for the opcode, creating them if necessary
+    StageHistograms& getHistograms(cb::mcbp::ClientOpcode opcode);
+
+    /// Per-opcode histograms; null until the opcode is first profiled
+    std::array<std::atomic<StageHistograms*>, MAX_NUM_OPCODES> opcodes;
+};
+
+extern StageProfiler stage_profiler;
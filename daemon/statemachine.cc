@@ -35,6 +35,13 @@
 #include <platform/string_hex.h>
 #include <gsl/gsl>
 
+/**
+ * The size of the write buffer we try to make available before encoding
+ * a batch of DCP messages. Values are only copied into it when they are
+ * small, so this is normally enough for a full batch.
+ */
+static const size_t dcpBatchWriteBufferSize = 64 * 1024;
+
 void StateMachine::setCurrentState(State task) {
     // Moving to the same state is legal
     if (task == currentState) {
@@ -193,8 +200,31 @@ bool StateMachine::conn_ship_log() {
             cookie.setEwouldblock(false);
             cont = true;
 
-            const auto ret = connection.getBucket().getDcpIface()->step(
-                    static_cast<const void*>(&cookie), &connection);
+            // Encode up to dcp_step_batch_size messages into the write
+            // buffer before we flush it to the network, so that small
+            // documents don't pay for a send per message. The headers end
+            // up back to back in the write buffer (and addIov merges them
+            // into a single entry) so the entire batch is typically sent
+            // with a single sendmsg.
+            const auto batchSize = settings.getDcpStepBatchSize();
+            if (batchSize > 1 && connection.write->empty()) {
+                connection.write->ensureCapacity(dcpBatchWriteBufferSize);
+            }
+
+            auto* dcp = connection.getBucket().getDcpIface();
+            size_t encoded = 0;
+            ENGINE_ERROR_CODE ret;
+            do {
+                ret = dcp->step(static_cast<const void*>(&cookie),
+                                &connection);
+            } while (ret == ENGINE_SUCCESS && ++encoded < batchSize);
+
+            if (encoded > 0 &&
+                (ret == ENGINE_EWOULDBLOCK || ret == ENGINE_E2BIG)) {
+                // Ship what we've got. The engine keeps the message which
+                // didn't fit and returns it from the next step.
+                ret = ENGINE_SUCCESS;
+            }
 
             switch (connection.remapErrorCode(ret)) {
             case ENGINE_SUCCESS:
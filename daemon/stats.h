@@ -20,6 +20,7 @@
 
 #include "listening_port.h"
 
+#include <platform/cacheline_padded.h>
 #include <relaxed_atomic.h>
 
 #include <cstdint>
@@ -119,9 +120,10 @@ struct thread_stats {
         return *this;
     }
 
-    void aggregate(const std::vector<thread_stats>& thread_stats) {
+    void aggregate(
+            const std::vector<cb::CachelinePadded<thread_stats>>& thread_stats) {
         for (auto& ii : thread_stats) {
-            *this += ii;
+            *this += *ii.get();
         }
     }
 
@@ -426,9 +426,10 @@ void notify_dispatcher() {
 
 /******************************* GLOBAL STATS ******************************/
 
-void threadlocal_stats_reset(std::vector<thread_stats>& thread_stats) {
+void threadlocal_stats_reset(
+        std::vector<cb::CachelinePadded<thread_stats>>& thread_stats) {
     for (auto& ii : thread_stats) {
-        ii.reset();
+        ii->reset();
     }
 }
 
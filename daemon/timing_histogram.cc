@@ -18,187 +18,206 @@
 #include "timing_histogram.h"
 
 #include <nlohmann/json.hpp>
+#include <utilities/hdrhistogram.h>
+#include <utilities/thread_index.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
-#include <functional>
-#include <gsl/gsl>
-#include <sstream>
 #include <string>
+#include <vector>
 
-TimingHistogram::TimingHistogram() {
-    reset();
-}
-
-TimingHistogram::TimingHistogram(const TimingHistogram &other) {
-    *this = other;
-}
-
-template <template <typename ...Args> class F>
-void TimingHistogram::arith_op(TimingHistogram& a, const TimingHistogram& b) {
-    a.ns = F<uint32_t>()(a.ns, b.ns);
+namespace {
+/**
+ * Largest value (in µs) which is tracked. Anything slower is recorded as
+ * this value, which still lands in the "80s-inf" bucket.
+ */
+const uint64_t MaxTrackedUsec = 120 * 1000 * 1000;
 
-    size_t idx;
-    size_t len = a.usec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.usec[idx] = F<uint32_t>()(a.usec[idx], b.usec[idx]);
-    }
+/// The percentiles reported by to_string()
+const std::array<double, 6> ReportedPercentiles = {
+        {50.0, 90.0, 95.0, 99.0, 99.9, 99.99}};
+} // namespace
 
-    len = a.msec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.msec[idx] = F<uint32_t>()(a.msec[idx], b.msec[idx]);
-    }
+constexpr size_t TimingHistogram::NumShards;
 
-    len = a.halfsec.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.halfsec[idx] = F<uint32_t>()(a.halfsec[idx], b.halfsec[idx]);
-    }
+TimingHistogram::TimingHistogram() = default;
 
-    len = a.wayout.size();
-    for (idx = 0; idx < len; ++idx) {
-        a.wayout[idx] = F<uint32_t>()(a.wayout[idx], b.wayout[idx]);
-    }
-    a.total = F<uint64_t>()(a.total, b.total);
+TimingHistogram::TimingHistogram(const TimingHistogram &other) {
+    *this = other;
 }
 
-template <typename T>
-struct identity {
-    T operator() (const T& a, const T& b) {
-        return b;
-    }
-};
+TimingHistogram::~TimingHistogram() = default;
 
 /**
- * This isn't completely accurate, but it's only called whenever we're
- * grabbing the stats. We don't want to create a lock in order to make
- * sure that "total" is in 100% sync with all of the samples.. We
- * don't care <em>THAT</em> much for being accurate..
+ * Samples recorded into other while it is being copied may or may not be
+ * included; we don't want to block every front-end thread in order to take
+ * a 100% consistent copy.
  */
 TimingHistogram& TimingHistogram::operator=(const TimingHistogram& other) {
-    TimingHistogram::arith_op<identity>(*this, other);
+    if (this != &other) {
+        auto merged = other.aggregate();
+        reset();
+        auto& shard = *shards.front();
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        shard.histogram = std::move(merged);
+    }
     return *this;
 }
 
 /**
- * As per operator=, this isn't completely accurate/consistent, but it's only
- * called whenever we're grabbing the stats.
+ * As per operator=, this isn't completely consistent with samples recorded
+ * while it runs, but it's only called whenever we're grabbing the stats.
  */
 TimingHistogram& TimingHistogram::operator+=(const TimingHistogram& other) {
-    TimingHistogram::arith_op<std::plus>(*this, other);
+    // Merge other before locking any of our shards, so that adding a
+    // histogram to itself doesn't deadlock.
+    auto merged = other.aggregate();
+    auto& shard = *shards.front();
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    if (shard.histogram) {
+        *shard.histogram += *merged;
+    } else {
+        shard.histogram = std::move(merged);
+    }
     return *this;
 }
 
 void TimingHistogram::reset() {
-    ns = 0;
-    for (auto& us : usec) {
-        us.reset();
-    }
-    for (auto& ms : msec) {
-        ms.reset();
-    }
-    for (auto& hs : halfsec) {
-        hs.reset();
-    }
-    for (auto& wo: wayout) {
-        wo.reset();
+    for (auto& s : shards) {
+        auto& shard = *s;
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        if (shard.histogram) {
+            shard.histogram->reset();
+        }
     }
-    total.reset();
 }
 
 void TimingHistogram::add(std::chrono::nanoseconds nsec) {
     using namespace std::chrono;
-    using halfseconds = duration<long long, std::ratio<1, 2>>;
-
-    auto us = duration_cast<microseconds>(nsec);
-    auto ms = duration_cast<milliseconds>(us);
-    auto hs = duration_cast<halfseconds>(ms);
-
-    if (us.count() == 0) {
-        ns++;
-    } else if (us.count() < 1000) {
-        usec[us.count() / 10]++;
-    } else if (ms.count() < 50) {
-        msec[ms.count()]++;
-    } else if (hs.count() < 10) {
-        halfsec[hs.count()]++;
-    } else {
-        // [5-9], [10-19], [20-39], [40-79], [80-inf].
-        auto sec = duration_cast<seconds>(hs);
-        if (sec.count() < 10) {
-            wayout[0]++;
-        } else if (sec.count() < 20) {
-            wayout[1]++;
-        } else if (sec.count() < 40) {
-            wayout[2]++;
-        } else if (sec.count() < 80) {
-            wayout[3]++;
-        } else {
-            wayout[4]++;
-        }
+    const auto us = duration_cast<microseconds>(nsec).count();
+    const auto value =
+            std::min(MaxTrackedUsec, uint64_t(std::max(decltype(us)(0), us)));
+
+    auto& shard = *shards[cb::getThreadIndex() % NumShards];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    if (!shard.histogram) {
+        shard.histogram = makeHistogram();
     }
-    total++;
+    shard.histogram->addValue(value);
 }
 
-std::string TimingHistogram::to_string() {
-    nlohmann::json json;
-
-    json["ns"] = get_ns();
-
-    std::vector<uint32_t> array;
-    for (auto &us : usec) {
-        array.push_back(us);
-    }
-    json["us"] = array;
+std::unique_ptr<HdrHistogram> TimingHistogram::makeHistogram() const {
+    return std::make_unique<HdrHistogram>(0, MaxTrackedUsec, 2);
+}
 
-    array.clear();
-    size_t len = msec.size();
-    // element 0 isn't used
-    for (size_t ii = 1; ii < len; ii++) {
-        array.push_back(get_msec(gsl::narrow<uint8_t>(ii)));
+std::unique_ptr<HdrHistogram> TimingHistogram::aggregate() const {
+    auto ret = makeHistogram();
+    for (const auto& s : shards) {
+        const auto& shard = *s;
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        if (shard.histogram) {
+            *ret += *shard.histogram;
+        }
     }
-    json["ms"] = array;
-
-    array.clear();
+    return ret;
+}
 
-    for (auto &hs : halfsec) {
-        array.push_back(hs);
+std::string TimingHistogram::to_string() const {
+    const auto histogram = aggregate();
+
+    // Rebuild the buckets of the original fixed-bucket histogram. Values are
+    // only held to the precision of the HdrHistogram, so a sample within 1%
+    // of a bucket boundary may be reported in the neighbouring bucket.
+    uint64_t ns = 0;
+    std::vector<uint64_t> usec(100);
+    std::vector<uint64_t> msec(50); // element 0 isn't used
+    std::vector<uint64_t> halfsec(10);
+    // [5-9], [10-19], [20-39], [40-79], [80-inf].
+    std::array<uint64_t, 5> wayout{};
+
+    auto iter = histogram->makeRecordedIterator();
+    while (auto pair = histogram->getNextValueAndCount(iter)) {
+        const auto us = pair->first;
+        const auto count = pair->second;
+        if (us == 0) {
+            ns += count;
+        } else if (us < 1000) {
+            usec[us / 10] += count;
+        } else if (us < 50 * 1000) {
+            msec[us / 1000] += count;
+        } else if (us < 5000 * 1000) {
+            halfsec[us / (500 * 1000)] += count;
+        } else {
+            const auto sec = us / (1000 * 1000);
+            if (sec < 10) {
+                wayout[0] += count;
+            } else if (sec < 20) {
+                wayout[1] += count;
+            } else if (sec < 40) {
+                wayout[2] += count;
+            } else if (sec < 80) {
+                wayout[3] += count;
+            } else {
+                wayout[4] += count;
+            }
+        }
     }
-    json["500ms"] = array;
 
-    json["5s-9s"] = get_wayout(0);
-    json["10s-19s"] = get_wayout(1);
-    json["20s-39s"] = get_wayout(2);
-    json["40s-79s"] = get_wayout(3);
-    json["80s-inf"] = get_wayout(4);
+    nlohmann::json json;
+    json["ns"] = ns;
+    json["us"] = usec;
+    json["ms"] = std::vector<uint64_t>(msec.begin() + 1, msec.end());
+    json["500ms"] = halfsec;
+    json["5s-9s"] = wayout[0];
+    json["10s-19s"] = wayout[1];
+    json["20s-39s"] = wayout[2];
+    json["40s-79s"] = wayout[3];
+    json["80s-inf"] = wayout[4];
 
     // for backwards compatibility, add the old wayouts
-    json["wayout"] = aggregate_wayout();
+    uint64_t aggregated = 0;
+    for (auto wo : wayout) {
+        aggregated += wo;
+    }
+    json["wayout"] = aggregated;
 
+    addSummary(json, *histogram);
     return json.dump();
 }
 
-/* get functions of Timings class */
-
-uint32_t TimingHistogram::get_ns() {
-    return ns;
-}
-
-uint32_t TimingHistogram::get_msec(uint8_t index) {
-    return msec[index];
+nlohmann::json TimingHistogram::getSummary() const {
+    nlohmann::json json;
+    addSummary(json, *aggregate());
+    return json;
 }
 
-uint32_t TimingHistogram::get_wayout(uint8_t index) {
-    return wayout[index];
+void TimingHistogram::addSummary(nlohmann::json& json,
+                                 const HdrHistogram& histogram) {
+    // The precise values (all in µs) from the HdrHistogram
+    json["total"] = histogram.getValueCount();
+    json["min"] = histogram.getMinValue();
+    json["max"] = histogram.getMaxValue();
+    json["mean"] = histogram.getMean();
+    nlohmann::json percentiles;
+    for (auto p : ReportedPercentiles) {
+        percentiles.push_back({p, histogram.getValueAtPercentile(p)});
+    }
+    json["percentiles"] = percentiles;
 }
 
-uint32_t TimingHistogram::aggregate_wayout() {
-    uint32_t ret = 0;
-    for (auto &wo : wayout) {
-        ret += wo;
+uint64_t TimingHistogram::get_total() const {
+    uint64_t total = 0;
+    for (const auto& s : shards) {
+        const auto& shard = *s;
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        if (shard.histogram) {
+            total += shard.histogram->getValueCount();
+        }
     }
-    return ret;
+    return total;
 }
 
-uint64_t TimingHistogram::get_total() {
-    return total;
+uint64_t TimingHistogram::getValueAtPercentile(double percentile) const {
+    return aggregate()->getValueAtPercentile(percentile);
 }
@@ -16,14 +16,33 @@
  */
 #pragma once
 
-#include <relaxed_atomic.h>
+#include <nlohmann/json_fwd.hpp>
+#include <platform/cacheline_padded.h>
+
 #include <array>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 
+class HdrHistogram;
+
 /** Records timings of some event, accumulating them in a histogram.
  *
- * Histogram has buckets of approximately exponentially increasing sizes:
+ * Samples are recorded (with microsecond resolution) in HdrHistograms with
+ * two significant figures of precision, so percentiles are accurate to
+ * within 1% regardless of the magnitude of the value. To keep add() cheap
+ * when called from many front-end threads the histogram is split into a
+ * number of cache-line padded shards; each thread records into the shard
+ * assigned to it (so the shard mutex is normally uncontended), and the
+ * shards are merged when the histogram is read. The HdrHistogram for a
+ * shard is only allocated once a sample is recorded into it, so an unused
+ * TimingHistogram (e.g. for an opcode which is never seen) is small.
+ *
+ * to_string() reports the precise percentiles along with the buckets of
+ * the original fixed-bucket format, which clients such as ns_server and
+ * older mctimings still depend on:
  *
  *     - Less than or equal to 1 microsecond (µs)
  *     - [10-19], [20-29], ..., [900-999] µs
@@ -38,35 +57,44 @@ public:
     TimingHistogram(const TimingHistogram &other);
     TimingHistogram& operator=(const TimingHistogram &other);
     TimingHistogram& operator+=(const TimingHistogram& other);
+    ~TimingHistogram();
 
     void reset();
     void add(std::chrono::nanoseconds nsec);
-    std::string to_string();
-    uint64_t get_total();
+    std::string to_string() const;
+    uint64_t get_total() const;
+
+    /**
+     * Get the value (in microseconds) at the given percentile (0-100) of
+     * all the recorded samples, or 0 if there are none.
+     */
+    uint64_t getValueAtPercentile(double percentile) const;
 
+    /**
+     * Get a summary of the samples without the legacy buckets: the total,
+     * min, max, mean and a set of percentiles (all in microseconds).
+     */
+    nlohmann::json getSummary() const;
+
+    /// Number of shards samples are spread over
+    static constexpr size_t NumShards = 8;
 
 private:
-    uint32_t get_ns();
-    uint32_t get_msec(uint8_t index);
-    uint32_t get_wayout(uint8_t index);
-    uint32_t aggregate_wayout();
+    /// Create an (empty) HdrHistogram with the precision and range used
+    std::unique_ptr<HdrHistogram> makeHistogram() const;
+
+    /// @return a histogram holding the samples of all the shards
+    std::unique_ptr<HdrHistogram> aggregate() const;
+
+    /// Add the summary (see getSummary()) of histogram to json
+    static void addSummary(nlohmann::json& json, const HdrHistogram& histogram);
 
-    // This helper is used for operator overloads. It is supplied a
-    // class such as std::plus, std::minus; with the first argument (of
-    // the class's function) being the current value and the second being
-    // the new value.
-    template <template <typename ...Args> class F>
-    static void arith_op(TimingHistogram& dst, const TimingHistogram& src);
+    struct Shard {
+        /// Guards histogram; only contended when reading the histogram
+        mutable std::mutex mutex;
+        /// Created on the first add() to this shard
+        std::unique_ptr<HdrHistogram> histogram;
+    };
 
-    /* We collect timings for <=1 us */
-    cb::RelaxedAtomic<uint32_t> ns;
-    /* We collect timings per 10usec */
-    std::array<cb::RelaxedAtomic<uint32_t>, 100> usec;
-    /* we collect timings from 0-49 ms (entry 0 is never used!) */
-    std::array<cb::RelaxedAtomic<uint32_t>, 50> msec;
-    std::array<cb::RelaxedAtomic<uint32_t>, 10> halfsec;
-    // wayout use the following buckets:
-    // [5-9], [10-19], [20-39], [40-79], [80-inf].
-    std::array<cb::RelaxedAtomic<uint32_t>, 5> wayout;
-    cb::RelaxedAtomic<uint64_t> total;
+    std::array<cb::CachelinePadded<Shard>, NumShards> shards;
 };
@@ -22,74 +22,61 @@
 #include <nlohmann/json.hpp>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <utilities/thread_index.h>
 #include <algorithm>
 #include <cstring>
 #include <gsl/gsl>
 #include <stdexcept>
+#include <unordered_map>
 
 /*
  * Implementation Details
  *
  * === TopKeys ===
  *
- * The TopKeys class is split into NUM_SHARDS shards, each which owns
- * 1/NUM_SHARDS of the keyspace. This is to allow some level of
- * concurrent access - each shard has a mutex guarding all access.
- * Other than that the TopKeys class is pretty uninteresting - it
- * simply passes on requests to the correct Shard, and when statistics
- * are requested it aggregates information from each shard.
+ * The TopKeys class is split into NUM_SHARDS shards. Each thread is assigned
+ * a shard the first time it updates a key, and always updates that shard -
+ * independently of which key is accessed. Each shard has a mutex guarding all
+ * access, but as the number of front-end threads is normally close to
+ * NUM_SHARDS it is rarely contended (a hot key is not a hot mutex).
+ * When statistics are requested the shards are merged: the counts of a key
+ * tracked by several shards are summed and the top max_keys keys are
+ * reported.
  *
  * === TopKeys::Shard ===
  *
- * This is where the action happens. Each Shard maintains an ordered
- * list of key names and related statistics, orded by when they were
- * last accessed. There is a fixed number of keys each Shard tracks.
-
- * Given we generally track only a small number of keys per shard (10
- * by default), it's highly likely that any one key access will 'miss'
- * - i.e. not find an existing topkey. Therefore this class is
- * optimized for that case, attempting to minimise memory allocation
- * in steady-state.
+ * Each Shard is a "space-saving" heavy-hitter sketch of (up to)
+ * max_keys / NUM_SHARDS keys, where max_keys is the number of keys reported
+ * by TopKeys; all shards together hold no more than the keys reported. Keys
+ * updated by a single thread are therefore limited to the keys of one shard.
  *
- * Internally Shard consists of a vector of topkey_t, storing the
- * current max_keys top_keys, and a list of topkey_t pointers, used to
- * main the current most -> least recently used ordering:
-
- * max_keys elements. Each element is a tuple of
- * {hash(key), key, topkey_stats}:
- *
- *
- *       vector<topkey_t>
- *   +----------+-------------+---------------+
- *   | size_t   | std::string | topkey_item_t |
- *   +----------+-------------+---------------+
- *   | <hash 1> | <key 1>     | stats 1       | <--- Node1
- *   | <hash 2> | <key 2>     | stats 2       | <--- Node2
- *   | <hash 3> | <key 3>     | stats 3       | <--- Node3
- *   . ....                                   .
- *   | <hash N> | <key N>     | stats N       | <--- NodeN
- *   +----------------------------------------+
- *
- *   Node3 <---> Node1 <---> ... <---> Node2
- *   ^^^                               ^^^
- *   MRU                               LRU
+ * Internally Shard consists of a vector of topkey_t storing the key and
+ * related statistics, and a parallel vector of the keys' hashes:
  *
+ *   vector<size_t>     vector<topkey_t>
+ *   +----------+       +-------------+---------------+
+ *   | <hash 1> |       | <key 1>     | stats 1       |
+ *   | <hash 2> |       | <key 2>     | stats 2       |
+ *   . ....     .       . ....                        .
+ *   | <hash N> |       | <key N>     | stats N       |
+ *   +----------+       +-----------------------------+
  *
  * Upon a key 'hit', TopKeys::updateKey() is called. That hashes the
- * key, and finds the Shard responsible for that
- * key. TopKeys::Shard::updateKey() is then called.
+ * key, and calls TopKeys::Shard::updateKey() on the calling thread's Shard.
  *
- * Shard::updateKey() iterates over the vector, searching for a hash
- * match with an existing element, using the actual key string to
- * validate (in case of a hash collision). If it is found, then the
- * stats are simply updated.  If it is not found, then the
- * least-recently-used element is selected as a 'victim' and it's
- * contents is replaced by the incoming key.  Finally the linked-list
- * is updated to move the updated element to the head of the list.
+ * Shard::updateKey() makes a single pass over the vectors searching for a
+ * hash match with an existing element (using the actual key string to
+ * validate, in case of a hash collision), while noting the element with the
+ * lowest access count. If a match is found then its count is simply
+ * incremented. If not, and the Shard is full, then the element with the
+ * lowest count is selected as a 'victim': its contents is replaced by the
+ * incoming key, which inherits (and increments) the victim's count.
+ * Inheriting the count is what ensures that a frequently accessed key cannot
+ * be repeatedly evicted by a stream of distinct, rarely accessed keys (as
+ * could happen with the LRU list previously used).
  */
 
-
-TopKeys::TopKeys(int mkeys) {
+TopKeys::TopKeys(int mkeys) : max_keys(mkeys * NUM_SHARDS) {
     for (auto& shard : shards) {
         shard.setMaxKeys(mkeys);
     }
@@ -125,28 +112,8 @@ ENGINE_ERROR_CODE TopKeys::json_stats(nlohmann::json& object,
     return ENGINE_SUCCESS;
 }
 
-TopKeys::Shard& TopKeys::getShard(size_t key_hash) {
-    /* This is special-cased for 8 */
-    static_assert(NUM_SHARDS == 8,
-                  "Topkeys::getShard() special-cased for SHARDS==8");
-    return shards[key_hash & 0x7];
-}
-
-TopKeys::Shard::topkey_t*
-TopKeys::Shard::searchForKey(size_t key_hash,
-                             const cb::const_char_buffer& key) {
-
-    for (auto& topkey : storage) {
-        if (topkey.first.hash == key_hash) {
-            // Double-check with full compare
-            if (topkey.first.key.compare(0, topkey.first.key.size(),
-                                         key.buf, key.len) == 0) {
-                // Match found.
-                return &topkey;
-            }
-        }
-    }
-    return nullptr;
+TopKeys::Shard& TopKeys::getShard() {
+    return shards[cb::getThreadIndex() % NUM_SHARDS];
 }
 
 bool TopKeys::Shard::updateKey(const cb::const_char_buffer& key,
@@ -155,38 +122,39 @@ bool TopKeys::Shard::updateKey(const cb::const_char_buffer& key,
     try {
         std::lock_guard<std::mutex> lock(mutex);
 
-        topkey_t* found_key = searchForKey(key_hash, key);
+        topkey_t* found_key = nullptr;
+        size_t victim = 0;
+        for (size_t ii = 0; ii < hashes.size(); ++ii) {
+            if (hashes[ii] == key_hash &&
+                // Double-check with full compare
+                storage[ii].first.compare(
+                        0, storage[ii].first.size(), key.buf, key.len) == 0) {
+                // Match found.
+                found_key = &storage[ii];
+                break;
+            }
+            if (storage[ii].second.ti_access_count <
+                storage[victim].second.ti_access_count) {
+                victim = ii;
+            }
+        }
 
-        if (found_key == NULL) {
+        if (found_key == nullptr) {
             // Key not found.
             if (storage.size() == max_keys) {
-                // Re-use the lowest keys' storage.
-                found_key = list.back();
-                found_key->first.hash = key_hash;
-                found_key->first.key.assign(key.buf, key.len);
-                found_key->second = topkey_item_t(ct);
-
-                // Move back element to the front, shuffling down the
-                // rest.
-                list.splice(list.begin(), list, --list.end());
-
+                // Re-use the storage of the key with the lowest count; the
+                // new key inherits that count.
+                found_key = &storage[victim];
+                hashes[victim] = key_hash;
+                found_key->first.assign(key.buf, key.len);
+                found_key->second.ti_ctime = ct;
             } else {
                 // add a new element to the storage array.
-
-                storage.emplace_back(
-                    std::make_pair(KeyId{key_hash,
-                                         std::string(key.buf, key.len)},
-                                   topkey_item_t(ct)));
+                storage.emplace_back(std::make_pair(
+                        std::string(key.buf, key.len), topkey_item_t(ct)));
+                hashes.push_back(key_hash);
                 found_key = &storage.back();
-
-                // Insert the new item to the front of the list
-                list.push_front(found_key);
             }
-        } else {
-            // Found - shuffle to the front.
-            auto it = std::find(list.begin(), list.end(),
-                                found_key);
-            list.splice(list.begin(), list, it);
         }
 
         // Increment access count.
@@ -212,7 +180,7 @@ void TopKeys::doUpdateKey(const void* key,
         std::hash<cb::const_char_buffer > hash_fn;
         const size_t key_hash = hash_fn(key_buf);
 
-        getShard(key_hash).updateKey(key_buf, key_hash, operation_time);
+        getShard().updateKey(key_buf, key_hash, operation_time);
     } catch (const std::bad_alloc&) {
         // Failed to increment topkeys, continue...
     }
@@ -289,9 +257,7 @@ ENGINE_ERROR_CODE TopKeys::doStats(const void* cookie,
                                    const AddStatFn& add_stat) {
     struct tk_context context(cookie, add_stat, current_time, nullptr);
 
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_iterfunc, &context);
-    }
+    accept_visitor(tk_iterfunc, &context);
 
     return ENGINE_SUCCESS;
 }
@@ -312,18 +278,56 @@ ENGINE_ERROR_CODE TopKeys::do_json_stats(nlohmann::json& object,
     struct tk_context context(nullptr, nullptr, current_time, &topkeys);
 
     /* Collate the topkeys JSON object */
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_jsonfunc, &context);
-    }
+    accept_visitor(tk_jsonfunc, &context);
 
     object["topkeys"] = topkeys;
     return ENGINE_SUCCESS;
 }
 
+void TopKeys::accept_visitor(iterfunc_t visitor_func, void* visitor_ctx) {
+    // Merge the shards; a key updated by threads using different shards is
+    // tracked by each of them.
+    std::unordered_map<std::string, topkey_item_t> merged;
+    auto merge = [](const std::string& key, const topkey_item_t& it,
+                    void* arg) {
+        auto& merged =
+                *static_cast<std::unordered_map<std::string, topkey_item_t>*>(
+                        arg);
+        auto res = merged.emplace(key, it);
+        if (!res.second) {
+            auto& existing = res.first->second;
+            existing.ti_access_count += it.ti_access_count;
+            existing.ti_ctime = std::min(existing.ti_ctime, it.ti_ctime);
+        }
+    };
+    for (auto& shard : shards) {
+        shard.accept_visitor(merge, &merged);
+    }
+
+    // Report the most accessed max_keys of them
+    std::vector<const std::pair<const std::string, topkey_item_t>*> sorted;
+    sorted.reserve(merged.size());
+    for (const auto& entry : merged) {
+        sorted.push_back(&entry);
+    }
+    const auto top = std::min(max_keys, sorted.size());
+    std::partial_sort(
+            sorted.begin(),
+            sorted.begin() + top,
+            sorted.end(),
+            [](const std::pair<const std::string, topkey_item_t>* a,
+               const std::pair<const std::string, topkey_item_t>* b) {
+                return a->second.ti_access_count > b->second.ti_access_count;
+            });
+    for (size_t ii = 0; ii < top; ++ii) {
+        visitor_func(sorted[ii]->first, sorted[ii]->second, visitor_ctx);
+    }
+}
+
 void TopKeys::Shard::accept_visitor(iterfunc_t visitor_func,
                                     void* visitor_ctx) {
     std::lock_guard<std::mutex> lock(mutex);
-    for (const auto key : list) {
-        visitor_func(key->first.key, key->second, visitor_ctx);
+    for (const auto& key : storage) {
+        visitor_func(key.first, key.second, visitor_ctx);
     }
 }
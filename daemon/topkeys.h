@@ -22,14 +22,13 @@
 #include <array>
 
 #include <mutex>
-#include <list>
 #include <string>
 #include <vector>
 
 /*
  * TopKeys
  *
- * Tracks the top N most recently accessed keys. The details are
+ * Tracks the N most frequently accessed keys. The details are
  * accessible by a stats call, which is used by ns_server to print the
  * top keys list in the GUI.
  */
@@ -49,7 +48,7 @@ class TopKeys {
 public:
     /* Constructor.
      * @param mkeys Number of keys stored in each shard (i.e. up to
-     * mkeys * SHARDS will be tracked).
+     * mkeys * NUM_SHARDS will be tracked, and reported by stats).
      */
     explicit TopKeys(int mkeys);
     ~TopKeys();
@@ -88,25 +87,37 @@ protected:
                                     rel_time_t current_time);
 
 private:
-    // Number of shards the keyspace is broken into. Permits some level of
-    // concurrent update (there is one mutex per shard).
+    // Number of shards the updates are broken into. Each thread always
+    // updates the same shard, so threads only contend on a shard's mutex
+    // with the (few) other threads sharing it, or with a stats call.
     static const int NUM_SHARDS = 8;
 
     class Shard;
 
-    Shard& getShard(size_t key_hash);
+    // The shard the calling thread updates.
+    Shard& getShard();
 
-    // One of N Shards which the keyspace has been broken
-    // into.
-    // Responsible for tracking the top {mkeys} within it's keyspace.
+    typedef void (*iterfunc_t)(const std::string& key,
+                               const topkey_item_t& it,
+                               void* arg);
+
+    // Merges the keys of all shards and invokes the given callback function
+    // for the top {max_keys} of them, most accessed first.
+    void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
+
+    // A "space-saving" heavy-hitter sketch of the keys updated by the
+    // threads using this Shard. Tracks up to {max_keys} keys; when a new key
+    // is seen and the shard is full, the key with the lowest count is
+    // replaced by the new key, which inherits that count. Any key accessed
+    // more than 1/{max_keys} of the time is guaranteed to be tracked, and
+    // a tracked key's count never under-estimates its accesses.
     class Shard {
     public:
 
         void setMaxKeys(int mkeys) {
             max_keys = mkeys;
+            hashes.reserve(max_keys);
             storage.reserve(max_keys);
-            // reallocating storage invalidates the LRU list.
-            list.clear();
         }
 
         // Updates the topkey 'ranking' for the specified key.
@@ -119,33 +130,13 @@ private:
                        size_t key_hash,
                        rel_time_t operation_time);
 
-        typedef void (*iterfunc_t)(const std::string& key,
-                                   const topkey_item_t& it,
-                                   void *arg);
-
         /* For each key in this shard, invoke the given callback function.
          */
         void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
 
     private:
-
-        struct KeyId {
-            size_t hash;
-            std::string key;
-        };
-
         // Pair of the key's string and the statistics related to it.
-        typedef std::pair<KeyId, topkey_item_t> topkey_t;
-
-        // An ordered list of topkey_t*, used for LRU.
-        typedef std::list<topkey_t*> key_history_t;
-
-        // Vector topket_t, used for actual topke storage.
-        typedef std::vector<topkey_t> key_storage_t;
-
-        // Searches for the given key. If found returns a pointer to the
-        // topkey_t, else returns NULL.
-        topkey_t* searchForKey(size_t hash, const cb::const_char_buffer& key);
+        typedef std::pair<std::string, topkey_item_t> topkey_t;
 
         // Maxumum numbers of keys to be tracked per shard.
         unsigned int max_keys;
@@ -153,14 +144,17 @@ private:
         // mutex to serial access to this shard.
         std::mutex mutex;
 
-        // list of keys, ordered from most-recently used (front) to least recently
-        // used (back).
-        key_history_t list;
+        // Hash of each tracked key, at the same index as the key in
+        // storage. Kept separately so a lookup scans one contiguous array.
+        std::vector<size_t> hashes;
 
         // Underlying topkey storage.
-        key_storage_t storage;
+        std::vector<topkey_t> storage;
     };
 
+    // Maximum number of keys reported by stats.
+    const size_t max_keys;
+
     // array of topkey shards.
     std::array<Shard, NUM_SHARDS> shards;
 };
@@ -60,7 +60,10 @@ void EngineFixture::TearDown(const benchmark::State& state) {
         engine->getDcpConnMap().manageConnections();
         engine.reset();
         ExecutorPool::shutdown();
-        cb::io::rmrf("benchmarks-test");
+        // Ephemeral buckets don't create a data directory.
+        if (cb::io::isDirectory("benchmarks-test")) {
+            cb::io::rmrf("benchmarks-test");
+        }
     }
     ObjectRegistry::onSwitchThread(nullptr);
 }
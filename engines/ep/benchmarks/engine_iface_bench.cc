@@ -0,0 +1,486 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * End-to-end benchmarks which drive EventuallyPersistentEngine through its
+ * EngineIface (get / store), as memcached's front-end threads do.
+ *
+ * Each configuration is a combination of bucket type (value eviction, full
+ * eviction or ephemeral), initial resident ratio, key distribution,
+ * durability level, number of DCP cursors and number of buckets, run with a
+ * range of front-end threads. Throughput is reported as items_per_second and
+ * per-operation latency percentiles as p50_us / p99_us / p99.9_us (averaged
+ * over the threads).
+ *
+ * The background work which a real bucket would run on its executor threads
+ * (flushing, draining DCP cursors, removing checkpoints, BgFetching) is run
+ * inline by the benchmark threads, so results are repeatable and
+ * independent of task scheduling:
+ *  - BgFetches are run by the thread which was told to wait for one;
+ *  - SyncWrites are acknowledged by the thread which wrote them, acting as
+ *    the (single) replica;
+ *  - thread 0 periodically flushes, drains every DCP cursor and removes
+ *    unreferenced checkpoints.
+ */
+
+#include "bgfetcher.h"
+#include "checkpoint_manager.h"
+#include "engine_fixture.h"
+#include "ep_bucket.h"
+#include "fakes/fake_executorpool.h"
+#include "hdrhistogram.h"
+#include "kvshard.h"
+
+#include <mock/mock_global_task.h>
+#include <mock/mock_synchronous_ep_engine.h>
+#include <platform/dirutils.h>
+#include <programs/engine_testapp/mock_server.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+
+enum class BucketType { ValueEviction = 0, FullEviction = 1, Ephemeral = 2 };
+
+static std::string to_string(BucketType type) {
+    switch (type) {
+    case BucketType::ValueEviction:
+        return "value_eviction";
+    case BucketType::FullEviction:
+        return "full_eviction";
+    case BucketType::Ephemeral:
+        return "ephemeral";
+    }
+    throw std::invalid_argument("to_string(BucketType): invalid enumeration " +
+                                std::to_string(int(type)));
+}
+
+enum class KeyDistribution { Uniform = 0, HotSet = 1 };
+
+static std::string to_string(KeyDistribution distribution) {
+    switch (distribution) {
+    case KeyDistribution::Uniform:
+        return "uniform";
+    case KeyDistribution::HotSet:
+        return "hot_set";
+    }
+    throw std::invalid_argument(
+            "to_string(KeyDistribution): invalid enumeration " +
+            std::to_string(int(distribution)));
+}
+
+/**
+ * Fixture for the EngineIface benchmarks. Arguments:
+ *  0: BucketType
+ *  1: initial resident ratio (percent of items resident after SetUp)
+ *  2: KeyDistribution
+ *  3: durability level of every store (cb::durability::Level)
+ *  4: number of DCP cursors registered on each vBucket
+ *  5: number of buckets; thread N operates on bucket (N % buckets)
+ */
+class EngineIfaceBench : public EngineFixture {
+protected:
+    /// Number of documents stored in each bucket by SetUp.
+    static const size_t numKeys = 100000;
+
+    /// Percent of operations which are gets; the rest are sets.
+    static const int readPercent = 80;
+
+    /**
+     * For KeyDistribution::HotSet, hotOpsPercent of the operations go to the
+     * first hotKeysPercent of the keys.
+     */
+    static const int hotKeysPercent = 20;
+    static const int hotOpsPercent = 80;
+
+    /// Thread 0 runs the background work every this many operations.
+    static const size_t backgroundWorkInterval = 1024;
+
+    /// A bucket under test, and the state needed to run its background work.
+    struct Bucket {
+        SynchronousEPEngine* engine = nullptr;
+        /// Serialises BgFetcher runs by the front-end threads.
+        std::mutex bgFetchMutex;
+        /// Serialises (and orders) the replica's seqno acks.
+        std::mutex ackMutex;
+        int64_t lastAckedSeqno = 0;
+        std::vector<Cursor> dcpCursors;
+    };
+
+    void SetUp(const benchmark::State& state) override {
+        bucketType = BucketType(state.range(0));
+        residentRatio = state.range(1);
+        keyDistribution = KeyDistribution(state.range(2));
+        durabilityLevel = cb::durability::Level(state.range(3));
+        numDcpCursors = state.range(4);
+        numBuckets = state.range(5);
+
+        varConfig = "max_size=1000000000";
+        switch (bucketType) {
+        case BucketType::ValueEviction:
+            varConfig += ";item_eviction_policy=value_only";
+            break;
+        case BucketType::FullEviction:
+            varConfig += ";item_eviction_policy=full_eviction";
+            break;
+        case BucketType::Ephemeral:
+            varConfig += ";bucket_type=ephemeral";
+            break;
+        }
+
+        EngineFixture::SetUp(state);
+        if (state.thread_index == 0) {
+            keys.reserve(numKeys);
+            for (size_t ii = 0; ii < numKeys; ++ii) {
+                // Pad the keys so they are of a more realistic length.
+                keys.push_back(std::string(20, 'k') + std::to_string(ii));
+            }
+
+            buckets = std::vector<Bucket>(numBuckets);
+            buckets[0].engine = engine.get();
+            for (size_t ii = 1; ii < numBuckets; ++ii) {
+                extraEngines.push_back(createEngine(ii));
+                buckets[ii].engine = extraEngines.back().get();
+            }
+            for (auto& bucket : buckets) {
+                populate(bucket);
+            }
+            ObjectRegistry::onSwitchThread(engine.get());
+
+            ready = true;
+        } else {
+            // Buckets are setup by thread:0; wait until it has completed.
+            while (!ready) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            ready = false;
+            executorPool->cancelAndClearAll();
+            buckets.clear();
+            for (size_t ii = 0; ii < extraEngines.size(); ++ii) {
+                ObjectRegistry::onSwitchThread(extraEngines[ii].get());
+                extraEngines[ii]->getDcpConnMap().manageConnections();
+                extraEngines[ii].reset();
+                if (cb::io::isDirectory(getDbname(ii + 1))) {
+                    cb::io::rmrf(getDbname(ii + 1));
+                }
+            }
+            extraEngines.clear();
+            keys.clear();
+            ObjectRegistry::onSwitchThread(engine.get());
+        }
+        EngineFixture::TearDown(state);
+    }
+
+    static std::string getDbname(size_t index) {
+        return "benchmarks-test-" + std::to_string(index);
+    }
+
+    /// Create the index'th bucket, set up as EngineFixture sets up 'engine'.
+    std::unique_ptr<SynchronousEPEngine> createEngine(size_t index) {
+        auto config = "dbname=" + getDbname(index) + ";ht_locks=47;" +
+                      varConfig;
+        auto newEngine = std::make_unique<SynchronousEPEngine>(config);
+        ObjectRegistry::onSwitchThread(newEngine.get());
+        newEngine->setKVBucket(
+                newEngine->public_makeBucket(newEngine->getConfiguration()));
+        newEngine->public_initializeEngineCallbacks();
+        return newEngine;
+    }
+
+    /**
+     * Activate the vBucket of the given bucket, store every key, register
+     * the DCP cursors and then (for persistent buckets) persist everything
+     * and evict items until the requested resident ratio is reached.
+     *
+     * The keys beyond the resident ratio are the ones evicted, so for
+     * KeyDistribution::HotSet the hot keys stay resident (at least
+     * initially; BgFetched items are not evicted again).
+     */
+    void populate(Bucket& bucket) {
+        ObjectRegistry::onSwitchThread(bucket.engine);
+        auto& kvBucket = *bucket.engine->getKVBucket();
+        nlohmann::json meta;
+        if (durabilityLevel != cb::durability::Level::None) {
+            meta = {{"topology",
+                     nlohmann::json::array({{"active", "replica"}})}};
+        }
+        ASSERT_EQ(ENGINE_SUCCESS,
+                  kvBucket.setVBucketState(vbid, vbucket_state_active, meta));
+
+        const std::string value(200, 'x');
+        for (const auto& key : keys) {
+            auto item = make_item(vbid, key, value);
+            ASSERT_EQ(ENGINE_SUCCESS, kvBucket.set(item, cookie));
+        }
+
+        auto vb = kvBucket.getVBucket(vbid);
+        for (size_t ii = 0; ii < numDcpCursors; ++ii) {
+            bucket.dcpCursors.push_back(
+                    vb->checkpointManager
+                            ->registerCursorBySeqno(
+                                    "bench-dcp-" + std::to_string(ii), 0)
+                            .cursor);
+        }
+
+        if (bucketType == BucketType::Ephemeral) {
+            return;
+        }
+        runBackgroundWork(bucket);
+        ObjectRegistry::onSwitchThread(bucket.engine);
+        const auto residentKeys = (numKeys * residentRatio) / 100;
+        for (size_t ii = residentKeys; ii < numKeys; ++ii) {
+            const char* msg;
+            ASSERT_EQ(cb::mcbp::Status::Success,
+                      kvBucket.evictKey(
+                              {keys[ii], DocKeyEncodesCollectionId::No},
+                              vbid,
+                              &msg));
+        }
+    }
+
+    /**
+     * Run the background work of the given bucket: flush everything
+     * outstanding, drain every DCP cursor and remove the checkpoints which
+     * are no longer referenced.
+     */
+    void runBackgroundWork(Bucket& bucket) {
+        ObjectRegistry::onSwitchThread(bucket.engine);
+        auto* kvBucket = bucket.engine->getKVBucket();
+        if (bucketType != BucketType::Ephemeral) {
+            auto& ep = dynamic_cast<EPBucket&>(*kvBucket);
+            bool moreAvailable;
+            do {
+                std::tie(moreAvailable, std::ignore) = ep.flushVBucket(vbid);
+            } while (moreAvailable);
+        }
+
+        auto vb = kvBucket->getVBucket(vbid);
+        auto& manager = *vb->checkpointManager;
+        std::vector<queued_item> items;
+        for (auto& cursor : bucket.dcpCursors) {
+            auto dcpCursor = cursor.lock();
+            if (!dcpCursor) {
+                continue;
+            }
+            CheckpointManager::ItemsForCursor result;
+            do {
+                items.clear();
+                result = manager.getItemsForCursor(
+                        dcpCursor.get(), items, backgroundWorkInterval);
+            } while (result.moreAvailable);
+        }
+
+        bool newOpenCheckpointCreated;
+        manager.removeClosedUnrefCheckpoints(*vb, newOpenCheckpointCreated);
+        ObjectRegistry::onSwitchThread(nullptr);
+    }
+
+    /**
+     * Complete an operation which returned EWOULDBLOCK, as a front-end
+     * thread would when notified: run any outstanding BgFetches, act as the
+     * replica and acknowledge everything written so far (if SyncWrites are
+     * in use), then consume the cookie's notification.
+     */
+    void waitForNotification(Bucket& bucket, const void* opCookie) {
+        ObjectRegistry::onSwitchThread(bucket.engine);
+        auto vb = bucket.engine->getKVBucket()->getVBucket(vbid);
+        if (bucketType != BucketType::Ephemeral) {
+            std::lock_guard<std::mutex> lh(bucket.bgFetchMutex);
+            MockGlobalTask task(bucket.engine->getTaskable(),
+                                TaskId::MultiBGFetcherTask);
+            vb->getShard()->getBgFetcher()->run(&task);
+        }
+        if (durabilityLevel != cb::durability::Level::None) {
+            // Acks must not go backwards; re-acking the same seqno is fine
+            // and completes any SyncWrite tracked since the previous ack.
+            std::lock_guard<std::mutex> lh(bucket.ackMutex);
+            bucket.lastAckedSeqno =
+                    std::max(bucket.lastAckedSeqno, vb->getHighSeqno());
+            vb->seqnoAcknowledged(
+                    "replica", bucket.lastAckedSeqno, 0 /*diskSeqno*/);
+        }
+        ObjectRegistry::onSwitchThread(nullptr);
+
+        lock_mock_cookie(opCookie);
+        waitfor_mock_cookie(opCookie);
+        unlock_mock_cookie(opCookie);
+    }
+
+    std::vector<std::string> keys;
+    std::vector<Bucket> buckets;
+    std::vector<std::unique_ptr<SynchronousEPEngine>> extraEngines;
+    std::atomic<bool> ready{false};
+
+    BucketType bucketType;
+    size_t residentRatio;
+    KeyDistribution keyDistribution;
+    cb::durability::Level durabilityLevel;
+    size_t numDcpCursors;
+    size_t numBuckets;
+};
+
+/*
+ * Mixed get / set workload (readPercent gets) against the keys stored by
+ * SetUp, each operation going through EngineIface exactly as a front-end
+ * thread would issue it (including the second call after an EWOULDBLOCK).
+ */
+BENCHMARK_DEFINE_F(EngineIfaceBench, GetSet)(benchmark::State& state) {
+    auto& bucket = buckets[state.thread_index % numBuckets];
+    EngineIface& iface = *bucket.engine;
+    const auto* opCookie = create_mock_cookie();
+
+    boost::optional<cb::durability::Requirements> durability;
+    if (durabilityLevel != cb::durability::Level::None) {
+        durability = cb::durability::Requirements{durabilityLevel,
+                                                  0 /*timeout*/};
+    }
+
+    std::mt19937 generator(state.thread_index);
+    std::uniform_int_distribution<int> percent(0, 99);
+    const size_t hotKeys = (numKeys * hotKeysPercent) / 100;
+    std::uniform_int_distribution<size_t> allKeys(0, numKeys - 1);
+    std::uniform_int_distribution<size_t> hotSet(0, hotKeys - 1);
+    std::uniform_int_distribution<size_t> coldSet(hotKeys, numKeys - 1);
+    auto nextKey = [&]() -> const std::string& {
+        if (keyDistribution == KeyDistribution::Uniform) {
+            return keys[allKeys(generator)];
+        }
+        return percent(generator) < hotOpsPercent ? keys[hotSet(generator)]
+                                                  : keys[coldSet(generator)];
+    };
+
+    // Latencies in nanoseconds, from 1ns to 100s.
+    HdrHistogram latencies(1, 100000000000, 3);
+    const std::string value(200, 'x');
+    size_t blocked = 0;
+    size_t ops = 0;
+    while (state.KeepRunning()) {
+        const auto& key = nextKey();
+        const bool read = percent(generator) < readPercent;
+        const auto start = std::chrono::steady_clock::now();
+        if (read) {
+            const DocKey docKey{key, DocKeyEncodesCollectionId::No};
+            auto result =
+                    iface.get(opCookie, docKey, vbid, DocStateFilter::Alive);
+            while (result.first == cb::engine_errc::would_block) {
+                ++blocked;
+                waitForNotification(bucket, opCookie);
+                result = iface.get(
+                        opCookie, docKey, vbid, DocStateFilter::Alive);
+            }
+            if (result.first != cb::engine_errc::success) {
+                state.SkipWithError(("get failed: " +
+                                     to_string(result.first)).c_str());
+                break;
+            }
+        } else {
+            auto item = make_item(vbid, key, value);
+            uint64_t cas = 0;
+            auto status = iface.store(opCookie,
+                                      &item,
+                                      cas,
+                                      OPERATION_SET,
+                                      durability,
+                                      DocumentState::Alive);
+            while (status == ENGINE_EWOULDBLOCK) {
+                ++blocked;
+                waitForNotification(bucket, opCookie);
+                status = iface.store(opCookie,
+                                     &item,
+                                     cas,
+                                     OPERATION_SET,
+                                     durability,
+                                     DocumentState::Alive);
+            }
+            if (status != ENGINE_SUCCESS) {
+                state.SkipWithError(("store failed: " +
+                                     cb::to_string(cb::engine_errc(status)))
+                                            .c_str());
+                break;
+            }
+        }
+        latencies.addValue(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count());
+
+        if (state.thread_index == 0 && ++ops % backgroundWorkInterval == 0) {
+            for (auto& b : buckets) {
+                runBackgroundWork(b);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(to_string(bucketType) + "/" + to_string(keyDistribution));
+    state.counters["p50_us"] = benchmark::Counter(
+            latencies.getValueAtPercentile(50) / 1000.0,
+            benchmark::Counter::kAvgThreads);
+    state.counters["p99_us"] = benchmark::Counter(
+            latencies.getValueAtPercentile(99) / 1000.0,
+            benchmark::Counter::kAvgThreads);
+    state.counters["p99.9_us"] = benchmark::Counter(
+            latencies.getValueAtPercentile(99.9) / 1000.0,
+            benchmark::Counter::kAvgThreads);
+    // Operations which had to wait for a BgFetch or a SyncWrite.
+    state.counters["blocked"] = blocked;
+
+    destroy_mock_cookie(opCookie);
+}
+
+static void EngineIfaceArguments(benchmark::internal::Benchmark* b) {
+    using cb::durability::Level;
+    const auto none = int64_t(Level::None);
+    const auto majority = int64_t(Level::Majority);
+    b->ArgNames({"bucket", "resident", "keys", "durability", "dcp", "buckets"});
+    for (auto type : {BucketType::ValueEviction,
+                      BucketType::FullEviction,
+                      BucketType::Ephemeral}) {
+        // Ephemeral buckets never evict to disk; they are always 100%
+        // resident.
+        std::vector<int64_t> residentRatios{100};
+        if (type != BucketType::Ephemeral) {
+            residentRatios.push_back(50);
+        }
+        for (auto resident : residentRatios) {
+            for (auto keys : {KeyDistribution::Uniform,
+                              KeyDistribution::HotSet}) {
+                b->Args({int64_t(type), resident, int64_t(keys), none, 0, 1});
+            }
+        }
+        // Replication: two DCP cursors (e.g. a replica and an indexer).
+        b->Args({int64_t(type), 100, 0, none, 2, 1});
+        // Several buckets sharing the front-end threads.
+        b->Args({int64_t(type), 100, 0, none, 0, 4});
+    }
+    // SyncWrites are only supported by persistent buckets.
+    for (auto type : {BucketType::ValueEviction, BucketType::FullEviction}) {
+        b->Args({int64_t(type), 100, 0, majority, 1, 1});
+    }
+}
+
+BENCHMARK_REGISTER_F(EngineIfaceBench, GetSet)
+        ->Apply(EngineIfaceArguments)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
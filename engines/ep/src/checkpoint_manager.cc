@@ -517,7 +517,7 @@ bool CheckpointManager::hasClosedCheckpointWhichCanBeRemoved() const {
 
 void CheckpointManager::updateStatsForNewQueuedItem_UNLOCKED(
         const LockHolder& lh, VBucket& vb, const queued_item& qi) {
-    ++stats.totalEnqueued;
+    ++stats.coreLocal.get()->totalEnqueued;
     if (checkpointConfig.isPersistenceEnabled()) {
         ++stats.diskQueueSize;
         vb.doStatsForQueueing(*qi, qi->size());
@@ -618,7 +618,7 @@ bool CheckpointManager::queueDirty(
 
     switch (result) {
     case QueueDirtyStatus::SuccessExistingItem:
-        ++stats.totalDeduplicated;
+        ++stats.coreLocal.get()->totalDeduplicated;
         return false;
     case QueueDirtyStatus::SuccessNewItem:
         ++numItems;
@@ -22,6 +22,7 @@
 #include "checkpoint_types.h"
 #include "cursor.h"
 #include "ep_types.h"
+#include "instrumented_mutex.h"
 #include "monotonic.h"
 #include "queue_op.h"
 
@@ -53,6 +54,12 @@ class CheckpointManager {
     friend class CheckpointManagerTestIntrospector;
 
 public:
+    /// Type of queueLock; see instrumented_mutex.h
+    using Mutex = InstrumentedMutex<std::mutex, LockSite::CheckpointQueue>;
+
+    /// Holder of queueLock, as required by the *_UNLOCKED methods.
+    using LockHolder = std::lock_guard<Mutex>;
+
     typedef std::shared_ptr<Callback<Vbid>> FlusherCallback;
 
     /// Return type of getItemsForCursor()
@@ -457,7 +464,7 @@ protected:
 
     EPStats                 &stats;
     CheckpointConfig        &checkpointConfig;
-    mutable std::mutex       queueLock;
+    mutable Mutex            queueLock;
     const Vbid vbucketId;
 
     // Total number of items (including meta items) in /all/ checkpoints managed
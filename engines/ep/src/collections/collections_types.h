@@ -53,6 +53,9 @@ using ManifestUid = WeaklyMonotonic<uint64_t>;
 // Map used in summary stats
 using Summary = std::unordered_map<CollectionID, uint64_t>;
 
+/// Soft memory quota (bytes) of each collection which has one
+using MemoryQuotas = std::unordered_map<CollectionID, size_t>;
+
 struct ManifestUidNetworkOrder {
     ManifestUidNetworkOrder(ManifestUid uid) : uid(htonll(uid)) {
     }
@@ -27,6 +27,9 @@
 
 #include <spdlog/fmt/ostr.h>
 
+#include <algorithm>
+#include <vector>
+
 Collections::Manager::Manager() {
 }
 
@@ -90,6 +93,20 @@ cb::engine_error Collections::Manager::update(KVBucket& bucket,
 
     current = std::move(newManifest);
 
+    // Forget the operation stats of dropped collections. The vbuckets'
+    // manifest entries share them, so they're freed once every vbucket has
+    // dropped the collection.
+    {
+        std::lock_guard<std::mutex> guard(opStatsLock);
+        for (auto itr = opStats.begin(); itr != opStats.end();) {
+            if (current->findCollection(itr->first) == current->end()) {
+                itr = opStats.erase(itr);
+            } else {
+                ++itr;
+            }
+        }
+    }
+
     return cb::engine_error(cb::engine_errc::success,
                             "Collections::Manager::update");
 }
@@ -118,6 +135,14 @@ std::pair<cb::mcbp::Status, std::string> Collections::Manager::getManifest()
     }
 }
 
+Collections::MemoryQuotas Collections::Manager::getMemoryQuotas() const {
+    std::unique_lock<std::mutex> ul(lock);
+    if (current) {
+        return current->getMemoryQuotas();
+    }
+    return {};
+}
+
 bool Collections::Manager::validateGetCollectionIDPath(
         const std::string& path) {
     return std::count(path.begin(), path.end(), '.') == 1;
@@ -217,6 +242,61 @@ void Collections::Manager::addScopeStats(const void* cookie,
     }
 }
 
+OperationStats& Collections::Manager::getOperationStats(
+        const VB::Manifest::CachingReadHandle& cHandle) {
+    auto* stats = cHandle.getOperationStats();
+    if (stats) {
+        return *stats;
+    }
+
+    // First use of this vbucket's entry for the collection. The lock also
+    // serialises attaching the stats to the entry.
+    std::lock_guard<std::mutex> guard(opStatsLock);
+    stats = cHandle.getOperationStats();
+    if (!stats) {
+        auto& entry = opStats[cHandle.getKey().getCollectionID()];
+        if (!entry) {
+            entry = std::make_shared<OperationStats>();
+        }
+        cHandle.setOperationStats(entry);
+        stats = entry.get();
+    }
+    return *stats;
+}
+
+std::shared_ptr<const OperationStats>
+Collections::Manager::findOperationStats(CollectionID cid) const {
+    std::lock_guard<std::mutex> guard(opStatsLock);
+    auto itr = opStats.find(cid);
+    if (itr == opStats.end()) {
+        return {};
+    }
+    return itr->second;
+}
+
+void Collections::Manager::addOperationStats(const void* cookie,
+                                             const AddStatFn& add_stat) const {
+    // Copy the entries so the stats are formatted without the lock held.
+    std::vector<std::pair<CollectionID, std::shared_ptr<const OperationStats>>>
+            entries;
+    {
+        std::lock_guard<std::mutex> guard(opStatsLock);
+        for (const auto& entry : opStats) {
+            entries.emplace_back(entry.first, entry.second);
+        }
+    }
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const auto& a, const auto& b) {
+                  return uint32_t(a.first) < uint32_t(b.first);
+              });
+
+    for (const auto& entry : entries) {
+        entry.second->addStats(
+                "collection:" + entry.first.to_string(), add_stat, cookie);
+    }
+}
+
 /**
  * Perform actions for a completed warmup - currently check if any
  * collections are 'deleting' and require erasing retriggering.
@@ -235,12 +315,23 @@ void Collections::Manager::warmupCompleted(KVBucket& bucket) const {
 
 class CollectionCountVBucketVisitor : public VBucketVisitor {
 public:
+    explicit CollectionCountVBucketVisitor(bool trackMemory)
+        : trackMemory(trackMemory) {
+    }
+
     void visitBucket(const VBucketPtr& vb) override {
         if (vb->getState() == vbucket_state_active) {
             vb->lockCollections().updateSummary(summary);
         }
+        // Memory is counted for all vbuckets, as that is what the ItemPager
+        // compares against a collection's memory quota. It is only counted
+        // while there are quotas.
+        vb->ht.setCollectionMemoryTracking(trackMemory);
+        vb->ht.updateCollectionMemorySummary(memSummary);
     }
+    const bool trackMemory;
     Collections::Summary summary;
+    Collections::Summary memSummary;
 };
 
 class CollectionDetailedVBucketVisitor : public VBucketVisitor {
@@ -330,8 +421,10 @@ ENGINE_ERROR_CODE Collections::Manager::doCollectionStats(
         }
     } else {
         // Do the high level stats (includes global count)
-        bucket.getCollectionsManager().addCollectionStats(cookie, add_stat);
-        CollectionCountVBucketVisitor visitor;
+        auto& manager = bucket.getCollectionsManager();
+        manager.addCollectionStats(cookie, add_stat);
+        CollectionCountVBucketVisitor visitor(
+                !manager.getMemoryQuotas().empty());
         bucket.visit(visitor);
         for (const auto& entry : visitor.summary) {
             try {
@@ -350,6 +443,23 @@ ENGINE_ERROR_CODE Collections::Manager::doCollectionStats(
                 success = false;
             }
         }
+        for (const auto& entry : visitor.memSummary) {
+            try {
+                const int bsize = 512;
+                char buffer[bsize];
+                checked_snprintf(buffer,
+                                 bsize,
+                                 "collection:%s:mem_used",
+                                 entry.first.to_string().c_str());
+                add_casted_stat(buffer, entry.second, add_stat, cookie);
+            } catch (const std::exception& e) {
+                EP_LOG_WARN(
+                        "Collections::Manager::doStats failed to build stats: "
+                        "{}",
+                        e.what());
+                success = false;
+            }
+        }
     }
 
     return success ? ENGINE_SUCCESS : ENGINE_FAILED;
@@ -17,12 +17,17 @@
 
 #pragma once
 
+#include "collections/collections_types.h"
+#include "collections/vbucket_manifest.h"
+#include "operation_stats.h"
+
 #include <memcached/engine.h>
 #include <memcached/engine_error.h>
 #include <platform/sized_buffer.h>
 
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 class KVBucket;
 class VBucket;
@@ -58,6 +63,12 @@ public:
      */
     std::pair<cb::mcbp::Status, std::string> getManifest() const;
 
+    /**
+     * @return the soft memory quotas of the current manifest's collections
+     *         (empty if there is no current manifest)
+     */
+    MemoryQuotas getMemoryQuotas() const;
+
     /**
      * Lookup collection id from path
      *
@@ -96,6 +107,30 @@ public:
      */
     void addScopeStats(const void* cookie, const AddStatFn& add_stat) const;
 
+    /**
+     * @return the bucket-wide operation stats of the collection of the
+     *         handle's key (which must be valid). The stats are created on
+     *         first use and attached to the collection's vbucket manifest
+     *         entry, so later calls for the entry need no lookup or lock.
+     */
+    OperationStats& getOperationStats(
+            const VB::Manifest::CachingReadHandle& cHandle);
+
+    /**
+     * @return the bucket-wide operation stats of the given collection, or
+     *         nullptr if it has none (it hasn't been accessed, or has been
+     *         dropped)
+     */
+    std::shared_ptr<const OperationStats> findOperationStats(
+            CollectionID cid) const;
+
+    /**
+     * Do 'add_stat' calls for the operation stats of every collection which
+     * has been accessed ("collections-ops").
+     */
+    void addOperationStats(const void* cookie,
+                           const AddStatFn& add_stat) const;
+
     /**
      * Perform actions for a completed warmup - currently check if any
      * collections are 'deleting' and require erasing retriggering.
@@ -164,6 +199,16 @@ private:
 
     /// Store the most recent (current) manifest received
     std::unique_ptr<Manifest> current;
+
+    /**
+     * Per-collection operation stats. Only locked when a vbucket's manifest
+     * entry for a collection is first used (the entry then shares ownership
+     * of the stats) and when reading the stats. Entries are removed when the
+     * collection is dropped from the manifest.
+     */
+    mutable std::mutex opStatsLock;
+    std::unordered_map<CollectionID, std::shared_ptr<OperationStats>>
+            opStats;
 };
 
 std::ostream& operator<<(std::ostream& os, const Manager& manager);
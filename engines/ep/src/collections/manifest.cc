@@ -51,6 +51,9 @@ static constexpr nlohmann::json::value_t UidType =
 static constexpr char const* MaxTtlKey = "max_ttl";
 static constexpr nlohmann::json::value_t MaxTtlType =
         nlohmann::json::value_t::number_unsigned;
+static constexpr char const* MemoryQuotaKey = "memory_quota";
+static constexpr nlohmann::json::value_t MemoryQuotaType =
+        nlohmann::json::value_t::number_unsigned;
 
 /**
  * Get json sub-object from the json object for key and check the type.
@@ -160,6 +163,8 @@ Manifest::Manifest(cb::const_char_buffer json,
             auto cuid = getJsonObject(collection, UidKey, UidType);
             auto cmaxttl = cb::getOptionalJsonObject(
                     collection, MaxTtlKey, MaxTtlType);
+            auto cmemquota = cb::getOptionalJsonObject(
+                    collection, MemoryQuotaKey, MemoryQuotaType);
 
             auto cnameValue = cname.get<std::string>();
             if (!validName(cnameValue)) {
@@ -217,9 +222,14 @@ Manifest::Manifest(cb::const_char_buffer json,
                 maxTtl = std::chrono::seconds(value);
             }
 
+            size_t memoryQuota = 0;
+            if (cmemquota) {
+                memoryQuota = cmemquota.get().get<uint64_t>();
+            }
+
             enableDefaultCollection(cuidValue);
             this->collections.emplace(cuidValue, cnameValue);
-            scopeCollections.push_back({cuidValue, maxTtl});
+            scopeCollections.push_back({cuidValue, maxTtl, memoryQuota});
         }
 
         this->scopes.emplace(uidValue,
@@ -297,6 +307,10 @@ std::string Manifest::toJson() const {
                     json << R"(,"max_ttl":)" << std::dec
                          << collection.maxTtl.get().count();
                 }
+                if (collection.memoryQuota) {
+                    json << R"(,"memory_quota":)" << std::dec
+                         << collection.memoryQuota;
+                }
                 json << "}";
                 if (nCollections != scope.second.collections.size() - 1) {
                     json << ",";
@@ -317,6 +331,18 @@ std::string Manifest::toJson() const {
     return json.str();
 }
 
+MemoryQuotas Manifest::getMemoryQuotas() const {
+    MemoryQuotas rv;
+    for (const auto& scope : scopes) {
+        for (const auto& collection : scope.second.collections) {
+            if (collection.memoryQuota) {
+                rv.emplace(collection.id, collection.memoryQuota);
+            }
+        }
+    }
+    return rv;
+}
+
 void Manifest::addCollectionStats(const void* cookie,
                                   const AddStatFn& add_stat) const {
     try {
@@ -336,6 +362,14 @@ void Manifest::addCollectionStats(const void* cookie,
                              entry.first.to_string().c_str());
             add_casted_stat(buffer, entry.second.c_str(), add_stat, cookie);
         }
+
+        for (const auto& entry : getMemoryQuotas()) {
+            checked_snprintf(buffer,
+                             bsize,
+                             "manifest:collection:%s:memory_quota",
+                             entry.first.to_string().c_str());
+            add_casted_stat(buffer, entry.second, add_stat, cookie);
+        }
     } catch (const std::exception& e) {
         EP_LOG_WARN(
                 "Manifest::addCollectionStats failed to build stats "
@@ -33,6 +33,8 @@ static const size_t MaxCollectionNameSize = 30;
 struct CollectionEntry {
     CollectionID id;
     cb::ExpiryLimit maxTtl;
+    /// Soft memory quota (bytes) of the collection on this node, 0 for none
+    size_t memoryQuota = 0;
 };
 
 struct Scope {
@@ -196,6 +198,15 @@ public:
      */
     std::string toJson() const;
 
+    /**
+     * @return the soft memory quota of every collection which has one. The
+     *         quota is the number of bytes of item memory the collection
+     *         should use across all vBuckets of the bucket (on this node)
+     *         before the ItemPager evicts from it in preference to other
+     *         collections.
+     */
+    MemoryQuotas getMemoryQuotas() const;
+
     void addCollectionStats(const void* cookie,
                             const AddStatFn& add_stat) const;
 
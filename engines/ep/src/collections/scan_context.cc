@@ -50,6 +50,18 @@ bool ScanContext::isLogicallyDeleted(const DocKey& key, int64_t seqno) const {
     return (seqno >= startSeqno && seqno <= endSeqno) && dropped.count(id) > 0;
 }
 
+bool ScanContext::isFilteredOut(const DocKey& key) const {
+    if (!collectionFilter) {
+        return false;
+    }
+
+    auto id = key.getCollectionID();
+    if (id.isSystem()) {
+        return false;
+    }
+    return collectionFilter->count(id) == 0;
+}
+
 std::ostream& operator<<(std::ostream& os, const ScanContext& scanContext) {
     os << "ScanContext: startSeqno:" << scanContext.startSeqno
        << ", endSeqno:" << scanContext.endSeqno;
@@ -58,6 +70,13 @@ std::ostream& operator<<(std::ostream& os, const ScanContext& scanContext) {
         os << cid.to_string() << ", ";
     }
     os << "]";
+    if (scanContext.collectionFilter) {
+        os << " filter:[";
+        for (const auto cid : *scanContext.collectionFilter) {
+            os << cid.to_string() << ", ";
+        }
+        os << "]";
+    }
     return os;
 }
 
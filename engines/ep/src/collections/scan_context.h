@@ -20,6 +20,7 @@
 #include "collections/collections_types.h"
 #include "collections/vbucket_manifest.h"
 
+#include <boost/optional/optional.hpp>
 #include <unordered_set>
 
 struct DocKey;
@@ -36,6 +37,11 @@ namespace VB {
  * The ScanContext holds data relevant to performing a scan of the disk index
  * e.g. collection erasing may iterate the index and use data with the
  * ScanContext for choosing which keys to ignore.
+ *
+ * A scan may also be restricted to a set of collections (e.g. for a DCP
+ * backfill of a collection filtered stream), in which case the keys of other
+ * collections are skipped before their value is read or they are passed to
+ * the scan callbacks.
  */
 class ScanContext {
 public:
@@ -49,12 +55,26 @@ public:
         return dropped.empty();
     }
 
+    /**
+     * Restrict the scan to the given collections. System event keys are
+     * never filtered.
+     */
+    void setCollectionFilter(std::unordered_set<CollectionID> collections) {
+        collectionFilter = std::move(collections);
+    }
+
+    /// @return true if key is not in the collections the scan is restricted to
+    bool isFilteredOut(const DocKey& key) const;
+
 protected:
     friend std::ostream& operator<<(std::ostream&, const ScanContext&);
 
     std::unordered_set<CollectionID> dropped;
     int64_t startSeqno = 0;
     int64_t endSeqno = 0;
+
+    /// If initialised, the only collections the scan should return
+    boost::optional<std::unordered_set<CollectionID>> collectionFilter;
 };
 
 std::ostream& operator<<(std::ostream& os, const ScanContext& scanContext);
@@ -421,6 +421,19 @@ void Filter::addStats(const AddStatFn& add_stat,
     }
 }
 
+boost::optional<std::unordered_set<CollectionID>>
+Filter::getFixedCollections() const {
+    if (passthrough || scopeID) {
+        return {};
+    }
+
+    std::unordered_set<CollectionID> rv(filter.begin(), filter.end());
+    if (defaultAllowed) {
+        rv.insert(CollectionID::Default);
+    }
+    return rv;
+}
+
 std::string Filter::getUid() const {
     if (uid) {
         return std::to_string(*uid);
@@ -20,6 +20,7 @@
 #include "collections/collections_types.h"
 #include "item.h"
 
+#include <boost/optional/optional.hpp>
 #include <memcached/dcp_stream_id.h>
 #include <memcached/engine_common.h>
 #include <nlohmann/json_fwd.hpp>
@@ -161,6 +162,15 @@ public:
 
     std::string getUid() const;
 
+    /**
+     * @return the set of collections this filter allows, if that set can
+     *         only shrink over the life of the filter (i.e. the filter names
+     *         collections explicitly). Uninitialised if the filter may allow
+     *         any collection, or collections created later (a scope filter).
+     */
+    boost::optional<std::unordered_set<CollectionID>> getFixedCollections()
+            const;
+
     cb::mcbp::DcpStreamId getStreamId() const {
         return streamId;
     }
@@ -871,8 +871,8 @@ boost::optional<std::vector<CollectionID>> Manifest::getCollectionsForScope(
 }
 
 bool Manifest::operator==(const Manifest& rhs) const {
-    std::lock_guard<cb::ReaderLock> readLock(rwlock.reader());
-    std::lock_guard<cb::ReaderLock> otherReadLock(rhs.rwlock.reader());
+    auto readLock = rwlock.lockShared();
+    auto otherReadLock = rhs.rwlock.lockShared();
 
     if (rhs.map.size() != map.size()) {
         return false;
@@ -21,11 +21,12 @@
 #include "collections/collections_types.h"
 #include "collections/manifest.h"
 #include "collections/vbucket_manifest_entry.h"
+#include "instrumented_mutex.h"
+#include "sharded_rwlock.h"
 #include "systemevent.h"
 
 #include <boost/optional/optional_fwd.hpp>
 #include <platform/non_negative_counter.h>
-#include <platform/rwlock.h>
 #include <platform/sized_buffer.h>
 
 #include <functional>
@@ -94,16 +95,22 @@ public:
          */
         ReadHandle() = default;
 
-        ReadHandle(const Manifest* m, cb::RWLock& lock)
-            : readLock(lock), manifest(m) {
+        ReadHandle(const Manifest* m, const ShardedRWLock& lock)
+            : lockTimer(LockSite::CollectionsManifest),
+              readLock(lock.lockShared()),
+              manifest(m) {
+            lockTimer.acquired();
         }
 
         ReadHandle(ReadHandle&& rhs)
-            : readLock(std::move(rhs.readLock)), manifest(rhs.manifest) {
+            : lockTimer(std::move(rhs.lockTimer)),
+              readLock(std::move(rhs.readLock)),
+              manifest(rhs.manifest) {
         }
 
         ReadHandle& operator=(ReadHandle&& other) {
             readLock = std::move(other.readLock);
+            lockTimer = std::move(other.lockTimer);
             manifest = std::move(other.manifest);
 
             return *this;
@@ -251,12 +258,15 @@ public:
          */
         void unlock() {
             readLock.unlock();
+            lockTimer.released();
         }
 
     protected:
         friend std::ostream& operator<<(std::ostream& os,
                                         const Manifest::ReadHandle& readHandle);
-        std::unique_lock<cb::ReaderLock> readLock;
+        // Declared before readLock so the hold is recorded after unlocking.
+        LockSiteTimer lockTimer;
+        ShardedRWLock::ReadLock readLock;
         const Manifest* manifest;
     };
 
@@ -288,7 +298,7 @@ public:
          *        should not be allowed, whereas a disk backfill is allowed
          */
         CachingReadHandle(const Manifest* m,
-                          cb::RWLock& lock,
+                          const ShardedRWLock& lock,
                           DocKey key,
                           bool allowSystem)
             : ReadHandle(m, lock),
@@ -436,6 +446,24 @@ public:
             return manifest->processExpiryTime(itr, t, bucketTtl);
         }
 
+        /**
+         * @return the bucket-wide operation stats attached to the key's
+         *         collection, or nullptr if none are attached yet (see
+         *         Collections::Manager::getOperationStats())
+         */
+        OperationStats* getOperationStats() const {
+            return itr->second.getOperationStats();
+        }
+
+        /**
+         * Attach the bucket-wide operation stats of the key's collection.
+         * As for setHighSeqno, this only changes data inside the collection
+         * entry so is possible with shared access to the Manifest.
+         */
+        void setOperationStats(std::shared_ptr<OperationStats> stats) const {
+            itr->second.setOperationStats(std::move(stats));
+        }
+
         /**
          * Dump this VB::Manifest to std::cerr
          */
@@ -465,7 +493,9 @@ public:
      */
     class StatsReadHandle : private ReadHandle {
     public:
-        StatsReadHandle(const Manifest* m, cb::RWLock& lock, CollectionID cid)
+        StatsReadHandle(const Manifest* m,
+                        const ShardedRWLock& lock,
+                        CollectionID cid)
             : ReadHandle(m, lock), itr(m->getManifestIterator(cid)) {
         }
 
@@ -499,12 +529,17 @@ public:
      */
     class WriteHandle {
     public:
-        WriteHandle(Manifest& m, cb::RWLock& lock)
-            : writeLock(lock), manifest(m) {
+        WriteHandle(Manifest& m, ShardedRWLock& lock)
+            : lockTimer(LockSite::CollectionsManifest),
+              writeLock(lock),
+              manifest(m) {
+            lockTimer.acquired();
         }
 
         WriteHandle(WriteHandle&& rhs)
-            : writeLock(std::move(rhs.writeLock)), manifest(rhs.manifest) {
+            : lockTimer(std::move(rhs.lockTimer)),
+              writeLock(std::move(rhs.writeLock)),
+              manifest(rhs.manifest) {
         }
 
         /**
@@ -640,7 +675,9 @@ public:
         }
 
     private:
-        std::unique_lock<cb::WriterLock> writeLock;
+        // Declared before writeLock so the hold is recorded after unlocking.
+        LockSiteTimer lockTimer;
+        std::unique_lock<ShardedRWLock> writeLock;
         Manifest& manifest;
     };
 
@@ -1250,9 +1287,11 @@ protected:
     bool dropInProgress{false};
 
     /**
-     * shared lock to allow concurrent readers and safe updates
+     * shared lock to allow concurrent readers and safe updates. Sharded so
+     * that the per-operation read locking of the manifest does not contend
+     * on a single cache line across all front-end threads.
      */
-    mutable cb::RWLock rwlock;
+    mutable ShardedRWLock rwlock;
 
     friend std::ostream& operator<<(std::ostream& os, const Manifest& manifest);
 
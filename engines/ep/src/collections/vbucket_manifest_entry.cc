@@ -35,6 +35,7 @@ Collections::VB::ManifestEntry& Collections::VB::ManifestEntry::operator=(
     highSeqno.reset(other.highSeqno);
     persistedHighSeqno.store(other.persistedHighSeqno,
                              std::memory_order_relaxed);
+    setOperationStats(other.opStats);
     return *this;
 }
 
@@ -25,8 +25,11 @@
 #include <platform/non_negative_counter.h>
 #include <platform/sized_buffer.h>
 
+#include <atomic>
 #include <memory>
 
+class OperationStats;
+
 namespace Collections {
 namespace VB {
 
@@ -139,6 +142,23 @@ public:
         return persistedHighSeqno.load(std::memory_order_relaxed);
     }
 
+    /**
+     * @return the bucket-wide operation stats of this collection, or nullptr
+     *         if none have been attached to this entry yet.
+     */
+    OperationStats* getOperationStats() const {
+        return opStatsPtr.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Attach the bucket-wide operation stats of this collection. Callers must
+     * serialise this (see Collections::Manager::getOperationStats()).
+     */
+    void setOperationStats(std::shared_ptr<OperationStats> stats) const {
+        opStats = std::move(stats);
+        opStatsPtr.store(opStats.get(), std::memory_order_release);
+    }
+
     /// @return true if successfully added stats, false otherwise
     bool addStats(const std::string& cid,
                   Vbid vbid,
@@ -222,6 +242,19 @@ private:
      *           The write lock is really for the Manifest map being changed.
      */
     mutable AtomicMonotonic<uint64_t, IgnorePolicy> persistedHighSeqno;
+
+    /**
+     * The bucket-wide operation stats of this collection, shared with the
+     * Collections::Manager and every vbucket's entry for the collection.
+     * Attached the first time the entry is used by a front end operation.
+     *
+     * mutable - as for highSeqno, attaching the stats doesn't change the
+     *           Manifest map so only needs the read lock.
+     */
+    mutable std::shared_ptr<OperationStats> opStats;
+
+    /// opStats.get(), so that front end threads can read it without a lock
+    mutable std::atomic<OperationStats*> opStatsPtr{nullptr};
 };
 
 std::ostream& operator<<(std::ostream& os, const ManifestEntry& manifestEntry);
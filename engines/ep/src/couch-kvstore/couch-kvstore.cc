@@ -43,6 +43,7 @@
 
 #include "bucket_logger.h"
 #include "common.h"
+#include "couch-kvstore/couch-fs-io-budget.h"
 #include "couch-kvstore/couch-kvstore.h"
 #include "diskdockey.h"
 #include "ep_types.h"
@@ -811,6 +812,9 @@ static int notify_expired_item(DocInfo& info,
     return COUCHSTORE_SUCCESS;
 }
 
+/// How many documents compaction visits between polls of isCancelled.
+static const size_t compactionCancelPollInterval = 1000;
+
 static int time_purge_hook(Db* d, DocInfo* info, sized_buf item, void* ctx_p) {
     compaction_ctx* ctx = static_cast<compaction_ctx*>(ctx_p);
 
@@ -819,6 +823,13 @@ static int time_purge_hook(Db* d, DocInfo* info, sized_buf item, void* ctx_p) {
         return couchstore_set_purge_seq(d, ctx->max_purged_seq);
     }
 
+    if (ctx->isCancelled &&
+        ctx->docsVisited++ % compactionCancelPollInterval == 0 &&
+        ctx->isCancelled()) {
+        ctx->cancelled = true;
+        return COUCHSTORE_ERROR_CANCEL;
+    }
+
     DbInfo infoDb;
     auto err = couchstore_db_info(d, &infoDb);
     if (err != COUCHSTORE_SUCCESS) {
@@ -945,7 +956,7 @@ bool CouchKVStore::compactDB(compaction_ctx *hook_ctx) {
                 hook_ctx->compactConfig.db_file_id,
                 le.what());
     }
-    if (!result) {
+    if (!result && !hook_ctx->cancelled) {
         ++st.numCompactionFailure;
     }
     return result;
@@ -965,6 +976,13 @@ bool CouchKVStore::compactDBInternal(compaction_ctx* hook_ctx,
     couchstore_compact_hook       hook = time_purge_hook;
     couchstore_docinfo_hook dhook = docinfo_hook;
     FileOpsInterface         *def_iops = statCollectingFileOpsCompaction.get();
+    // Declared before the DbHolders, which close their files through it.
+    std::unique_ptr<IOBudgetOps> budgetOps;
+    if (hook_ctx->ioBudget) {
+        budgetOps =
+                std::make_unique<IOBudgetOps>(*def_iops, *hook_ctx->ioBudget);
+        def_iops = budgetOps.get();
+    }
     DbHolder compactdb(*this);
     DbHolder targetDb(*this);
     couchstore_error_t         errCode = COUCHSTORE_SUCCESS;
@@ -1028,6 +1046,17 @@ bool CouchKVStore::compactDBInternal(compaction_ctx* hook_ctx,
                                        dhook,
                                        hook_ctx,
                                        def_iops);
+    if (hook_ctx->cancelled) {
+        logger.info(
+                "CouchKVStore::compactDB: compaction of {} cancelled after "
+                "{} documents, name:{}",
+                vbid,
+                hook_ctx->docsVisited,
+                dbfile);
+        compactdb.close();
+        removeCompactFile(compact_file);
+        return false;
+    }
     if (errCode != COUCHSTORE_SUCCESS) {
         logger.warn(
                 "CouchKVStore::compactDB:couchstore_compact_db_ex "
@@ -1805,6 +1834,13 @@ int CouchKVStore::recordDbDump(Db *db, DocInfo *docinfo, void *ctx) {
             }
         }
 
+        // Skip keys of collections the scan isn't interested in, before
+        // reading the document body.
+        if (sctx->collectionsContext.isFilteredOut(docKey)) {
+            sctx->lastReadSeqno = byseqno;
+            return COUCHSTORE_SUCCESS;
+        }
+
         CacheLookup lookup(diskKey, byseqno, vbucketId);
 
         cl->callback(lookup);
@@ -18,6 +18,7 @@
 #include "active_stream_impl.h"
 
 #include "checkpoint_manager.h"
+#include "dcp/dcpconnmap.h"
 #include "dcp/producer.h"
 #include "dcp/response.h"
 #include "ep_time.h"
@@ -25,6 +26,14 @@
 #include "statwriter.h"
 #include <memcached/protocol_binary.h>
 
+#include <algorithm>
+
+/**
+ * The maximum number of values an adaptively compressing stream sends as is
+ * after a value which didn't compress well enough.
+ */
+static const size_t maxValueCompressionBackoff = 1024;
+
 ActiveStream::ActiveStream(EventuallyPersistentEngine* e,
                            std::shared_ptr<DcpProducer> p,
                            const std::string& n,
@@ -77,9 +86,13 @@ ActiveStream::ActiveStream(EventuallyPersistentEngine* e,
       forceValueCompression(p->isForceValueCompressionEnabled()
                                     ? ForceValueCompression::Yes
                                     : ForceValueCompression::No),
+      adaptiveValueCompression(p->isAdaptiveValueCompressionEnabled()
+                                       ? AdaptiveValueCompression::Yes
+                                       : AdaptiveValueCompression::No),
       syncReplication(p->isSyncReplicationEnabled() ? SyncReplication::Yes
                                                     : SyncReplication::No),
       filter(std::move(f)),
+      backfillCollections(filter.getFixedCollections()),
       sid(filter.getStreamId()) {
     const char* type = "";
     if (flags_ & DCP_ADD_STREAM_FLAG_TAKEOVER) {
@@ -346,6 +359,18 @@ bool ActiveStream::backfillReceived(std::unique_ptr<Item> itm,
     return true;
 }
 
+void ActiveStream::resetBackfillScanBuffer() {
+    auto producer = producerPtr.lock();
+    if (producer) {
+        producer->resetBackfillManagerScanBuffer();
+    }
+}
+
+bool ActiveStream::isBackfillBufferFull() {
+    auto producer = producerPtr.lock();
+    return producer && producer->isBackfillManagerBufferFull();
+}
+
 void ActiveStream::completeBackfill() {
     {
         LockHolder lh(streamMutex);
@@ -676,6 +701,37 @@ void ActiveStream::addStats(const AddStatFn& add_stat, const void* c) {
                          vb_.get());
         add_casted_stat(buffer, cursor.lock() != nullptr, add_stat, c);
 
+        if (isAdaptiveValueCompressionEnabled()) {
+            const std::pair<const char*, size_t> compressionStats[] = {
+                    {"compressed", valueCompression.compressed},
+                    {"rejected", valueCompression.rejected},
+                    {"skipped", valueCompression.skipped},
+                    {"bytes_in", valueCompression.bytesIn},
+                    {"bytes_out", valueCompression.bytesOut}};
+            for (const auto& stat : compressionStats) {
+                checked_snprintf(buffer,
+                                 bsize,
+                                 "%s:stream_%d_value_compression_%s",
+                                 name_.c_str(),
+                                 vb_.get(),
+                                 stat.first);
+                add_casted_stat(buffer, stat.second, add_stat, c);
+            }
+
+            const size_t bytesIn = valueCompression.bytesIn;
+            checked_snprintf(buffer,
+                             bsize,
+                             "%s:stream_%d_value_compression_ratio",
+                             name_.c_str(),
+                             vb_.get());
+            add_casted_stat(buffer,
+                            bytesIn == 0 ? 1.0
+                                         : double(valueCompression.bytesOut) /
+                                                   bytesIn,
+                            add_stat,
+                            c);
+        }
+
         if (isTakeoverSend() && takeoverStart != 0) {
             checked_snprintf(buffer,
                              bsize,
@@ -849,7 +905,7 @@ std::vector<queued_item> ActiveStream::getOutstandingItems(VBucket& vb) {
 static bool shouldModifyItem(const queued_item& item,
                              IncludeValue includeValue,
                              IncludeXattrs includeXattrs,
-                             bool isForceValueCompressionEnabled,
+                             bool compressValue,
                              bool isSnappyEnabled) {
     // If there is no value, no modification needs to be done
     if (item->getValue()) {
@@ -866,7 +922,7 @@ static bool shouldModifyItem(const queued_item& item,
          * If yes, then then value definitely needs modification
          */
         if (isSnappyEnabled) {
-            if (isForceValueCompressionEnabled) {
+            if (compressValue) {
                 if (!mcbp::datatype::is_snappy(item->getDataType())) {
                     return true;
                 }
@@ -908,23 +964,27 @@ std::unique_ptr<DcpResponse> ActiveStream::makeResponseFromItem(
     }
 
     if (item->getOperation() != queue_op::system_event) {
+        const bool compressValue = shouldCompressValue(*item);
         if (shouldModifyItem(item,
                              includeValue,
                              includeXattributes,
-                             isForceValueCompressionEnabled(),
+                             compressValue,
                              isSnappyEnabled())) {
             auto finalItem = std::make_unique<Item>(*item);
             finalItem->pruneValueAndOrXattrs(includeValue, includeXattributes);
 
             if (isSnappyEnabled()) {
-                if (isForceValueCompressionEnabled()) {
-                    if (!mcbp::datatype::is_snappy(finalItem->getDataType())) {
+                if (compressValue &&
+                    !mcbp::datatype::is_snappy(finalItem->getDataType())) {
+                    if (isForceValueCompressionEnabled()) {
                         if (!finalItem->compressValue()) {
                             log(spdlog::level::level_enum::warn,
                                 "{} Failed to snappy compress an uncompressed "
                                 "value",
                                 logPrefix);
                         }
+                    } else {
+                        adaptivelyCompressValue(*finalItem);
                     }
                 }
             } else {
@@ -965,6 +1025,60 @@ std::unique_ptr<DcpResponse> ActiveStream::makeResponseFromItem(
     return SystemEventProducerMessage::make(opaque_, item, sid);
 }
 
+bool ActiveStream::shouldCompressValue(const Item& item) {
+    if (!isSnappyEnabled() || !item.getValue() ||
+        mcbp::datatype::is_snappy(item.getDataType())) {
+        return false;
+    }
+
+    if (isForceValueCompressionEnabled()) {
+        return true;
+    }
+
+    if (!isAdaptiveValueCompressionEnabled() ||
+        includeValue != IncludeValue::Yes) {
+        return false;
+    }
+
+    // Skip the value if we're backing off after values which didn't
+    // compress well enough (the decrement may race with another thread
+    // making a response, which is fine as it is only a heuristic)
+    auto skip = valueCompression.skip.load();
+    if (skip > 0) {
+        valueCompression.skip.store(skip - 1);
+        valueCompression.skipped++;
+        valueCompression.bytesIn += item.getNBytes();
+        valueCompression.bytesOut += item.getNBytes();
+        return false;
+    }
+
+    return true;
+}
+
+void ActiveStream::adaptivelyCompressValue(Item& item) {
+    const auto before = item.getNBytes();
+    if (!item.compressValue(
+                engine->getDcpConnMap().getMinCompressionRatio())) {
+        log(spdlog::level::level_enum::warn,
+            "{} Failed to snappy compress an uncompressed value",
+            logPrefix);
+        return;
+    }
+
+    valueCompression.bytesIn += before;
+    valueCompression.bytesOut += item.getNBytes();
+    if (mcbp::datatype::is_snappy(item.getDataType())) {
+        valueCompression.compressed++;
+        valueCompression.backoff.store(1);
+    } else {
+        valueCompression.rejected++;
+        const auto backoff = valueCompression.backoff.load();
+        valueCompression.skip.store(backoff);
+        valueCompression.backoff.store(
+                std::min(backoff * 2, maxValueCompressionBackoff));
+    }
+}
+
 void ActiveStream::processItems(std::vector<queued_item>& items,
                                 const LockHolder& streamMutex) {
     if (!items.empty()) {
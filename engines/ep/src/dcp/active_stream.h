@@ -72,6 +72,15 @@ public:
                           backfill_source_t backfill_source,
                           bool force);
 
+    /**
+     * Reset the scan buffer of this stream's BackfillManager; called when
+     * the stream's backfill is advanced by another connection's task.
+     */
+    void resetBackfillScanBuffer();
+
+    /// @return true if the backfill buffer of this stream's producer is full
+    bool isBackfillBufferFull();
+
     void completeBackfill();
 
     bool isCompressionEnabled();
@@ -80,6 +89,10 @@ public:
         return forceValueCompression == ForceValueCompression::Yes;
     }
 
+    bool isAdaptiveValueCompressionEnabled() const {
+        return adaptiveValueCompression == AdaptiveValueCompression::Yes;
+    }
+
     bool isSnappyEnabled() const {
         return snappyEnabled == SnappyEnabled::Yes;
     }
@@ -118,6 +131,15 @@ public:
      */
     bool handleSlowStream();
 
+    /**
+     * @return the collections a disk backfill for this stream needs to read,
+     *         or uninitialised if it needs all collections.
+     */
+    const boost::optional<std::unordered_set<CollectionID>>&
+    getBackfillCollections() const {
+        return backfillCollections;
+    }
+
     /// @return true if both includeValue and includeXattributes are set to No,
     /// otherwise return false.
     bool isKeyOnly() const {
@@ -208,6 +230,24 @@ protected:
         std::atomic<size_t> sent;
     } backfillItems;
 
+    //! State and stats for adaptive value compression
+    struct {
+        /// Number of values to send as is before we try to compress again
+        std::atomic<size_t> skip{0};
+        /// What skip is set to when the next value doesn't compress
+        std::atomic<size_t> backoff{1};
+        /// Number of values sent compressed
+        std::atomic<size_t> compressed{0};
+        /// Number of values which didn't compress well enough
+        std::atomic<size_t> rejected{0};
+        /// Number of values sent without trying to compress them
+        std::atomic<size_t> skipped{0};
+        /// Size of the values before compression
+        std::atomic<size_t> bytesIn{0};
+        /// Size of the values as sent
+        std::atomic<size_t> bytesOut{0};
+    } valueCompression;
+
     /* The last sequence number queued from disk or memory and is
        snapshotted and put onto readyQ */
     AtomicMonotonic<uint64_t, ThrowExceptionPolicy> lastReadSeqno;
@@ -226,6 +266,22 @@ protected:
 private:
     std::unique_ptr<DcpResponse> next(std::lock_guard<std::mutex>& lh);
 
+    /**
+     * Should the value of the given item be compressed before it is sent?
+     * In adaptive mode this consumes one of the values to skip (if any).
+     */
+    bool shouldCompressValue(const Item& item);
+
+    /**
+     * Compress the value of the item if the compressed value is no more
+     * than dcp_min_compression_ratio of the original size. Every value
+     * which doesn't compress well enough doubles the number of values we
+     * send as is before trying again (up to maxValueCompressionBackoff),
+     * so a stream of incompressible documents quickly stops paying for
+     * the compression attempts.
+     */
+    void adaptivelyCompressValue(Item& item);
+
     std::unique_ptr<DcpResponse> inMemoryPhase();
 
     std::unique_ptr<DcpResponse> takeoverSendPhase();
@@ -357,6 +413,9 @@ private:
     /// Should items be forcefully compressed on this stream?
     ForceValueCompression forceValueCompression;
 
+    /// Should items be compressed where it pays off on this stream?
+    AdaptiveValueCompression adaptiveValueCompression;
+
     /// Does this stream support synchronous replication?
     const SyncReplication syncReplication;
 
@@ -365,6 +424,14 @@ private:
      */
     Collections::VB::Filter filter;
 
+    /**
+     * The collections of the filter at stream creation, if the filter can
+     * only ever allow a subset of them (see Filter::getFixedCollections).
+     * Immutable so it can be read by a backfill without the streamMutex.
+     */
+    const boost::optional<std::unordered_set<CollectionID>>
+            backfillCollections;
+
     /**
      * A stream-ID which is defined if the producer is using enabled to allow
      * many streams-per-vbucket
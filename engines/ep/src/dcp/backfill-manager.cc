@@ -227,6 +227,17 @@ void BackfillManager::bytesForceRead(size_t bytes) {
     }
 }
 
+void BackfillManager::resetScanBuffer() {
+    LockHolder lh(lock);
+    scanBuffer.bytesRead = 0;
+    scanBuffer.itemsRead = 0;
+}
+
+bool BackfillManager::isBufferFull() {
+    LockHolder lh(lock);
+    return buffer.full;
+}
+
 void BackfillManager::bytesSent(size_t bytes) {
     LockHolder lh(lock);
     if (bytes > buffer.bytesRead) {
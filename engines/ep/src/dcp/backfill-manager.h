@@ -94,6 +94,16 @@ public:
 
     void bytesSent(size_t bytes);
 
+    /**
+     * Reset the scan buffer, starting a new run's worth of reads. Used when
+     * a backfill is advanced by another connection's BackfillManager (a
+     * shared disk scan), as this manager's backfill() never sees that run.
+     */
+    void resetScanBuffer();
+
+    /// @return true if the backfill buffer of this connection is full
+    bool isBufferFull();
+
     // Called by the managerTask to acutally perform backfilling & manage
     // backfills between the different queues.
     backfill_status_t backfill();
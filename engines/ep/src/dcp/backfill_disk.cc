@@ -19,10 +19,13 @@
 
 #include "dcp/active_stream_impl.h"
 #include "dcp/backfill_disk.h"
+#include "dcp/dcpconnmap.h"
 #include "ep_engine.h"
 #include "kv_bucket.h"
 #include "vbucket.h"
 
+#include <algorithm>
+
 static std::string backfillStateToString(backfill_state_t state) {
     switch (state) {
     case backfill_state_init:
@@ -145,13 +148,292 @@ void DiskCallback::callback(GetValue& val) {
     }
 }
 
+DiskBackfillScan::Participant::Participant(EventuallyPersistentEngine& e,
+                                           std::shared_ptr<ActiveStream> s,
+                                           uint64_t startSeqno)
+    : stream(s), startSeqno(startSeqno), cacheCallback(e, s), diskCallback(s) {
+}
+
+/* Callbacks given to the KVStore, forwarding to the owning scan */
+class DiskBackfillScan::FanOutCacheCallback
+    : public StatusCallback<CacheLookup> {
+public:
+    explicit FanOutCacheCallback(DiskBackfillScan& scan) : scan(scan) {
+    }
+
+    void callback(CacheLookup& lookup) override {
+        setStatus(scan.cacheLookup(lookup));
+    }
+
+private:
+    DiskBackfillScan& scan;
+};
+
+class DiskBackfillScan::FanOutDiskCallback : public StatusCallback<GetValue> {
+public:
+    explicit FanOutDiskCallback(DiskBackfillScan& scan) : scan(scan) {
+    }
+
+    void callback(GetValue& val) override {
+        setStatus(scan.diskItem(val));
+    }
+
+private:
+    DiskBackfillScan& scan;
+};
+
+DiskBackfillScan::DiskBackfillScan(
+        EventuallyPersistentEngine& e,
+        Vbid vbid,
+        ValueFilter valFilter,
+        boost::optional<std::unordered_set<CollectionID>> collections)
+    : engine(e),
+      vbid(vbid),
+      valFilter(valFilter),
+      collections(std::move(collections)),
+      kvstore(e.getKVBucket()->getROUnderlying(vbid)) {
+}
+
+DiskBackfillScan::~DiskBackfillScan() {
+    kvstore->destroyScanContext(scanCtx);
+}
+
+bool DiskBackfillScan::open(uint64_t startSeqno) {
+    scanCtx = kvstore->initScanContext(
+            std::make_shared<FanOutDiskCallback>(*this),
+            std::make_shared<FanOutCacheCallback>(*this),
+            vbid,
+            startSeqno,
+            DocumentFilter::ALL_ITEMS,
+            valFilter);
+    if (scanCtx && collections) {
+        scanCtx->collectionsContext.setCollectionFilter(*collections);
+    }
+    return scanCtx != nullptr;
+}
+
+std::shared_ptr<DiskBackfillScan::Participant> DiskBackfillScan::attach(
+        std::shared_ptr<ActiveStream> stream, uint64_t startSeqno) {
+    auto participant =
+            std::make_shared<Participant>(engine, stream, startSeqno);
+    LockHolder lh(scanMutex);
+    participants.push_back(participant);
+    return participant;
+}
+
+std::shared_ptr<DiskBackfillScan::Participant> DiskBackfillScan::tryAttach(
+        std::shared_ptr<ActiveStream> stream,
+        uint64_t startSeqno,
+        uint64_t endSeqno) {
+    // Blocks whilst another thread is advancing the scan, so the read
+    // position checked below cannot move before we are attached.
+    LockHolder lh(scanMutex);
+    if (!scanCtx || finished) {
+        return {};
+    }
+
+    // Every item from startSeqno must still be ahead of the scan...
+    const auto nextSeqno = scanCtx->lastReadSeqno == 0
+                                   ? uint64_t(scanCtx->startSeqno)
+                                   : uint64_t(scanCtx->lastReadSeqno) + 1;
+    if (startSeqno < nextSeqno) {
+        return {};
+    }
+
+    // ... the scan must reach the end of the range we need from disk ...
+    if (endSeqno > uint64_t(scanCtx->maxSeqno)) {
+        return {};
+    }
+
+    // ... and the start must not be behind the purge seqno of the file
+    // (see DCPBackfillDisk::create)
+    if (startSeqno != 1 && startSeqno <= scanCtx->purgeSeqno) {
+        return {};
+    }
+
+    // ... and a collection restricted scan must read every collection the
+    // stream needs.
+    if (collections) {
+        const auto& needed = stream->getBackfillCollections();
+        if (!needed || !std::all_of(needed->begin(),
+                                    needed->end(),
+                                    [this](CollectionID cid) {
+                                        return collections->count(cid) > 0;
+                                    })) {
+            return {};
+        }
+    }
+
+    auto participant =
+            std::make_shared<Participant>(engine, stream, startSeqno);
+    participants.push_back(participant);
+    return participant;
+}
+
+DiskBackfillScan::Status DiskBackfillScan::scan(const Participant& driver) {
+    if (finished) {
+        return Status::Done;
+    }
+
+    std::unique_lock<std::mutex> lh(scanMutex, std::try_to_lock);
+    if (!lh) {
+        return Status::Busy;
+    }
+
+    participants.erase(
+            std::remove_if(participants.begin(),
+                           participants.end(),
+                           [](const std::shared_ptr<Participant>& p) {
+                               return p->detached.load();
+                           }),
+            participants.end());
+
+    // The other participants' BackfillManagers don't see this run, so reset
+    // their scan buffers here to give each a full run's worth of reads.
+    for (auto& p : participants) {
+        if (p.get() != &driver) {
+            if (auto stream = p->stream.lock()) {
+                stream->resetBackfillScanBuffer();
+            }
+        }
+    }
+
+    this->driver = &driver;
+    blocked = false;
+    const auto status = kvstore->scan(scanCtx);
+    this->driver = nullptr;
+
+    if (status == scan_again) {
+        return blocked ? Status::Blocked : Status::Again;
+    }
+
+    finished = true;
+    return Status::Done;
+}
+
+uint64_t DiskBackfillScan::getMaxSeqno() const {
+    return scanCtx->maxSeqno;
+}
+
+uint64_t DiskBackfillScan::getPurgeSeqno() const {
+    return scanCtx->purgeSeqno;
+}
+
+uint64_t DiskBackfillScan::getDocumentCount() const {
+    return scanCtx->documentCount;
+}
+
+bool DiskBackfillScan::wants(const Participant& p, uint64_t seqno) {
+    return !p.detached && seqno >= p.startSeqno && seqno > p.lastSeqno;
+}
+
+void DiskBackfillScan::checkBlocked(const Participant& p) {
+    if (&p == driver) {
+        return;
+    }
+    auto stream = p.stream.lock();
+    blocked = stream && stream->isBackfillBufferFull();
+}
+
+ENGINE_ERROR_CODE DiskBackfillScan::cacheLookup(CacheLookup& lookup) {
+    const auto seqno = uint64_t(lookup.getBySeqno());
+    bool needDiskRead = false;
+    for (auto& p : participants) {
+        if (!wants(*p, seqno)) {
+            continue;
+        }
+        p->cacheCallback.callback(lookup);
+        switch (p->cacheCallback.getStatus()) {
+        case ENGINE_KEY_EEXISTS:
+            // Sent from memory
+            p->lastSeqno = seqno;
+            break;
+        case ENGINE_ENOMEM:
+            // Pause the scan; participants already sent this item will skip
+            // it when it is re-read.
+            checkBlocked(*p);
+            return ENGINE_ENOMEM;
+        default:
+            needDiskRead = true;
+        }
+    }
+    return needDiskRead ? ENGINE_SUCCESS : ENGINE_KEY_EEXISTS;
+}
+
+ENGINE_ERROR_CODE DiskBackfillScan::diskItem(GetValue& val) {
+    if (!val.item) {
+        throw std::invalid_argument("DiskBackfillScan::diskItem: val is NULL");
+    }
+
+    const auto seqno = uint64_t(val.item->getBySeqno());
+    auto remaining = std::count_if(participants.begin(),
+                                   participants.end(),
+                                   [seqno](const std::shared_ptr<Participant>& p) {
+                                       return wants(*p, seqno);
+                                   });
+    for (auto& p : participants) {
+        if (!wants(*p, seqno)) {
+            continue;
+        }
+        // The last recipient takes the item read from disk, the others get
+        // a copy (which shares the value Blob).
+        if (--remaining == 0) {
+            p->diskCallback.callback(val);
+        } else {
+            GetValue copy(std::make_unique<Item>(*val.item),
+                          val.getStatus(),
+                          val.getId(),
+                          val.isPartial());
+            p->diskCallback.callback(copy);
+        }
+        if (p->diskCallback.getStatus() == ENGINE_ENOMEM) {
+            checkBlocked(*p);
+            return ENGINE_ENOMEM;
+        }
+        p->lastSeqno = seqno;
+    }
+    return ENGINE_SUCCESS;
+}
+
+void DiskBackfillScanRegistry::add(
+        const std::shared_ptr<DiskBackfillScan>& scan) {
+    LockHolder lh(mutex);
+    scans[scan->getVBucketId()].push_back(scan);
+}
+
+std::vector<std::shared_ptr<DiskBackfillScan>>
+DiskBackfillScanRegistry::getScans(Vbid vbid, ValueFilter valFilter) {
+    std::vector<std::shared_ptr<DiskBackfillScan>> result;
+    LockHolder lh(mutex);
+    auto itr = scans.find(vbid);
+    if (itr == scans.end()) {
+        return result;
+    }
+
+    auto& list = itr->second;
+    for (auto it = list.begin(); it != list.end();) {
+        auto scan = it->lock();
+        if (!scan) {
+            it = list.erase(it);
+            continue;
+        }
+        if (scan->getValueFilter() == valFilter) {
+            result.push_back(std::move(scan));
+        }
+        ++it;
+    }
+    if (list.empty()) {
+        scans.erase(itr);
+    }
+    return result;
+}
+
 DCPBackfillDisk::DCPBackfillDisk(EventuallyPersistentEngine& e,
                                  std::shared_ptr<ActiveStream> s,
                                  uint64_t startSeqno,
                                  uint64_t endSeqno)
     : DCPBackfill(s, startSeqno, endSeqno),
       engine(e),
-      scanCtx(nullptr),
       state(backfill_state_init) {
 }
 
@@ -207,7 +489,6 @@ backfill_status_t DCPBackfillDisk::create() {
         return backfill_snooze;
     }
 
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
     ValueFilter valFilter = ValueFilter::VALUES_DECOMPRESSED;
     if (stream->isKeyOnly()) {
         valFilter = ValueFilter::KEYS_ONLY;
@@ -217,48 +498,81 @@ backfill_status_t DCPBackfillDisk::create() {
         }
     }
 
-    auto cb = std::make_shared<DiskCallback>(stream);
-    auto cl = std::make_shared<CacheCallback>(engine, stream);
-    scanCtx = kvstore->initScanContext(
-            cb, cl, vbid, startSeqno, DocumentFilter::ALL_ITEMS, valFilter);
-
-    // Check startSeqno against the purge-seqno of the opened datafile.
-    // 1) A normal stream request would of checked inside streamRequest, but
-    //    compaction may have changed the purgeSeqno
-    // 2) Cursor dropping can also schedule backfills and they must not re-start
-    //    behind the current purge-seqno
-    // If the startSeqno != 1 (a client 0 to n request becomes 1 to n) then
-    // start-seqno must be above purge-seqno
-    if (!scanCtx || (startSeqno != 1 && (startSeqno <= scanCtx->purgeSeqno))) {
-        auto vb = engine.getVBucket(vbid);
-        std::stringstream log;
-        log << "DCPBackfillDisk::create(): (" << getVBucketId()
-            << ") cannot be scanned. Associated stream is set to dead state.";
-        end_stream_status_t status = END_STREAM_BACKFILL_FAIL;
-        if (scanCtx) {
-            log << " startSeqno:" << startSeqno
-                << " < purgeSeqno:" << scanCtx->purgeSeqno;
-            kvstore->destroyScanContext(scanCtx);
-            status = END_STREAM_ROLLBACK;
-        } else {
-            log << " failed to create scan";
+    auto& scanRegistry = engine.getDcpConnMap().getDiskBackfillScanRegistry();
+    const bool coalesce = engine.getConfiguration().isDcpBackfillCoalescing();
+    if (coalesce) {
+        // Try to piggy-back on a scan of this vBucket another stream has
+        // already opened.
+        for (auto& candidate : scanRegistry.getScans(vbid, valFilter)) {
+            participant = candidate->tryAttach(stream, startSeqno, endSeqno);
+            if (participant) {
+                diskScan = std::move(candidate);
+                scanRegistry.recordScanShared();
+                stream->log(spdlog::level::level_enum::info,
+                            "({}) Backfill ({} to {}) sharing existing disk "
+                            "scan up to seqno {}",
+                            vbid,
+                            startSeqno,
+                            endSeqno,
+                            diskScan->getMaxSeqno());
+                break;
+            }
         }
-        log << ". The vbucket state:";
-        if (vb) {
-            log << VBucket::toString(vb->getState());
-        } else {
-            log << "vb not found!!";
+    }
+
+    if (!diskScan) {
+        // Only read the collections this stream needs; keys of other
+        // collections are skipped by the KVStore without reading values.
+        auto newScan = std::make_shared<DiskBackfillScan>(
+                engine, vbid, valFilter, stream->getBackfillCollections());
+
+        // Check startSeqno against the purge-seqno of the opened datafile.
+        // 1) A normal stream request would of checked inside streamRequest,
+        //    but compaction may have changed the purgeSeqno
+        // 2) Cursor dropping can also schedule backfills and they must not
+        //    re-start behind the current purge-seqno
+        // If the startSeqno != 1 (a client 0 to n request becomes 1 to n)
+        // then start-seqno must be above purge-seqno
+        if (!newScan->open(startSeqno) ||
+            (startSeqno != 1 && (startSeqno <= newScan->getPurgeSeqno()))) {
+            auto vb = engine.getVBucket(vbid);
+            std::stringstream log;
+            log << "DCPBackfillDisk::create(): (" << getVBucketId()
+                << ") cannot be scanned. Associated stream is set to dead "
+                   "state.";
+            end_stream_status_t status = END_STREAM_BACKFILL_FAIL;
+            if (newScan->isOpen()) {
+                log << " startSeqno:" << startSeqno
+                    << " < purgeSeqno:" << newScan->getPurgeSeqno();
+                status = END_STREAM_ROLLBACK;
+            } else {
+                log << " failed to create scan";
+            }
+            log << ". The vbucket state:";
+            if (vb) {
+                log << VBucket::toString(vb->getState());
+            } else {
+                log << "vb not found!!";
+            }
+
+            stream->log(spdlog::level::level_enum::warn, "{}", log.str());
+            stream->setDead(status);
+            transitionState(backfill_state_done);
+            return backfill_success;
         }
 
-        stream->log(spdlog::level::level_enum::warn, "{}", log.str());
-        stream->setDead(status);
-        transitionState(backfill_state_done);
-    } else {
-        stream->incrBackfillRemaining(scanCtx->documentCount);
-        stream->markDiskSnapshot(startSeqno, scanCtx->maxSeqno);
-        transitionState(backfill_state_scanning);
+        participant = newScan->attach(stream, startSeqno);
+        scanRegistry.recordScanOpened();
+        if (coalesce) {
+            scanRegistry.add(newScan);
+        }
+        diskScan = std::move(newScan);
     }
 
+    stream->incrBackfillRemaining(diskScan->getDocumentCount());
+    stream->markDiskSnapshot(startSeqno, diskScan->getMaxSeqno());
+    transitionState(backfill_state_scanning);
+
     return backfill_success;
 }
 
@@ -268,17 +582,23 @@ backfill_status_t DCPBackfillDisk::scan() {
         return complete(true);
     }
 
-    Vbid vbid = stream->getVBucket();
-
     if (!(stream->isActive())) {
         return complete(true);
     }
 
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
-    scan_error_t error = kvstore->scan(scanCtx);
-
-    if (error == scan_again) {
+    switch (diskScan->scan(*participant)) {
+    case DiskBackfillScan::Status::Again:
         return backfill_success;
+    case DiskBackfillScan::Status::Busy:
+        // Another stream's backfill is advancing the shared scan (and
+        // sending our items); check back later.
+        return backfill_snooze;
+    case DiskBackfillScan::Status::Blocked:
+        // Another stream's connection must drain its backfill buffer before
+        // the scan can progress; its backfill resumes the scan once woken.
+        return backfill_snooze;
+    case DiskBackfillScan::Status::Done:
+        break;
     }
 
     transitionState(backfill_state_completing);
@@ -287,10 +607,13 @@ backfill_status_t DCPBackfillDisk::scan() {
 }
 
 backfill_status_t DCPBackfillDisk::complete(bool cancelled) {
-    /* we want to destroy kv store context irrespective of a premature complete
-       or not */
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(getVBucketId());
-    kvstore->destroyScanContext(scanCtx);
+    /* we want to release the disk scan irrespective of a premature complete
+       or not; the scan context is destroyed once no backfill uses it */
+    if (participant) {
+        participant->detached = true;
+        participant.reset();
+    }
+    diskScan.reset();
 
     auto stream = streamPtr.lock();
     if (!stream) {
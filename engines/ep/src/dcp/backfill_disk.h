@@ -21,8 +21,16 @@
 
 #include "callbacks.h"
 #include "dcp/backfill.h"
+#include "kvstore.h"
 
+#include <boost/optional/optional.hpp>
+
+#include <atomic>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class EventuallyPersistentEngine;
 class ScanContext;
@@ -67,12 +75,221 @@ private:
     std::weak_ptr<ActiveStream> streamPtr;
 };
 
+/**
+ * A disk scan of a single vBucket which can be shared by more than one
+ * DCPBackfillDisk.
+ *
+ * Each DCPBackfillDisk using the scan attaches its stream as a Participant.
+ * Items read from disk are fanned out to every Participant whose start seqno
+ * they are at or above; each Participant remembers the last seqno it
+ * accepted so that when the scan is paused (because any one Participant's
+ * backfill buffer is full) and later resumed, items are not sent twice.
+ *
+ * The scan is driven by whichever owning DCPBackfillDisk runs first; only
+ * one thread can advance it at a time. As the other participants' items are
+ * read by the driver's task, the driver resets their BackfillManagers' scan
+ * buffers at the start of each run, and if a participant's connection
+ * backfill buffer fills the driver snoozes (rather than rescheduling) until
+ * that connection drains. The ScanContext is destroyed when the last owning
+ * DCPBackfillDisk releases the scan.
+ *
+ * A stream can only attach to a scan which has not yet read past the
+ * stream's start seqno and which covers the stream's end seqno - see
+ * tryAttach().
+ */
+class DiskBackfillScan {
+public:
+    /// Per-stream state of a shared scan.
+    struct Participant {
+        Participant(EventuallyPersistentEngine& e,
+                    std::shared_ptr<ActiveStream> s,
+                    uint64_t startSeqno);
+
+        std::weak_ptr<ActiveStream> stream;
+        const uint64_t startSeqno;
+        /// The highest seqno this participant has accepted (or skipped).
+        uint64_t lastSeqno = 0;
+        CacheCallback cacheCallback;
+        DiskCallback diskCallback;
+        /// Set when the owning backfill is done with the scan; the
+        /// participant is then skipped and removed by the scanning thread.
+        std::atomic<bool> detached{false};
+    };
+
+    /// Outcome of a call to scan().
+    enum class Status {
+        /// Scan paused; call again to make further progress.
+        Again,
+        /// Another thread is currently advancing the scan.
+        Busy,
+        /// Scan paused as another participant's backfill buffer is full.
+        Blocked,
+        /// Scan has read all items up to maxSeqno (or failed).
+        Done
+    };
+
+    /**
+     * @param collections if initialised, the scan only returns items of
+     *        these collections (plus system events); other keys are skipped
+     *        by the KVStore before their values are read.
+     */
+    DiskBackfillScan(
+            EventuallyPersistentEngine& e,
+            Vbid vbid,
+            ValueFilter valFilter,
+            boost::optional<std::unordered_set<CollectionID>> collections =
+                    {});
+
+    ~DiskBackfillScan();
+
+    /**
+     * Create the underlying ScanContext, reading from startSeqno.
+     *
+     * @return true if the scan context was created
+     */
+    bool open(uint64_t startSeqno);
+
+    bool isOpen() const {
+        return scanCtx != nullptr;
+    }
+
+    /**
+     * Unconditionally attach the given stream to this scan. Used by the
+     * backfill which opened the scan.
+     */
+    std::shared_ptr<Participant> attach(std::shared_ptr<ActiveStream> stream,
+                                        uint64_t startSeqno);
+
+    /**
+     * Attach the given stream to this scan if the scan can serve all items
+     * from startSeqno to endSeqno to it (and, for a collection restricted
+     * scan, every collection the stream needs).
+     *
+     * @return the new participant, or nullptr if the stream cannot share
+     *         this scan
+     */
+    std::shared_ptr<Participant> tryAttach(std::shared_ptr<ActiveStream> stream,
+                                           uint64_t startSeqno,
+                                           uint64_t endSeqno);
+
+    /**
+     * Advance the scan, fanning out items to all attached participants.
+     *
+     * @param driver the participant of the backfill advancing the scan
+     */
+    Status scan(const Participant& driver);
+
+    Vbid getVBucketId() const {
+        return vbid;
+    }
+
+    ValueFilter getValueFilter() const {
+        return valFilter;
+    }
+
+    uint64_t getMaxSeqno() const;
+
+    uint64_t getPurgeSeqno() const;
+
+    uint64_t getDocumentCount() const;
+
+private:
+    class FanOutCacheCallback;
+    class FanOutDiskCallback;
+
+    /// Should the given participant be sent the item at seqno?
+    static bool wants(const Participant& p, uint64_t seqno);
+
+    /**
+     * Record whether the pause caused by participant p (which could not
+     * accept an item) must wait for p's connection to drain its backfill
+     * buffer, rather than just for the next run.
+     */
+    void checkBlocked(const Participant& p);
+
+    /// Offer the cache lookup to each participant needing it.
+    ENGINE_ERROR_CODE cacheLookup(CacheLookup& lookup);
+
+    /// Offer the disk item to each participant needing it.
+    ENGINE_ERROR_CODE diskItem(GetValue& val);
+
+    EventuallyPersistentEngine& engine;
+    const Vbid vbid;
+    const ValueFilter valFilter;
+    /// If initialised, the only (non-system) collections the scan returns
+    const boost::optional<std::unordered_set<CollectionID>> collections;
+    KVStore* kvstore;
+    ScanContext* scanCtx = nullptr;
+    std::atomic<bool> finished{false};
+
+    /// Serialises advancing the scan and modifying participants.
+    std::mutex scanMutex;
+    std::vector<std::shared_ptr<Participant>> participants;
+    /// The participant advancing the scan in the current call to scan().
+    const Participant* driver = nullptr;
+    /// Set if the current scan() paused on a full buffer of a participant
+    /// other than the driver.
+    bool blocked = false;
+};
+
+/**
+ * Bucket-wide index of the open DiskBackfillScans, used to coalesce the
+ * backfills of different streams (possibly on different DCP connections)
+ * for the same vBucket into a single disk scan.
+ *
+ * Only weak references to scans are held; a scan stays open for only as long
+ * as a DCPBackfillDisk is using it.
+ */
+class DiskBackfillScanRegistry {
+public:
+    /**
+     * Record a newly opened scan which other backfills may attach to.
+     */
+    void add(const std::shared_ptr<DiskBackfillScan>& scan);
+
+    /**
+     * @return the currently open scans of the given vBucket which read
+     *         values in the given form.
+     */
+    std::vector<std::shared_ptr<DiskBackfillScan>> getScans(
+            Vbid vbid, ValueFilter valFilter);
+
+    /// Count a backfill which opened its own disk scan.
+    void recordScanOpened() {
+        scansOpened++;
+    }
+
+    /// Count a backfill which attached to an existing disk scan.
+    void recordScanShared() {
+        scansShared++;
+    }
+
+    size_t getNumScansOpened() const {
+        return scansOpened;
+    }
+
+    size_t getNumScansShared() const {
+        return scansShared;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<Vbid, std::list<std::weak_ptr<DiskBackfillScan>>> scans;
+
+    std::atomic<size_t> scansOpened{0};
+    std::atomic<size_t> scansShared{0};
+};
+
 /**
  * Concrete class that does backfill from the disk and informs the DCP stream
  * of the backfill progress.
  * This class calls asynchronous kvstore apis and manages a state machine to
  * read items in the sequential order from the disk and to call the DCP stream
  * for disk snapshot, backfill items and backfill completion.
+ *
+ * When dcp_backfill_coalescing is enabled, a backfill which can be served by
+ * a disk scan already opened by another stream of the same vBucket attaches
+ * to that scan instead of opening its own (see DiskBackfillScan).
  */
 class DCPBackfillDisk : public DCPBackfill {
 public:
@@ -122,7 +339,10 @@ private:
      */
     EventuallyPersistentEngine& engine;
 
-    ScanContext* scanCtx;
+    /// The (possibly shared) disk scan this backfill reads from.
+    std::shared_ptr<DiskBackfillScan> diskScan;
+    /// This backfill's stream's state within diskScan.
+    std::shared_ptr<DiskBackfillScan::Participant> participant;
     backfill_state_t state;
     std::mutex lock;
 };
@@ -187,9 +187,11 @@ backfill_status_t DCPBackfillMemoryBuffered::create() {
         return backfill_finished;
     }
 
-    /* Create range read cursor */
+    /* Create range read cursor, positioned at the first item >= startSeqno */
     try {
-        auto rangeItrOptional = evb->makeRangeIterator(true /*isBackfill*/);
+        auto rangeItrOptional =
+                evb->makeRangeIterator(true /*isBackfill*/,
+                                       static_cast<seqno_t>(startSeqno));
         if (rangeItrOptional) {
             rangeItr = std::move(*rangeItrOptional);
         } else {
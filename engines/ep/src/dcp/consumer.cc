@@ -51,6 +51,7 @@ class DcpConsumerTask : public GlobalTask {
 public:
     DcpConsumerTask(EventuallyPersistentEngine* e,
                     std::shared_ptr<DcpConsumer> c,
+                    size_t processor,
                     double sleeptime = 1,
                     bool completeBeforeShutdown = true)
         : GlobalTask(e,
@@ -58,6 +59,7 @@ public:
                      sleeptime,
                      completeBeforeShutdown),
           consumerPtr(c),
+          processor(processor),
           description("DcpConsumerTask, processing buffered items for " +
                       c->getName()) {
     }
@@ -81,7 +83,8 @@ public:
         }
 
         double sleepFor = 0.0;
-        enum process_items_error_t state = consumer->processBufferedItems();
+        enum process_items_error_t state =
+                consumer->processBufferedItems(processor);
         switch (state) {
             case all_processed:
                 sleepFor = INT_MAX;
@@ -99,30 +102,30 @@ public:
         // Check if we've been notified of more work to do - if not then sleep;
         // if so then wakeup and re-run the task.
         // Note: The order of the wakeUp / snooze here is *critical* - another
-        // thread may concurrently notify us (set processorNotification=true)
+        // thread may concurrently notify us (set Processor::notification=true)
         // while we are performing the checks, so we need to ensure we don't
         // loose a wakeup as that would result in this Task sleeping forever
         // (and DCP hanging).
         // To prevent this, we perform an initial check of notifiedProcessor(),
         // which if false we initially sleep, and then check a second time.
-        // We could race if the other actor sets processorNotification=true
+        // We could race if the other actor sets notification=true
         // between the second `if(consumer->notifiedProcessor)` and us calling
         // `wakeUp()`; but that's essentially a benign race as it will just
         // result in wakeUp() being called twice which is benign.
-        if (consumer->notifiedProcessor(false)) {
+        if (consumer->notifiedProcessor(processor, false)) {
             wakeUp();
             state = more_to_process;
         } else {
             snooze(sleepFor);
             // Check if the processor was notified again,
             // in which case the task should wake immediately.
-            if (consumer->notifiedProcessor(false)) {
+            if (consumer->notifiedProcessor(processor, false)) {
                 wakeUp();
                 state = more_to_process;
             }
         }
 
-        consumer->setProcessorTaskState(state);
+        consumer->setProcessorTaskState(processor, state);
 
         return true;
     }
@@ -141,6 +144,8 @@ private:
     /* we have one task per consumer. the task only needs a reference to the
        consumer object and does not own it. Hence std::weak_ptr should be used*/
     const std::weak_ptr<DcpConsumer> consumerPtr;
+    /* index of the consumer's processor (set of vBuckets) this task runs */
+    const size_t processor;
     const std::string description;
 };
 
@@ -152,15 +157,12 @@ DcpConsumer::DcpConsumer(EventuallyPersistentEngine& engine,
       lastMessageTime(ep_current_time()),
       engine(engine),
       opaqueCounter(0),
-      processorTaskId(0),
-      processorTaskState(all_processed),
-      processorNotification(false),
       backoffs(0),
       dcpNoopTxInterval(engine.getConfiguration().getDcpNoopTxInterval()),
       pendingSendStreamEndOnClientStreamClose(true),
       consumerName(consumerName_),
       producerIsVersion5orHigher(false),
-      processorTaskRunning(false),
+      processorTasksRunning(0),
       flowControl(engine, this),
       processBufferedMessagesYieldThreshold(
               engine.getConfiguration()
@@ -186,6 +188,12 @@ DcpConsumer::DcpConsumer(EventuallyPersistentEngine& engine,
     syncReplNegotiation.state = SyncReplNegotiation::State::PendingRequest;
     // If a consumer_name was provided then tell the producer about it.
     pendingSendConsumerName = !consumerName.empty();
+
+    const size_t numProcessors = config.getDcpConsumerProcessorTasks();
+    for (size_t ii = 0; ii < numProcessors; ++ii) {
+        processors.push_back(
+                std::make_unique<Processor>(config.getMaxVbuckets()));
+    }
 }
 
 DcpConsumer::~DcpConsumer() {
@@ -194,14 +202,15 @@ DcpConsumer::~DcpConsumer() {
 
 
 void DcpConsumer::cancelTask() {
-    bool exp = true;
-    if (processorTaskRunning.compare_exchange_strong(exp, false)) {
-        ExecutorPool::get()->cancel(processorTaskId);
+    if (processorTasksRunning.load() > 0) {
+        for (auto& processor : processors) {
+            ExecutorPool::get()->cancel(processor->taskId);
+        }
     }
 }
 
 void DcpConsumer::taskCancelled() {
-    processorTaskRunning.store(false);
+    processorTasksRunning--;
 }
 
 std::shared_ptr<PassiveStream> DcpConsumer::makePassiveStream(
@@ -285,13 +294,16 @@ ENGINE_ERROR_CODE DcpConsumer::addStream(uint32_t opaque,
         }
     }
 
-    /* We need 'Processor' task only when we have a stream. Hence create it
-     only once when the first stream is added */
-    bool exp = false;
-    if (processorTaskRunning.compare_exchange_strong(exp, true)) {
-        ExTask task = std::make_shared<DcpConsumerTask>(
-                &engine, shared_from_this(), 1);
-        processorTaskId = ExecutorPool::get()->schedule(task);
+    /* We need 'Processor' tasks only when we have a stream. Hence create
+     them only once when the first stream is added */
+    size_t exp = 0;
+    if (processorTasksRunning.compare_exchange_strong(exp,
+                                                      processors.size())) {
+        for (size_t ii = 0; ii < processors.size(); ++ii) {
+            ExTask task = std::make_shared<DcpConsumerTask>(
+                    &engine, shared_from_this(), ii, 1);
+            processors[ii]->taskId = ExecutorPool::get()->schedule(task);
+        }
     }
 
     stream = makePassiveStream(engine_,
@@ -1111,11 +1123,19 @@ void DcpConsumer::addStats(const AddStatFn& add_stat, const void* c) {
     addStat("processor_task_state", getProcessorTaskStatusStr(), add_stat, c);
     flowControl.addStats(add_stat, c);
 
-    vbReady.addStats(getName() + ":dcp_buffered_ready_queue_", add_stat, c);
-    addStat("processor_notification",
-            processorNotification.load(),
-            add_stat,
-            c);
+    for (size_t ii = 0; ii < processors.size(); ++ii) {
+        // Processor 0 keeps the stat names used before there could be
+        // more than one processor.
+        const auto suffix = ii == 0 ? std::string{} : "_" + std::to_string(ii);
+        processors[ii]->vbReady.addStats(
+                getName() + ":dcp_buffered_ready_queue" + suffix + "_",
+                add_stat,
+                c);
+        addStat(("processor_notification" + suffix).c_str(),
+                processors[ii]->notification.load(),
+                add_stat,
+                c);
+    }
 
     addStat("synchronous_replication", isSyncReplicationEnabled(), add_stat, c);
 }
@@ -1133,12 +1153,14 @@ process_items_error_t DcpConsumer::drainStreamsBufferedItems(
         switch (engine_.getReplicationThrottle().getStatus()) {
         case ReplicationThrottle::Status::Pause:
             backoffs++;
-            vbReady.pushUnique(stream->getVBucket());
+            getProcessor(stream->getVBucket())
+                    .vbReady.pushUnique(stream->getVBucket());
             return cannot_process;
 
         case ReplicationThrottle::Status::Disconnect:
             backoffs++;
-            vbReady.pushUnique(stream->getVBucket());
+            getProcessor(stream->getVBucket())
+                    .vbReady.pushUnique(stream->getVBucket());
             logger->warn(
                     "{} Processor task indicating disconnection "
                     "as there is no memory to complete replication",
@@ -1166,7 +1188,8 @@ process_items_error_t DcpConsumer::drainStreamsBufferedItems(
 
     // The stream may not be done yet so must go back in the ready queue
     if (bytesProcessed > 0) {
-        vbReady.pushUnique(stream->getVBucket());
+        getProcessor(stream->getVBucket())
+                .vbReady.pushUnique(stream->getVBucket());
         if (rval == stop_processing) {
             return stop_processing;
         }
@@ -1176,7 +1199,8 @@ process_items_error_t DcpConsumer::drainStreamsBufferedItems(
     return rval;
 }
 
-process_items_error_t DcpConsumer::processBufferedItems() {
+process_items_error_t DcpConsumer::processBufferedItems(size_t processor) {
+    auto& vbReady = processors.at(processor)->vbReady;
     process_items_error_t process_ret = all_processed;
     Vbid vbucket = Vbid(0);
     while (vbReady.popFront(vbucket)) {
@@ -1212,23 +1236,36 @@ process_items_error_t DcpConsumer::processBufferedItems() {
 }
 
 void DcpConsumer::notifyVbucketReady(Vbid vbucket) {
-    if (vbReady.pushUnique(vbucket) &&
-        notifiedProcessor(true)) {
-        ExecutorPool::get()->wake(processorTaskId);
+    auto& processor = getProcessor(vbucket);
+    if (processor.vbReady.pushUnique(vbucket) &&
+        !processor.notification.exchange(true)) {
+        ExecutorPool::get()->wake(processor.taskId);
     }
 }
 
-bool DcpConsumer::notifiedProcessor(bool to) {
+bool DcpConsumer::notifiedProcessor(size_t processor, bool to) {
     bool inverse = !to;
-    return processorNotification.compare_exchange_strong(inverse, to);
+    return processors.at(processor)->notification.compare_exchange_strong(
+            inverse, to);
 }
 
-void DcpConsumer::setProcessorTaskState(enum process_items_error_t to) {
-    processorTaskState = to;
+void DcpConsumer::setProcessorTaskState(size_t processor,
+                                        enum process_items_error_t to) {
+    processors.at(processor)->taskState = to;
 }
 
 std::string DcpConsumer::getProcessorTaskStatusStr() {
-    switch (processorTaskState.load()) {
+    // Report the state of the first processor which has not processed
+    // everything; or ALL_PROCESSED if they all have.
+    auto state = all_processed;
+    for (const auto& processor : processors) {
+        state = processor->taskState.load();
+        if (state != all_processed) {
+            break;
+        }
+    }
+
+    switch (state) {
         case all_processed:
             return "ALL_PROCESSED";
         case more_to_process:
@@ -245,7 +245,11 @@ public:
 
     void closeStreamDueToVbStateChange(Vbid vbucket, vbucket_state_t state);
 
-    process_items_error_t processBufferedItems();
+    /**
+     * Process the buffered messages of the ready vBuckets assigned to the
+     * given processor.
+     */
+    process_items_error_t processBufferedItems(size_t processor = 0);
 
     uint64_t incrOpaqueCounter();
 
@@ -261,9 +265,10 @@ public:
 
     void taskCancelled();
 
-    bool notifiedProcessor(bool to);
+    bool notifiedProcessor(size_t processor, bool to);
 
-    void setProcessorTaskState(enum process_items_error_t to);
+    void setProcessorTaskState(size_t processor,
+                               enum process_items_error_t to);
 
     std::string getProcessorTaskStatusStr();
 
@@ -498,14 +503,32 @@ protected:
         uint32_t bytes;
     };
 
+    /**
+     * State of one of the 'Processor' tasks which apply buffered messages.
+     * Each vBucket is assigned to a single processor (by vbid modulo the
+     * number of processors) so the messages of a vBucket are always applied
+     * in order by one task, while different vBuckets are applied in parallel.
+     */
+    struct Processor {
+        explicit Processor(size_t maxVBuckets) : vbReady(maxVBuckets) {
+        }
+
+        size_t taskId{0};
+        std::atomic<enum process_items_error_t> taskState{all_processed};
+        DcpReadyQueue vbReady;
+        std::atomic<bool> notification{false};
+    };
+
+    Processor& getProcessor(Vbid vbucket) {
+        return *processors[vbucket.get() % processors.size()];
+    }
+
     /* Reference to the ep engine; need to create the 'Processor' task */
     EventuallyPersistentEngine& engine;
     uint64_t opaqueCounter;
-    size_t processorTaskId;
-    std::atomic<enum process_items_error_t> processorTaskState;
 
-    DcpReadyQueue vbReady;
-    std::atomic<bool> processorNotification;
+    /* Fixed at construction from dcp_consumer_processor_tasks */
+    std::vector<std::unique_ptr<Processor>> processors;
 
     std::mutex readyMutex;
     std::list<Vbid> ready;
@@ -573,8 +596,12 @@ protected:
     } getErrorMapState;
     bool producerIsVersion5orHigher;
 
-    /* Indicates if the 'Processor' task is running */
-    std::atomic<bool> processorTaskRunning;
+    /*
+     * The number of 'Processor' tasks which exist; each task decrements it
+     * when it is destroyed, so a new set of tasks is only created once all
+     * of the previous set are gone
+     */
+    std::atomic<size_t> processorTasksRunning;
 
     FlowControl flowControl;
 
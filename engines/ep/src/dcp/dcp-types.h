@@ -136,6 +136,15 @@ enum class ForceValueCompression : bool {
     No,
 };
 
+/**
+ * AdaptiveValueCompression is used to state whether an active stream
+ * should compress the items where it reduces their size sufficiently.
+ */
+enum class AdaptiveValueCompression : bool {
+    Yes,
+    No,
+};
+
 /*
  * EnableExpiryOutput is used to state whether an active stream should
  * support outputting expiry messages.
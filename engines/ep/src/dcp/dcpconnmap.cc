@@ -20,6 +20,7 @@
 #include "bucket_logger.h"
 #include "configuration.h"
 #include "conn_notifier.h"
+#include "dcp/backfill_disk.h"
 #include "dcp/consumer.h"
 #include "dcp/producer.h"
 #include "ep_engine.h"
@@ -46,6 +47,7 @@ private:
 
 DcpConnMap::DcpConnMap(EventuallyPersistentEngine &e)
     : ConnMap(e),
+      diskBackfillScans(std::make_unique<DiskBackfillScanRegistry>()),
       aggrDcpConsumerBufferSize(0) {
     backfills.numActiveSnoozing = 0;
     updateMaxActiveSnoozingBackfills(engine.getEpStats().getMaxDataSize());
@@ -508,6 +510,14 @@ void DcpConnMap::addStats(const AddStatFn& add_stat, const void* c) {
     LockHolder lh(connsLock);
     add_casted_stat("ep_dcp_dead_conn_count", deadConnections.size(), add_stat,
                     c);
+    add_casted_stat("ep_dcp_backfill_disk_scans_opened",
+                    diskBackfillScans->getNumScansOpened(),
+                    add_stat,
+                    c);
+    add_casted_stat("ep_dcp_backfill_disk_scans_shared",
+                    diskBackfillScans->getNumScansShared(),
+                    add_stat,
+                    c);
 }
 
 void DcpConnMap::updateMinCompressionRatioForProducers(float value) {
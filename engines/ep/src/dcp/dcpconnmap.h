@@ -31,6 +31,7 @@
 class CheckpointCursor;
 class DcpProducer;
 class DcpConsumer;
+class DiskBackfillScanRegistry;
 
 class DcpConnMap : public ConnMap {
 
@@ -134,6 +135,14 @@ public:
         return backfills.maxActiveSnoozing;
     }
 
+    /**
+     * The open disk backfill scans of this bucket, used to coalesce the
+     * backfills of streams on different connections.
+     */
+    DiskBackfillScanRegistry& getDiskBackfillScanRegistry() {
+        return *diskBackfillScans;
+    }
+
     ENGINE_ERROR_CODE addPassiveStream(ConnHandler& conn,
                                        uint32_t opaque,
                                        Vbid vbucket,
@@ -227,6 +236,8 @@ protected:
 
     std::atomic<float> minCompressionRatioForProducer;
 
+    std::unique_ptr<DiskBackfillScanRegistry> diskBackfillScans;
+
     /* Total memory used by all DCP consumer buffers */
     std::atomic<size_t> aggrDcpConsumerBufferSize;
 
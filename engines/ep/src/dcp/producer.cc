@@ -169,6 +169,7 @@ DcpProducer::DcpProducer(EventuallyPersistentEngine& e,
       lastSendTime(ep_current_time()),
       log(*this),
       backfillMgr(std::make_shared<BackfillManager>(engine_)),
+      ready(e.getConfiguration().getMaxVbuckets()),
       itemsSent(0),
       totalBytesSent(0),
       totalUncompressedDataSize(0),
@@ -241,6 +242,7 @@ DcpProducer::DcpProducer(EventuallyPersistentEngine& e,
 
     enableExtMetaData = false;
     forceValueCompression = false;
+    adaptiveValueCompression = false;
     enableExpiryOpcode = false;
 
     // Cursor dropping is disabled for replication connections by default,
@@ -895,6 +897,22 @@ ENGINE_ERROR_CODE DcpProducer::control(uint32_t opaque,
             forceValueCompression = false;
         }
         return ENGINE_SUCCESS;
+    } else if (keyStr == "adaptive_value_compression") {
+        if (!engine_.isDatatypeSupported(getCookie(),
+                                         PROTOCOL_BINARY_DATATYPE_SNAPPY)) {
+            engine_.setErrorContext(getCookie(),
+                                    "The ctrl parameter "
+                                    "adaptive_value_compression is only "
+                                    "supported if datatype snappy is enabled "
+                                    "on the connection");
+            return ENGINE_EINVAL;
+        }
+        if (valueStr == "true") {
+            adaptiveValueCompression = true;
+        } else {
+            adaptiveValueCompression = false;
+        }
+        return ENGINE_SUCCESS;
         // vulcan onwards we accept two cursor_dropping control keys.
     } else if (keyStr == "supports_cursor_dropping_vulcan" ||
                keyStr == "supports_cursor_dropping") {
@@ -1179,6 +1197,14 @@ void DcpProducer::recordBackfillManagerBytesSent(size_t bytes) {
     backfillMgr->bytesSent(bytes);
 }
 
+void DcpProducer::resetBackfillManagerScanBuffer() {
+    backfillMgr->resetScanBuffer();
+}
+
+bool DcpProducer::isBackfillManagerBufferFull() {
+    return backfillMgr->isBufferFull();
+}
+
 void DcpProducer::scheduleBackfillManager(VBucket& vb,
                                           std::shared_ptr<ActiveStream> s,
                                           uint64_t start,
@@ -1202,6 +1228,10 @@ void DcpProducer::addStats(const AddStatFn& add_stat, const void* c) {
     addStat("noop_wait", noopCtx.pendingRecv, add_stat, c);
     addStat("enable_ext_metadata", enableExtMetaData, add_stat, c);
     addStat("force_value_compression", forceValueCompression, add_stat, c);
+    addStat("adaptive_value_compression",
+            adaptiveValueCompression,
+            add_stat,
+            c);
     addStat("cursor_dropping", supportsCursorDropping, add_stat, c);
     addStat("send_stream_end_on_client_close_stream",
             sendStreamEndOnClientStreamClose,
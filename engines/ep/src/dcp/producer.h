@@ -161,6 +161,8 @@ public:
     void notifyBackfillManager();
     bool recordBackfillManagerBytesRead(size_t bytes, bool force);
     void recordBackfillManagerBytesSent(size_t bytes);
+    void resetBackfillManagerScanBuffer();
+    bool isBackfillManagerBufferFull();
     void scheduleBackfillManager(VBucket& vb,
                                  std::shared_ptr<ActiveStream> s,
                                  uint64_t start,
@@ -183,6 +185,10 @@ public:
         return forceValueCompression.load();
     }
 
+    bool isAdaptiveValueCompressionEnabled() {
+        return adaptiveValueCompression.load();
+    }
+
     bool isSnappyEnabled() {
         return engine_.isDatatypeSupported(getCookie(),
                                            PROTOCOL_BINARY_DATATYPE_SNAPPY);
@@ -477,6 +483,7 @@ protected:
 
     cb::RelaxedAtomic<bool> enableExtMetaData;
     cb::RelaxedAtomic<bool> forceValueCompression;
+    cb::RelaxedAtomic<bool> adaptiveValueCompression;
     cb::RelaxedAtomic<bool> supportsCursorDropping;
     cb::RelaxedAtomic<bool> sendStreamEndOnClientStreamClose;
     cb::RelaxedAtomic<bool> consumerSupportsHifiMfu;
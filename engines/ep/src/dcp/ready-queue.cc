@@ -17,94 +17,155 @@
 
 #include "ready-queue.h"
 
-#include "locks.h"
 #include "statwriter.h"
 
-bool DcpReadyQueue::exists(Vbid vbucket) {
-    LockHolder lh(lock);
-    return (queuedValues.count(vbucket) != 0);
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// @return the index of the lowest bit set in (non-zero) word
+static inline size_t lowestBitSet(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+DcpReadyQueue::DcpReadyQueue(size_t maxVBuckets)
+    : bitmap((maxVBuckets + bitsPerWord - 1) / bitsPerWord) {
+    for (auto& word : bitmap) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool DcpReadyQueue::exists(Vbid vbucket) const {
+    const auto id = vbucket.get();
+    return (bitmap.at(id / bitsPerWord).load() &
+            (uint64_t(1) << (id % bitsPerWord))) != 0;
 }
 
 bool DcpReadyQueue::popFront(Vbid& frontValue) {
-    LockHolder lh(lock);
-    if (!readyQueue.empty()) {
-        frontValue = readyQueue.front();
-        readyQueue.pop();
-        queuedValues.erase(frontValue);
-        return true;
+    if (count.load() == 0 || bitmap.empty()) {
+        return false;
+    }
+
+    const size_t words = bitmap.size();
+    size_t start = next.load(std::memory_order_relaxed);
+    if (start >= words * bitsPerWord) {
+        start = 0;
+    }
+    const size_t startWord = start / bitsPerWord;
+    const uint64_t fromStart = ~uint64_t(0) << (start % bitsPerWord);
+
+    // Visit the words from the start position and wrap around, finishing
+    // with the bits of the first word which are before the start position
+    for (size_t ii = 0; ii <= words; ++ii) {
+        const size_t idx = (startWord + ii) % words;
+        uint64_t mask = ~uint64_t(0);
+        if (ii == 0) {
+            mask = fromStart;
+        } else if (ii == words) {
+            mask = ~fromStart;
+        }
+
+        auto& word = bitmap[idx];
+        uint64_t bits = word.load() & mask;
+        while (bits != 0) {
+            const size_t bit = lowestBitSet(bits);
+            const uint64_t bitMask = uint64_t(1) << bit;
+            // Someone else may have popped it after we loaded the word
+            if (word.fetch_and(~bitMask) & bitMask) {
+                count.fetch_sub(1);
+                const size_t id = idx * bitsPerWord + bit;
+                next.store(id + 1, std::memory_order_relaxed);
+                frontValue = Vbid(static_cast<Vbid::id_type>(id));
+                return true;
+            }
+            bits &= ~bitMask;
+        }
     }
     return false;
 }
 
 void DcpReadyQueue::pop() {
-    LockHolder lh(lock);
-    if (!readyQueue.empty()) {
-        queuedValues.erase(readyQueue.front());
-        readyQueue.pop();
-    }
+    Vbid vbucket(0);
+    popFront(vbucket);
 }
 
 bool DcpReadyQueue::pushUnique(Vbid vbucket) {
-    bool wasEmpty;
-    {
-        LockHolder lh(lock);
-        wasEmpty = queuedValues.empty();
-        const bool inserted = queuedValues.emplace(vbucket).second;
-        if (inserted) {
-            readyQueue.push(vbucket);
-        }
+    const auto id = vbucket.get();
+    auto& word = bitmap.at(id / bitsPerWord);
+    const uint64_t bitMask = uint64_t(1) << (id % bitsPerWord);
+    if (word.load() & bitMask) {
+        // Already queued
+        return false;
+    }
+
+    const bool wasEmpty = count.fetch_add(1) == 0;
+    if (word.fetch_or(bitMask) & bitMask) {
+        // Lost the race with someone else pushing the same vbucket. Still
+        // report the transition from empty if we saw it, as the winner
+        // may not have.
+        count.fetch_sub(1);
     }
     return wasEmpty;
 }
 
-size_t DcpReadyQueue::size() {
-    LockHolder lh(lock);
-    return readyQueue.size();
+size_t DcpReadyQueue::size() const {
+    return count.load();
 }
 
-bool DcpReadyQueue::empty() {
-    LockHolder lh(lock);
-    return readyQueue.empty();
+bool DcpReadyQueue::empty() const {
+    return count.load() == 0;
 }
 
 void DcpReadyQueue::addStats(const std::string& prefix,
                              const AddStatFn& add_stat,
-                             const void* c) {
-    // Take a copy of the queue data under lock; then format it to stats.
-    std::queue<Vbid> qCopy;
-    std::unordered_set<Vbid> qMapCopy;
-    {
-        LockHolder lh(lock);
-        qCopy = readyQueue;
-        qMapCopy = queuedValues;
+                             const void* c) const {
+    // Form a comma-separated string of the queue's contents (in the order
+    // popFront would return them). The bitmap may change while we're
+    // reading it, so use the number of entries found for the size.
+    std::vector<Vbid::id_type> queued;
+    for (size_t idx = 0; idx < bitmap.size(); ++idx) {
+        uint64_t bits = bitmap[idx].load(std::memory_order_relaxed);
+        while (bits != 0) {
+            const size_t bit = lowestBitSet(bits);
+            queued.push_back(
+                    static_cast<Vbid::id_type>(idx * bitsPerWord + bit));
+            bits &= bits - 1;
+        }
     }
 
-    add_casted_stat((prefix + "size").c_str(), qCopy.size(), add_stat, c);
-    add_casted_stat(
-            (prefix + "map_size").c_str(), qMapCopy.size(), add_stat, c);
-
-    // Form a comma-separated string of the queue's contents.
+    const auto start = next.load(std::memory_order_relaxed);
     std::string contents;
-    while (!qCopy.empty()) {
-        contents += std::to_string(qCopy.front().get()) + ",";
-        qCopy.pop();
+    std::string mapContents;
+    const auto split = std::lower_bound(queued.begin(), queued.end(), start);
+    for (auto it = split; it != queued.end(); ++it) {
+        contents += std::to_string(*it) + ",";
+    }
+    for (auto it = queued.begin(); it != split; ++it) {
+        contents += std::to_string(*it) + ",";
+    }
+    for (const auto vbid : queued) {
+        mapContents += std::to_string(vbid) + ",";
     }
     if (!contents.empty()) {
         contents.pop_back();
+        mapContents.pop_back();
     }
+
+    add_casted_stat((prefix + "size").c_str(), queued.size(), add_stat, c);
+    add_casted_stat(
+            (prefix + "map_size").c_str(), queued.size(), add_stat, c);
     add_casted_stat(
             (prefix + "contents").c_str(), contents.c_str(), add_stat, c);
-
-    // Form a comma-separated string of the queue map's contents.
-    std::string qMapContents;
-    for (auto& vbid : qMapCopy) {
-        qMapContents += std::to_string(vbid.get()) + ",";
-    }
-    if (!qMapContents.empty()) {
-        qMapContents.pop_back();
-    }
     add_casted_stat((prefix + "map_contents").c_str(),
-                    qMapContents.c_str(),
+                    mapContents.c_str(),
                     add_stat,
                     c);
 }
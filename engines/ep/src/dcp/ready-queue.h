@@ -20,29 +20,38 @@
 #include <memcached/engine_common.h>
 #include <memcached/vbucket.h>
 
-#include <mutex>
-#include <queue>
-#include <unordered_set>
+#include <atomic>
+#include <vector>
 
 /**
- * DcpReadyQueue is a std::queue wrapper for managing a
- * queue of vbuckets that are ready for a DCP producer/consumer to process.
- * The queue does not allow duplicates and the push_unique method enforces
- * this. The interface is generally customised for the needs of:
+ * DcpReadyQueue is a set of vbuckets that are ready for a DCP
+ * producer/consumer to process. A vbucket can only be in the set once, which
+ * the pushUnique method enforces. The interface is generally customised for
+ * the needs of:
  * - getNextItem and is thread safe as the frontend operations and
  *   DCPProducer threads are accessing this data.
  * - processBufferedItems by the processer task of the consumer
  *
- * Internally a std::queue and std::set track the contents and the std::set
- * enables a fast exists method which is used by front-end threads.
+ * Internally the set is a bitmap of atomic words (one bit per vbucket), so
+ * pushUnique (called by front-end threads for every mutation) and exists
+ * don't take a lock or allocate memory. popFront scans the bitmap
+ * round-robin from the vbucket after the previous one popped, so every
+ * ready vbucket gets its turn.
  */
 class DcpReadyQueue {
 public:
-    bool exists(Vbid vbucket);
+    /**
+     * @param maxVBuckets the number of vbuckets the queue can hold (vbucket
+     *        ids must be below this)
+     */
+    explicit DcpReadyQueue(size_t maxVBuckets);
+
+    bool exists(Vbid vbucket) const;
 
     /**
      * Return true and set the ref-param 'frontValue' if the queue is not
-     * empty. frontValue is set to the front of the queue.
+     * empty. frontValue is set to the next ready vbucket (in round-robin
+     * order) which is removed from the queue.
      */
     bool popFront(Vbid& frontValue);
 
@@ -55,31 +64,37 @@ public:
     /**
      * Push the vbucket only if it's not already in the queue.
      * @return true if the queue was previously empty (i.e. we have
-     * transitioned from zero -> one elements in the queue).
+     * transitioned from zero -> one elements in the queue). May
+     * (rarely) return true when racing with another push of the same
+     * vbucket, but never misses a transition.
      */
     bool pushUnique(Vbid vbucket);
 
     /**
      * Size of the queue.
      */
-    size_t size();
+    size_t size() const;
 
-    bool empty();
+    bool empty() const;
 
     void addStats(const std::string& prefix,
                   const AddStatFn& add_stat,
-                  const void* c);
+                  const void* c) const;
 
 private:
-    std::mutex lock;
+    static constexpr size_t bitsPerWord = 64;
 
-    /* a queue of vbuckets that are ready for producing */
-    std::queue<Vbid> readyQueue;
+    /// The bitmap of ready vbuckets
+    std::vector<std::atomic<uint64_t>> bitmap;
 
     /**
-     * maintain a std::unordered_set of values that are in the readyQueue.
-     * find() is performed by front-end threads so we want it to be
-     * efficient so just a set lookup is required.
+     * The number of vbuckets in the queue. It is incremented before a bit
+     * is set and decremented after a bit is cleared, so it is never less
+     * than the number of bits set (which keeps empty() safe to use for the
+     * "recheck before sleeping" in DcpProducer::getNextItem).
      */
-    std::unordered_set<Vbid> queuedValues;
+    std::atomic<size_t> count{0};
+
+    /// The vbucket popFront starts scanning from
+    std::atomic<size_t> next{0};
 };
@@ -24,7 +24,9 @@
 #include "stored-value.h"
 #include "vbucket.h"
 
+#include <boost/optional/optional.hpp>
 #include <gsl.h>
+#include <algorithm>
 #include <unordered_map>
 
 // An empty string is used to indicate an undefined node in a replication
@@ -36,24 +38,25 @@ static const std::string UndefinedNode{};
  * Note that the lifetime of a Position is determined by the logic in
  * DurabilityMonitor.
  *
- * - it: Iterator that points to a position in the Container of tracked
- *         SyncWrites. This is an optimization: logically it points always to
- *         the last SyncWrite acknowledged by the tracked replica, so that we
- *         can avoid any O(N) scan when updating the replica state at seqno-ack
- *         received. It may point to Container::end (e.g, when the pointed
- *         SyncWrite is the last element in Container and it is removed).
+ * - next: Index in TrackedWrites of the first SyncWrite not yet acknowledged
+ *         by the tracked replica (i.e., one past the last acknowledged). This
+ *         is an optimization: we can avoid any O(N) scan when updating the
+ *         replica state at seqno-ack received. Indexes are never invalidated
+ *         by the removal of a SyncWrite, so 'next' may refer to a removed
+ *         SyncWrite or precede TrackedWrites::begin; TrackedWrites::next()
+ *         resolves it to the next SyncWrite still tracked.
  *
  * - lastWriteSeqno: Stores always the seqno of the last SyncWrite
- *         acknowledged by the tracked replica, even when Position::it points to
- *         Container::end. Used for validation at seqno-ack received and stats.
+ *         acknowledged by the tracked replica, even when that SyncWrite has
+ *         been removed. Used for validation at seqno-ack received and stats.
  *
  * - lastAckSeqno: Stores always the last seqno acknowledged by the tracked
  *         replica. Used for validation at seqno-ack received and stats.
  */
 struct DurabilityMonitor::Position {
-    Position(const Container::iterator& it) : it(it) {
+    Position(uint64_t next) : next(next) {
     }
-    Container::iterator it;
+    uint64_t next;
     WeaklyMonotonic<int64_t, ThrowExceptionPolicy> lastWriteSeqno{0};
     WeaklyMonotonic<int64_t, ThrowExceptionPolicy> lastAckSeqno{0};
 };
@@ -80,8 +83,7 @@ struct DurabilityMonitor::ReplicationChain {
      *    (to assign the correct replicas. An undefined replica is represented
      *    by an empty node name (""s).
      */
-    ReplicationChain(const std::vector<std::string>& nodes,
-                     const Container::iterator& it)
+    ReplicationChain(const std::vector<std::string>& nodes, uint64_t next)
         : majority(nodes.size() / 2 + 1), active(nodes.at(0)) {
         if (nodes.at(0) == UndefinedNode) {
             throw std::invalid_argument(
@@ -97,7 +99,8 @@ struct DurabilityMonitor::ReplicationChain {
             // This check ensures that there is no duplicate in the given chain
             if (!positions
                          .emplace(node,
-                                  NodePosition{Position(it), Position(it)})
+                                  NodePosition{Position(next),
+                                               Position(next)})
                          .second) {
                 throw std::logic_error(
                         "ReplicationChain::ReplicationChain: Duplicate node: " +
@@ -131,6 +134,7 @@ public:
         : cookie(cookie),
           item(item),
           majority(chain.getSize() / 2 + 1),
+          startTime(std::chrono::steady_clock::now()),
           expiryTime(
                   item->getDurabilityReqs().getTimeout()
                           ? std::chrono::steady_clock::now() +
@@ -161,6 +165,10 @@ public:
         return cookie;
     }
 
+    std::chrono::steady_clock::time_point getStartTime() const {
+        return startTime;
+    }
+
     /**
      * Notify this SyncWrite that it has been ack'ed by node.
      *
@@ -252,6 +260,10 @@ private:
     // Majority in the arithmetic definition: num-nodes / 2 + 1
     const uint8_t majority;
 
+    // When this SyncWrite was added for tracking into the DurabilityMonitor;
+    // the start of the client's durability wait.
+    const std::chrono::steady_clock::time_point startTime;
+
     // Used for enforcing the Durability Requirements Timeout. It is set when
     // this SyncWrite is added for tracking into the DurabilityMonitor.
     const boost::optional<std::chrono::steady_clock::time_point> expiryTime;
@@ -291,7 +303,168 @@ std::ostream& operator<<(std::ostream& os,
     return os;
 }
 
+/*
+ * The SyncWrites tracked by a DurabilityMonitor, in seqno order.
+ *
+ * SyncWrites are stored by value in a ring buffer (power-of-two sized, grown
+ * by doubling) and are addressed by a logical index which increases
+ * monotonically over the lifetime of the object: the N-th SyncWrite ever
+ * added has index N. As SyncWrites are added in seqno order, index order is
+ * also seqno order.
+ *
+ * SyncWrites may complete out of order (e.g., a Majority SyncWrite can be
+ * committed before a preceding PersistToMajority one), so removing a
+ * SyncWrite just empties its slot. The begin of the buffer advances past
+ * empty slots, so the first slot in [begin, end) is never empty.
+ *
+ * That gives:
+ * - O(1) add, remove and lookup by index
+ * - Indexes (and so node Positions) are never invalidated by add/remove
+ * - Contiguous storage, no per-SyncWrite allocation for the container
+ */
+class DurabilityMonitor::TrackedWrites {
+public:
+    /// @return the index of the first tracked SyncWrite, or end() if none
+    uint64_t begin() const {
+        return head;
+    }
+
+    /// @return the index one past the last SyncWrite added
+    uint64_t end() const {
+        return tail;
+    }
+
+    /// @return the number of tracked SyncWrites
+    size_t size() const {
+        return numTracked;
+    }
+
+    /// @return the number of slots allocated
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    /**
+     * Add a SyncWrite at the end of the buffer.
+     * Caller ensures that the SyncWrite's seqno is greater than the seqno of
+     * any SyncWrite already added.
+     */
+    void push_back(SyncWrite&& sw) {
+        if (tail - head == slots.size()) {
+            grow();
+        }
+        slots[tail & mask()].emplace(std::move(sw));
+        ++tail;
+        ++numTracked;
+    }
+
+    /**
+     * @param index
+     * @return the index of the first tracked SyncWrite at or after the given
+     *     index, end() if none
+     */
+    uint64_t next(uint64_t index) const {
+        index = std::max(index, head);
+        while (index < tail && !slots[index & mask()]) {
+            ++index;
+        }
+        return index;
+    }
+
+    /**
+     * @param index The index of a tracked SyncWrite
+     * @throw gsl::fail_fast if there is no SyncWrite tracked at index
+     */
+    SyncWrite& at(uint64_t index) {
+        return *getSlot(index);
+    }
+
+    const SyncWrite& at(uint64_t index) const {
+        return *const_cast<TrackedWrites&>(*this).getSlot(index);
+    }
+
+    /**
+     * Remove the SyncWrite at the given index.
+     *
+     * @param index The index of a tracked SyncWrite
+     * @return the removed SyncWrite
+     * @throw gsl::fail_fast if there is no SyncWrite tracked at index
+     */
+    SyncWrite remove(uint64_t index) {
+        auto& slot = getSlot(index);
+        SyncWrite removed(std::move(*slot));
+        slot.reset();
+        --numTracked;
+
+        while (head < tail && !slots[head & mask()]) {
+            ++head;
+        }
+
+        // Release the memory of a past burst of SyncWrites once the tracked
+        // range has drained below a quarter of the capacity.
+        auto newCapacity = slots.size();
+        while (newCapacity > initialCapacity &&
+               tail - head <= newCapacity / 4) {
+            newCapacity /= 2;
+        }
+        if (newCapacity != slots.size()) {
+            resize(newCapacity);
+        }
+        return removed;
+    }
+
+    /// Invoke the given function for every tracked SyncWrite, in seqno order
+    template <class Func>
+    void forEach(Func func) const {
+        for (auto index = next(head); index < tail; index = next(index + 1)) {
+            func(index, at(index));
+        }
+    }
+
+private:
+    boost::optional<SyncWrite>& getSlot(uint64_t index) {
+        Expects(index >= head && index < tail);
+        auto& slot = slots[index & mask()];
+        Expects(slot);
+        return slot;
+    }
+
+    size_t mask() const {
+        return slots.size() - 1;
+    }
+
+    void grow() {
+        resize(std::max(size_t(initialCapacity), slots.size() * 2));
+    }
+
+    /**
+     * Move the tracked SyncWrites to a buffer of the given capacity.
+     *
+     * @param capacity a power of two, at least the tracked range
+     */
+    void resize(size_t capacity) {
+        Expects(tail - head <= capacity);
+        std::vector<boost::optional<SyncWrite>> newSlots(capacity);
+        const auto newMask = newSlots.size() - 1;
+        for (auto index = head; index < tail; ++index) {
+            auto& slot = slots[index & mask()];
+            if (slot) {
+                newSlots[index & newMask].emplace(std::move(*slot));
+            }
+        }
+        slots.swap(newSlots);
+    }
+
+    static const size_t initialCapacity = 16;
+
+    std::vector<boost::optional<SyncWrite>> slots;
+    uint64_t head{0};
+    uint64_t tail{0};
+    size_t numTracked{0};
+};
+
 DurabilityMonitor::DurabilityMonitor(VBucket& vb) : vb(vb) {
+    state.trackedWrites = std::make_unique<TrackedWrites>();
 }
 
 DurabilityMonitor::~DurabilityMonitor() = default;
@@ -354,8 +527,11 @@ void DurabilityMonitor::setReplicationTopology(const nlohmann::json& topology) {
     //     supported. With the current model the new replication-chain will
     //     kick-in at the first new SyncWrite added to tracking.
     // @todo: Check if the above is legal
+    // Note: Positions start pointing to the first tracked SyncWrite (if any),
+    //     so the next SyncWrite processed for each node is the one after it.
+    const auto& tracked = *state.trackedWrites;
     state.firstChain = std::make_unique<ReplicationChain>(
-            firstChain, state.trackedWrites.begin());
+            firstChain, std::min(tracked.begin() + 1, tracked.end()));
 }
 
 const nlohmann::json& DurabilityMonitor::getReplicationTopology() const {
@@ -378,13 +554,16 @@ void DurabilityMonitor::addSyncWrite(const void* cookie, queued_item item) {
                 "DurabilityMonitor::addSyncWrite: FirstChain not registered");
     }
 
-    state.trackedWrites.push_back(SyncWrite(cookie, item, *state.firstChain));
+    state.trackedWrites->push_back(SyncWrite(cookie, item, *state.firstChain));
 
     // By logic, before this call the item has been enqueued into the
     // CheckpointManager. So, the memory-tracking for the active has implicitly
     // advanced.
     const auto& thisNode = state.firstChain->active;
-    advanceNodePosition(lg, thisNode, Tracking::Memory);
+    advanceNodePosition(lg,
+                        thisNode,
+                        Tracking::Memory,
+                        getNodePosition(lg, thisNode, Tracking::Memory));
     updateNodeAck(lg, thisNode, Tracking::Memory, item->getBySeqno());
 
     Ensures(getNodeWriteSeqnos(lg, thisNode).memory == item->getBySeqno());
@@ -462,18 +641,11 @@ void DurabilityMonitor::processTimeout(
 
     {
         std::lock_guard<std::mutex> lg(state.m);
-        Container::iterator it = state.trackedWrites.begin();
-        while (it != state.trackedWrites.end()) {
-            if (it->isExpired(asOf)) {
-                // Note: 'it' will be invalidated, so it will need to be reset
-                const auto next = std::next(it);
-
-                auto removed = removeSyncWrite(lg, it);
-                toAbort.splice(toAbort.end(), removed);
-
-                it = next;
-            } else {
-                ++it;
+        auto& tracked = *state.trackedWrites;
+        for (auto index = tracked.next(tracked.begin()); index < tracked.end();
+             index = tracked.next(index + 1)) {
+            if (tracked.at(index).isExpired(asOf)) {
+                toAbort.push_back(removeSyncWrite(lg, index));
             }
         }
     }
@@ -586,7 +758,12 @@ std::string DurabilityMonitor::to_string(Tracking tracking) {
 
 size_t DurabilityMonitor::getNumTracked(
         const std::lock_guard<std::mutex>& lg) const {
-    return state.trackedWrites.size();
+    return state.trackedWrites->size();
+}
+
+size_t DurabilityMonitor::getTrackedCapacity(
+        const std::lock_guard<std::mutex>& lg) const {
+    return state.trackedWrites->capacity();
 }
 
 size_t DurabilityMonitor::getReplicationChainSize(
@@ -594,52 +771,48 @@ size_t DurabilityMonitor::getReplicationChainSize(
     return state.firstChain ? state.firstChain->positions.size() : 0;
 }
 
-DurabilityMonitor::Container::iterator DurabilityMonitor::getNodeNext(
+DurabilityMonitor::Position& DurabilityMonitor::getNodePosition(
         const std::lock_guard<std::mutex>& lg,
         const std::string& node,
         Tracking tracking) {
-    const auto& pos = state.firstChain->positions.at(node);
-    const auto& it =
-            (tracking == Tracking::Memory ? pos.memory.it : pos.disk.it);
-    // Note: Container::end could be the new position when the pointed SyncWrite
-    //     is removed from Container and the iterator repositioned.
-    //     In that case next=Container::begin
-    return (it == state.trackedWrites.end()) ? state.trackedWrites.begin()
-                                             : std::next(it);
+    auto& pos = state.firstChain->positions.at(node);
+    return tracking == Tracking::Memory ? pos.memory : pos.disk;
 }
 
-void DurabilityMonitor::advanceNodePosition(
+uint64_t DurabilityMonitor::getNodeNext(const std::lock_guard<std::mutex>& lg,
+                                        const Position& pos) const {
+    // Note: the SyncWrite at pos.next may have been removed, in which case
+    //     the next tracked SyncWrite (if any) is returned.
+    return state.trackedWrites->next(pos.next);
+}
+
+uint64_t DurabilityMonitor::advanceNodePosition(
         const std::lock_guard<std::mutex>& lg,
         const std::string& node,
-        Tracking tracking) {
-    const auto& pos_ = state.firstChain->positions.at(node);
-    auto& pos = const_cast<Position&>(tracking == Tracking::Memory ? pos_.memory
-                                                                   : pos_.disk);
+        Tracking tracking,
+        Position& pos) {
+    const auto index = getNodeNext(lg, pos);
+    Expects(index != state.trackedWrites->end());
+    auto& sw = state.trackedWrites->at(index);
 
-    if (pos.it == state.trackedWrites.end()) {
-        pos.it = state.trackedWrites.begin();
-    } else {
-        pos.it++;
-    }
-
-    Expects(pos.it != state.trackedWrites.end());
+    pos.next = index + 1;
 
     // Note that Position::lastWriteSeqno is always set to the current
-    // pointed SyncWrite to keep the replica seqno-state for when the pointed
-    // SyncWrite is removed
-    pos.lastWriteSeqno = pos.it->getBySeqno();
+    // SyncWrite to keep the replica seqno-state for when the SyncWrite is
+    // removed
+    pos.lastWriteSeqno = sw.getBySeqno();
 
     // Update the SyncWrite ack-counters, necessary for DurReqs verification
-    pos.it->ack(node, tracking);
+    sw.ack(node, tracking);
+
+    return index;
 }
 
 void DurabilityMonitor::updateNodeAck(const std::lock_guard<std::mutex>& lg,
                                       const std::string& node,
                                       Tracking tracking,
                                       int64_t seqno) {
-    const auto& pos_ = state.firstChain->positions.at(node);
-    auto& pos = const_cast<Position&>(tracking == Tracking::Memory ? pos_.memory
-                                                                   : pos_.disk);
+    auto& pos = getNodePosition(lg, node, tracking);
 
     // Note: using WeaklyMonotonic, as receiving the same seqno multiple times
     // for the same node is ok. That just means that the node has not advanced
@@ -669,43 +842,16 @@ DurabilityMonitor::NodeSeqnos DurabilityMonitor::getNodeAckSeqnos(
     return {pos.memory.lastAckSeqno, pos.disk.lastAckSeqno};
 }
 
-DurabilityMonitor::Container DurabilityMonitor::removeSyncWrite(
-        const std::lock_guard<std::mutex>& lg, Container::iterator it) {
-    if (it == state.trackedWrites.end()) {
+DurabilityMonitor::SyncWrite DurabilityMonitor::removeSyncWrite(
+        const std::lock_guard<std::mutex>& lg, uint64_t index) {
+    if (index >= state.trackedWrites->end()) {
         throw std::logic_error(
-                "DurabilityMonitor::commit: Position points to end");
-    }
-
-    Container::iterator prev;
-    // Note: iterators in state.trackedWrites are never singular, Container::end
-    //     is used as placeholder element for when an iterator cannot point to
-    //     any valid element in Container
-    if (it == state.trackedWrites.begin()) {
-        prev = state.trackedWrites.end();
-    } else {
-        prev = std::prev(it);
+                "DurabilityMonitor::removeSyncWrite: Position points to end");
     }
 
-    // Removing the element at 'it' from trackedWrites invalidates any
-    // iterator that points to that element. So, we have to reposition the
-    // invalidated iterators before proceeding with the removal.
-    //
-    // Note: O(N) with N=<number of iterators>, max(N)=12
-    //     (max 2 chains, 3 replicas, 2 iterators per replica)
-    for (const auto& entry : state.firstChain->positions) {
-        const auto& nodePos = entry.second;
-        if (nodePos.memory.it == it) {
-            const_cast<Position&>(nodePos.memory).it = prev;
-        }
-        if (nodePos.disk.it == it) {
-            const_cast<Position&>(nodePos.disk).it = prev;
-        }
-    }
-
-    Container removed;
-    removed.splice(removed.end(), state.trackedWrites, it);
-
-    return removed;
+    // Note: Positions refer to SyncWrites by index and indexes are never
+    //     invalidated, so no Position needs to be updated here.
+    return state.trackedWrites->remove(index);
 }
 
 void DurabilityMonitor::commit(const SyncWrite& sw) {
@@ -722,7 +868,7 @@ void DurabilityMonitor::commit(const SyncWrite& sw) {
     }
 
     // 3) send a response with Success back to the client
-    vb.notifyClientOfCommit(sw.getCookie());
+    vb.notifyClientOfCommit(sw.getCookie(), sw.getStartTime());
 }
 
 void DurabilityMonitor::abort(const SyncWrite& sw) {
@@ -742,22 +888,19 @@ void DurabilityMonitor::processSeqnoAck(const std::lock_guard<std::mutex>& lg,
                                         Tracking tracking,
                                         int64_t ackSeqno,
                                         Container& toCommit) {
+    auto& pos = getNodePosition(lg, node, tracking);
+    const auto& tracked = *state.trackedWrites;
+
     // Note: process up to the ack'ed seqno
-    DurabilityMonitor::Container::iterator next;
-    while ((next = getNodeNext(lg, node, tracking)) !=
-                   state.trackedWrites.end() &&
-           next->getBySeqno() <= ackSeqno) {
+    uint64_t next;
+    while ((next = getNodeNext(lg, pos)) != tracked.end() &&
+           tracked.at(next).getBySeqno() <= ackSeqno) {
         // Update replica tracking
-        advanceNodePosition(lg, node, tracking);
-
-        const auto& nodePos = state.firstChain->positions.at(node);
-        const auto& pos =
-                (tracking == Tracking::Memory ? nodePos.memory : nodePos.disk);
+        const auto index = advanceNodePosition(lg, node, tracking, pos);
 
         // Check if Durability Requirements satisfied now, and add for commit
-        if (pos.it->isSatisfied()) {
-            auto removed = removeSyncWrite(lg, pos.it);
-            toCommit.splice(toCommit.end(), removed);
+        if (tracked.at(index).isSatisfied()) {
+            toCommit.push_back(removeSyncWrite(lg, index));
         }
     }
 
@@ -768,9 +911,9 @@ void DurabilityMonitor::processSeqnoAck(const std::lock_guard<std::mutex>& lg,
 std::unordered_set<int64_t> DurabilityMonitor::getTrackedSeqnos() const {
     std::lock_guard<std::mutex> lg(state.m);
     std::unordered_set<int64_t> ret;
-    for (const auto& w : state.trackedWrites) {
+    state.trackedWrites->forEach([&ret](uint64_t, const SyncWrite& w) {
         ret.insert(w.getBySeqno());
-    }
+    });
     return ret;
 }
 
@@ -778,10 +921,11 @@ std::ostream& operator<<(std::ostream& os, const DurabilityMonitor& dm) {
     std::lock_guard<std::mutex> lg(dm.state.m);
     os << "DurabilityMonitor[" << &dm
        << "] with topology:" << dm.state.replicationTopology
-       << " #trackedWrites:" << dm.state.trackedWrites.size() << "\n";
-    for (const auto& w : dm.state.trackedWrites) {
-        os << "    " << w << "\n";
-    }
+       << " #trackedWrites:" << dm.state.trackedWrites->size() << "\n";
+    dm.state.trackedWrites->forEach(
+            [&os](uint64_t, const DurabilityMonitor::SyncWrite& w) {
+                os << "    " << w << "\n";
+            });
     os << "]";
     return os;
 }
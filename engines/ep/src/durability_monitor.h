@@ -24,9 +24,10 @@
 
 #include <nlohmann/json.hpp>
 
-#include <list>
+#include <memory>
 #include <mutex>
 #include <unordered_set>
+#include <vector>
 
 class StoredDocKey;
 class StoredValue;
@@ -125,11 +126,14 @@ public:
 
 protected:
     class SyncWrite;
+    class TrackedWrites;
     struct ReplicationChain;
     struct Position;
     struct NodePosition;
 
-    using Container = std::list<SyncWrite>;
+    // A batch of SyncWrites removed from tracking, to be committed or aborted
+    // once the object lock has been released
+    using Container = std::vector<SyncWrite>;
 
     enum class Tracking : uint8_t { Memory, Disk };
 
@@ -141,6 +145,13 @@ protected:
      */
     size_t getNumTracked(const std::lock_guard<std::mutex>& lg) const;
 
+    /**
+     * @param lg the object lock
+     * @return the number of SyncWrites the tracking buffer can hold before
+     *     it is grown
+     */
+    size_t getTrackedCapacity(const std::lock_guard<std::mutex>& lg) const;
+
     /**
      * @param lg the object lock
      * @return the size of the replication chain
@@ -148,31 +159,44 @@ protected:
     size_t getReplicationChainSize(const std::lock_guard<std::mutex>& lg) const;
 
     /**
-     * Returns the next position for a node iterator.
-     *
      * @param lg the object lock
      * @param node
      * @param tracking Memory or Disk?
-     * @return the iterator to the next position for the given node
+     * @return the memory or disk Position of the given node
+     */
+    Position& getNodePosition(const std::lock_guard<std::mutex>& lg,
+                              const std::string& node,
+                              Tracking tracking);
+
+    /**
+     * Returns the next position for a node.
+     *
+     * @param lg the object lock
+     * @param pos the node memory or disk Position
+     * @return the index in TrackedWrites of the next SyncWrite to be ack'ed
+     *     by the node, TrackedWrites::end() if none
      */
-    Container::iterator getNodeNext(const std::lock_guard<std::mutex>& lg,
-                                    const std::string& node,
-                                    Tracking tracking);
+    uint64_t getNodeNext(const std::lock_guard<std::mutex>& lg,
+                         const Position& pos) const;
 
     /**
-     * Advance a node tracking to the next Position in the tracked Container.
+     * Advance a node tracking to the next SyncWrite in TrackedWrites.
      * Note that a Position tracks a node in terms of both:
-     * - iterator to a SyncWrite in the tracked Container
+     * - index of the next SyncWrite in TrackedWrites
      * - seqno of the last SyncWrite ack'ed by the node
-     * This function advances both iterator and seqno.
+     * This function advances both index and seqno, and returns the SyncWrite
+     * that the node has now ack'ed.
      *
      * @param lg the object lock
      * @param node
      * @param tracking Memory or Disk?
+     * @param pos the node Position for tracking
+     * @return the index in TrackedWrites of the SyncWrite ack'ed by the node
      */
-    void advanceNodePosition(const std::lock_guard<std::mutex>& lg,
-                             const std::string& node,
-                             Tracking tracking);
+    uint64_t advanceNodePosition(const std::lock_guard<std::mutex>& lg,
+                                 const std::string& node,
+                                 Tracking tracking,
+                                 Position& pos);
 
     /**
      * We track both the memory/disk seqnos ack'ed by nodes.
@@ -226,14 +250,15 @@ protected:
                                 const std::string& node) const;
 
     /**
-     * Remove the given SyncWrte from tracking.
+     * Remove the given SyncWrite from tracking. O(1), node Positions do not
+     * need to be updated.
      *
      * @param lg The object lock
-     * @param it The iterator to the SyncWrite to be removed
-     * @return single-element list of the removed SyncWrite.
+     * @param index The index in TrackedWrites of the SyncWrite to be removed
+     * @return the removed SyncWrite
      */
-    Container removeSyncWrite(const std::lock_guard<std::mutex>& lg,
-                              Container::iterator it);
+    SyncWrite removeSyncWrite(const std::lock_guard<std::mutex>& lg,
+                              uint64_t index);
 
     /**
      * Commit the given SyncWrite.
@@ -256,7 +281,7 @@ protected:
      * @param node The node that ack'ed the given seqno
      * @param tracking Memory or Disk?
      * @param ackSeqno
-     * @param [out] toCommit
+     * @param [out] toCommit all the SyncWrites satisfied by this ack
      */
     void processSeqnoAck(const std::lock_guard<std::mutex>& lg,
                          const std::string& node,
@@ -281,7 +306,7 @@ protected:
         nlohmann::json replicationTopology;
         // @todo: Expand for supporting the SecondChain.
         std::unique_ptr<ReplicationChain> firstChain;
-        Container trackedWrites;
+        std::unique_ptr<TrackedWrites> trackedWrites;
     } state;
 
     const size_t maxReplicas = 3;
@@ -35,6 +35,8 @@
 
 #include "dcp/dcpconnmap.h"
 
+#include <algorithm>
+
 /**
  * Callback class used by EpStore, for adding relevant keys
  * to bloomfilter during compaction.
@@ -192,6 +194,12 @@ public:
                                   size_t value) override {
         if (key == "flusher_batch_split_trigger") {
             bucket.setFlusherBatchSplitTrigger(value);
+        } else if (key == "compaction_max_bytes_per_sec") {
+            bucket.compactionIOBudget.setBytesPerSec(value);
+        } else if (key == "compaction_max_iops") {
+            bucket.compactionIOBudget.setOpsPerSec(value);
+        } else if (key == "compaction_max_concurrency") {
+            bucket.setCompactionMaxConcurrency(value);
         } else if (key == "alog_sleep_time") {
             bucket.setAccessScannerSleeptime(value, false);
         } else if (key == "alog_task_time") {
@@ -239,6 +247,19 @@ EPBucket::EPBucket(EventuallyPersistentEngine& theEngine)
             "flusher_batch_split_trigger",
             std::make_unique<ValueChangedListener>(*this));
 
+    compactionIOBudget.setBytesPerSec(config.getCompactionMaxBytesPerSec());
+    config.addValueChangedListener(
+            "compaction_max_bytes_per_sec",
+            std::make_unique<ValueChangedListener>(*this));
+    compactionIOBudget.setOpsPerSec(config.getCompactionMaxIops());
+    config.addValueChangedListener(
+            "compaction_max_iops",
+            std::make_unique<ValueChangedListener>(*this));
+    compactionMaxConcurrency = config.getCompactionMaxConcurrency();
+    config.addValueChangedListener(
+            "compaction_max_concurrency",
+            std::make_unique<ValueChangedListener>(*this));
+
     retainErroneousTombstones = config.isRetainErroneousTombstones();
     config.addValueChangedListener(
            "retain_erroneous_tombstones",
@@ -706,9 +727,12 @@ ENGINE_ERROR_CODE EPBucket::scheduleCompaction(Vbid vbid,
             *this, c, vb->getPurgeSeqno(), cookie);
     compactionTasks.push_back(std::make_pair(c.db_file_id, task));
     if (compactionTasks.size() > 1) {
+        const size_t maxConcurrency = compactionMaxConcurrency;
         if ((stats.diskQueueSize > compactionWriteQueueCap &&
              compactionTasks.size() > (vbMap.getNumShards() / 2)) ||
-            engine.getWorkLoadPolicy().getWorkLoadPattern() == READ_HEAVY) {
+            engine.getWorkLoadPolicy().getWorkLoadPattern() == READ_HEAVY ||
+            (maxConcurrency != 0 &&
+             compactionTasks.size() > maxConcurrency)) {
             // Snooze a new compaction task.
             // We will wake it up when one of the existing compaction tasks is
             // done.
@@ -738,6 +762,18 @@ ENGINE_ERROR_CODE EPBucket::cancelCompaction(Vbid vbid) {
     return ENGINE_SUCCESS;
 }
 
+ENGINE_ERROR_CODE EPBucket::deleteVBucket(Vbid vbid, const void* c) {
+    {
+        LockHolder lh(compactionLock);
+        for (auto* ctx : activeCompactions) {
+            if (ctx->compactConfig.db_file_id == vbid) {
+                ctx->cancelRequested = true;
+            }
+        }
+    }
+    return KVBucket::deleteVBucket(vbid, c);
+}
+
 void EPBucket::flushOneDeleteAll() {
     for (auto vbid : vbMap.getBuckets()) {
         auto vb = getLockedVBucket(vbid);
@@ -844,10 +880,36 @@ void EPBucket::compactInternal(const CompactionConfig& config,
                                  std::placeholders::_1,
                                  std::placeholders::_2);
 
+    ctx.ioBudget = &compactionIOBudget;
+
+    // Abandon the compaction rather than hold up shutdown or the move of
+    // the vBucket away from this node. Deletion of the vBucket sets
+    // cancelRequested (see deleteVBucket()), as it can't change the
+    // vBucket's state until the compaction releases the vBucket lock.
+    const Vbid vbid = config.db_file_id;
+    ctx.isCancelled = [this, vbid, &ctx]() {
+        if (stats.isShutdown || ctx.cancelRequested) {
+            return true;
+        }
+        auto vb = getVBucket(vbid);
+        return vb && vb->getState() == vbucket_state_dead;
+    };
+
+    {
+        LockHolder lh(compactionLock);
+        activeCompactions.push_back(&ctx);
+    }
+
     KVShard* shard = vbMap.getShardByVbId(config.db_file_id);
     KVStore* store = shard->getRWUnderlying();
     bool result = store->compactDB(&ctx);
 
+    {
+        LockHolder lh(compactionLock);
+        activeCompactions.erase(std::find(
+                activeCompactions.begin(), activeCompactions.end(), &ctx));
+    }
+
     /* Iterate over all the vbucket ids set in max_purged_seq map. If there is
      * an entry
      * in the map for a vbucket id, then it was involved in compaction and thus
@@ -905,6 +967,7 @@ bool EPBucket::doCompact(const CompactionConfig& config,
         auto vb = getLockedVBucket(vbid, std::try_to_lock);
         if (!vb.owns_lock()) {
             // VB currently locked; try again later.
+            finishCompaction();
             return true;
         }
 
@@ -923,6 +986,7 @@ bool EPBucket::doCompact(const CompactionConfig& config,
         compactInternal(config, purgeSeqno);
     }
 
+    finishCompaction();
     updateCompactionTasks(vbid);
 
     if (cookie) {
@@ -933,25 +997,83 @@ bool EPBucket::doCompact(const CompactionConfig& config,
 }
 
 void EPBucket::updateCompactionTasks(Vbid db_file_id) {
-    LockHolder lh(compactionLock);
-    bool erased = false, woke = false;
-    std::list<CompTaskEntry>::iterator it = compactionTasks.begin();
-    while (it != compactionTasks.end()) {
-        if ((*it).first == db_file_id) {
-            it = compactionTasks.erase(it);
-            erased = true;
-        } else {
-            ExTask& task = (*it).second;
-            if (task->getState() == TASK_SNOOZED) {
-                ExecutorPool::get()->wake(task->getId());
-                woke = true;
+    std::vector<CompTaskEntry> snoozed;
+    {
+        LockHolder lh(compactionLock);
+        auto it = compactionTasks.begin();
+        while (it != compactionTasks.end()) {
+            if ((*it).first == db_file_id) {
+                it = compactionTasks.erase(it);
+            } else {
+                if ((*it).second->getState() == TASK_SNOOZED) {
+                    snoozed.push_back(*it);
+                }
+                ++it;
             }
-            ++it;
         }
-        if (erased && woke) {
-            break;
+    }
+
+    if (snoozed.empty()) {
+        return;
+    }
+
+    // Wake the waiting compaction which will reclaim the most space.
+    auto next = snoozed.begin();
+    if (snoozed.size() > 1) {
+        uint64_t maxFragmented = 0;
+        for (auto it = snoozed.begin(); it != snoozed.end(); ++it) {
+            DBFileInfo info;
+            try {
+                info = getROUnderlying(it->first)->getDbFileInfo(it->first);
+            } catch (std::runtime_error& e) {
+                // The file may have gone away (e.g. the vBucket was deleted
+                // while its compaction was waiting) - treat it as having
+                // nothing to reclaim.
+                EP_LOG_WARN(
+                        "EPBucket::updateCompactionTasks: Exception caught "
+                        "during getDbFileInfo for {} - what(): {}",
+                        it->first,
+                        e.what());
+            }
+            const uint64_t fragmented = info.fileSize > info.spaceUsed
+                                                ? info.fileSize - info.spaceUsed
+                                                : 0;
+            if (fragmented > maxFragmented) {
+                maxFragmented = fragmented;
+                next = it;
+            }
         }
     }
+    ExecutorPool::get()->wake(next->second->getId());
+}
+
+double EPBucket::getCompactionIODelay() {
+    if (!compactionIOBudget.isLimited()) {
+        return 0;
+    }
+    const auto now = IOBudget::Clock::now();
+    const auto available = compactionIOBudget.getAvailableTime();
+    if (available <= now) {
+        return 0;
+    }
+    return std::chrono::duration<double>(available - now).count();
+}
+
+bool EPBucket::tryStartCompaction() {
+    const size_t maxConcurrency = compactionMaxConcurrency;
+    LockHolder lh(compactionLock);
+    if (maxConcurrency != 0 && runningCompactions >= maxConcurrency) {
+        return false;
+    }
+    ++runningCompactions;
+    return true;
+}
+
+void EPBucket::finishCompaction() {
+    LockHolder lh(compactionLock);
+    if (runningCompactions > 0) {
+        --runningCompactions;
+    }
 }
 
 std::pair<uint64_t, bool> EPBucket::getLastPersistedCheckpointId(Vbid vb) {
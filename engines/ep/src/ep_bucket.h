@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "io_budget.h"
 #include "kv_bucket.h"
 
 /**
@@ -85,6 +86,13 @@ public:
 
     ENGINE_ERROR_CODE cancelCompaction(Vbid vbid) override;
 
+    /**
+     * Delete the vBucket, first cancelling any compaction of it which is
+     * running (a compaction holds the vBucket lock which deletion waits on
+     * until it completes).
+     */
+    ENGINE_ERROR_CODE deleteVBucket(Vbid vbid, const void* c = NULL) override;
+
     /**
      * Compaction of a database file
      *
@@ -98,6 +106,25 @@ public:
                    uint64_t purgeSeq,
                    const void* cookie);
 
+    /**
+     * @return how long (in seconds) a compaction must wait before starting
+     *         for the I/O of earlier compactions to fit within the
+     *         compaction I/O budget; 0 if it may start now.
+     */
+    double getCompactionIODelay();
+
+    /**
+     * Claim one of the compaction_max_concurrency slots for a compaction
+     * which is about to run. The slot is released by doCompact().
+     *
+     * @return false if all slots are in use.
+     */
+    bool tryStartCompaction();
+
+    void setCompactionMaxConcurrency(size_t value) {
+        compactionMaxConcurrency = value;
+    }
+
     std::pair<uint64_t, bool> getLastPersistedCheckpointId(Vbid vb) override;
 
     ENGINE_ERROR_CODE getFileStats(const void* cookie,
@@ -201,12 +228,16 @@ protected:
     void compactInternal(const CompactionConfig& config, uint64_t purgeSeqno);
 
     /**
-     * Remove completed compaction tasks or wake snoozed tasks
+     * Remove completed compaction tasks and wake the snoozed task whose
+     * file is the most fragmented
      *
      * @param db_file_id vbucket id for couchstore
      */
     void updateCompactionTasks(Vbid db_file_id);
 
+    /// Release the slot claimed by tryStartCompaction() (if any).
+    void finishCompaction();
+
     void stopWarmup();
 
     /// function which is passed down to compactor for dropping keys
@@ -218,6 +249,19 @@ protected:
      */
     size_t flusherBatchSplitTrigger;
 
+    /// Disk I/O budget shared by all compactions of the bucket.
+    IOBudget compactionIOBudget;
+
+    /// Max number of compactions which may run at once (0 = unlimited).
+    std::atomic<size_t> compactionMaxConcurrency;
+
+    /// Number of compactions currently running. Guarded by compactionLock.
+    size_t runningCompactions = 0;
+
+    /// The contexts of the compactions in compactInternal(). Guarded by
+    /// compactionLock.
+    std::vector<compaction_ctx*> activeCompactions;
+
     /**
      * Indicates whether erroneous tombstones need to retained or not during
      * compaction
@@ -38,6 +38,7 @@
 #include "failover-table.h"
 #include "flusher.h"
 #include "htresizer.h"
+#include "instrumented_mutex.h"
 #include "memory_tracker.h"
 #include "replicationthrottle.h"
 #include "stats-info.h"
@@ -606,6 +607,12 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setDefragmenterChunkDuration(std::stoull(val));
         } else if (key == "defragmenter_run") {
             runDefragmenterTask();
+        } else if (key == "compaction_max_bytes_per_sec") {
+            getConfiguration().setCompactionMaxBytesPerSec(std::stoull(val));
+        } else if (key == "compaction_max_concurrency") {
+            getConfiguration().setCompactionMaxConcurrency(std::stoull(val));
+        } else if (key == "compaction_max_iops") {
+            getConfiguration().setCompactionMaxIops(std::stoull(val));
         } else if (key == "compaction_write_queue_cap") {
             getConfiguration().setCompactionWriteQueueCap(std::stoull(val));
         } else if (key == "dcp_min_compression_ratio") {
@@ -649,6 +656,10 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setMemUsedMergeThresholdPercent(std::stof(val));
         } else if (key == "retain_erroneous_tombstones") {
             getConfiguration().setRetainErroneousTombstones(cb_stob(val));
+        } else if (key == "stats_cache_enabled") {
+            getConfiguration().setStatsCacheEnabled(cb_stob(val));
+        } else if (key == "stats_cache_max_staleness") {
+            getConfiguration().setStatsCacheMaxStaleness(std::stoull(val));
         } else {
             msg = "Unknown config param";
             rv = cb::mcbp::Status::KeyEnoent;
@@ -697,11 +708,17 @@ cb::mcbp::Status EventuallyPersistentEngine::setDcpParam(const std::string& key,
             validate(v, size_t(1), std::numeric_limits<size_t>::max());
             getConfiguration().setDcpConsumerProcessBufferedMessagesBatchSize(
                     v);
+        } else if (key == "dcp_consumer_processor_tasks") {
+            size_t v = size_t(std::stoul(val));
+            checkNumeric(val.c_str());
+            getConfiguration().setDcpConsumerProcessorTasks(v);
         } else if (key == "dcp_idle_timeout") {
             size_t v = size_t(std::stoul(val));
             checkNumeric(val.c_str());
             validate(v, size_t(1), std::numeric_limits<size_t>::max());
             getConfiguration().setDcpIdleTimeout(v);
+        } else if (key == "dcp_backfill_coalescing") {
+            getConfiguration().setDcpBackfillCoalescing(cb_stob(val));
         } else {
             msg = "Unknown config param";
             rv = cb::mcbp::Status::KeyEnoent;
@@ -953,7 +970,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getReplicaCmd(
             key, request.getVBucket(), cookie, options));
     auto error_code = rv.getStatus();
     if (error_code != ENGINE_EWOULDBLOCK) {
-        ++(getEpStats().numOpsGet);
+        ++getEpStats().coreLocal.get()->numOpsGet;
     }
 
     if (error_code == ENGINE_SUCCESS) {
@@ -2183,11 +2200,13 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::itemDelete(
     // Check if this is a in-progress durable delete which has now completed -
     // (see 'case EWOULDBLOCK' at the end of this function where we record
     // the fact we must block the client until the SycnWrite is durable).
-    if (durability && getEngineSpecific(cookie) != nullptr) {
-        // Non-null means this is the second call to this function after
-        // the SyncWrite has completed.
-        // Clear the engineSpecific, and return SUCCESS.
-        storeEngineSpecific(cookie, nullptr);
+    if (durability && kvBucket->isSyncWritePending(cookie)) {
+        // This is the second call to this function after the SyncWrite has
+        // completed.
+        // Clear the engineSpecific (recording the SyncDelete's stats), and
+        // return SUCCESS.
+        kvBucket->completeSyncWrite(
+                cookie, vbucket, key, OperationStats::Op::Delete);
         // @todo-durability - add support for non-sucesss (e.g. Aborted) when
         // we support non-successful completions of SyncWrites.
         return ENGINE_SUCCESS;
@@ -2209,15 +2228,14 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::itemDelete(
         if (durability) {
             // Record the fact that we are blocking to wait for SyncDelete
             // completion; so the next call to this function should return
-            // the result of the SyncWrite (see call to getEngineSpecific at
+            // the result of the SyncWrite (see call to isSyncWritePending at
             // the head of this function).
-            // (just store non-null value to indicate this).
-            storeEngineSpecific(cookie, reinterpret_cast<void*>(0x1));
+            kvBucket->setSyncWritePending(cookie);
         }
         break;
 
     case ENGINE_SUCCESS:
-        ++stats.numOpsDelete;
+        ++stats.coreLocal.get()->numOpsDelete;
         break;
 
     default:
@@ -2246,7 +2264,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::get(const void* cookie,
     if (ret == ENGINE_SUCCESS) {
         *itm = gv.item.release();
         if (options & TRACK_STATISTICS) {
-            ++stats.numOpsGet;
+            ++stats.coreLocal.get()->numOpsGet;
         }
     } else if (ret == ENGINE_KEY_ENOENT || ret == ENGINE_NOT_MY_VBUCKET) {
         if (isDegradedMode()) {
@@ -2267,8 +2285,8 @@ cb::EngineErrorItemPair EventuallyPersistentEngine::getAndTouchInner(
 
     auto rv = gv.getStatus();
     if (rv == ENGINE_SUCCESS) {
-        ++stats.numOpsGet;
-        ++stats.numOpsStore;
+        ++stats.coreLocal.get()->numOpsGet;
+        ++stats.coreLocal.get()->numOpsStore;
         return cb::makeEngineErrorItemPair(
                 cb::engine_errc::success, gv.item.release(), handle);
     }
@@ -2397,7 +2415,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getLockedInner(
                                       lock_timeout, cookie);
 
     if (result.getStatus() == ENGINE_SUCCESS) {
-        ++stats.numOpsGet;
+        ++stats.coreLocal.get()->numOpsGet;
         *itm = result.item.release();
     }
 
@@ -2425,11 +2443,15 @@ cb::EngineErrorCasPair EventuallyPersistentEngine::storeIfInner(
     // (see 'case EWOULDBLOCK' at the end of this function where we record
     // the fact we must block the client until the SycnWrite is durable).
     if (item.getCommitted() == CommittedState::Pending &&
-        getEngineSpecific(cookie) != nullptr) {
-        // Non-null means this is the second call to this function after
-        // the SyncWrite has completed.
-        // Clear the engineSpecific, and return SUCCESS.
-        storeEngineSpecific(cookie, nullptr);
+        kvBucket->isSyncWritePending(cookie)) {
+        // This is the second call to this function after the SyncWrite has
+        // completed.
+        // Clear the engineSpecific (recording the SyncWrite's stats), and
+        // return SUCCESS.
+        kvBucket->completeSyncWrite(cookie,
+                                    item.getVBucketId(),
+                                    item.getKey(),
+                                    OperationStats::Op::Store);
         // @todo-durability - return correct CAS
         // @todo-durability - add support for non-sucesss (e.g. Aborted) when
         // we support non-successful completions of SyncWrites.
@@ -2474,7 +2496,7 @@ cb::EngineErrorCasPair EventuallyPersistentEngine::storeIfInner(
 
     switch (status) {
     case ENGINE_SUCCESS:
-        ++stats.numOpsStore;
+        ++stats.coreLocal.get()->numOpsStore;
         // If success - check if we're now in need of some memory freeing
         kvBucket->checkAndMaybeFreeMemory();
         break;
@@ -2491,10 +2513,9 @@ cb::EngineErrorCasPair EventuallyPersistentEngine::storeIfInner(
         if (item.getCommitted() == CommittedState::Pending) {
             // Record the fact that we are blocking to wait for SyncWrite
             // completion; so the next call to this function should return
-            // the result of the SyncWrite (see call to getEngineSpecific at
+            // the result of the SyncWrite (see call to isSyncWritePending at
             // the head of this function.
-            // (just store non-null value to indicate this).
-            storeEngineSpecific(cookie, reinterpret_cast<void*>(0x1));
+            kvBucket->setSyncWritePending(cookie);
         }
         break;
     default:
@@ -2587,11 +2608,14 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(
     }
 
     add_casted_stat("ep_total_enqueued",
-                    epstats.totalEnqueued, add_stat, cookie);
-    add_casted_stat("ep_total_deduplicated",
-                    epstats.totalDeduplicated,
+                    epstats.getCoreLocalTotal(&CoreLocalStats::totalEnqueued),
                     add_stat,
                     cookie);
+    add_casted_stat(
+            "ep_total_deduplicated",
+            epstats.getCoreLocalTotal(&CoreLocalStats::totalDeduplicated),
+            add_stat,
+            cookie);
     add_casted_stat("ep_expired_access", epstats.expired_access,
                     add_stat, cookie);
     add_casted_stat("ep_expired_compactor", epstats.expired_compactor,
@@ -2839,22 +2863,43 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(
         add_casted_stat("ep_warmup_dups", epstats.warmDups, add_stat, cookie);
     }
 
-    add_casted_stat("ep_num_ops_get_meta", epstats.numOpsGetMeta,
-                    add_stat, cookie);
-    add_casted_stat("ep_num_ops_set_meta", epstats.numOpsSetMeta,
-                    add_stat, cookie);
-    add_casted_stat("ep_num_ops_del_meta", epstats.numOpsDelMeta,
-                    add_stat, cookie);
+    add_casted_stat("ep_num_ops_get_meta",
+                    epstats.getCoreLocalTotal(&CoreLocalStats::numOpsGetMeta),
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_num_ops_set_meta",
+                    epstats.getCoreLocalTotal(&CoreLocalStats::numOpsSetMeta),
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_num_ops_del_meta",
+                    epstats.getCoreLocalTotal(&CoreLocalStats::numOpsDelMeta),
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_num_ops_set_meta_res_fail",
-                    epstats.numOpsSetMetaResolutionFailed, add_stat, cookie);
+                    epstats.getCoreLocalTotal(
+                            &CoreLocalStats::numOpsSetMetaResolutionFailed),
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_num_ops_del_meta_res_fail",
-                    epstats.numOpsDelMetaResolutionFailed, add_stat, cookie);
-    add_casted_stat("ep_num_ops_set_ret_meta", epstats.numOpsSetRetMeta,
-                    add_stat, cookie);
-    add_casted_stat("ep_num_ops_del_ret_meta", epstats.numOpsDelRetMeta,
-                    add_stat, cookie);
+                    epstats.getCoreLocalTotal(
+                            &CoreLocalStats::numOpsDelMetaResolutionFailed),
+                    add_stat,
+                    cookie);
+    add_casted_stat(
+            "ep_num_ops_set_ret_meta",
+            epstats.getCoreLocalTotal(&CoreLocalStats::numOpsSetRetMeta),
+            add_stat,
+            cookie);
+    add_casted_stat(
+            "ep_num_ops_del_ret_meta",
+            epstats.getCoreLocalTotal(&CoreLocalStats::numOpsDelRetMeta),
+            add_stat,
+            cookie);
     add_casted_stat("ep_num_ops_get_meta_on_set_meta",
-                    epstats.numOpsGetMetaOnSetWithMeta, add_stat, cookie);
+                    epstats.getCoreLocalTotal(
+                            &CoreLocalStats::numOpsGetMetaOnSetWithMeta),
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_workload_pattern",
                     workload->stringOfWorkLoadPattern(),
                     add_stat, cookie);
@@ -3196,6 +3241,52 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doVBucketStats(
     return ENGINE_SUCCESS;
 }
 
+ENGINE_ERROR_CODE EventuallyPersistentEngine::doVBucketOpStats(
+        const void* cookie,
+        const AddStatFn& add_stat,
+        const char* stat_key,
+        int nkey) {
+    class OpStatsVBucketVisitor : public VBucketVisitor {
+    public:
+        OpStatsVBucketVisitor(const void* c, const AddStatFn& a)
+            : cookie(c), add_stat(a) {
+        }
+
+        void visitBucket(const VBucketPtr& vb) override {
+            addVBStats(cookie, add_stat, *vb);
+        }
+
+        static void addVBStats(const void* cookie,
+                               const AddStatFn& add_stat,
+                               const VBucket& vb) {
+            vb.opStats.addStats(
+                    "vb_" + std::to_string(vb.getId().get()), add_stat, cookie);
+        }
+
+    private:
+        const void* cookie;
+        AddStatFn add_stat;
+    };
+
+    // "vbucket-ops" or "vbucket-ops <vbid>"
+    if (nkey > 12) {
+        std::string vbid(&stat_key[12], nkey - 12);
+        uint16_t vbucket_id(0);
+        if (!parseUint16(vbid.c_str(), &vbucket_id)) {
+            return ENGINE_EINVAL;
+        }
+        VBucketPtr vb = getVBucket(Vbid(vbucket_id));
+        if (!vb) {
+            return ENGINE_NOT_MY_VBUCKET;
+        }
+        OpStatsVBucketVisitor::addVBStats(cookie, add_stat, *vb);
+    } else {
+        OpStatsVBucketVisitor visitor(cookie, add_stat);
+        kvBucket->visit(visitor);
+    }
+    return ENGINE_SUCCESS;
+}
+
 ENGINE_ERROR_CODE EventuallyPersistentEngine::doHashStats(
         const void* cookie, const AddStatFn& add_stat) {
     class StatVBucketVisitor : public VBucketVisitor {
@@ -3479,6 +3570,135 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doCheckpointStats(
     return ENGINE_SUCCESS;
 }
 
+/**
+ * Refreshes the snapshot of a cacheable stat group and notifies the requests
+ * waiting for it (see StatCache).
+ */
+class StatCacheRefreshTask : public GlobalTask {
+public:
+    StatCacheRefreshTask(EventuallyPersistentEngine* e, std::string group)
+        : GlobalTask(e, TaskId::StatCacheRefreshTask, 0, false),
+          ep(e),
+          group(std::move(group)),
+          description("Refreshing \"" + this->group + "\" stats") {
+    }
+
+    bool run() override {
+        TRACE_EVENT0("ep-engine/task", "StatCacheRefreshTask");
+        bool refreshAgain;
+        do {
+            auto waiters = ep->getStatCache().publish(
+                    group, ep->takeStatSnapshot(group), refreshAgain);
+            for (const auto* cookie : waiters) {
+                ep->notifyIOComplete(cookie, ENGINE_SUCCESS);
+            }
+        } while (refreshAgain);
+        return false;
+    }
+
+    std::string getDescription() override {
+        return description;
+    }
+
+    std::chrono::microseconds maxExpectedDuration() override {
+        // Runs instead of the front-end thread computing the stats; as for
+        // StatCheckpointTask only the waiting stat requests are affected,
+        // but it shouldn't take /too/ long.
+        return std::chrono::milliseconds(100);
+    }
+
+private:
+    EventuallyPersistentEngine* ep;
+    const std::string group;
+    const std::string description;
+};
+
+bool EventuallyPersistentEngine::isCacheableStatGroup(
+        const std::string& group) {
+    return group.empty() || group == "dcp" || group == "hash" ||
+           group == "vbucket" || group == "vbucket-details" ||
+           group == "prev-vbucket" || group == "vbucket-seqno" ||
+           group == "checkpoint" || group == "failovers" ||
+           group == "diskinfo" || group == "diskinfo detail";
+}
+
+ENGINE_ERROR_CODE EventuallyPersistentEngine::doCachedStats(
+        const void* cookie,
+        const AddStatFn& add_stat,
+        const std::string& group) {
+    const auto notBefore =
+            StatCache::Clock::now() -
+            std::chrono::milliseconds(
+                    configuration.getStatsCacheMaxStaleness());
+    bool scheduleRefresh;
+    auto snapshot =
+            statCache.getOrWait(group, cookie, notBefore, scheduleRefresh);
+    if (snapshot) {
+        snapshot->addStats(add_stat, cookie);
+        return snapshot->status;
+    }
+    if (scheduleRefresh) {
+        ExTask task = std::make_shared<StatCacheRefreshTask>(this, group);
+        ExecutorPool::get()->schedule(task);
+    }
+    return ENGINE_EWOULDBLOCK;
+}
+
+ENGINE_ERROR_CODE EventuallyPersistentEngine::doCacheableStats(
+        const void* cookie,
+        const AddStatFn& add_stat,
+        const std::string& group) {
+    if (group.empty()) {
+        return doEngineStats(cookie, add_stat);
+    } else if (group == "dcp") {
+        return doDcpStats(cookie, add_stat);
+    } else if (group == "hash") {
+        return doHashStats(cookie, add_stat);
+    } else if (group == "vbucket") {
+        return doVBucketStats(
+                cookie, add_stat, group.data(), group.size(), false, false);
+    } else if (group == "vbucket-details") {
+        return doVBucketStats(
+                cookie, add_stat, group.data(), group.size(), false, true);
+    } else if (group == "prev-vbucket") {
+        return doVBucketStats(
+                cookie, add_stat, group.data(), group.size(), true, false);
+    } else if (group == "vbucket-seqno") {
+        return doSeqnoStats(cookie, add_stat, group.data(), group.size());
+    } else if (group == "checkpoint") {
+        StatCheckpointVisitor scv(kvBucket.get(), cookie, add_stat);
+        kvBucket->visit(scv);
+        return ENGINE_SUCCESS;
+    } else if (group == "failovers") {
+        return doAllFailoverLogStats(cookie, add_stat);
+    } else if (group == "diskinfo") {
+        return kvBucket->getFileStats(cookie, add_stat);
+    } else if (group == "diskinfo detail") {
+        return kvBucket->getPerVBucketDiskStats(cookie, add_stat);
+    }
+    throw std::invalid_argument(
+            "EventuallyPersistentEngine::doCacheableStats: '" + group +
+            "' is not a cacheable stat group");
+}
+
+StatCache::SnapshotPtr EventuallyPersistentEngine::takeStatSnapshot(
+        const std::string& group) {
+    auto snapshot = std::make_shared<StatCache::Snapshot>();
+    snapshot->takenAt = StatCache::Clock::now();
+    // The snapshot itself is passed as the stats' cookie, to collect them.
+    auto collect = [](const char* key,
+                      const uint16_t klen,
+                      const char* val,
+                      const uint32_t vlen,
+                      gsl::not_null<const void*> cookie) {
+        auto* s = reinterpret_cast<StatCache::Snapshot*>(
+                const_cast<void*>(cookie.get()));
+        s->stats.emplace_back(std::string(key, klen), std::string(val, vlen));
+    };
+    snapshot->status = doCacheableStats(snapshot.get(), collect, group);
+    return snapshot;
+}
+
 ENGINE_ERROR_CODE EventuallyPersistentEngine::doDurabilityMonitorStats(
         const void* cookie,
         const AddStatFn& add_stat,
@@ -3891,6 +4111,27 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doSchedulerStats(
     return ENGINE_SUCCESS;
 }
 
+ENGINE_ERROR_CODE EventuallyPersistentEngine::doLockStats(
+        const void* cookie, const AddStatFn& add_stat) {
+#ifdef EP_INSTRUMENT_LOCKS
+    add_casted_stat("instrumented", true, add_stat, cookie);
+#else
+    // The histograms below will be empty; say why.
+    add_casted_stat("instrumented", false, add_stat, cookie);
+#endif
+    for (size_t ii = 0; ii < NumLockSites; ++ii) {
+        const auto site = LockSite(ii);
+        const auto& histograms = getLockSiteHistograms(site);
+        const auto name = to_string(site);
+        add_casted_stat(
+                (name + "_wait").c_str(), histograms.wait, add_stat, cookie);
+        add_casted_stat(
+                (name + "_hold").c_str(), histograms.hold, add_stat, cookie);
+    }
+
+    return ENGINE_SUCCESS;
+}
+
 ENGINE_ERROR_CODE EventuallyPersistentEngine::doRunTimeStats(
         const void* cookie, const AddStatFn& add_stat) {
     for (TaskId id : GlobalTask::allTaskIds) {
@@ -4164,6 +4405,18 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getStats(
         EP_LOG_DEBUG("stats engine");
     }
 
+    if (isCacheableStatGroup(statKey)) {
+        // Is this the re-run of a request which waited for a refresh?
+        auto snapshot = statCache.collect(statKey, cookie);
+        if (snapshot) {
+            snapshot->addStats(add_stat, cookie);
+            return snapshot->status;
+        }
+        if (configuration.isStatsCacheEnabled()) {
+            return doCachedStats(cookie, add_stat, statKey);
+        }
+    }
+
     ENGINE_ERROR_CODE rv = ENGINE_KEY_ENOENT;
     if (statKey.empty()) {
         rv = doEngineStats(cookie, add_stat);
@@ -4184,6 +4437,9 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getStats(
         rv = doVBucketStats(cookie, add_stat, stat_key, nkey, false, true);
     } else if (cb_isPrefix(statKey, "vbucket-seqno")) {
         rv = doSeqnoStats(cookie, add_stat, stat_key, nkey);
+    } else if (statKey == "vbucket-ops" ||
+               cb_isPrefix(statKey, "vbucket-ops ")) {
+        rv = doVBucketOpStats(cookie, add_stat, stat_key, nkey);
     } else if (statKey == "prev-vbucket") {
         rv = doVBucketStats(cookie, add_stat, stat_key, nkey, true, false);
     } else if (cb_isPrefix(statKey, "checkpoint")) {
@@ -4200,6 +4456,11 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getStats(
         rv = doSchedulerStats(cookie, add_stat);
     } else if (statKey == "runtimes") {
         rv = doRunTimeStats(cookie, add_stat);
+    } else if (statKey == "locks") {
+        rv = doLockStats(cookie, add_stat);
+    } else if (statKey == "collections-ops") {
+        kvBucket->getCollectionsManager().addOperationStats(cookie, add_stat);
+        rv = ENGINE_SUCCESS;
     } else if (statKey == "memory") {
         rv = doMemoryStats(cookie, add_stat);
     } else if (statKey == "uuid") {
@@ -4349,6 +4610,7 @@ void EventuallyPersistentEngine::resetStats() {
     if (kvBucket) {
         kvBucket->resetUnderlyingStats();
     }
+    statCache.reset();
 }
 
 ENGINE_ERROR_CODE EventuallyPersistentEngine::observe(
@@ -4963,7 +5225,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::setWithMeta(
     }
 
     if (ret == ENGINE_SUCCESS) {
-        ++stats.numOpsSetMeta;
+        ++stats.coreLocal.get()->numOpsSetMeta;
         auto endTime = std::chrono::steady_clock::now();
         TRACE_END(cookie, TraceCode::SETWITHMETA, endTime);
         auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -4974,7 +5236,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::setWithMeta(
     } else if (ret == ENGINE_ENOMEM) {
         return memoryCondition();
     } else if (ret == ENGINE_EWOULDBLOCK) {
-        ++stats.numOpsGetMetaOnSetWithMeta;
+        ++stats.coreLocal.get()->numOpsGetMetaOnSetWithMeta;
         auto* startTimeC = cb_malloc(sizeof(hrtime_t));
         memcpy(startTimeC, &startTime, sizeof(hrtime_t));
         storeEngineSpecific(cookie, startTimeC);
@@ -5161,7 +5423,7 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::deleteWithMeta(
     }
 
     if (ret == ENGINE_SUCCESS) {
-        stats.numOpsDelMeta++;
+        stats.coreLocal.get()->numOpsDelMeta++;
     } else if (ret == ENGINE_ENOMEM) {
         return memoryCondition();
     } else {
@@ -5401,7 +5663,7 @@ EventuallyPersistentEngine::returnMeta(const void* cookie,
             ret = kvBucket->add(*itm, cookie);
         }
         if (ret == ENGINE_SUCCESS) {
-            ++stats.numOpsSetRetMeta;
+            ++stats.coreLocal.get()->numOpsSetRetMeta;
         }
         cas = itm->getCas();
         seqno = htonll(itm->getRevSeqno());
@@ -5416,7 +5678,7 @@ EventuallyPersistentEngine::returnMeta(const void* cookie,
                                    &itm_meta,
                                    mutation_descr);
         if (ret == ENGINE_SUCCESS) {
-            ++stats.numOpsDelRetMeta;
+            ++stats.coreLocal.get()->numOpsDelRetMeta;
         }
         flags = itm_meta.flags;
         exp = gsl::narrow<uint32_t>(itm_meta.exptime);
@@ -5661,6 +5923,11 @@ void EventuallyPersistentEngine::notifyIOComplete(const void* cookie,
         EP_LOG_WARN("Tried to signal a NULL cookie!");
     } else {
         BlockTimer bt(&stats.notifyIOHisto);
+        if (status != ENGINE_SUCCESS && kvBucket) {
+            // The front-end won't retry the blocked operation, so it mustn't
+            // leave its start behind for the connection's next command.
+            kvBucket->clearOperationStart(cookie);
+        }
         NonBucketAllocationGuard guard;
         serverApi->cookie->notify_io_complete(cookie, status);
     }
@@ -5783,6 +6050,7 @@ ConnHandler* EventuallyPersistentEngine::getConnHandler(const void *cookie) {
 
 void EventuallyPersistentEngine::handleDisconnect(const void *cookie) {
     dcpConnMap_->disconnect(cookie);
+    statCache.removeCookie(cookie);
     /**
      * Decrement session_cas's counter, if the connection closes
      * before a control command (that returned ENGINE_EWOULDBLOCK
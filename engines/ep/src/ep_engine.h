@@ -23,6 +23,7 @@
 #include "connhandler.h"
 #include "item.h"
 #include "permitted_vb_states.h"
+#include "stat_cache.h"
 #include "stats.h"
 #include "storeddockey.h"
 #include "taskable.h"
@@ -480,6 +481,16 @@ public:
                                int nkey,
                                const AddStatFn& add_stat);
 
+    /**
+     * Compute a snapshot of a cacheable stat group (see StatCache), for
+     * the background refresh of the group.
+     */
+    StatCache::SnapshotPtr takeStatSnapshot(const std::string& group);
+
+    StatCache& getStatCache() {
+        return statCache;
+    }
+
     void resetStats();
 
     ENGINE_ERROR_CODE storeInner(const void* cookie,
@@ -848,6 +859,10 @@ protected:
                                      int nkey,
                                      bool prevStateRequested,
                                      bool details);
+    ENGINE_ERROR_CODE doVBucketOpStats(const void* cookie,
+                                       const AddStatFn& add_stat,
+                                       const char* stat_key,
+                                       int nkey);
     ENGINE_ERROR_CODE doHashStats(const void* cookie,
                                   const AddStatFn& add_stat);
     ENGINE_ERROR_CODE doHashDump(const void* cookie,
@@ -860,6 +875,26 @@ protected:
     ENGINE_ERROR_CODE doCheckpointDump(const void* cookie,
                                        const AddStatFn& addStat,
                                        cb::const_char_buffer keyArgs);
+
+    /**
+     * @return true if the given stat group visits every vBucket (or every
+     *         connection) and so can be served from the StatCache.
+     */
+    static bool isCacheableStatGroup(const std::string& group);
+
+    /**
+     * Serve a cacheable stat group from the StatCache: from the group's
+     * snapshot if it is within stats_cache_max_staleness, else by waiting
+     * (ENGINE_EWOULDBLOCK) for a background refresh of the group.
+     */
+    ENGINE_ERROR_CODE doCachedStats(const void* cookie,
+                                    const AddStatFn& add_stat,
+                                    const std::string& group);
+
+    /// Compute a cacheable stat group synchronously.
+    ENGINE_ERROR_CODE doCacheableStats(const void* cookie,
+                                       const AddStatFn& add_stat,
+                                       const std::string& group);
     ENGINE_ERROR_CODE doDurabilityMonitorStats(const void* cookie,
                                                const AddStatFn& add_stat,
                                                const char* stat_key,
@@ -880,6 +915,8 @@ protected:
                                        const AddStatFn& add_stat);
     ENGINE_ERROR_CODE doRunTimeStats(const void* cookie,
                                      const AddStatFn& add_stat);
+    ENGINE_ERROR_CODE doLockStats(const void* cookie,
+                                  const AddStatFn& add_stat);
     ENGINE_ERROR_CODE doDispatcherStats(const void* cookie,
                                         const AddStatFn& add_stat);
     ENGINE_ERROR_CODE doTasksStats(const void* cookie,
@@ -1115,6 +1152,7 @@ protected:
     std::map<const void*, std::unique_ptr<Item>> lookups;
     std::unordered_map<const void*, ENGINE_ERROR_CODE> allKeysLookups;
     std::mutex lookupMutex;
+    StatCache statCache;
     GET_SERVER_API getServerApiFunc;
 
     std::unique_ptr<DcpFlowControlManager> dcpFlowControlManager_;
@@ -185,12 +185,17 @@ ENGINE_ERROR_CODE EPVBucket::completeBGFetchForSingleItem(
     const auto fetchEnd = std::chrono::steady_clock::now();
     updateBGStats(fetched_item.initTime, startTime, fetchEnd);
 
-    // Close the BG_WAIT span; and add a BG_LOAD span
+    // Add the BG_WAIT and BG_LOAD spans. This is the background fetcher's
+    // thread, so they're handed to the cookie rather than its tracer.
     if (fetched_item.cookie) {
-        TRACE_END(fetched_item.cookie, cb::tracing::TraceCode::BG_WAIT, startTime);
-        TRACE_BEGIN(
-                  fetched_item.cookie, cb::tracing::TraceCode::BG_LOAD, startTime);
-        TRACE_END(fetched_item.cookie, cb::tracing::TraceCode::BG_LOAD, fetchEnd);
+        TRACE_BACKGROUND_SPAN(fetched_item.cookie,
+                              cb::tracing::TraceCode::BG_WAIT,
+                              fetched_item.initTime,
+                              startTime);
+        TRACE_BACKGROUND_SPAN(fetched_item.cookie,
+                              cb::tracing::TraceCode::BG_LOAD,
+                              startTime,
+                              fetchEnd);
     }
 
     return status;
@@ -486,7 +491,7 @@ void EPVBucket::queueBackfillItem(queued_item& qi,
     backfill.items.push(qi);
     ++stats.diskQueueSize;
     ++stats.vbBackfillQueueSize;
-    ++stats.totalEnqueued;
+    ++stats.coreLocal.get()->totalEnqueued;
     doStatsForQueueing(*qi, qi->size());
     stats.coreLocal.get()->memOverhead.fetch_add(sizeof(queued_item));
 }
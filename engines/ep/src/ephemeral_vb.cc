@@ -307,8 +307,8 @@ EphemeralVBucket::inMemoryBackfill(uint64_t start, uint64_t end) {
 }
 
 boost::optional<SequenceList::RangeIterator>
-EphemeralVBucket::makeRangeIterator(bool isBackfill) {
-    return seqList->makeRangeIterator(isBackfill);
+EphemeralVBucket::makeRangeIterator(bool isBackfill, seqno_t startSeqno) {
+    return seqList->makeRangeIterator(isBackfill, startSeqno);
 }
 
 /* Vb level backfill queue is for items in a huge snapshot (disk backfill
@@ -332,7 +332,7 @@ void EphemeralVBucket::queueBackfillItem(
     } else {
         checkpointManager->setBySeqno(qi->getBySeqno());
     }
-    ++stats.totalEnqueued;
+    ++stats.coreLocal.get()->totalEnqueued;
     stats.coreLocal.get()->memOverhead.fetch_add(sizeof(queued_item));
 }
 
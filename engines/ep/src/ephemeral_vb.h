@@ -149,12 +149,14 @@ public:
      * the SequenceList, new range iterator will not be allowed
      *
      * @param isBackfill indicates if the iterator is for backfill (for debug)
+     * @param startSeqno the iterator begins at the first item with a seqno
+     *                   >= startSeqno
      *
      * @return range iterator object when possible
      *         null when not possible
      */
     boost::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill);
+            bool isBackfill, seqno_t startSeqno = 1);
 
     void dump() const override;
 
@@ -129,7 +129,7 @@ void HashTable::clear(bool deactivate) {
                     "non-active object");
         }
     }
-    MultiLockHolder mlh(mutexes);
+    MultiLockHolder<Mutex> mlh(mutexes);
     clear_UNLOCKED(deactivate);
 }
 
@@ -156,6 +156,28 @@ void HashTable::clear_UNLOCKED(bool deactivate) {
     valueStats.reset();
 }
 
+void HashTable::setCollectionMemoryTracking(bool enabled) {
+    if (valueStats.isCollectionMemTracked() == enabled) {
+        return;
+    }
+
+    MultiLockHolder<Mutex> mlh(mutexes);
+    if (valueStats.isCollectionMemTracked() == enabled) {
+        return;
+    }
+
+    Collections::Summary memSize;
+    if (enabled) {
+        for (size_t ii = 0; ii < size; ++ii) {
+            for (auto* v = values[ii].get().get(); v;
+                 v = v->getNext().get().get()) {
+                memSize[v->getKey().getCollectionID()] += v->size();
+            }
+        }
+    }
+    valueStats.setCollectionMemTracking(enabled, std::move(memSize));
+}
+
 static size_t distance(size_t a, size_t b) {
     return std::max(a, b) - std::min(a, b);
 }
@@ -220,7 +242,7 @@ void HashTable::resize(size_t newSize) {
     TRACE_EVENT2(
             "HashTable", "resize", "size", size.load(), "newSize", newSize);
 
-    MultiLockHolder mlh(mutexes);
+    MultiLockHolder<Mutex> mlh(mutexes);
     if (visitors.load() > 0) {
         // Do not allow a resize while any visitors are actually
         // processing.  The next attempt will have to pick it up.  New
@@ -444,7 +466,8 @@ HashTable::Statistics::StoredValueProperties::StoredValueProperties(
     isResident = sv->isResident();
     isDeleted = sv->isDeleted();
     isTempItem = sv->isTempItem();
-    isSystemItem = sv->getKey().getCollectionID().isSystem();
+    collection = sv->getKey().getCollectionID();
+    isSystemItem = collection.isSystem();
     isPreparedSyncWrite = sv->isPending();
 }
 
@@ -464,6 +487,17 @@ void HashTable::Statistics::epilogue(StoredValueProperties pre,
     if (pre.size != post.size) {
         cacheSize.fetch_add(post.size - pre.size);
         memSize.fetch_add(post.size - pre.size);
+        if (isCollectionMemTracked()) {
+            // pre & post are the same key (so collection) when both are
+            // valid.
+            if (pre.isValid && post.isValid) {
+                updateCollectionMemSize(post.collection, post.size - pre.size);
+            } else if (pre.isValid) {
+                updateCollectionMemSize(pre.collection, -pre.size);
+            } else {
+                updateCollectionMemSize(post.collection, post.size);
+            }
+        }
     }
     if (pre.metaDataSize != post.metaDataSize) {
         metaDataMemory.fetch_add(post.metaDataSize - pre.metaDataSize);
@@ -532,6 +566,48 @@ void HashTable::Statistics::reset() {
     memSize.store(0);
     cacheSize.store(0);
     uncompressedMemSize.store(0);
+    std::lock_guard<ShardedRWLock> wl(collectionMemSizeLock);
+    collectionMemSize.clear();
+}
+
+void HashTable::Statistics::setCollectionMemTracking(
+        bool enabled, Collections::Summary initial) {
+    std::lock_guard<ShardedRWLock> wl(collectionMemSizeLock);
+    collectionMemSize.clear();
+    for (const auto& entry : initial) {
+        collectionMemSize[entry.first].store(entry.second);
+    }
+    collectionMemTracked.store(enabled);
+}
+
+size_t HashTable::Statistics::getCollectionMemSize(
+        CollectionID collection) const {
+    auto rl = collectionMemSizeLock.lockShared();
+    auto itr = collectionMemSize.find(collection);
+    return itr == collectionMemSize.end() ? 0 : itr->second.load();
+}
+
+void HashTable::Statistics::updateCollectionMemSummary(
+        Collections::Summary& summary) const {
+    auto rl = collectionMemSizeLock.lockShared();
+    for (const auto& entry : collectionMemSize) {
+        summary[entry.first] += entry.second.load();
+    }
+}
+
+void HashTable::Statistics::updateCollectionMemSize(CollectionID collection,
+                                                    int64_t delta) {
+    {
+        auto rl = collectionMemSizeLock.lockShared();
+        auto itr = collectionMemSize.find(collection);
+        if (itr != collectionMemSize.end()) {
+            itr->second.fetch_add(delta);
+            return;
+        }
+    }
+    // First item of this collection; take the exclusive lock to add it.
+    std::lock_guard<ShardedRWLock> wl(collectionMemSizeLock);
+    collectionMemSize[collection].fetch_add(delta);
 }
 
 std::pair<StoredValue*, StoredValue::UniquePtr>
@@ -781,7 +857,7 @@ void HashTable::visitDepth(HashTableDepthVisitor &visitor) {
     // Acquire one (any) of the mutexes before incrementing {visitors}, this
     // prevents any race between this visitor and the HashTable resizer.
     // See comments in pauseResumeVisit() for further details.
-    std::unique_lock<std::mutex> lh(mutexes[0]);
+    std::unique_lock<Mutex> lh(mutexes[0]);
     VisitorTracker vt(&visitors);
     lh.unlock();
 
@@ -789,7 +865,7 @@ void HashTable::visitDepth(HashTableDepthVisitor &visitor) {
         for (int i = l; i < static_cast<int>(size); i+= mutexes.size()) {
             // (re)acquire mutex on each HashBucket, to minimise any impact
             // on front-end threads.
-            LockHolder lh(mutexes[l]);
+            std::lock_guard<Mutex> lh(mutexes[l]);
 
             size_t depth = 0;
             StoredValue* p = values[i].get().get();
@@ -838,7 +914,7 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
     // inside the inner for() loop. To prevent this race, we explicitly acquire
     // (any) mutex, increment {visitors} and then release the mutex. This
     //avoids the race as if visitors >0 then Resizer will not attempt to resize.
-    std::unique_lock<std::mutex> lh(mutexes[0]);
+    std::unique_lock<Mutex> lh(mutexes[0]);
     VisitorTracker vt(&visitors);
     lh.unlock();
 
@@ -957,7 +1033,7 @@ std::unique_ptr<Item> HashTable::getRandomKeyFromSlot(int slot) {
 }
 
 bool HashTable::unlocked_restoreValue(
-        const std::unique_lock<std::mutex>& htLock,
+        const std::unique_lock<Mutex>& htLock,
         const Item& itm,
         StoredValue& v) {
     if (!htLock || !isActive() || v.isResident()) {
@@ -979,7 +1055,7 @@ bool HashTable::unlocked_restoreValue(
     return true;
 }
 
-void HashTable::unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
+void HashTable::unlocked_restoreMeta(const std::unique_lock<Mutex>& htLock,
                                      const Item& itm,
                                      StoredValue& v) {
     if (!htLock) {
@@ -18,7 +18,10 @@
 #pragma once
 
 #include "config.h"
+#include "collections/collections_types.h"
+#include "instrumented_mutex.h"
 #include "probabilistic_counter.h"
+#include "sharded_rwlock.h"
 #include "stored-value.h"
 #include "storeddockey.h"
 
@@ -27,6 +30,7 @@
 
 #include <array>
 #include <functional>
+#include <unordered_map>
 
 class AbstractStoredValueFactory;
 class HashTableVisitor;
@@ -257,6 +261,7 @@ public:
             bool isTempItem = false;
             bool isSystemItem = false;
             bool isPreparedSyncWrite = false;
+            CollectionID collection = CollectionID::Default;
         };
 
         /**
@@ -344,7 +349,33 @@ public:
             return uncompressedMemSize;
         }
 
+        /// @return true if the memory of each collection is being counted.
+        bool isCollectionMemTracked() const {
+            return collectionMemTracked.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Start counting the memory of each collection (from the given
+         * memory already used by each collection), or stop counting it.
+         * Must be called with every hash bucket lock held, so no item can
+         * change size concurrently.
+         */
+        void setCollectionMemTracking(bool enabled,
+                                      Collections::Summary initial);
+
+        /// @return memory consumed by the items of the given collection.
+        size_t getCollectionMemSize(CollectionID collection) const;
+
+        /**
+         * Add the memory consumed by the items of each collection into the
+         * given summary (summing with any existing value).
+         */
+        void updateCollectionMemSummary(Collections::Summary& summary) const;
+
     private:
+        /// Apply delta to the memory consumed by the given collection.
+        void updateCollectionMemSize(CollectionID collection, int64_t delta);
+
         /// Count of alive & deleted, in-memory non-resident and resident items.
         /// Excludes temporary items.
         cb::NonNegativeCounter<size_t> numItems;
@@ -386,9 +417,24 @@ public:
         /// Memory consumed if the items were uncompressed.
         std::atomic<size_t> uncompressedMemSize = {};
 
+        /**
+         * Memory consumed by the items of each collection (the same measure
+         * as memSize). Only maintained while collectionMemTracked is set, as
+         * it adds a lock and lookup to every item size change. Entries are
+         * only added (under the exclusive lock); updates of an existing
+         * entry only need the shared lock.
+         */
+        std::unordered_map<CollectionID, cb::NonNegativeCounter<size_t>>
+                collectionMemSize;
+        mutable ShardedRWLock collectionMemSizeLock;
+        std::atomic<bool> collectionMemTracked{false};
+
         EPStats& epStats;
     };
 
+    /// Type of the hash bucket locks; see instrumented_mutex.h
+    using Mutex = InstrumentedMutex<std::mutex, LockSite::HashBucket>;
+
     /**
      * Represents a locked hash bucket that provides RAII semantics for the lock
      *
@@ -400,7 +446,7 @@ public:
         HashBucketLock()
             : bucketNum(-1) {}
 
-        HashBucketLock(int bucketNum, std::mutex& mutex)
+        HashBucketLock(int bucketNum, Mutex& mutex)
             : bucketNum(bucketNum), htLock(mutex) {
         }
 
@@ -414,17 +460,17 @@ public:
             return bucketNum;
         }
 
-        const std::unique_lock<std::mutex>& getHTLock() const {
+        const std::unique_lock<Mutex>& getHTLock() const {
             return htLock;
         }
 
-        std::unique_lock<std::mutex>& getHTLock() {
+        std::unique_lock<Mutex>& getHTLock() {
             return htLock;
         }
 
     private:
         int bucketNum;
-        std::unique_lock<std::mutex> htLock;
+        std::unique_lock<Mutex> htLock;
     };
 
     /**
@@ -445,7 +491,7 @@ public:
     size_t memorySize() {
         return sizeof(HashTable)
             + (size * sizeof(StoredValue*))
-            + (mutexes.size() * sizeof(std::mutex));
+            + (mutexes.size() * sizeof(Mutex));
     }
 
     /**
@@ -561,6 +607,33 @@ public:
         return valueStats.getUncompressedMemSize();
     }
 
+    /**
+     * Enable or disable counting the item memory of each collection (see
+     * getCollectionItemMemory). The counts are only needed while collections
+     * have memory quotas, and maintaining them adds a lookup to every item
+     * size change.
+     *
+     * Enabling counts the memory of the items already in the table, holding
+     * every hash bucket lock while it does so.
+     */
+    void setCollectionMemoryTracking(bool enabled);
+
+    /**
+     * Get the item memory size of the given collection in this hash table
+     * (zero unless setCollectionMemoryTracking() has enabled counting it).
+     */
+    size_t getCollectionItemMemory(CollectionID collection) const {
+        return valueStats.getCollectionMemSize(collection);
+    }
+
+    /**
+     * Add the item memory size of every collection in this hash table into
+     * summary.
+     */
+    void updateCollectionMemorySummary(Collections::Summary& summary) const {
+        valueStats.updateCollectionMemSummary(summary);
+    }
+
     /**
      * Clear the hash table.
      *
@@ -946,7 +1019,7 @@ public:
      *
      * @return true if restored; else false
      */
-    bool unlocked_restoreValue(const std::unique_lock<std::mutex>& htLock,
+    bool unlocked_restoreValue(const std::unique_lock<Mutex>& htLock,
                                const Item& itm,
                                StoredValue& v);
 
@@ -959,7 +1032,7 @@ public:
      * @param itm the Item whose metadata is being restored
      * @param v corresponding StoredValue
      */
-    void unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
+    void unlocked_restoreMeta(const std::unique_lock<Mutex>& htLock,
                               const Item& itm,
                               StoredValue& v);
 
@@ -1077,7 +1150,7 @@ private:
     // in `values`
     std::atomic<size_t> size;
     table_type values;
-    std::vector<std::mutex> mutexes;
+    std::vector<Mutex> mutexes;
     EPStats&             stats;
     std::unique_ptr<AbstractStoredValueFactory> valFact;
     std::atomic<size_t>       visitors;
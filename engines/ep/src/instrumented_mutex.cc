@@ -0,0 +1,51 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "instrumented_mutex.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace {
+std::array<LockSiteHistograms, NumLockSites> lockSiteHistograms;
+} // namespace
+
+std::string to_string(LockSite site) {
+    switch (site) {
+    case LockSite::HashBucket:
+        return "hash_bucket";
+    case LockSite::CheckpointQueue:
+        return "checkpoint_queue";
+    case LockSite::VBucketState:
+        return "vbucket_state";
+    case LockSite::CollectionsManifest:
+        return "collections_manifest";
+    }
+    throw std::invalid_argument("to_string(LockSite): invalid site " +
+                                std::to_string(int(site)));
+}
+
+LockSiteHistograms& getLockSiteHistograms(LockSite site) {
+    return lockSiteHistograms[size_t(site)];
+}
+
+void resetLockSiteHistograms() {
+    for (auto& histograms : lockSiteHistograms) {
+        histograms.wait.reset();
+        histograms.hold.reset();
+    }
+}
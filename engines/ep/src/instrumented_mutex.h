@@ -0,0 +1,204 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Lock-wait instrumentation for the hottest ep-engine locks.
+ *
+ * When ep-engine is built with EP_INSTRUMENT_LOCKS (cmake option of the same
+ * name) every acquisition of an instrumented lock records how long the caller
+ * waited for it and how long it was then held, in a pair of histograms per
+ * LockSite. The histograms are reported by "cbstats locks".
+ *
+ * In a normal build InstrumentedMutex and InstrumentedRWLock are aliases of
+ * the underlying lock type and LockSiteTimer does nothing, so there is no
+ * cost when the instrumentation is disabled.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <platform/histogram.h>
+#include <platform/rwlock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * The locks which are instrumented. Each site aggregates every lock of its
+ * kind in the process (e.g. all HashTable bucket locks of every vBucket of
+ * every bucket).
+ */
+enum class LockSite : uint8_t {
+    /// HashTable::HashBucketLock
+    HashBucket,
+    /// CheckpointManager::queueLock
+    CheckpointQueue,
+    /// VBucket::stateLock
+    VBucketState,
+    /// Collections::VB::Manifest lock (read and write handles)
+    CollectionsManifest
+};
+
+constexpr size_t NumLockSites = size_t(LockSite::CollectionsManifest) + 1;
+
+std::string to_string(LockSite site);
+
+/// How long callers waited for, and then held, the locks of one LockSite.
+struct LockSiteHistograms {
+    MicrosecondHistogram wait;
+    MicrosecondHistogram hold;
+};
+
+/// @return the (process-wide) histograms of the given site.
+LockSiteHistograms& getLockSiteHistograms(LockSite site);
+
+/// Reset the histograms of every site.
+void resetLockSiteHistograms();
+
+/**
+ * Times a single acquisition of a lock at a LockSite: constructing the timer
+ * starts the wait, acquired() records the wait and starts the hold and
+ * released() (or destruction / move-assignment) records the hold.
+ *
+ * A default constructed timer is inactive and records nothing. When
+ * EP_INSTRUMENT_LOCKS is not defined every member is a no-op.
+ */
+class LockSiteTimer {
+public:
+    LockSiteTimer() = default;
+
+#ifdef EP_INSTRUMENT_LOCKS
+    explicit LockSiteTimer(LockSite site)
+        : site(site),
+          state(State::Waiting),
+          start(std::chrono::steady_clock::now()) {
+    }
+
+    LockSiteTimer(LockSiteTimer&& other)
+        : site(other.site), state(other.state), start(other.start) {
+        other.state = State::Inactive;
+    }
+
+    LockSiteTimer& operator=(LockSiteTimer&& other) {
+        if (this != &other) {
+            released();
+            site = other.site;
+            state = other.state;
+            start = other.start;
+            other.state = State::Inactive;
+        }
+        return *this;
+    }
+
+    ~LockSiteTimer() {
+        released();
+    }
+
+    void acquired() {
+        if (state == State::Waiting) {
+            const auto now = std::chrono::steady_clock::now();
+            getLockSiteHistograms(site).wait.add(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            now - start));
+            state = State::Held;
+            start = now;
+        }
+    }
+
+    void released() {
+        if (state == State::Held) {
+            getLockSiteHistograms(site).hold.add(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start));
+        }
+        state = State::Inactive;
+    }
+
+private:
+    enum class State : uint8_t { Inactive, Waiting, Held };
+
+    LockSite site = LockSite::HashBucket;
+    State state = State::Inactive;
+    std::chrono::steady_clock::time_point start;
+#else
+    explicit LockSiteTimer(LockSite) {
+    }
+
+    void acquired() {
+    }
+
+    void released() {
+    }
+#endif
+};
+
+#ifdef EP_INSTRUMENT_LOCKS
+/**
+ * A Lockable wrapper around Mutex which records the wait and hold time of
+ * every acquisition against Site. Usable with any of the std lock holders
+ * (std::lock_guard, std::unique_lock, ...).
+ *
+ * The hold timer lives in the mutex itself; that is safe as only the owner
+ * of the lock touches it.
+ */
+template <class Mutex, LockSite Site>
+class InstrumentedMutex {
+public:
+    void lock() {
+        LockSiteTimer timer(Site);
+        mutex.lock();
+        timer.acquired();
+        holdTimer = std::move(timer);
+    }
+
+    bool try_lock() {
+        if (!mutex.try_lock()) {
+            return false;
+        }
+        LockSiteTimer timer(Site);
+        timer.acquired();
+        holdTimer = std::move(timer);
+        return true;
+    }
+
+    void unlock() {
+        // Must record before unlocking; the next owner reuses holdTimer.
+        holdTimer.released();
+        mutex.unlock();
+    }
+
+private:
+    Mutex mutex;
+    LockSiteTimer holdTimer;
+};
+
+/**
+ * A cb::RWLock tagged with its LockSite. ReaderLockHolder and
+ * WriterLockHolder time their acquisitions of an InstrumentedRWLock (shared
+ * holders each have their own hold time, so it cannot be kept in the lock).
+ */
+template <LockSite Site>
+class InstrumentedRWLock : public cb::RWLock {};
+#else
+template <class Mutex, LockSite Site>
+using InstrumentedMutex = Mutex;
+
+template <LockSite Site>
+using InstrumentedRWLock = cb::RWLock;
+#endif
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "io_budget.h"
+
+#include <algorithm>
+
+constexpr std::chrono::milliseconds IOBudget::maxBurst;
+
+IOBudget::IOBudget(size_t bytesPerSec, size_t opsPerSec)
+    : bytesPerSec(bytesPerSec), opsPerSec(opsPerSec) {
+}
+
+void IOBudget::charge(size_t bytes) {
+    if (isLimited()) {
+        reserve(bytes, Clock::now());
+    }
+}
+
+IOBudget::Clock::time_point IOBudget::getAvailableTime() {
+    const size_t byteLimit = bytesPerSec;
+    const size_t opLimit = opsPerSec;
+
+    std::lock_guard<std::mutex> lh(mutex);
+    auto ret = Clock::time_point::min();
+    if (byteLimit != 0) {
+        ret = std::max(ret, nextByteTime);
+    }
+    if (opLimit != 0) {
+        ret = std::max(ret, nextOpTime);
+    }
+    return ret;
+}
+
+IOBudget::Clock::time_point IOBudget::reserve(size_t bytes,
+                                              Clock::time_point now) {
+    const size_t byteLimit = bytesPerSec;
+    const size_t opLimit = opsPerSec;
+
+    std::lock_guard<std::mutex> lh(mutex);
+    auto start = now;
+    if (byteLimit != 0) {
+        start = std::max(start,
+                         reserve(nextByteTime,
+                                 now,
+                                 double(bytes) / double(byteLimit)));
+    }
+    if (opLimit != 0) {
+        start = std::max(start,
+                         reserve(nextOpTime, now, 1.0 / double(opLimit)));
+    }
+    return start;
+}
+
+IOBudget::Clock::time_point IOBudget::reserve(Clock::time_point& next,
+                                              Clock::time_point now,
+                                              double cost) {
+    const auto start = std::max(next, now - maxBurst);
+    next = start + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double>(cost));
+    return start;
+}
@@ -0,0 +1,100 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/**
+ * A budget of disk I/O, in bytes per second and I/O operations per second,
+ * shared by all of the users charging I/O against it (for example all the
+ * compactions of a bucket running in parallel).
+ *
+ * Each I/O is charged via charge(), which never blocks (the I/O may be
+ * issued with locks held). Instead, users wait until getAvailableTime()
+ * before starting their next batch of I/O (for example the next
+ * compaction), which keeps the average rate within the budget. Budget
+ * left unused is allowed to accumulate for up to maxBurst, so short pauses
+ * in I/O do not immediately cost throughput.
+ *
+ * A limit of zero means that dimension is unlimited.
+ */
+class IOBudget {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// How much unused budget may accumulate.
+    static constexpr std::chrono::milliseconds maxBurst{100};
+
+    IOBudget(size_t bytesPerSec = 0, size_t opsPerSec = 0);
+
+    void setBytesPerSec(size_t value) {
+        bytesPerSec = value;
+    }
+
+    size_t getBytesPerSec() const {
+        return bytesPerSec;
+    }
+
+    void setOpsPerSec(size_t value) {
+        opsPerSec = value;
+    }
+
+    size_t getOpsPerSec() const {
+        return opsPerSec;
+    }
+
+    /// @return true if either dimension of the budget is limited.
+    bool isLimited() const {
+        return bytesPerSec != 0 || opsPerSec != 0;
+    }
+
+    /// Charge one I/O of the given size against the budget.
+    void charge(size_t bytes);
+
+    /**
+     * @return the time at which all of the I/O charged so far fits within
+     *         the budget, and so further I/O may start.
+     */
+    Clock::time_point getAvailableTime();
+
+    /**
+     * Charge one I/O of the given size against the budget.
+     *
+     * @return the time at which the I/O may proceed.
+     */
+    Clock::time_point reserve(size_t bytes, Clock::time_point now);
+
+private:
+    /**
+     * Reserve `cost` seconds of the timeline tracked by `next`.
+     * @return the time the reservation starts.
+     */
+    static Clock::time_point reserve(Clock::time_point& next,
+                                     Clock::time_point now,
+                                     double cost);
+
+    std::atomic<size_t> bytesPerSec;
+    std::atomic<size_t> opsPerSec;
+
+    std::mutex mutex;
+    /// When the next byte / operation of budget becomes available.
+    Clock::time_point nextByteTime;
+    Clock::time_point nextOpTime;
+};
@@ -154,8 +154,14 @@ public:
         return ret;
     }
 
-    /* Snappy compress value and update datatype */
-    bool compressValue();
+    /**
+     * Snappy compress value and update datatype
+     *
+     * @param minCompressionRatio the value is only replaced if the
+     *        compressed size is no more than this fraction of the original
+     *        size
+     */
+    bool compressValue(float minCompressionRatio = 1.0f);
 
     /* Snappy uncompress value and update datatype */
     bool decompressValue();
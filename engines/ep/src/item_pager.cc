@@ -19,6 +19,7 @@
 
 #include "bucket_logger.h"
 #include "checkpoint_manager.h"
+#include "collections/manager.h"
 #include "connmap.h"
 #include "dcp/dcpconnmap.h"
 #include "ep_engine.h"
@@ -43,6 +44,34 @@
 #include <phosphor/phosphor.h>
 #include <memory>
 
+/**
+ * @return the collections whose item memory (summed over all vBuckets)
+ *         exceeds their memory quota, mapped to the number of bytes over.
+ */
+static Collections::Summary getCollectionsOverMemoryQuota(KVBucket& bucket) {
+    const auto quotas = bucket.getCollectionsManager().getMemoryQuotas();
+
+    // The memory of each collection is only counted while there are quotas
+    // to compare it against.
+    Collections::Summary memUsed;
+    for (auto vbid : bucket.getVBuckets().getBuckets()) {
+        auto vb = bucket.getVBucket(vbid);
+        if (vb) {
+            vb->ht.setCollectionMemoryTracking(!quotas.empty());
+            vb->ht.updateCollectionMemorySummary(memUsed);
+        }
+    }
+
+    Collections::Summary overQuota;
+    for (const auto& quota : quotas) {
+        auto used = memUsed.find(quota.first);
+        if (used != memUsed.end() && used->second > quota.second) {
+            overQuota[quota.first] = used->second - quota.second;
+        }
+    }
+    return overQuota;
+}
+
 ItemPager::ItemPager(EventuallyPersistentEngine& e, EPStats& st)
     : GlobalTask(&e, TaskId::ItemPager, 10, false),
       engine(e),
@@ -169,6 +198,31 @@ bool ItemPager::run(void) {
                 cfg.getItemEvictionFreqCounterAgeThreshold(),
                 evictionPolicy);
 
+        // Collections over their memory quota are paged before any other
+        // collection: if there are any, this run only evicts from them.
+        Collections::Summary overQuota;
+        if (!lastRunWasCollectionQuotaPass) {
+            overQuota = getCollectionsOverMemoryQuota(*kvBucket);
+        }
+        lastRunWasCollectionQuotaPass = !overQuota.empty();
+        if (lastRunWasCollectionQuotaPass) {
+            EP_LOG_DEBUG("Paging {} collection(s) over their memory quota",
+                         overQuota.size());
+            // Quota pass visits every vbucket we may evict from, regardless
+            // of phase (ephemeral doesn't evict from replica vbuckets).
+            VBucketFilter quotaFilter;
+            if (isEphemeral) {
+                for (auto state :
+                     {vbucket_state_active, vbucket_state_pending}) {
+                    for (auto vb : kvBucket->getVBucketsInState(state)) {
+                        quotaFilter.addVBucket(vb);
+                    }
+                }
+            }
+            pv->setVBucketFilter(std::move(quotaFilter));
+            pv->setCollectionsOverQuota(std::move(overQuota));
+        }
+
         // p99.99 is ~200ms
         const auto maxExpectedDurationForVisitorTask =
                 std::chrono::milliseconds(200);
@@ -96,6 +96,13 @@ private:
 
     /// atomic bool used in the task's run trigger
     std::atomic<bool> notified;
+
+    /**
+     * True if the previous run only paged collections which were over their
+     * memory quota; the next run then pages normally so that memory is still
+     * reclaimed if those collections cannot be reduced further.
+     */
+    bool lastRunWasCollectionQuotaPass = false;
 };
 
 /**
@@ -592,6 +592,7 @@ void KVBucket::logRunTime(TaskId taskType,
 ENGINE_ERROR_CODE KVBucket::set(Item& itm,
                                 const void* cookie,
                                 cb::StoreIfPredicate predicate) {
+    const auto start = takeOperationStart(cookie);
     VBucketPtr vb = getVBucket(itm.getVBucketId());
     if (!vb) {
         ++stats.numNotMyVBuckets;
@@ -632,12 +633,16 @@ ENGINE_ERROR_CODE KVBucket::set(Item& itm,
         // maybe need to adjust expiry of item
         cHandle.processExpiryTime(itm, getMaxTtl());
 
-        return vb->set(itm, cookie, engine, predicate, cHandle);
+        auto rv = vb->set(itm, cookie, engine, predicate, cHandle);
+        recordOperation(
+                *vb, cHandle, OperationStats::Op::Store, rv, cookie, start);
+        return rv;
     }
 }
 
 ENGINE_ERROR_CODE KVBucket::add(Item &itm, const void *cookie)
 {
+    const auto start = takeOperationStart(cookie);
     VBucketPtr vb = getVBucket(itm.getVBucketId());
     if (!vb) {
         ++stats.numNotMyVBuckets;
@@ -680,13 +685,17 @@ ENGINE_ERROR_CODE KVBucket::add(Item &itm, const void *cookie)
 
         // maybe need to adjust expiry of item
         cHandle.processExpiryTime(itm, getMaxTtl());
-        return vb->add(itm, cookie, engine, cHandle);
+        auto rv = vb->add(itm, cookie, engine, cHandle);
+        recordOperation(
+                *vb, cHandle, OperationStats::Op::Store, rv, cookie, start);
+        return rv;
     }
 }
 
 ENGINE_ERROR_CODE KVBucket::replace(Item& itm,
                                     const void* cookie,
                                     cb::StoreIfPredicate predicate) {
+    const auto start = takeOperationStart(cookie);
     VBucketPtr vb = getVBucket(itm.getVBucketId());
     if (!vb) {
         ++stats.numNotMyVBuckets;
@@ -718,7 +727,10 @@ ENGINE_ERROR_CODE KVBucket::replace(Item& itm,
 
         // maybe need to adjust expiry of item
         cHandle.processExpiryTime(itm, getMaxTtl());
-        return vb->replace(itm, cookie, engine, predicate, cHandle);
+        auto rv = vb->replace(itm, cookie, engine, predicate, cHandle);
+        recordOperation(
+                *vb, cHandle, OperationStats::Op::Store, rv, cookie, start);
+        return rv;
     }
 }
 
@@ -1335,6 +1347,11 @@ GetValue KVBucket::getInternal(const DocKey& key,
                                const void* cookie,
                                vbucket_state_t allowedState,
                                get_options_t options) {
+    // Only front end gets track statistics; other callers may be using the
+    // cookie's engine-specific data for their own purposes.
+    const auto start = (options & TRACK_STATISTICS)
+                               ? takeOperationStart(cookie)
+                               : std::chrono::steady_clock::now();
     vbucket_state_t disallowedState = (allowedState == vbucket_state_active) ?
         vbucket_state_replica : vbucket_state_active;
     VBucketPtr vb = getVBucket(vbucket);
@@ -1375,12 +1392,21 @@ GetValue KVBucket::getInternal(const DocKey& key,
             return GetValue(NULL, ENGINE_UNKNOWN_COLLECTION);
         }
 
-        return vb->getInternal(cookie,
-                               engine,
-                               options,
-                               diskDeleteAll,
-                               VBucket::GetKeyOnly::No,
-                               cHandle);
+        auto gv = vb->getInternal(cookie,
+                                  engine,
+                                  options,
+                                  diskDeleteAll,
+                                  VBucket::GetKeyOnly::No,
+                                  cHandle);
+        if (options & TRACK_STATISTICS) {
+            recordOperation(*vb,
+                            cHandle,
+                            OperationStats::Op::Get,
+                            gv.getStatus(),
+                            cookie,
+                            start);
+        }
+        return gv;
     }
 }
 
@@ -1699,6 +1725,7 @@ ENGINE_ERROR_CODE KVBucket::deleteItem(
         boost::optional<cb::durability::Requirements> durability,
         ItemMetaData* itemMeta,
         mutation_descr_t& mutInfo) {
+    const auto start = takeOperationStart(cookie);
     VBucketPtr vb = getVBucket(vbucket);
     if (!vb || vb->getState() == vbucket_state_dead) {
         ++stats.numNotMyVBuckets;
@@ -1728,8 +1755,11 @@ ENGINE_ERROR_CODE KVBucket::deleteItem(
             return ENGINE_UNKNOWN_COLLECTION;
         }
 
-        return vb->deleteItem(
+        auto rv = vb->deleteItem(
                 cas, cookie, engine, durability, itemMeta, mutInfo, cHandle);
+        recordOperation(
+                *vb, cHandle, OperationStats::Op::Delete, rv, cookie, start);
+        return rv;
     }
 }
 
@@ -2043,6 +2073,96 @@ void KVBucket::setAllBloomFilters(bool to) {
     }
 }
 
+void KVBucket::recordOperation(
+        VBucket& vb,
+        const Collections::VB::Manifest::CachingReadHandle& cHandle,
+        OperationStats::Op op,
+        ENGINE_ERROR_CODE status,
+        const void* cookie,
+        std::chrono::steady_clock::time_point start) {
+    if (status == ENGINE_EWOULDBLOCK) {
+        // Recorded when the operation is retried (or the SyncWrite
+        // completes), timed from when it started.
+        stashOperationStart(cookie, start, false);
+        return;
+    }
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    vb.opStats.record(op, latency);
+    collectionsManager->getOperationStats(cHandle).record(op, latency);
+}
+
+/*
+ * The start of a blocked operation is stored in the engine-specific pointer
+ * itself, so nothing needs freeing if the operation is never retried. The
+ * time since the steady_clock epoch is shifted left by two: bit 1 is always
+ * set, telling it apart from the (aligned) pointers other commands store,
+ * and bit 0 marks a SyncWrite waiting for durability.
+ */
+static constexpr uintptr_t operationStartTag = 0x2;
+static constexpr uintptr_t syncWritePendingTag = 0x1;
+
+static_assert(sizeof(uintptr_t) >= sizeof(std::chrono::steady_clock::rep),
+              "The operation start time must fit in a pointer");
+
+std::chrono::steady_clock::time_point KVBucket::takeOperationStart(
+        const void* cookie) {
+    if (cookie) {
+        const auto stashed =
+                reinterpret_cast<uintptr_t>(engine.getEngineSpecific(cookie));
+        if (stashed & operationStartTag) {
+            engine.storeEngineSpecific(cookie, nullptr);
+            return std::chrono::steady_clock::time_point(
+                    std::chrono::steady_clock::duration(stashed >> 2));
+        }
+    }
+    return std::chrono::steady_clock::now();
+}
+
+void KVBucket::stashOperationStart(const void* cookie,
+                                   std::chrono::steady_clock::time_point start,
+                                   bool syncWrite) {
+    if (cookie) {
+        const auto stashed =
+                (uintptr_t(start.time_since_epoch().count()) << 2) |
+                operationStartTag | (syncWrite ? syncWritePendingTag : 0);
+        engine.storeEngineSpecific(cookie, reinterpret_cast<void*>(stashed));
+    }
+}
+
+void KVBucket::clearOperationStart(const void* cookie) {
+    const auto stashed =
+            reinterpret_cast<uintptr_t>(engine.getEngineSpecific(cookie));
+    if (stashed & operationStartTag) {
+        engine.storeEngineSpecific(cookie, nullptr);
+    }
+}
+
+void KVBucket::setSyncWritePending(const void* cookie) {
+    stashOperationStart(cookie, takeOperationStart(cookie), true);
+}
+
+bool KVBucket::isSyncWritePending(const void* cookie) {
+    const auto stashed =
+            reinterpret_cast<uintptr_t>(engine.getEngineSpecific(cookie));
+    return (stashed & operationStartTag) && (stashed & syncWritePendingTag);
+}
+
+void KVBucket::completeSyncWrite(const void* cookie,
+                                 Vbid vbid,
+                                 const DocKey& key,
+                                 OperationStats::Op op) {
+    const auto start = takeOperationStart(cookie);
+    VBucketPtr vb = getVBucket(vbid);
+    if (!vb) {
+        return;
+    }
+    auto cHandle = vb->lockCollections(key);
+    if (cHandle.valid()) {
+        recordOperation(*vb, cHandle, op, ENGINE_SUCCESS, cookie, start);
+    }
+}
+
 void KVBucket::visit(VBucketVisitor &visitor)
 {
     for (auto vbid : vbMap.getBuckets()) {
@@ -626,6 +626,33 @@ public:
 
     const Collections::Manager& getCollectionsManager() const;
 
+    /**
+     * Record that the given cookie's SyncWrite is blocked waiting for
+     * durability; the next call to store (or delete) for the cookie returns
+     * its result (see isSyncWritePending()). Uses the cookie's engine-specific
+     * data, which also holds when the SyncWrite started.
+     */
+    void setSyncWritePending(const void* cookie);
+
+    /// @return true if setSyncWritePending() was called for the cookie
+    bool isSyncWritePending(const void* cookie);
+
+    /**
+     * Forget the start of the given cookie's blocked operation (or its
+     * pending SyncWrite). Used when the operation fails while blocked, as
+     * the front-end won't retry it.
+     */
+    void clearOperationStart(const void* cookie);
+
+    /**
+     * Clear the pending SyncWrite of the given cookie, and record it against
+     * the operation stats of its vBucket and collection.
+     */
+    void completeSyncWrite(const void* cookie,
+                           Vbid vbid,
+                           const DocKey& key,
+                           OperationStats::Op op);
+
     bool isXattrEnabled() const;
 
     void setXattrEnabled(bool value);
@@ -694,6 +721,42 @@ protected:
      */
     SyncWriteCompleteCallback makeSyncWriteCompleteCB();
 
+    /**
+     * Record a completed front-end operation against the operation stats of
+     * the vBucket and collection it accessed. Operations which returned
+     * EWOULDBLOCK are recorded when they're retried (or, for SyncWrites,
+     * completed); their start is kept until then by stashOperationStart().
+     *
+     * @param cHandle the collections handle of the operation's key
+     * @param start when the operation started (see takeOperationStart())
+     */
+    void recordOperation(
+            VBucket& vb,
+            const Collections::VB::Manifest::CachingReadHandle& cHandle,
+            OperationStats::Op op,
+            ENGINE_ERROR_CODE status,
+            const void* cookie,
+            std::chrono::steady_clock::time_point start);
+
+    /**
+     * @return when the given cookie's front-end operation started: the time
+     *         kept by stashOperationStart() if it was blocked (which is
+     *         cleared), otherwise now.
+     */
+    std::chrono::steady_clock::time_point takeOperationStart(
+            const void* cookie);
+
+    /**
+     * Keep the start of the given cookie's blocked operation in its
+     * engine-specific data, until it's retried.
+     *
+     * @param syncWrite true if the operation is a SyncWrite waiting for
+     *        durability (see setSyncWritePending())
+     */
+    void stashOperationStart(const void* cookie,
+                             std::chrono::steady_clock::time_point start,
+                             bool syncWrite);
+
     friend class Warmup;
     friend class PersistenceCallback;
 
@@ -31,6 +31,7 @@
 #include <chrono>
 #include <cstring>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <string>
@@ -40,6 +41,7 @@
 /* Forward declarations */
 class BucketLogger;
 class DiskDocKey;
+class IOBudget;
 class Item;
 class KVStore;
 class KVStoreConfig;
@@ -131,6 +133,23 @@ struct compaction_ctx {
     /// pointer as context cannot be constructed until deeper inside storage
     std::unique_ptr<Collections::VB::EraserContext> eraserContext;
     Collections::KVStore::DroppedCb droppedKeyCb;
+    /// If non-null, the disk I/O of the compaction is charged against it.
+    IOBudget* ioBudget = nullptr;
+    /**
+     * If set, polled while the compaction runs; returning true abandons
+     * the compaction, leaving the original file in place (for example as
+     * the vBucket is being moved away or the bucket is shutting down).
+     */
+    std::function<bool()> isCancelled;
+    /**
+     * Set by another thread to ask for the compaction to be abandoned (for
+     * example when its vBucket is being deleted); checked by isCancelled.
+     */
+    std::atomic<bool> cancelRequested{false};
+    /// Set if the compaction was abandoned because isCancelled returned true.
+    bool cancelled = false;
+    /// Documents visited by the compaction (used to pace isCancelled polls).
+    size_t docsVisited = 0;
 };
 
 /**
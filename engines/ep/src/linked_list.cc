@@ -24,7 +24,7 @@
 
 BasicLinkedList::BasicLinkedList(Vbid vbucketId, EPStats& st)
     : SequenceList(),
-      readRange(0, 0),
+      purgeRange(0, 0),
       staleSize(0),
       staleMetaDataSize(0),
       highSeqno(0),
@@ -54,6 +54,7 @@ BasicLinkedList::~BasicLinkedList() {
     /* Erase all the list elements (does not destroy elements, just removes
        them from the list) */
     seqList.clear();
+    seqnoIndex.clear();
 }
 
 void BasicLinkedList::appendToList(std::lock_guard<std::mutex>& seqLock,
@@ -66,10 +67,11 @@ SequenceList::UpdateStatus BasicLinkedList::updateListElem(
         std::lock_guard<std::mutex>& seqLock,
         std::lock_guard<std::mutex>& writeLock,
         OrderedStoredValue& v) {
-    /* Lock that needed for consistent read of SeqRange 'readRange' */
+    /* Lock that needed for consistent read of the read and purge ranges */
     std::lock_guard<SpinLock> lh(rangeLock);
 
-    if (readRange.fallsInRange(v.getBySeqno())) {
+    if (isInReadRange(lh, v.getBySeqno()) ||
+        purgeRange.fallsInRange(v.getBySeqno())) {
         /* Range read is in middle of a point-in-time snapshot, hence we cannot
            move the element to the end of the list. Return a temp failure */
         return UpdateStatus::Append;
@@ -77,6 +79,7 @@ SequenceList::UpdateStatus BasicLinkedList::updateListElem(
 
     /* Since there is no other reads or writes happenning in this range, we can
        move the item to the end of the list */
+    removeFromSeqnoIndex(v);
     auto it = seqList.iterator_to(v);
     /* If the list is being updated at 'pausedPurgePoint', then we must save
        the new 'pausedPurgePoint' */
@@ -101,9 +104,8 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
         return std::make_tuple(ENGINE_ERANGE, std::vector<UniqueItemPtr>(), 0);
     }
 
-    /* Allows only 1 rangeRead for now */
-    std::lock_guard<std::mutex> lckGd(rangeReadLock);
-
+    ReadRangeHandle rangeHandle;
+    OrderedLL::iterator startIt;
     {
         std::lock_guard<std::mutex> listWriteLg(getListWriteLock());
         std::lock_guard<SpinLock> lh(rangeLock);
@@ -123,13 +125,17 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
         /* Mark the initial read range */
         end = std::min(end, static_cast<seqno_t>(highSeqno));
         end = std::max(end, static_cast<seqno_t>(highestDedupedSeqno));
-        readRange = SeqRange(1, end);
+        rangeHandle = registerReadRange(lh, SeqRange(start, end));
+
+        /* Items before 'start' are not needed, begin at the first one after */
+        startIt = seek(listWriteLg, start);
     }
 
     /* Read items in the range */
     std::vector<UniqueItemPtr> items;
 
-    for (const auto& osv : seqList) {
+    for (auto it = startIt; it != seqList.end(); ++it) {
+        const auto& osv = *it;
         int64_t currSeqno(osv.getBySeqno());
 
         if (currSeqno > end || currSeqno < 0) {
@@ -140,14 +146,9 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
 
         {
             std::lock_guard<SpinLock> lh(rangeLock);
-            readRange.setBegin(currSeqno); /* [EPHE TODO]: should we
-                                                     update the min every time ?
-                                                   */
-        }
-
-        if (currSeqno < start) {
-            /* skip this item */
-            continue;
+            rangeHandle->setBegin(currSeqno); /* [EPHE TODO]: should we
+                                                 update the min every time ?
+                                               */
         }
 
         /* Check if this OSV has been made stale and has been superseded by a
@@ -177,15 +178,17 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
                     "item with seqno {}before streaming it",
                     vbid,
                     currSeqno);
+            std::lock_guard<SpinLock> lh(rangeLock);
+            unregisterReadRange(lh, rangeHandle);
             return std::make_tuple(
                     ENGINE_ENOMEM, std::vector<UniqueItemPtr>(), 0);
         }
     }
 
-    /* Done with range read, reset the range */
+    /* Done with range read, remove the range */
     {
         std::lock_guard<SpinLock> lh(rangeLock);
-        readRange.reset();
+        unregisterReadRange(lh, rangeHandle);
     }
 
     /* Return all the range read items */
@@ -201,6 +204,14 @@ void BasicLinkedList::updateHighSeqno(std::lock_guard<std::mutex>& listWriteLg,
                 std::to_string(v.getBySeqno()) + " which is < 1");
     }
     highSeqno = v.getBySeqno();
+
+    /* 'v' has just been placed at the end of the list; index it if the last
+       indexed element is far enough behind */
+    if (seqnoIndex.empty() ||
+        v.getBySeqno() >= seqnoIndex.rbegin()->first + seqnoIndexInterval) {
+        seqnoIndex.emplace(v.getBySeqno(),
+                           const_cast<OrderedStoredValue*>(&v));
+    }
 }
 void BasicLinkedList::updateHighestDedupedSeqno(
         std::lock_guard<std::mutex>& listWriteLg, const OrderedStoredValue& v) {
@@ -238,14 +249,18 @@ size_t BasicLinkedList::purgeTombstones(
     // Purge items marked as stale from the seqList.
     //
     // Strategy - we try to ensure that this function does not block
-    // frontend-writes (adding new OrderedStoredValues (OSVs) to the seqList).
-    // To achieve this (safely),
-    // we (try to) acquire the rangeReadLock and setup a 'read' range for the
-    // whole of the seqList. This prevents any other readers from iterating
-    // the list (and accessing stale items) while we purge on it; but permits
-    // front-end operations to continue as they:
+    // frontend-writes (adding new OrderedStoredValues (OSVs) to the seqList)
+    // or range reads.
+    // To achieve this (safely), we setup a 'purge' range for the part of the
+    // seqList we are visiting. This permits front-end operations to continue
+    // as they:
     //   a) Only read/modify non-stale items (we only change stale items) and
-    //   b) Do not change the list membership of anything within the read-range.
+    //   b) Do not change the list membership of anything within the range.
+    // Range reads may run concurrently; an item is only removed if it is
+    // outside every registered read range, i.e. no reader can still visit it
+    // (readers only move forwards, and only read up to the end of their
+    // range). The check and the removal happen under the writeLock, which is
+    // also held when a new range read is registered.
     // However, we do need to be careful about what members of OSVs we access
     // here - the only OSVs we can safely access are ones marked stale as they
     // are no longer in the HashTable (and hence subject to HashTable locks).
@@ -255,13 +270,11 @@ size_t BasicLinkedList::purgeTombstones(
     // release the lock between each element so front-end operations can
     // have the opportunity to acquire it.
     //
-    // Attempt to acquire the readRangeLock, to block anyone else concurrently
-    // reading from the list while we remove elements from it.
-    std::unique_lock<std::mutex> rrGuard(rangeReadLock, std::try_to_lock);
-    if (!rrGuard) {
-        // If we cannot acquire the lock then another thread is
-        // running a range read. Given these are typically long-running,
-        // return without blocking.
+    // Attempt to acquire the purgeLock, only one purge may run at a time.
+    std::unique_lock<std::mutex> purgeGuard(purgeLock, std::try_to_lock);
+    if (!purgeGuard) {
+        // If we cannot acquire the lock then another thread is already
+        // purging; return without blocking.
         return 0;
     }
 
@@ -287,9 +300,9 @@ size_t BasicLinkedList::purgeTombstones(
             return 0;
         }
 
-        // Update readRange
+        // Update purgeRange
         std::lock_guard<SpinLock> rangeGuard(rangeLock);
-        readRange = SeqRange(startIt->getBySeqno(), purgeUpToSeqno);
+        purgeRange = SeqRange(startIt->getBySeqno(), purgeUpToSeqno);
     }
 
     // Iterate across all but the last item in the seqList, looking
@@ -304,10 +317,10 @@ size_t BasicLinkedList::purgeTombstones(
 
         {
             // As we move past the items in the list, increment the begin of
-            // 'readRange' to reduce the window of creating stale items during
+            // 'purgeRange' to reduce the window of creating stale items during
             // updates
             std::lock_guard<SpinLock> rangeGuard(rangeLock);
-            readRange.setBegin(it->getBySeqno());
+            purgeRange.setBegin(it->getBySeqno());
         }
 
         {
@@ -320,10 +333,9 @@ size_t BasicLinkedList::purgeTombstones(
             isDropped = isDroppedKeyCb(it->getKey(), it->getBySeqno());
         }
 
-        // Only stale or dropped items are purged.
-        if (stale || isDropped) {
-            // Checks pass, remove from list and delete.
-            it = purgeListElem(it, stale);
+        // Only stale or dropped items are purged, and only if no range read
+        // can still visit them.
+        if ((stale || isDropped) && purgeListElem(it, stale)) {
             ++purgedCount;
         } else {
             ++it;
@@ -335,10 +347,10 @@ size_t BasicLinkedList::purgeTombstones(
         }
     }
 
-    // Complete; reset the readRange.
+    // Complete; reset the purgeRange.
     {
         std::lock_guard<SpinLock> lh(rangeLock);
-        readRange.reset();
+        purgeRange.reset();
     }
     return purgedCount;
 }
@@ -389,24 +401,79 @@ seqno_t BasicLinkedList::getHighestPurgedDeletedSeqno() const {
 
 uint64_t BasicLinkedList::getRangeReadBegin() const {
     std::lock_guard<SpinLock> lh(rangeLock);
-    return readRange.getBegin();
+    seqno_t begin = purgeRange.getBegin();
+    for (const auto& range : readRanges) {
+        if (begin <= 0 || range.getBegin() < begin) {
+            begin = range.getBegin();
+        }
+    }
+    return begin;
 }
 
 uint64_t BasicLinkedList::getRangeReadEnd() const {
     std::lock_guard<SpinLock> lh(rangeLock);
-    return readRange.getEnd();
+    seqno_t end = purgeRange.getEnd();
+    for (const auto& range : readRanges) {
+        end = std::max(end, range.getEnd());
+    }
+    return end;
 }
 std::mutex& BasicLinkedList::getListWriteLock() const {
     return writeLock;
 }
 
 boost::optional<SequenceList::RangeIterator> BasicLinkedList::makeRangeIterator(
-        bool isBackfill) {
-    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill);
+        bool isBackfill, seqno_t startSeqno) {
+    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill, startSeqno);
     return pRangeItr ? RangeIterator(std::move(pRangeItr))
                      : boost::optional<SequenceList::RangeIterator>{};
 }
 
+BasicLinkedList::ReadRangeHandle BasicLinkedList::registerReadRange(
+        std::lock_guard<SpinLock>& rangeGuard, const SeqRange& range) {
+    return readRanges.insert(readRanges.end(), range);
+}
+
+void BasicLinkedList::unregisterReadRange(std::lock_guard<SpinLock>& rangeGuard,
+                                          ReadRangeHandle handle) {
+    readRanges.erase(handle);
+}
+
+bool BasicLinkedList::isInReadRange(std::lock_guard<SpinLock>& rangeGuard,
+                                    seqno_t seqno) const {
+    for (const auto& range : readRanges) {
+        if (range.fallsInRange(seqno)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+OrderedLL::iterator BasicLinkedList::seek(
+        std::lock_guard<std::mutex>& writeGuard, seqno_t startSeqno) {
+    auto it = seqList.begin();
+
+    /* Start from the highest indexed element at or before startSeqno */
+    auto indexIt = seqnoIndex.upper_bound(startSeqno);
+    if (indexIt != seqnoIndex.begin()) {
+        --indexIt;
+        it = seqList.iterator_to(*indexIt->second);
+    }
+
+    while (it != seqList.end() && it->getBySeqno() > 0 &&
+           it->getBySeqno() < startSeqno) {
+        ++it;
+    }
+    return it;
+}
+
+void BasicLinkedList::removeFromSeqnoIndex(const OrderedStoredValue& v) {
+    auto it = seqnoIndex.find(v.getBySeqno());
+    if (it != seqnoIndex.end() && it->second == &v) {
+        seqnoIndex.erase(it);
+    }
+}
+
 void BasicLinkedList::dump() const {
     std::cerr << *this << std::endl;
 }
@@ -426,11 +493,19 @@ std::ostream& operator <<(std::ostream& os, const BasicLinkedList& ll) {
     return os;
 }
 
-OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
-                                                   bool isStale) {
-    StoredValue::UniquePtr purged(&*it);
+bool BasicLinkedList::purgeListElem(OrderedLL::iterator& it, bool isStale) {
+    StoredValue::UniquePtr purged;
     {
         std::lock_guard<std::mutex> lckGd(getListWriteLock());
+        {
+            std::lock_guard<SpinLock> rangeGuard(rangeLock);
+            if (isInReadRange(rangeGuard, it->getBySeqno())) {
+                /* A range read has yet to visit this element */
+                return false;
+            }
+        }
+        removeFromSeqnoIndex(*it);
+        purged = StoredValue::UniquePtr(&*it);
         it = seqList.erase(it);
     }
 
@@ -451,46 +526,58 @@ OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
         highestPurgedDeletedSeqno = std::max(seqno_t(highestPurgedDeletedSeqno),
                                              purged->getBySeqno());
     }
-    return it;
+    return true;
 }
 
 std::unique_ptr<BasicLinkedList::RangeIteratorLL>
-BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll, bool isBackfill) {
+BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll,
+                                         bool isBackfill,
+                                         seqno_t startSeqno) {
     /* Note: cannot use std::make_unique because the constructor of
        RangeIteratorLL is private */
     std::unique_ptr<BasicLinkedList::RangeIteratorLL> pRangeItr(
-            new BasicLinkedList::RangeIteratorLL(ll, isBackfill));
-    return pRangeItr->tryLater() ? nullptr : std::move(pRangeItr);
+            new BasicLinkedList::RangeIteratorLL(ll, isBackfill, startSeqno));
+
+    /* The first item may be an old version of an item that is updated
+       within the range; skip it like operator++ would */
+    if (pRangeItr->curr() != pRangeItr->end() &&
+        pRangeItr->itrRangeContainsAnUpdatedVersion()) {
+        ++(*pRangeItr);
+    }
+    return pRangeItr;
 }
 
 BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
-                                                  bool isBackfill)
+                                                  bool isBackfill,
+                                                  seqno_t startSeqno)
     : list(ll),
-      /* Try to get range read lock, do not block */
-      readLockHolder(list.rangeReadLock, std::try_to_lock),
+      ownsReadRange(false),
       itrRange(0, 0),
       numRemaining(0),
       earlySnapShotEndSeqno(0),
       isBackfill(isBackfill) {
-    if (!readLockHolder) {
-        /* no blocking */
-        return;
-    }
-
     std::lock_guard<std::mutex> listWriteLg(list.getListWriteLock());
     std::lock_guard<SpinLock> lh(list.rangeLock);
     if (list.highSeqno < 1) {
-        /* No need of holding a lock for the snapshot as there are no items;
+        /* No need of holding a range for the snapshot as there are no items;
            Also iterator range is at default (0, 0) */
-        readLockHolder.unlock();
         return;
     }
 
-    /* Iterator to the beginning of linked list */
-    currIt = list.seqList.begin();
+    /* Iterator to the first item to be read */
+    currIt = list.seek(listWriteLg, std::max(startSeqno, seqno_t(1)));
+    if (currIt == list.seqList.end() || currIt->getBySeqno() < 1) {
+        /* No items at or after startSeqno; iterator range is at default */
+        return;
+    }
+
+    const seqno_t backSeqno = list.seqList.back().getBySeqno();
 
-    /* Number of items that can be iterated over */
-    numRemaining = list.seqList.size();
+    /* Number of items that can be iterated over. Seqnos in the list are
+       unique and increasing, so this is exact when reading from the start of
+       the list and an upper bound otherwise */
+    numRemaining = std::min(uint64_t(list.seqList.size()),
+                            uint64_t(backSeqno - currIt->getBySeqno() + 1));
 
     /* The minimum seqno in the iterator that must be read to get a consistent
        read snapshot */
@@ -498,19 +585,19 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
 
     /* Mark the snapshot range on linked list. The range that can be read by the
        iterator is inclusive of the start and the end. */
-    list.readRange =
-            SeqRange(currIt->getBySeqno(), list.seqList.back().getBySeqno());
+    readRange = list.registerReadRange(
+            lh, SeqRange(currIt->getBySeqno(), backSeqno));
+    ownsReadRange = true;
 
     /* Keep the range in the iterator obj. We store the range end seqno as one
        higher than the end seqno that can be read by this iterator.
        This is because, we must identify the end point of the iterator, and
-       we the read is inclusive of the end points of list.readRange.
+       we the read is inclusive of the end points of the read range.
 
        Further, since use the class 'SeqRange' for 'itrRange' we cannot use
        curr() == end() + 1 to identify the end point because 'SeqRange' does
        not internally allow curr > end */
-    itrRange = SeqRange(currIt->getBySeqno(),
-                        list.seqList.back().getBySeqno() + 1);
+    itrRange = SeqRange(currIt->getBySeqno(), backSeqno + 1);
 
     auto severity = isBackfill ? spdlog::level::level_enum::info
                                : spdlog::level::level_enum::debug;
@@ -523,17 +610,18 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
 }
 
 BasicLinkedList::RangeIteratorLL::~RangeIteratorLL() {
+    releaseReadRange();
+}
+
+void BasicLinkedList::RangeIteratorLL::releaseReadRange() {
     std::lock_guard<SpinLock> lh(list.rangeLock);
-    if (readLockHolder.owns_lock()) {
-        /* we must reset the list readRange only if the list iterator still owns
-           the read lock on the list */
-        list.readRange.reset();
+    if (ownsReadRange) {
+        list.unregisterReadRange(lh, readRange);
+        ownsReadRange = false;
         auto severity = isBackfill ? spdlog::level::level_enum::info
                                    : spdlog::level::level_enum::debug;
         EP_LOG_FMT(severity, "{} Releasing the range iterator", list.vbid);
     }
-    /* As readLockHolder goes out of scope here, it will automatically release
-       the snapshot read lock on the linked list */
 }
 
 OrderedStoredValue& BasicLinkedList::RangeIteratorLL::operator*() const {
@@ -573,15 +661,10 @@ void BasicLinkedList::RangeIteratorLL::incrOperatorHelper() {
     /* Check if the iterator is pointing to the last element. Increment beyond
        the last element indicates the end of the iteration */
     if (curr() == itrRange.getEnd() - 1) {
-        std::lock_guard<SpinLock> lh(list.rangeLock);
-        /* We reset the range and release the readRange lock here so that any
-           iterator client that does not delete the iterator obj will not end up
-           holding the list readRange lock forever */
-        list.readRange.reset();
-        auto severity = isBackfill ? spdlog::level::level_enum::info
-                                   : spdlog::level::level_enum::debug;
-        EP_LOG_FMT(severity, "{} Releasing the range iterator", list.vbid);
-        readLockHolder.unlock();
+        /* We release the read range here so that any iterator client that
+           does not delete the iterator obj will not end up pinning items in
+           the list forever */
+        releaseReadRange();
 
         /* Update the begin to end() so the client can see that the iteration
            has ended */
@@ -595,7 +678,7 @@ void BasicLinkedList::RangeIteratorLL::incrOperatorHelper() {
            linked list. This helps reduce the stale items in the list during
            heavy update load from the front end */
         std::lock_guard<SpinLock> lh(list.rangeLock);
-        list.readRange.setBegin(currIt->getBySeqno());
+        readRange->setBegin(currIt->getBySeqno());
     }
 
     /* Also update the current range stored in the iterator obj */
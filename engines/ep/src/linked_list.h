@@ -33,6 +33,9 @@
 #include <platform/non_negative_counter.h>
 #include <relaxed_atomic.h>
 
+#include <list>
+#include <map>
+
 /* This option will configure "list" to use the member hook */
 using MemberHookOption =
         boost::intrusive::member_hook<OrderedStoredValue,
@@ -131,20 +134,32 @@ private:
  *      BasicLinkedList (invalidate next, prev links) and then delete from the
  *      hashtable.
  *
+ * Concurrent range reads:
+ * ======================
+ * Any number of range reads (rangeRead() and RangeIterators) may be in flight
+ * at once. Each registers its own SeqRange in 'readRanges' and shrinks it as
+ * it moves forward. An element inside any registered range is neither moved
+ * by updateListElem() nor removed by purgeTombstones(); elements that every
+ * reader has already moved past can be purged while the readers continue.
+ *
+ * Range reads which begin part way into the list find their start element
+ * via 'seqnoIndex', a sparse ordered index over the list, rather than by
+ * walking the list from the front.
+ *
  * Ordering/Hierarchy of Locks:
  * ===========================
  * BasicLinkedList has 3 locks namely:
- * (i) writeLock (ii) rangeLock (iii) rangeReadLock
+ * (i) writeLock (ii) rangeLock (iii) purgeLock
  * Description of each lock can be found below in the class declaration, here
  * we describe in what order the locks should be grabbed
  *
- * rangeReadLock ==> writeLock ==> rangeLock is the valid lock hierarchy.
+ * purgeLock ==> writeLock ==> rangeLock is the valid lock hierarchy.
  *
  * Preferred/Expected Lock Duration:
  * ================================
  * 'writeLock' and 'rangeLock' are held for short durations, typically for
  * single list element writes and reads.
- * 'rangeReadLock' is held for longer duration on the list (for entire range).
+ * 'purgeLock' is held for the duration of a purgeTombstones() run.
  */
 class BasicLinkedList : public SequenceList {
 public:
@@ -205,7 +220,7 @@ public:
     std::mutex& getListWriteLock() const override;
 
     boost::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) override;
+            bool isBackfill, seqno_t startSeqno = 1) override;
 
     void dump() const override;
 
@@ -220,34 +235,67 @@ protected:
      */
     mutable std::mutex writeLock;
 
+    /* Handle to a range registered in 'readRanges' by one range read */
+    using ReadRangeHandle = std::list<SeqRange>::iterator;
+
     /**
-     * Used to mark of the range where point-in-time snapshot is happening.
-     * To get a valid point-in-time snapshot and for correct list iteration we
-     * must not de-duplicate an item in the list in this range.
+     * The ranges where point-in-time snapshots are happening, one per range
+     * read in flight. To get a valid point-in-time snapshot and for correct
+     * list iteration we must not de-duplicate (or purge) an item in the list
+     * in any of these ranges.
      */
-    SeqRange readRange;
+    std::list<SeqRange> readRanges;
 
     /**
-     * Lock that protects readRange.
+     * Range of the list currently being visited by purgeTombstones(). Items
+     * in this range are not moved by updateListElem() so the purger's
+     * iterator stays valid, but unlike 'readRanges' it does not pin items
+     * against purging.
+     */
+    SeqRange purgeRange;
+
+    /**
+     * Lock that protects readRanges and purgeRange.
      * We use spinlock here since the lock is held only for very small time
      * periods.
      */
     mutable SpinLock rangeLock;
 
     /**
-     * Lock that serializes range reads on the 'seqList' - i.e. serializes
-     * the addition / removal of range reads from the set in-flight.
-     * We need to serialize range reads because, range reads set a list level
-     * range in which items are read. If we have multiple range reads then we
-     * must handle the races in the updation of the range to have most inclusive
-     * range.
-     * For now we use this lock to allow only one range read at a time.
-     *
-     * It is also additionally used in purgeTombstones() to prevent the
-     * creation of any new rangeReads while purge is in-progress - see
-     * detailed comments there.
+     * Lock that serializes runs of purgeTombstones(); it does not block range
+     * reads.
+     */
+    std::mutex purgeLock;
+
+    /**
+     * Registers a new read range, pinning the items in it.
+     * Caller must hold rangeLock.
+     */
+    ReadRangeHandle registerReadRange(std::lock_guard<SpinLock>& rangeGuard,
+                                      const SeqRange& range);
+
+    /**
+     * Removes a range registered by registerReadRange().
+     * Caller must hold rangeLock.
+     */
+    void unregisterReadRange(std::lock_guard<SpinLock>& rangeGuard,
+                             ReadRangeHandle handle);
+
+    /**
+     * @return true if the seqno falls in any registered read range.
+     * Caller must hold rangeLock.
+     */
+    bool isInReadRange(std::lock_guard<SpinLock>& rangeGuard,
+                       seqno_t seqno) const;
+
+    /**
+     * Returns an iterator to the first element with a seqno >= startSeqno, or
+     * to the first element which has not yet been assigned a seqno (possibly
+     * seqList.end()). Uses 'seqnoIndex' to avoid walking the list from the
+     * front.
      */
-    std::mutex rangeReadLock;
+    OrderedLL::iterator seek(std::lock_guard<std::mutex>& writeGuard,
+                             seqno_t startSeqno);
 
     /* Overall memory consumed by (stale) OrderedStoredValues owned by the
        list */
@@ -258,7 +306,36 @@ protected:
     cb::RelaxedAtomic<size_t> staleMetaDataSize;
 
 private:
-    OrderedLL::iterator purgeListElem(OrderedLL::iterator it, bool isStale);
+    /**
+     * Removes the element at 'it' from the list and deletes it, unless a
+     * range read may still visit it.
+     *
+     * @param it [in/out] element to purge; on return points to the next
+     *           element in the list
+     * @return true if the element was purged
+     */
+    bool purgeListElem(OrderedLL::iterator& it, bool isStale);
+
+    /**
+     * Removes the index entry for 'v', if it has one. Must be called with
+     * the writeLock held before 'v' leaves its position in the list.
+     */
+    void removeFromSeqnoIndex(const OrderedStoredValue& v);
+
+    /**
+     * An element is added to 'seqnoIndex' once at least this many seqnos have
+     * been assigned since the last indexed element.
+     */
+    static const seqno_t seqnoIndexInterval = 64;
+
+    /**
+     * Sparse index from seqno to (a subset of) the list elements, used to seek
+     * to the start of a range read in O(log n). Since the list is ordered by
+     * seqno, an element found here can be walked forward from.
+     *
+     * Guarded by writeLock.
+     */
+    std::map<seqno_t, OrderedStoredValue*> seqnoIndex;
 
     /**
      * We need to keep track of the highest seqno separately because there is a
@@ -318,20 +395,19 @@ private:
     class RangeIteratorLL : public SequenceList::RangeIteratorImpl {
     public:
         /**
-         * Method to create instances of RangeIteratorLL. We only
-         * allow one RangeIteratorLL object to exist at any one time,
-         * hence creation can fail and that's why object creation is via a
-         * public method and not constructor.
+         * Method to create instances of RangeIteratorLL.
          *
          * @param ll ref to the linkedlist on which the iterator is created
          * @param isBackfill indicates if the iterator is for backfill (for
          *                   debug)
+         * @param startSeqno the iterator begins at the first item with a
+         *                   seqno >= startSeqno
          *
-         * @return Non-null pointer on success, or null if a RangeIteratorLL
-         *         already exists.
+         * @return Non-null pointer to the iterator
          */
         static std::unique_ptr<RangeIteratorLL> create(BasicLinkedList& ll,
-                                                       bool isBackfill);
+                                                       bool isBackfill,
+                                                       seqno_t startSeqno);
 
         ~RangeIteratorLL();
 
@@ -363,21 +439,15 @@ private:
         }
 
     private:
-        /* We have a private constructor because we want to create the iterator
-           optionally, that is, only when it is possible to get a read lock */
-        RangeIteratorLL(BasicLinkedList& ll, bool isBackfill);
+        RangeIteratorLL(BasicLinkedList& ll,
+                        bool isBackfill,
+                        seqno_t startSeqno);
 
         /**
-         * Indicates if the client should try creating the iterator at a later
-         * point.
-         *
-         * @return true: iterator should be created later again
-         *         false: iterator created successfully
+         * Removes the iterator's read range from the list (if still
+         * registered), allowing items in it to be de-duplicated and purged.
          */
-        bool tryLater() const {
-            /* could not lock and the list has items */
-            return (!readLockHolder && (list.getHighSeqno() > 0));
-        }
+        void releaseReadRange();
 
         /**
          * Helps to increment the iterator. Moves the iterator to the next
@@ -401,8 +471,12 @@ private:
         /* The current list element pointed by the iterator */
         OrderedLL::iterator currIt;
 
-        /* Lock holder which allows having only one iterator at a time */
-        std::unique_lock<std::mutex> readLockHolder;
+        /* The read range registered on the list by this iterator; only valid
+           while ownsReadRange is true */
+        ReadRangeHandle readRange;
+
+        /* Indicates if the iterator still has a read range on the list */
+        bool ownsReadRange;
 
         /* Current range of the iterator */
         SeqRange itrRange;
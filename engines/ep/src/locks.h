@@ -17,6 +17,7 @@
 #pragma once
 
 #include "config.h"
+#include "instrumented_mutex.h"
 #include "utility.h"
 #include <platform/rwlock.h>
 #include <mutex>
@@ -27,6 +28,7 @@ using LockHolder = std::lock_guard<std::mutex>;
 /**
  * RAII lock holder over multiple locks.
  */
+template <class Mutex>
 class MultiLockHolder {
 public:
 
@@ -35,7 +37,7 @@ public:
      *
      * @param m reference to a vector of locks
      */
-    MultiLockHolder(std::vector<std::mutex>& m)
+    MultiLockHolder(std::vector<Mutex>& m)
         : mutexes(m) {
         lock();
     }
@@ -63,7 +65,7 @@ private:
         }
     }
 
-    std::vector<std::mutex>& mutexes;
+    std::vector<Mutex>& mutexes;
 
     DISALLOW_COPY_AND_ASSIGN(MultiLockHolder);
 };
@@ -80,7 +82,16 @@ public:
         : lh(lock) {
     }
 
+#ifdef EP_INSTRUMENT_LOCKS
+    template <LockSite Site>
+    ReaderLockHolder(InstrumentedRWLock<Site>& lock) : timer(Site), lh(lock) {
+        timer.acquired();
+    }
+#endif
+
 private:
+    // Declared before lh so the hold is recorded after lh has unlocked.
+    LockSiteTimer timer;
     std::lock_guard<cb::ReaderLock> lh;
 
     DISALLOW_COPY_AND_ASSIGN(ReaderLockHolder);
@@ -98,7 +109,16 @@ public:
         : lh(lock) {
     }
 
+#ifdef EP_INSTRUMENT_LOCKS
+    template <LockSite Site>
+    WriterLockHolder(InstrumentedRWLock<Site>& lock) : timer(Site), lh(lock) {
+        timer.acquired();
+    }
+#endif
+
 private:
+    // Declared before lh so the hold is recorded after lh has unlocked.
+    LockSiteTimer timer;
     std::lock_guard<cb::WriterLock> lh;
 
     DISALLOW_COPY_AND_ASSIGN(WriterLockHolder);
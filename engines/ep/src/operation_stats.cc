@@ -0,0 +1,122 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "operation_stats.h"
+
+#include "statwriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+constexpr size_t OperationStats::NumOps;
+constexpr size_t OperationStats::NumLatencyBuckets;
+
+uint64_t OperationStats::getTotalCount() const {
+    uint64_t total = 0;
+    for (const auto& count : counts) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::chrono::microseconds OperationStats::getLatencyAtPercentile(
+        double percentile) const {
+    std::array<uint64_t, NumLatencyBuckets> snapshot;
+    uint64_t total = 0;
+    for (size_t ii = 0; ii < NumLatencyBuckets; ++ii) {
+        snapshot[ii] = latencies[ii].load(std::memory_order_relaxed);
+        total += snapshot[ii];
+    }
+    if (total == 0) {
+        return std::chrono::microseconds(0);
+    }
+
+    // The rank of the requested percentile; at least the first sample.
+    const auto rank = std::max(
+            uint64_t(1), uint64_t(std::ceil(total * (percentile / 100.0))));
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (; bucket < NumLatencyBuckets - 1; ++bucket) {
+        seen += snapshot[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return std::chrono::microseconds(uint64_t(1) << bucket);
+}
+
+void OperationStats::addStats(const std::string& prefix,
+                              const AddStatFn& add_stat,
+                              const void* c) const {
+    for (size_t ii = 0; ii < NumOps; ++ii) {
+        const auto op = Op(ii);
+        add_prefixed_stat(prefix.data(),
+                          to_string(op).c_str(),
+                          getCount(op),
+                          add_stat,
+                          c);
+    }
+    add_prefixed_stat(prefix.data(), "ops", getTotalCount(), add_stat, c);
+    add_prefixed_stat(prefix.data(),
+                      "latency_p50_us",
+                      getLatencyAtPercentile(50).count(),
+                      add_stat,
+                      c);
+    add_prefixed_stat(prefix.data(),
+                      "latency_p99_us",
+                      getLatencyAtPercentile(99).count(),
+                      add_stat,
+                      c);
+    add_prefixed_stat(prefix.data(),
+                      "latency_p999_us",
+                      getLatencyAtPercentile(99.9).count(),
+                      add_stat,
+                      c);
+}
+
+void OperationStats::reset() {
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    for (auto& latency : latencies) {
+        latency.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t OperationStats::getLatencyBucket(std::chrono::microseconds latency) {
+    auto usec = latency.count();
+    size_t bucket = 0;
+    while (usec > 0 && bucket < NumLatencyBuckets - 1) {
+        usec >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::string to_string(OperationStats::Op op) {
+    switch (op) {
+    case OperationStats::Op::Get:
+        return "get";
+    case OperationStats::Op::Store:
+        return "store";
+    case OperationStats::Op::Delete:
+        return "delete";
+    }
+    throw std::invalid_argument("to_string(OperationStats::Op): invalid op " +
+                                std::to_string(int(op)));
+}
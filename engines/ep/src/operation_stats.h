@@ -0,0 +1,96 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <memcached/engine_common.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * Front-end operation counters and a latency sketch for one vBucket or one
+ * collection, used to find hot vBuckets / collections ("vbucket-ops" and
+ * "collections-ops" stats).
+ *
+ * Recording is a couple of relaxed atomic increments; everything else
+ * (percentiles, totals) is computed when the stats are read. Rates are
+ * derived by the consumer from successive samples of the counters, as for
+ * every other ep-engine counter.
+ *
+ * The latency sketch is a fixed set of power-of-two microsecond buckets, so
+ * percentiles are reported as the upper bound of the bucket they fall in
+ * (i.e. to within a factor of two) - plenty to tell a hot or slow vBucket
+ * from the rest, at a fixed ~200 bytes per instance.
+ */
+class OperationStats {
+public:
+    enum class Op : uint8_t { Get, Store, Delete };
+
+    static constexpr size_t NumOps = size_t(Op::Delete) + 1;
+
+    /**
+     * Number of latency buckets. Bucket 0 counts latencies below 1us,
+     * bucket n (n > 0) those in [2^(n-1), 2^n) us; the last bucket also
+     * counts everything larger (>= ~4s).
+     */
+    static constexpr size_t NumLatencyBuckets = 24;
+
+    OperationStats() = default;
+
+    OperationStats(const OperationStats&) = delete;
+    OperationStats& operator=(const OperationStats&) = delete;
+
+    void record(Op op, std::chrono::microseconds latency) {
+        counts[size_t(op)].fetch_add(1, std::memory_order_relaxed);
+        latencies[getLatencyBucket(latency)].fetch_add(
+                1, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount(Op op) const {
+        return counts[size_t(op)].load(std::memory_order_relaxed);
+    }
+
+    /// @return the total number of operations of every type
+    uint64_t getTotalCount() const;
+
+    /**
+     * @param percentile in the range [0, 100]
+     * @return the upper bound of the latency bucket containing the given
+     *         percentile (zero if nothing has been recorded).
+     */
+    std::chrono::microseconds getLatencyAtPercentile(double percentile) const;
+
+    /**
+     * Add the counters and latency percentiles as "<prefix>:<name>" stats.
+     */
+    void addStats(const std::string& prefix,
+                  const AddStatFn& add_stat,
+                  const void* c) const;
+
+    void reset();
+
+    static size_t getLatencyBucket(std::chrono::microseconds latency);
+
+private:
+    std::array<std::atomic<uint64_t>, NumOps> counts{};
+    std::array<std::atomic<uint64_t>, NumLatencyBuckets> latencies{};
+};
+
+std::string to_string(OperationStats::Op op);
@@ -27,6 +27,7 @@
 #include "kv_bucket.h"
 #include "kv_bucket_iface.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
@@ -91,6 +92,11 @@ bool PagingVisitor::visit(const HashTable::HashBucketLock& lh, StoredValue& v) {
         return true;
     }
 
+    if (isCollectionQuotaPass) {
+        evictIfCollectionOverQuota(lh, v);
+        return true;
+    }
+
     switch (evictionPolicy) {
     case EvictionPolicy::lru2Bit: {
         // always evict unreferenced items, or randomly evict referenced
@@ -229,6 +235,20 @@ void PagingVisitor::visitBucket(const VBucketPtr& vb) {
     double current = static_cast<double>(stats.getEstimatedTotalMemoryUsed());
     double lower = static_cast<double>(stats.mem_low_wat);
     double high = static_cast<double>(stats.mem_high_wat);
+
+    if (isCollectionQuotaPass) {
+        if (current > lower) {
+            if (vBucketFilter(vb->getId())) {
+                currentBucket = vb;
+                vb->ht.visit(*this);
+                removeClosedUnrefCheckpoints(*vb);
+            }
+        } else {
+            isBelowLowWaterMark = true;
+        }
+        return;
+    }
+
     if (vb->getState() == vbucket_state_active && current < high &&
         store.getActiveResidentRatio() < store.getReplicaResidentRatio()) {
         return;
@@ -327,7 +347,9 @@ void PagingVisitor::complete() {
     bool inverse = false;
     (*stateFinalizer).compare_exchange_strong(inverse, true);
 
-    if (pager_phase && !isBelowLowWaterMark) {
+    // A collection quota pass doesn't advance the phase; the next run will
+    // be a normal pass of the current phase.
+    if (pager_phase && !isBelowLowWaterMark && !isCollectionQuotaPass) {
         if (*pager_phase == PAGING_UNREFERENCED) {
             *pager_phase = PAGING_RANDOM;
         } else if (*pager_phase == PAGING_RANDOM) {
@@ -404,6 +426,24 @@ bool PagingVisitor::doEviction(const HashTable::HashBucketLock& lh,
     return false;
 }
 
+void PagingVisitor::evictIfCollectionOverQuota(
+        const HashTable::HashBucketLock& lh, StoredValue& v) {
+    auto itr = collectionsOverQuota.find(v.getKey().getCollectionID());
+    if (itr == collectionsOverQuota.end() || itr->second == 0) {
+        return;
+    }
+
+    // Estimate of the memory freed by evicting v; the value for value
+    // eviction, else the whole StoredValue. Read now as eviction may free v.
+    const uint64_t freed =
+            (store.getItemEvictionPolicy() == VALUE_ONLY && !isEphemeral)
+                    ? v.valuelen()
+                    : v.size();
+    if (doEviction(lh, &v)) {
+        itr->second -= std::min(freed, itr->second);
+    }
+}
+
 void PagingVisitor::setUpHashBucketVisit() {
     // Grab a locked ReadHandle
     readHandle = currentBucket->lockCollections();
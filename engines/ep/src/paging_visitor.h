@@ -98,6 +98,18 @@ public:
      */
     void tearDownHashBucketVisit() override;
 
+    /**
+     * Make this a collection quota pass: only items of the given collections
+     * are evicted (regardless of their age or frequency), until the given
+     * number of bytes has been evicted from each collection.
+     *
+     * @param overQuota map of collection to bytes over its memory quota
+     */
+    void setCollectionsOverQuota(Collections::Summary overQuota) {
+        collectionsOverQuota = std::move(overQuota);
+        isCollectionQuotaPass = true;
+    }
+
     /**
      * Get the number of items ejected during the visit.
      */
@@ -135,6 +147,10 @@ private:
 
     bool doEviction(const HashTable::HashBucketLock& lh, StoredValue* v);
 
+    /// Evict v if it belongs to a collection still over its memory quota.
+    void evictIfCollectionOverQuota(const HashTable::HashBucketLock& lh,
+                                    StoredValue& v);
+
     std::list<Item> expired;
 
     KVBucket& store;
@@ -174,4 +190,12 @@ private:
     // The VB::Manifest read handle that we use to lock around HashBucket
     // visits. Will contain a nullptr if we aren't currently locking anything.
     Collections::VB::Manifest::ReadHandle readHandle;
+
+    // Set if this visitor only evicts from collections over their memory
+    // quota (see setCollectionsOverQuota).
+    bool isCollectionQuotaPass = false;
+
+    // Bytes which still need to be evicted from each collection to bring it
+    // back within its memory quota.
+    Collections::Summary collectionsOverQuota;
 };
@@ -1496,6 +1496,11 @@ scan_error_t RocksDBKVStore::scan(ScanContext* ctx) {
                 }
             }
 
+            if (ctx->collectionsContext.isFilteredOut(key.getDocKey())) {
+                ctx->lastReadSeqno = byseqno;
+                continue;
+            }
+
             CacheLookup lookup(key, byseqno, ctx->vbid);
 
             ctx->lookup->callback(lookup);
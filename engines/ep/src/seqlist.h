@@ -75,8 +75,8 @@ protected:
      * (b) Iterator cannot be invalidated while in use.
      * (c) Reading all the items from the iterator results in point-in-time
      *     snapshot.
-     * (d) Only 1 iterator can be created for now.
-     * (e) Currently iterator can be created only from start till end
+     * (d) Multiple iterators can be in use concurrently.
+     * (e) Iterator is created from a given start seqno till the end
      */
     class RangeIteratorImpl {
     public:
@@ -158,8 +158,8 @@ public:
      * Note: (a) Do not hold the iterator for long, as it will result in stale
      *           items in list and hence increased memory usage.
      *       (b) Make sure to delete the iterator after using it.
-     *       (c) For now, we allow on one RangeIterator. Try to create more
-     *           iterators will result in the create call(s) being blocked.
+     *       (c) Multiple RangeIterators may be in use concurrently; each
+     *           only pins the items it has yet to read.
      */
     class RangeIterator {
     public:
@@ -405,12 +405,14 @@ public:
     virtual seqno_t getHighestPurgedDeletedSeqno() const = 0;
 
     /**
-     * Returns the current range read begin sequence number.
+     * Returns the current range read begin sequence number (the lowest across
+     * all range reads in flight).
      */
     virtual uint64_t getRangeReadBegin() const = 0;
 
     /**
-     * Returns the current range read end sequence number.
+     * Returns the current range read end sequence number (the highest across
+     * all range reads in flight).
      */
     virtual uint64_t getRangeReadEnd() const = 0;
 
@@ -427,12 +429,14 @@ public:
      * the SequenceList, new range iterator will not be allowed
      *
      * @param isBackfill indicates if the iterator is for backfill (for debug)
+     * @param startSeqno the iterator begins at the first item with a seqno
+     *                   >= startSeqno
      *
      * @return range iterator object when possible
      *         null when not possible
      */
     virtual boost::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) = 0;
+            bool isBackfill, seqno_t startSeqno = 1) = 0;
 
     /**
      * Debug - prints a representation of the list to stderr.
@@ -0,0 +1,56 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "sharded_rwlock.h"
+
+#include <platform/sysinfo.h>
+#include <utilities/thread_index.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+constexpr size_t ShardedRWLock::MaxDefaultShards;
+
+ShardedRWLock::ShardedRWLock(size_t numShards) : shards(numShards) {
+    if (numShards == 0) {
+        throw std::invalid_argument(
+                "ShardedRWLock::ShardedRWLock: shards must be non-zero");
+    }
+}
+
+void ShardedRWLock::lock() {
+    // Always lock in ascending index order - see class comment.
+    for (auto& shard : shards) {
+        shard->writer().lock();
+    }
+}
+
+void ShardedRWLock::unlock() {
+    for (auto it = shards.rbegin(); it != shards.rend(); ++it) {
+        (*it)->writer().unlock();
+    }
+}
+
+size_t ShardedRWLock::getDefaultShardCount() {
+    return std::max(size_t(1),
+                    std::min(Couchbase::get_available_cpu_count(),
+                             MaxDefaultShards));
+}
+
+cb::RWLock& ShardedRWLock::getShardForThisThread() const {
+    return *shards[cb::getThreadIndex() % shards.size()];
+}
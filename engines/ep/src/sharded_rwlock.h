@@ -0,0 +1,136 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <platform/cacheline_padded.h>
+#include <platform/rwlock.h>
+
+#include <vector>
+
+/**
+ * A reader/writer lock optimised for read-mostly data where the write side is
+ * very rarely taken (e.g. the per-vBucket collections manifest, which is read
+ * by every key operation but only changed when the cluster manifest changes).
+ *
+ * A single cb::RWLock requires every reader to modify the same lock word,
+ * so on a many-core machine the cache line holding it bounces between cores
+ * even though readers never logically conflict. ShardedRWLock instead owns
+ * a number of cache-line padded cb::RWLock shards:
+ *
+ * - A reader locks (shared) only the shard assigned to its thread, so readers
+ *   on different threads touch different cache lines.
+ * - A writer locks (exclusive) every shard, in index order.
+ *
+ * Each thread is permanently assigned a shard, so a thread which already
+ * holds a read lock and reads again (e.g. a nested lookup) re-enters the same
+ * shard and has the same (reader-preferring) recursion semantics as the
+ * underlying cb::RWLock. Because writers acquire shards in a fixed order a
+ * writer can never hold a shard which a recursing reader needs: the reader
+ * already holds that shard shared, so the writer cannot be past it.
+ *
+ * The shard is recorded in the ReadLock, so a ReadLock may be released on a
+ * different thread to the one which acquired it.
+ */
+class ShardedRWLock {
+public:
+    /**
+     * RAII holder of a shared (read) lock on a ShardedRWLock. Movable, and
+     * may be default constructed in the unlocked state.
+     */
+    class ReadLock {
+    public:
+        ReadLock() = default;
+
+        explicit ReadLock(const ShardedRWLock& lock)
+            : shard(&lock.getShardForThisThread()) {
+            shard->reader().lock();
+        }
+
+        ReadLock(ReadLock&& other) : shard(other.shard) {
+            other.shard = nullptr;
+        }
+
+        ReadLock& operator=(ReadLock&& other) {
+            if (this != &other) {
+                unlock();
+                shard = other.shard;
+                other.shard = nullptr;
+            }
+            return *this;
+        }
+
+        ReadLock(const ReadLock&) = delete;
+        ReadLock& operator=(const ReadLock&) = delete;
+
+        ~ReadLock() {
+            unlock();
+        }
+
+        /// Release the lock (if held). Safe to call more than once.
+        void unlock() {
+            if (shard) {
+                shard->reader().unlock();
+                shard = nullptr;
+            }
+        }
+
+        bool owns_lock() const {
+            return shard != nullptr;
+        }
+
+    private:
+        cb::RWLock* shard = nullptr;
+    };
+
+    /**
+     * @param numShards number of reader shards; defaults to the number of
+     *        available CPUs, capped at MaxDefaultShards.
+     */
+    explicit ShardedRWLock(size_t numShards = getDefaultShardCount());
+
+    ShardedRWLock(const ShardedRWLock&) = delete;
+    ShardedRWLock& operator=(const ShardedRWLock&) = delete;
+
+    /// Acquire the lock in shared mode, for the lifetime of the ReadLock.
+    ReadLock lockShared() const {
+        return ReadLock(*this);
+    }
+
+    /// Acquire the lock in exclusive mode (BasicLockable).
+    void lock();
+
+    /// Release an exclusive lock (BasicLockable).
+    void unlock();
+
+    size_t getNumShards() const {
+        return shards.size();
+    }
+
+    /**
+     * Upper bound of the default shard count. Every vBucket owns one of these
+     * locks, so the memory cost (one cache line per shard) is bounded.
+     */
+    static constexpr size_t MaxDefaultShards = 16;
+
+    static size_t getDefaultShardCount();
+
+private:
+    cb::RWLock& getShardForThisThread() const;
+
+    mutable std::vector<cb::CachelinePadded<cb::RWLock>> shards;
+};
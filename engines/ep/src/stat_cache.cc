@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "stat_cache.h"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+
+void StatCache::Snapshot::addStats(const AddStatFn& add_stat,
+                                   const void* cookie) const {
+    for (const auto& stat : stats) {
+        add_stat(stat.first.data(),
+                 gsl::narrow<uint16_t>(stat.first.size()),
+                 stat.second.data(),
+                 gsl::narrow<uint32_t>(stat.second.size()),
+                 cookie);
+    }
+}
+
+StatCache::SnapshotPtr StatCache::getOrWait(const std::string& group,
+                                            const void* cookie,
+                                            Clock::time_point notBefore,
+                                            bool& scheduleRefresh) {
+    std::lock_guard<std::mutex> lh(mutex);
+    auto& entry = groups[group];
+    scheduleRefresh = false;
+    if (entry.latest && entry.latest->takenAt >= notBefore) {
+        return entry.latest;
+    }
+    entry.waiters.push_back({cookie, notBefore});
+    if (!entry.refreshing) {
+        entry.refreshing = true;
+        scheduleRefresh = true;
+    }
+    return nullptr;
+}
+
+std::vector<const void*> StatCache::publish(const std::string& group,
+                                            SnapshotPtr snapshot,
+                                            bool& refreshAgain) {
+    std::lock_guard<std::mutex> lh(mutex);
+    auto& entry = groups[group];
+    const auto takenAt = snapshot->takenAt;
+    entry.latest = std::move(snapshot);
+
+    std::vector<const void*> satisfied;
+    auto remaining = std::partition(
+            entry.waiters.begin(),
+            entry.waiters.end(),
+            [takenAt](const Waiter& w) { return w.notBefore > takenAt; });
+    for (auto it = remaining; it != entry.waiters.end(); ++it) {
+        satisfied.push_back(it->cookie);
+        entry.notified.insert(it->cookie);
+    }
+    entry.waiters.erase(remaining, entry.waiters.end());
+
+    refreshAgain = !entry.waiters.empty();
+    entry.refreshing = refreshAgain;
+    return satisfied;
+}
+
+StatCache::SnapshotPtr StatCache::collect(const std::string& group,
+                                          const void* cookie) {
+    std::lock_guard<std::mutex> lh(mutex);
+    auto it = groups.find(group);
+    if (it == groups.end() || it->second.notified.erase(cookie) == 0) {
+        return nullptr;
+    }
+    return it->second.latest;
+}
+
+void StatCache::removeCookie(const void* cookie) {
+    std::lock_guard<std::mutex> lh(mutex);
+    for (auto& entry : groups) {
+        auto& waiters = entry.second.waiters;
+        waiters.erase(std::remove_if(waiters.begin(),
+                                     waiters.end(),
+                                     [cookie](const Waiter& w) {
+                                         return w.cookie == cookie;
+                                     }),
+                      waiters.end());
+        entry.second.notified.erase(cookie);
+    }
+}
+
+void StatCache::reset() {
+    std::lock_guard<std::mutex> lh(mutex);
+    for (auto& entry : groups) {
+        entry.second.latest.reset();
+    }
+}
@@ -0,0 +1,136 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <memcached/engine_common.h>
+#include <memcached/engine_error.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Snapshots of the expensive stat groups (those which visit every vBucket or
+ * every connection), so that a "stats" request for one of them doesn't have
+ * to compute it on the front-end thread.
+ *
+ * A request for a group is answered immediately from the group's snapshot if
+ * that was taken recently enough (within the requester's maximum staleness).
+ * Otherwise the requester's cookie is added to the group's waiters and a
+ * single background refresh of the group is scheduled; once the refresh has
+ * published a new snapshot the waiters it satisfies are notified and collect
+ * it when their request is re-run.
+ *
+ * A waiter is only satisfied by a snapshot taken no earlier than its maximum
+ * staleness before it made its request - with a staleness of zero it never
+ * sees a snapshot which was started before its request, as a synchronous
+ * stats call would. Waiters which a refresh does not satisfy (because they
+ * arrived while it was running) are satisfied by a further refresh.
+ *
+ * StatCache only tracks snapshots and waiters; computing the snapshots and
+ * notifying the waiters is the caller's responsibility (see
+ * EventuallyPersistentEngine::takeStatSnapshot).
+ */
+class StatCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// The output of one computation of a stat group.
+    struct Snapshot {
+        /// Add every stat of the snapshot via add_stat.
+        void addStats(const AddStatFn& add_stat, const void* cookie) const;
+
+        /// When the computation started.
+        Clock::time_point takenAt;
+        /// The status the computation returned.
+        ENGINE_ERROR_CODE status = ENGINE_SUCCESS;
+        /// The stats the computation added, as (key, value) pairs.
+        std::vector<std::pair<std::string, std::string>> stats;
+    };
+
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    /**
+     * Get the snapshot of group if one was taken at or after notBefore; else
+     * add cookie to the group's waiters.
+     *
+     * @param group the stat group
+     * @param cookie the requester
+     * @param notBefore the oldest snapshot the requester accepts
+     * @param[out] scheduleRefresh set to true if the caller must schedule a
+     *             refresh of group (i.e. cookie now waits and no refresh is
+     *             in progress), else false.
+     * @return the snapshot, or nullptr if cookie now waits for a refresh.
+     */
+    SnapshotPtr getOrWait(const std::string& group,
+                          const void* cookie,
+                          Clock::time_point notBefore,
+                          bool& scheduleRefresh);
+
+    /**
+     * Publish a new snapshot of group, computed by a refresh.
+     *
+     * @param group the stat group
+     * @param snapshot the new snapshot
+     * @param[out] refreshAgain set to true if waiters remain which the
+     *             snapshot does not satisfy, in which case the refresh is
+     *             still in progress and the caller must compute and publish
+     *             another snapshot; else false.
+     * @return the waiters which the snapshot satisfies (to be notified). Each
+     *         collects the snapshot with collect().
+     */
+    std::vector<const void*> publish(const std::string& group,
+                                     SnapshotPtr snapshot,
+                                     bool& refreshAgain);
+
+    /**
+     * @return the latest snapshot of group if cookie was notified for it by
+     *         publish() (and forget the notification), else nullptr.
+     */
+    SnapshotPtr collect(const std::string& group, const void* cookie);
+
+    /// Forget every waiter / notification of cookie (e.g. on disconnect).
+    void removeCookie(const void* cookie);
+
+    /**
+     * Drop every snapshot (e.g. after the stats have been reset), so the next
+     * request for each group is computed afresh. Waiters are not affected.
+     */
+    void reset();
+
+private:
+    struct Waiter {
+        const void* cookie;
+        Clock::time_point notBefore;
+    };
+
+    struct Group {
+        SnapshotPtr latest;
+        bool refreshing = false;
+        std::vector<Waiter> waiters;
+        std::unordered_set<const void*> notified;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Group> groups;
+};
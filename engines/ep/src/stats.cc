@@ -42,7 +42,6 @@ EPStats::EPStats()
       tooOld(0),
       totalPersisted(0),
       totalPersistVBState(0),
-      totalEnqueued(0),
       flushFailed(0),
       flushExpired(0),
       expired_access(0),
@@ -94,17 +93,6 @@ EPStats::EPStats()
       vbucketDelMaxWalltime(0),
       vbucketDelTotWalltime(0),
       replicationThrottleThreshold(0),
-      numOpsStore(0),
-      numOpsDelete(0),
-      numOpsGet(0),
-      numOpsGetMeta(0),
-      numOpsSetMeta(0),
-      numOpsDelMeta(0),
-      numOpsSetMetaResolutionFailed(0),
-      numOpsDelMetaResolutionFailed(0),
-      numOpsSetRetMeta(0),
-      numOpsDelRetMeta(0),
-      numOpsGetMetaOnSetWithMeta(0),
       alogRuns(0),
       accessScannerSkips(0),
       alogNumItems(0),
@@ -208,66 +196,43 @@ size_t EPStats::getPreciseTotalMemoryUsed() {
     return getCurrentSize() + getMemOverhead();
 }
 
-size_t EPStats::getCurrentSize() const {
+size_t EPStats::getCoreLocalTotal(
+        CoreLocalStats::Counter CoreLocalStats::*counter) const {
     int64_t result = 0;
     for (const auto& core : coreLocal) {
-        result += core->currentSize;
+        result += (core.get()->*counter).load();
     }
     return std::max(int64_t(0), result);
 }
 
+size_t EPStats::getCurrentSize() const {
+    return getCoreLocalTotal(&CoreLocalStats::currentSize);
+}
+
 size_t EPStats::getNumBlob() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->numBlob;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::numBlob);
 }
 
 size_t EPStats::getBlobOverhead() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->blobOverhead;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::blobOverhead);
 }
 
 size_t EPStats::getTotalValueSize() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->totalValueSize;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::totalValueSize);
 }
 
 size_t EPStats::getNumStoredVal() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->numStoredVal;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::numStoredVal);
 }
 
 size_t EPStats::getStoredValSize() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->totalStoredValSize;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::totalStoredValSize);
 }
 
 size_t EPStats::getMemOverhead() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->memOverhead;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::memOverhead);
 }
 
 size_t EPStats::getNumItem() const {
-    int64_t result = 0;
-    for (const auto& core : coreLocal) {
-        result += core->numItem;
-    }
-    return std::max(int64_t(0), result);
+    return getCoreLocalTotal(&CoreLocalStats::numItem);
 }
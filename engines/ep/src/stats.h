@@ -33,7 +33,80 @@
 #include <algorithm>
 #include <atomic>
 
-class CoreLocalStats;
+/**
+ * Core-local statistics
+ *
+ * For statistics which are updated frequently by multiple cores, there can be
+ * signifcant cost in maintaining a single bucket-level counter, due to cache
+ * line thrashing.
+ * This class contains core-local statistics which are signicantly cheaper
+ * to update. They are then summed into a bucket-level when read.
+ */
+class CoreLocalStats {
+public:
+    // Thread-safe type for counting occurances of discrete,
+    // non-negative entities (# events, sizes).  Relaxed memory
+    // ordering (no ordering or synchronization).
+    // This is a signed variable as depending on how/when the core-local
+    // counters merge their info, this could be negative.
+    using Counter = cb::RelaxedAtomic<int64_t>;
+
+    //! The total amount of memory used by this bucket (From memory tracking)
+    Counter totalMemory;
+
+    //! Total size of stored objects.
+    Counter currentSize;
+
+    //! Total number of blob objects
+    Counter numBlob;
+
+    //! Total size of blob memory overhead
+    Counter blobOverhead;
+
+    //! Total memory overhead to store values for resident keys.
+    Counter totalValueSize;
+
+    //! The number of storedVal object
+    Counter numStoredVal;
+
+    //! Total memory for stored values
+    Counter totalStoredValSize;
+
+    //! Amount of memory used to track items and what-not.
+    Counter memOverhead;
+
+    //! Total number of Item objects
+    Counter numItem;
+
+    //! Cumulative number of items added to the queue.
+    Counter totalEnqueued;
+    //! Cumulative count of items de-duplicated when queued to CheckpointManager
+    Counter totalDeduplicated;
+
+    //! The number of basic store (add, set, arithmetic, touch, etc.) operations
+    Counter numOpsStore;
+    //! The number of basic delete operations
+    Counter numOpsDelete;
+    //! The number of basic get operations
+    Counter numOpsGet;
+
+    //! The number of get with meta operations
+    Counter numOpsGetMeta;
+    //! The number of set with meta operations
+    Counter numOpsSetMeta;
+    //! The number of delete with meta operations
+    Counter numOpsDelMeta;
+    //! The number of failed set meta ops due to conflict resoltion
+    Counter numOpsSetMetaResolutionFailed;
+    //! The number of failed del meta ops due to conflict resoltion
+    Counter numOpsDelMetaResolutionFailed;
+    //! The number of set returning meta operations
+    Counter numOpsSetRetMeta;
+    //! The number of delete returning meta operations
+    Counter numOpsDelRetMeta;
+    //! The number of background get meta ops due to set_with_meta operations
+    Counter numOpsGetMetaOnSetWithMeta;
+};
 
 /**
  * Global engine stats container.
@@ -103,6 +176,17 @@ public:
      */
     size_t getPreciseTotalMemoryUsed();
 
+    /**
+     * @returns the sum of the given core-local counter across all cores.
+     * Core-local counters are updated without any cross-core traffic and only
+     * aggregated here, when read. The total is clamped at zero as a core may
+     * observe a decrement of a value counted on another core.
+     *
+     * Usage: stats.getCoreLocalTotal(&CoreLocalStats::numOpsGet)
+     */
+    size_t getCoreLocalTotal(
+            CoreLocalStats::Counter CoreLocalStats::*counter) const;
+
     /// @returns total size of stored objects.
     size_t getCurrentSize() const;
 
@@ -171,10 +255,6 @@ public:
     Counter totalPersisted;
     //! Number of times VBucket state persisted.
     Counter totalPersistVBState;
-    //! Cumulative number of items added to the queue.
-    Counter totalEnqueued;
-    //! Cumulative count of items de-duplicated when queued to CheckpointManager
-    Counter totalDeduplicated;
     //! Number of times an item flush failed.
     Counter flushFailed;
     //! Number of times an item is not flushed due to the item's expiry
@@ -328,30 +408,6 @@ public:
     //! Percentage of memory in use before we throttle replication input
     std::atomic<double> replicationThrottleThreshold;
 
-    //! The number of basic store (add, set, arithmetic, touch, etc.) operations
-    Counter numOpsStore;
-    //! The number of basic delete operations
-    Counter numOpsDelete;
-    //! The number of basic get operations
-    Counter numOpsGet;
-
-    //! The number of get with meta operations
-    Counter  numOpsGetMeta;
-    //! The number of set with meta operations
-    Counter  numOpsSetMeta;
-    //! The number of delete with meta operations
-    Counter  numOpsDelMeta;
-    //! The number of failed set meta ops due to conflict resoltion
-    Counter numOpsSetMetaResolutionFailed;
-    //! The number of failed del meta ops due to conflict resoltion
-    Counter numOpsDelMetaResolutionFailed;
-    //! The number of set returning meta operations
-    Counter  numOpsSetRetMeta;
-    //! The number of delete returning meta operations
-    Counter  numOpsDelRetMeta;
-    //! The number of background get meta ops due to set_with_meta operations
-    Counter  numOpsGetMetaOnSetWithMeta;
-
     //! The number of times the access scanner runs
     Counter alogRuns;
     //! The number of times the access scanner skips generating access log
@@ -599,52 +655,6 @@ protected:
     float memUsedMergeThresholdPercent;
 };
 
-/**
- * Core-local statistics
- *
- * For statistics which are updated frequently by multiple cores, there can be
- * signifcant cost in maintaining a single bucket-level counter, due to cache
- * line thrashing.
- * This class contains core-local statistics which are signicantly cheaper
- * to update. They are then summed into a bucket-level when read.
- */
-class CoreLocalStats {
-public:
-    // Thread-safe type for counting occurances of discrete,
-    // non-negative entities (# events, sizes).  Relaxed memory
-    // ordering (no ordering or synchronization).
-    // This is a signed variable as depending on how/when the core-local
-    // counters merge their info, this could be negative.
-    using Counter = cb::RelaxedAtomic<int64_t>;
-
-    //! The total amount of memory used by this bucket (From memory tracking)
-    Counter totalMemory;
-
-    //! Total size of stored objects.
-    Counter currentSize;
-
-    //! Total number of blob objects
-    Counter numBlob;
-
-    //! Total size of blob memory overhead
-    Counter blobOverhead;
-
-    //! Total memory overhead to store values for resident keys.
-    Counter totalValueSize;
-
-    //! The number of storedVal object
-    Counter numStoredVal;
-
-    //! Total memory for stored values
-    Counter totalStoredValSize;
-
-    //! Amount of memory used to track items and what-not.
-    Counter memOverhead;
-
-    //! Total number of Item objects
-    Counter numItem;
-};
-
 /**
  * Stats returned by key stats.
  */
@@ -65,6 +65,22 @@ bool CompactTask::run() {
      */
     compactionConfig.retain_erroneous_tombstones =
                              bucket.isRetainErroneousTombstones();
+
+    const double ioDelay = bucket.getCompactionIODelay();
+    if (ioDelay > 0) {
+        // Wait for the I/O of earlier compactions to fit within the
+        // compaction I/O budget. Waiting here rather than while compacting
+        // means we don't hold the vBucket lock or a writer thread meanwhile.
+        snooze(ioDelay);
+        return true;
+    }
+
+    if (!bucket.tryStartCompaction()) {
+        // compaction_max_concurrency compactions are already running; this
+        // task is woken when one of them completes.
+        snooze(60);
+        return true;
+    }
     return bucket.doCompact(compactionConfig, purgeSeqno, cookie);
 }
 
@@ -113,17 +129,19 @@ WorkLoadMonitor::WorkLoadMonitor(EventuallyPersistentEngine *e,
 }
 
 size_t WorkLoadMonitor::getNumMutations() {
-    return engine->getEpStats().numOpsStore +
-           engine->getEpStats().numOpsDelete +
-           engine->getEpStats().numOpsSetMeta +
-           engine->getEpStats().numOpsDelMeta +
-           engine->getEpStats().numOpsSetRetMeta +
-           engine->getEpStats().numOpsDelRetMeta;
+    const auto& stats = engine->getEpStats();
+    return stats.getCoreLocalTotal(&CoreLocalStats::numOpsStore) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsDelete) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsSetMeta) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsDelMeta) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsSetRetMeta) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsDelRetMeta);
 }
 
 size_t WorkLoadMonitor::getNumGets() {
-    return engine->getEpStats().numOpsGet +
-           engine->getEpStats().numOpsGetMeta;
+    const auto& stats = engine->getEpStats();
+    return stats.getCoreLocalTotal(&CoreLocalStats::numOpsGet) +
+           stats.getCoreLocalTotal(&CoreLocalStats::numOpsGetMeta);
 }
 
 bool WorkLoadMonitor::run() {
@@ -73,6 +73,7 @@ TASK(ClosedUnrefCheckpointRemoverTask, NONIO_TASK_IDX, 6)
 TASK(ClosedUnrefCheckpointRemoverVisitorTask, NONIO_TASK_IDX, 6)
 TASK(VBucketMemoryDeletionTask, NONIO_TASK_IDX, 6)
 TASK(StatCheckpointTask, NONIO_TASK_IDX, 7)
+TASK(StatCacheRefreshTask, NONIO_TASK_IDX, 7)
 TASK(DefragmenterTask, NONIO_TASK_IDX, 7)
 TASK(ItemCompressorTask, NONIO_TASK_IDX, 7)
 TASK(EphTombstoneHTCleaner, NONIO_TASK_IDX, 7)
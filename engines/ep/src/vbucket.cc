@@ -36,6 +36,7 @@
 #include "pre_link_document_context.h"
 #include "statwriter.h"
 #include "stored_value_factories.h"
+#include "trace_helpers.h"
 #include "vb_filter.h"
 #include "vbucket.h"
 #include "vbucketdeletiontask.h"
@@ -551,6 +552,7 @@ void VBucket::resetStats() {
     opsGet.store(0);
     opsReject.store(0);
     opsUpdate.store(0);
+    opStats.reset();
 
     stats.diskQueueSize.fetch_sub(dirtyQueueSize.exchange(0));
     dirtyQueueMem.store(0);
@@ -714,8 +716,17 @@ ENGINE_ERROR_CODE VBucket::abort(
     return ENGINE_SUCCESS;
 }
 
-void VBucket::notifyClientOfCommit(const void* cookie) {
+void VBucket::notifyClientOfCommit(
+        const void* cookie, std::chrono::steady_clock::time_point startTime) {
     EP_LOG_DEBUG("VBucket::notifyClientOfCommit ({}) cookie:{}", id, cookie);
+    if (cookie) {
+        // This isn't the cookie's front-end thread, so the span is handed
+        // to the cookie rather than its tracer.
+        TRACE_BACKGROUND_SPAN(cookie,
+                              cb::tracing::TraceCode::DURABILITY_WAIT,
+                              startTime,
+                              std::chrono::steady_clock::now());
+    }
 
     syncWriteCompleteCb(cookie, ENGINE_SUCCESS);
 }
@@ -1413,7 +1424,7 @@ ENGINE_ERROR_CODE VBucket::setWithMeta(
                                             itm.getMetaData(),
                                             itm.getDataType(),
                                             itm.isDeleted()))) {
-                ++stats.numOpsSetMetaResolutionFailed;
+                ++stats.coreLocal.get()->numOpsSetMetaResolutionFailed;
                 // If the existing item happens to be a temporary item,
                 // delete the item to save memory in the hash table
                 if (v->isTempItem()) {
@@ -1678,7 +1689,7 @@ ENGINE_ERROR_CODE VBucket::deleteWithMeta(
                                             itemMeta,
                                             PROTOCOL_BINARY_RAW_BYTES,
                                             true))) {
-                ++stats.numOpsDelMetaResolutionFailed;
+                ++stats.coreLocal.get()->numOpsDelMetaResolutionFailed;
                 return ENGINE_KEY_EEXISTS;
             }
         } else {
@@ -2152,7 +2163,7 @@ ENGINE_ERROR_CODE VBucket::getMetaData(
     auto& hbl = htRes.lock;
 
     if (v) {
-        stats.numOpsGetMeta++;
+        stats.coreLocal.get()->numOpsGetMeta++;
         if (v->isTempInitialItem()) {
             // Need bg meta fetch.
             bgFetch(cHandle.getKey(), cookie, engine, true);
@@ -2194,7 +2205,7 @@ ENGINE_ERROR_CODE VBucket::getMetaData(
             return addTempItemAndBGFetch(
                     hbl, cHandle.getKey(), cookie, engine, true);
         } else {
-            stats.numOpsGetMeta++;
+            stats.coreLocal.get()->numOpsGetMeta++;
             return ENGINE_KEY_ENOENT;
         }
     }
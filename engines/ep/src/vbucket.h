@@ -25,8 +25,10 @@
 #include "dcp/dcp-types.h"
 #include "hash_table.h"
 #include "hlc.h"
+#include "instrumented_mutex.h"
 #include "item_pager.h"
 #include "monotonic.h"
+#include "operation_stats.h"
 #include "vbucket_bgfetch_item.h"
 #include "vbucket_fwd.h"
 #include "vbucket_state.h"
@@ -389,7 +391,10 @@ public:
                            const nlohmann::json& meta,
                            WriterLockHolder& vbStateLock);
 
-    cb::RWLock& getStateLock() {return stateLock;}
+    /// Type of stateLock; see instrumented_mutex.h
+    using StateLock = InstrumentedRWLock<LockSite::VBucketState>;
+
+    StateLock& getStateLock() {return stateLock;}
 
     vbucket_state_t getInitialState(void) { return initialState; }
 
@@ -1316,8 +1321,11 @@ public:
     /**
      * Notify a client connection that a SyncWrite has been committed.
      * @param cookie The client's cookie.
+     * @param startTime When the SyncWrite started waiting for its
+     *        durability requirements
      */
-    void notifyClientOfCommit(const void* cookie);
+    void notifyClientOfCommit(const void* cookie,
+                              std::chrono::steady_clock::time_point startTime);
 
     /**
      * Update in memory data structures after an item is deleted on disk
@@ -1504,6 +1512,9 @@ public:
     std::atomic<size_t>  opsReject;
     std::atomic<size_t>  opsUpdate;
 
+    /// Front-end get/store/delete counts and latencies ("vbucket-ops")
+    OperationStats opStats;
+
     cb::NonNegativeCounter<size_t> dirtyQueueSize;
     std::atomic<size_t>  dirtyQueueMem;
     std::atomic<size_t>  dirtyQueueFill;
@@ -2044,7 +2055,7 @@ private:
 
     Vbid id;
     std::atomic<vbucket_state_t>    state;
-    cb::RWLock                      stateLock;
+    StateLock                       stateLock;
 
     vbucket_state_t                 initialState;
     std::mutex                           pendingOpLock;
@@ -44,9 +44,6 @@ public:
           cookie(c),
           initTime(init_time),
           metaDataOnly(meta_only) {
-        if (cookie) {
-            TRACE_BEGIN(cookie, cb::tracing::TraceCode::BG_WAIT, init_time);
-        }
     }
 
     GetValue* value;
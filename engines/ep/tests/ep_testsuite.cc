@@ -6537,7 +6537,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "chk_items",
               "estimate"}},
             {"dcp",
-             {"ep_dcp_count",
+             {"ep_dcp_backfill_disk_scans_opened",
+              "ep_dcp_backfill_disk_scans_shared",
+              "ep_dcp_count",
               "ep_dcp_dead_conn_count",
               "ep_dcp_items_remaining",
               "ep_dcp_items_sent",
@@ -6660,6 +6662,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_collections_enabled",
               "ep_collections_max_size",
               "ep_compaction_exp_mem_threshold",
+              "ep_compaction_max_bytes_per_sec",
+              "ep_compaction_max_concurrency",
+              "ep_compaction_max_iops",
               "ep_compaction_write_queue_cap",
               "ep_compression_mode",
               "ep_config_file",
@@ -6673,6 +6678,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_coalescing",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
@@ -6689,6 +6695,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_dcp_producer_snapshot_marker_yield_limit",
               "ep_dcp_consumer_process_buffered_messages_yield_limit",
               "ep_dcp_consumer_process_buffered_messages_batch_size",
+              "ep_dcp_consumer_processor_tasks",
               "ep_dcp_scan_byte_limit",
               "ep_dcp_scan_item_limit",
               "ep_dcp_takeover_max_time",
@@ -6851,6 +6858,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_collections_enabled",
               "ep_collections_max_size",
               "ep_compaction_exp_mem_threshold",
+              "ep_compaction_max_bytes_per_sec",
+              "ep_compaction_max_concurrency",
+              "ep_compaction_max_iops",
               "ep_compaction_write_queue_cap",
               "ep_compression_mode",
               "ep_config_file",
@@ -6870,12 +6880,14 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_coalescing",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
               "ep_dcp_conn_buffer_size_max",
               "ep_dcp_conn_buffer_size_perc",
               "ep_dcp_consumer_process_buffered_messages_batch_size",
+              "ep_dcp_consumer_processor_tasks",
               "ep_dcp_consumer_process_buffered_messages_yield_limit",
               "ep_dcp_enable_noop",
               "ep_dcp_ephemeral_backfill_type",
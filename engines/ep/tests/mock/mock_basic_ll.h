@@ -46,19 +46,21 @@ public:
         return allSeqnos;
     }
 
-    /// Expose the rangeReadLock for testing.
-    std::mutex& getRangeReadLock() {
-        return rangeReadLock;
-    }
-
     /* Register fake read range for testing */
     void registerFakeReadRange(seqno_t start, seqno_t end) {
         std::lock_guard<SpinLock> lh(rangeLock);
-        readRange = SeqRange(start, end);
+        fakeReadRanges.push_back(registerReadRange(lh, SeqRange(start, end)));
     }
 
+    /* Remove all fake read ranges registered by registerFakeReadRange() */
     void resetReadRange() {
         std::lock_guard<SpinLock> lh(rangeLock);
-        readRange.reset();
+        for (auto& handle : fakeReadRanges) {
+            unregisterReadRange(lh, handle);
+        }
+        fakeReadRanges.clear();
     }
+
+private:
+    std::vector<ReadRangeHandle> fakeReadRanges;
 };
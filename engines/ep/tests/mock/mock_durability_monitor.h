@@ -32,6 +32,11 @@ public:
         return DurabilityMonitor::getNumTracked(lg);
     }
 
+    size_t public_getTrackedCapacity() const {
+        std::lock_guard<std::mutex> lg(state.m);
+        return DurabilityMonitor::getTrackedCapacity(lg);
+    }
+
     size_t public_getReplicationChainSize() const {
         std::lock_guard<std::mutex> lg(state.m);
         return DurabilityMonitor::getReplicationChainSize(lg);
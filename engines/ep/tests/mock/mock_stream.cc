@@ -30,7 +30,9 @@ MockActiveStream::MockActiveStream(EventuallyPersistentEngine* e,
                                    uint64_t snap_start_seqno,
                                    uint64_t snap_end_seqno,
                                    IncludeValue includeValue,
-                                   IncludeXattrs includeXattrs)
+                                   IncludeXattrs includeXattrs,
+                                   boost::optional<cb::const_char_buffer>
+                                           jsonFilter)
     : ActiveStream(e,
                    p,
                    p->getName(),
@@ -45,7 +47,7 @@ MockActiveStream::MockActiveStream(EventuallyPersistentEngine* e,
                    includeValue,
                    includeXattrs,
                    IncludeDeleteTime::No,
-                   {{}, vb.getManifest()}) {
+                   {jsonFilter, vb.getManifest()}) {
 }
 
 void MockActiveStream::public_registerCursor(CheckpointManager& manager,
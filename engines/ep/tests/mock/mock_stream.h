@@ -43,7 +43,8 @@ public:
                      uint64_t snap_start_seqno,
                      uint64_t snap_end_seqno,
                      IncludeValue includeValue = IncludeValue::Yes,
-                     IncludeXattrs includeXattrs = IncludeXattrs::Yes);
+                     IncludeXattrs includeXattrs = IncludeXattrs::Yes,
+                     boost::optional<cb::const_char_buffer> jsonFilter = {});
 
     // Expose underlying protected ActiveStream methods as public
     std::vector<queued_item> public_getOutstandingItems(VBucket& vb) {
@@ -109,6 +110,18 @@ public:
         return backfillItems.memory + backfillItems.disk;
     }
 
+    size_t getNumValuesCompressed() const {
+        return valueCompression.compressed;
+    }
+
+    size_t getNumValuesRejectedForCompression() const {
+        return valueCompression.rejected;
+    }
+
+    size_t getNumValuesSkippedForCompression() const {
+        return valueCompression.skipped;
+    }
+
     int getLastReadSeqno() const {
         return lastReadSeqno;
     }
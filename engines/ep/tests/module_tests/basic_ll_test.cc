@@ -28,6 +28,7 @@
 #include "stored_value_factories.h"
 #include "tests/module_tests/test_helpers.h"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -238,8 +239,9 @@ protected:
      * Creates an optional 'RangeIterator'. Expected to create the optional
      * one always.
      */
-    SequenceList::RangeIterator getRangeIterator() {
-        auto itrOptional = basicLL->makeRangeIterator(true /*isBackfill*/);
+    SequenceList::RangeIterator getRangeIterator(seqno_t startSeqno = 1) {
+        auto itrOptional =
+                basicLL->makeRangeIterator(true /*isBackfill*/, startSeqno);
         EXPECT_TRUE(itrOptional);
         return std::move(*itrOptional);
     }
@@ -685,7 +687,7 @@ TEST_F(BasicLinkedListTest, RangeIteratorUpdateItemDuringRead) {
 }
 
 /* Creates 2 range iterators such that iterator2 is created after iterator1
-   has read all items, and has hence released the rangeReadLock, but before
+   has read all items, and has hence released its read range, but before
    iterator1 is deleted */
 TEST_F(BasicLinkedListTest, MultipleRangeIterator_MB24474) {
     const int numItems = 3;
@@ -723,7 +725,7 @@ TEST_F(BasicLinkedListTest, MultipleRangeIterator_MB24474) {
     EXPECT_EQ(expectedSeqno, actualSeqno);
 }
 
-TEST_F(BasicLinkedListTest, NonBlockingRangeIterators) {
+TEST_F(BasicLinkedListTest, ConcurrentRangeIterators) {
     const int numItems = 3;
     const std::string keyPrefix("key");
 
@@ -731,25 +733,108 @@ TEST_F(BasicLinkedListTest, NonBlockingRangeIterators) {
     std::vector<seqno_t> expectedSeqno =
             addNewItemsToList(1, keyPrefix, numItems);
 
+    auto itr1 = getRangeIterator();
+    auto itr2 = getRangeIterator();
+
+    /* Interleave reads from both the iterators, each should see all items */
+    std::vector<seqno_t> actualSeqno1, actualSeqno2;
+    actualSeqno1.push_back((*itr1).getBySeqno());
+    ++itr1;
+    while (itr2.curr() != itr2.end()) {
+        actualSeqno2.push_back((*itr2).getBySeqno());
+        ++itr2;
+    }
+    while (itr1.curr() != itr1.end()) {
+        actualSeqno1.push_back((*itr1).getBySeqno());
+        ++itr1;
+    }
+    EXPECT_EQ(expectedSeqno, actualSeqno1);
+    EXPECT_EQ(expectedSeqno, actualSeqno2);
+}
+
+/* An item in any of the concurrent read ranges must not be moved by an update,
+   and once all the readers are done the ranges must be released */
+TEST_F(BasicLinkedListTest, UpdateDuringConcurrentRangeIterators) {
+    const int numItems = 3;
+    const std::string keyPrefix("key");
+
+    addNewItemsToList(1, keyPrefix, numItems);
+
     {
         auto itr1 = getRangeIterator();
-        auto itr2 = basicLL->makeRangeIterator(true /*isBackfill*/);
-        /* itr1 is already using the list, we cannot have another iterator */
-        EXPECT_FALSE(itr2);
+        auto itr2 = getRangeIterator();
 
-        /* itr1 goes out of scope and releases the read lock on the list */
+        /* itr1 moves past the first item, but itr2 still has to read it */
+        ++itr1;
+        EXPECT_EQ(1, basicLL->getRangeReadBegin());
+        EXPECT_EQ(numItems, basicLL->getRangeReadEnd());
+
+        updateItemDuringRangeRead(numItems, keyPrefix + std::to_string(1));
+        EXPECT_EQ(1, basicLL->getNumStaleItems());
     }
 
-    /* Iterator created now, should be able to read all items */
-    auto itr = getRangeIterator();
-    std::vector<seqno_t> actualSeqno;
+    EXPECT_EQ(0, basicLL->getRangeReadBegin());
+    EXPECT_EQ(0, basicLL->getRangeReadEnd());
 
-    /* Read all the items with the iterator */
-    while (itr.curr() != itr.end()) {
-        actualSeqno.push_back((*itr).getBySeqno());
-        ++itr;
+    /* No range read now, update should move the item to the end */
+    updateItem(numItems + 1, keyPrefix + std::to_string(2));
+    std::vector<seqno_t> expectedSeqno = {1, 3, 4, 5};
+    EXPECT_EQ(expectedSeqno, basicLL->getAllSeqnoForVerification());
+}
+
+TEST_F(BasicLinkedListTest, RangeIteratorFromSeqno) {
+    /* Add enough items that the seek uses the seqno index */
+    const int numItems = 1000;
+    const std::string keyPrefix("key");
+
+    addNewItemsToList(1, keyPrefix, numItems);
+
+    for (const seqno_t start : {1, 2, 63, 64, 65, 500, 999, 1000}) {
+        auto itr = getRangeIterator(start);
+        EXPECT_EQ(start, itr.curr());
+        EXPECT_EQ(numItems, itr.back());
+        EXPECT_EQ(uint64_t(numItems - start + 1), itr.count());
+        EXPECT_EQ(start, basicLL->getRangeReadBegin());
+
+        seqno_t expected = start;
+        while (itr.curr() != itr.end()) {
+            EXPECT_EQ(expected++, (*itr).getBySeqno());
+            ++itr;
+        }
+        EXPECT_EQ(numItems + 1, expected);
+    }
+
+    /* Nothing to read beyond the high seqno */
+    auto itr = getRangeIterator(numItems + 1);
+    EXPECT_EQ(itr.curr(), itr.end());
+}
+
+TEST_F(BasicLinkedListTest, RangeIteratorFromSeqnoAfterUpdates) {
+    const int numItems = 300;
+    const std::string keyPrefix("key");
+
+    addNewItemsToList(1, keyPrefix, numItems);
+
+    /* Move some of the items (including indexed ones) to the end of the
+       list */
+    seqno_t highSeqno = numItems;
+    for (const int key : {1, 65, 66, 129, 200}) {
+        updateItem(highSeqno++, keyPrefix + std::to_string(key));
+    }
+
+    auto allSeqnos = basicLL->getAllSeqnoForVerification();
+    for (const seqno_t start : {1, 65, 129, 130, 250, 301, 303}) {
+        auto itr = getRangeIterator(start);
+        std::vector<seqno_t> actualSeqno;
+        while (itr.curr() != itr.end()) {
+            actualSeqno.push_back((*itr).getBySeqno());
+            ++itr;
+        }
+        std::vector<seqno_t> expectedSeqno(
+                std::lower_bound(allSeqnos.begin(), allSeqnos.end(), start),
+                allSeqnos.end());
+        EXPECT_EQ(expectedSeqno, actualSeqno) << "start:" << start;
     }
-    EXPECT_EQ(expectedSeqno, actualSeqno);
 }
 
 TEST_F(BasicLinkedListTest, RangeReadStopsOnInvalidSeqno) {
@@ -1027,3 +1112,39 @@ TEST_F(BasicLinkedListTest, PurgePauseResumeWithUpdateAtPausedPoint) {
     EXPECT_GE(numPaused, 1);
     EXPECT_EQ(numItems, basicLL->getNumItems());
 }
+
+/* Purge must not be blocked by a range iterator; it can remove the stale items
+   the iterator has already read, but not those it has yet to read */
+TEST_F(BasicLinkedListTest, PurgeDuringRangeIterator) {
+    const std::string keyPrefix("key");
+
+    /* seqnos: 1 (stale), 2, 3 (stale), 4 */
+    addStaleItem("stale1", 1);
+    addNewItemsToList(2, keyPrefix, 1);
+    addStaleItem("stale3", 3);
+    addNewItemsToList(4, keyPrefix, 1);
+    ASSERT_EQ(2, basicLL->getNumStaleItems());
+
+    auto itr = getRangeIterator();
+    ASSERT_EQ(1, itr.curr());
+    ++itr;
+    ASSERT_EQ(2, itr.curr());
+
+    /* Only the stale item behind the iterator can be purged */
+    EXPECT_EQ(1, basicLL->purgeTombstones(4));
+    EXPECT_EQ(1, basicLL->getNumStaleItems());
+    std::vector<seqno_t> expectedSeqno = {2, 3, 4};
+    EXPECT_EQ(expectedSeqno, basicLL->getAllSeqnoForVerification());
+
+    /* The iterator continues unaffected */
+    std::vector<seqno_t> actualSeqno;
+    while (itr.curr() != itr.end()) {
+        actualSeqno.push_back((*itr).getBySeqno());
+        ++itr;
+    }
+    EXPECT_EQ(expectedSeqno, actualSeqno);
+
+    /* Iterator is done, the remaining stale item can now be purged */
+    EXPECT_EQ(1, basicLL->purgeTombstones(4));
+    EXPECT_EQ(0, basicLL->getNumStaleItems());
+}
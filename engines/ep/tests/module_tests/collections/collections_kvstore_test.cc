@@ -53,6 +53,23 @@ public:
     }
 };
 
+/// Cache lookup callback which always has the scan read the item from disk
+class NoCacheLookupCallback : public StatusCallback<CacheLookup> {
+public:
+    void callback(CacheLookup&) {
+    }
+};
+
+/// Records the key of each item returned by a scan
+class ScannedKeysCallback : public StatusCallback<GetValue> {
+public:
+    void callback(GetValue& result) {
+        keys.push_back(result.item->getKey());
+    }
+
+    std::vector<StoredDocKey> keys;
+};
+
 class CollectionsKVStoreTest : public KVStoreParamTest {
 public:
     CollectionsKVStoreTest()
@@ -298,6 +315,61 @@ TEST_P(CollectionsKVStoreTest, add_of_dropped) {
     }
 }
 
+// A scan restricted to one collection only returns that collection's keys
+// (and system events), but still moves lastReadSeqno past the skipped keys so
+// a paused scan resumes after them and the end of the range is seen.
+TEST_P(CollectionsKVStoreTest, collection_filtered_scan) {
+    CollectionsManifest cm;
+    cm.add(CollectionEntry::fruit).add(CollectionEntry::vegetable);
+    applyAndCheck(cm, 3, 1);
+
+    // Interleave the two collections, ending with a vegetable key
+    int64_t seqno = vbucket.getHighSeqno();
+    std::vector<StoredDocKey> fruitKeys;
+    kvstore->begin(std::make_unique<TransactionContext>());
+    for (int i = 0; i < 3; i++) {
+        StoredDocKey fruit{"fruit" + std::to_string(i), CollectionEntry::fruit};
+        StoredDocKey vegetable{"vegetable" + std::to_string(i),
+                               CollectionEntry::vegetable};
+        for (const auto& key : {fruit, vegetable}) {
+            Item item(key,
+                      0,
+                      0,
+                      "value",
+                      5,
+                      PROTOCOL_BINARY_RAW_BYTES,
+                      0,
+                      ++seqno);
+            kvstore->set(item, wc);
+        }
+        fruitKeys.push_back(fruit);
+    }
+    kvstore->commit(flush);
+
+    auto cb = std::make_shared<ScannedKeysCallback>();
+    auto cl = std::make_shared<NoCacheLookupCallback>();
+    auto* scanCtx = kvstore->initScanContext(cb,
+                                             cl,
+                                             Vbid(0),
+                                             1,
+                                             DocumentFilter::ALL_ITEMS,
+                                             ValueFilter::VALUES_DECOMPRESSED);
+    ASSERT_NE(nullptr, scanCtx);
+    scanCtx->collectionsContext.setCollectionFilter(
+            {CollectionEntry::fruit.getId()});
+    EXPECT_EQ(scan_success, kvstore->scan(scanCtx));
+    EXPECT_EQ(seqno, scanCtx->lastReadSeqno);
+    kvstore->destroyScanContext(scanCtx);
+
+    std::vector<StoredDocKey> scannedKeys;
+    for (const auto& key : cb->keys) {
+        if (key.getCollectionID() != CollectionID::System) {
+            scannedKeys.push_back(key);
+        }
+    }
+    EXPECT_EQ(fruitKeys, scannedKeys);
+}
+
 static std::string kvstoreTestParams[] = {"couchdb"};
 
 INSTANTIATE_TEST_CASE_P(CollectionsKVStoreTests,
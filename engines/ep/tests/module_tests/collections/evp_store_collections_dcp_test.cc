@@ -20,6 +20,7 @@
  */
 #include "bgfetcher.h"
 #include "collections/manager.h"
+#include "dcp/backfill_disk.h"
 #include "dcp/dcpconnmap.h"
 #include "failover-table.h"
 #include "kvstore.h"
@@ -28,6 +29,7 @@
 #include "tests/mock/mock_dcp_consumer.h"
 #include "tests/mock/mock_dcp_producer.h"
 #include "tests/mock/mock_global_task.h"
+#include "tests/mock/mock_stream.h"
 #include "tests/mock/mock_synchronous_ep_engine.h"
 #include "tests/module_tests/collections/collections_dcp_test.h"
 #include "tests/module_tests/collections/test_manifest.h"
@@ -1221,6 +1223,101 @@ TEST_F(CollectionsFilteredDcpTest, filtering) {
     testDcpCreateDelete({CollectionEntry::dairy}, {}, 2, false);
 }
 
+/**
+ * With dcp_backfill_coalescing enabled, the disk backfill of a collection
+ * filtered stream opens a scan which only reads that stream's collections.
+ * Another stream can share the scan only if it needs a subset of those
+ * collections, and each stream is only sent the keys of its collections.
+ */
+TEST_F(CollectionsFilteredDcpTest, filtering_shared_backfill) {
+    engine->getConfiguration().setDcpBackfillCoalescing(true);
+
+    CollectionsManifest cm;
+    store->setCollections(
+            {cm.add(CollectionEntry::meat).add(CollectionEntry::dairy)});
+    store_item(vbid, StoredDocKey{"meat:one", CollectionEntry::meat}, "value");
+    store_item(
+            vbid, StoredDocKey{"dairy:one", CollectionEntry::dairy}, "value");
+    store_item(vbid, StoredDocKey{"meat:two", CollectionEntry::meat}, "value");
+    flush_vbucket_to_disk(vbid, 5);
+    ensureDcpWillBackfill();
+
+    auto vb = store->getVBucket(vbid);
+    const auto highSeqno = uint64_t(vb->getHighSeqno());
+    auto* cookie = create_mock_cookie();
+    auto backfillProducer =
+            std::make_shared<MockDcpProducer>(*engine,
+                                              cookie,
+                                              "test_producer",
+                                              /*flags*/ 0,
+                                              /*startTask*/ false);
+    auto makeStream = [this, &vb, &backfillProducer](const char* filter) {
+        auto stream = std::make_shared<MockActiveStream>(
+                static_cast<EventuallyPersistentEngine*>(engine.get()),
+                backfillProducer,
+                /*flags*/ 0,
+                /*opaque*/ 0,
+                *vb,
+                /*st_seqno*/ 0,
+                /*en_seqno*/ ~0,
+                /*vb_uuid*/ 0xabcd,
+                /*snap_start_seqno*/ 0,
+                /*snap_end_seqno*/ ~0,
+                IncludeValue::Yes,
+                IncludeXattrs::Yes,
+                cb::const_char_buffer{filter, strlen(filter)});
+        stream->transitionStateToBackfilling();
+        return stream;
+    };
+    auto dairy1 = makeStream(R"({"collections":["c"]})");
+    auto meat = makeStream(R"({"collections":["8"]})");
+    auto dairy2 = makeStream(R"({"collections":["c"]})");
+
+    DCPBackfillDisk dairyBackfill1(*engine, dairy1, 1, highSeqno);
+    DCPBackfillDisk meatBackfill(*engine, meat, 1, highSeqno);
+    DCPBackfillDisk dairyBackfill2(*engine, dairy2, 1, highSeqno);
+
+    // create: the first dairy backfill opens a scan of dairy only, which the
+    // meat backfill cannot share but the second dairy backfill can.
+    EXPECT_EQ(backfill_success, dairyBackfill1.run());
+    EXPECT_EQ(backfill_success, meatBackfill.run());
+    EXPECT_EQ(backfill_success, dairyBackfill2.run());
+    auto& registry = engine->getDcpConnMap().getDiskBackfillScanRegistry();
+    EXPECT_EQ(2, registry.getNumScansOpened());
+    EXPECT_EQ(1, registry.getNumScansShared());
+
+    for (auto* backfill : {&dairyBackfill1, &meatBackfill, &dairyBackfill2}) {
+        int runs = 0;
+        while (backfill->run() != backfill_finished) {
+            ASSERT_LT(++runs, 10) << "Backfill did not finish";
+        }
+    }
+
+    // Each stream is only sent the mutations of its collection
+    auto getKeys = [](MockActiveStream& stream) {
+        std::vector<StoredDocKey> keys;
+        while (auto response = stream.public_nextQueuedItem()) {
+            if (response->getEvent() == DcpResponse::Event::Mutation) {
+                keys.push_back(static_cast<MutationResponse&>(*response)
+                                       .getItem()
+                                       ->getKey());
+            }
+        }
+        return keys;
+    };
+    const std::vector<StoredDocKey> dairyKeys = {
+            StoredDocKey{"dairy:one", CollectionEntry::dairy}};
+    const std::vector<StoredDocKey> meatKeys = {
+            StoredDocKey{"meat:one", CollectionEntry::meat},
+            StoredDocKey{"meat:two", CollectionEntry::meat}};
+    EXPECT_EQ(dairyKeys, getKeys(*dairy1));
+    EXPECT_EQ(dairyKeys, getKeys(*dairy2));
+    EXPECT_EQ(meatKeys, getKeys(*meat));
+
+    backfillProducer->closeAllStreams();
+    destroy_mock_cookie(cookie);
+}
+
 TEST_F(CollectionsFilteredDcpTest, filtering_scope) {
     VBucketPtr vb = store->getVBucket(vbid);
 
@@ -1107,3 +1107,50 @@ TEST_F(CollectionsVBFilterTest, empty_scope_filter) {
 
     EXPECT_EQ(vbf.size(), 1);
 }
+
+/**
+ * getFixedCollections returns the collections a disk backfill may pre-filter
+ * on - only for filters whose collection set cannot grow.
+ */
+TEST_F(CollectionsVBFilterTest, fixed_collections) {
+    cm.add(CollectionEntry::vegetable)
+            .add(CollectionEntry::meat)
+            .add(CollectionEntry::fruit)
+            .add(CollectionEntry::dairy);
+    Collections::Manifest m(cm);
+    vbm.wlock().update(vb, m);
+
+    {
+        // Passthrough - everything is wanted, no fixed set
+        std::string jsonFilter;
+        boost::optional<cb::const_char_buffer> json(jsonFilter);
+        Collections::VB::Filter f(json, vbm);
+        EXPECT_FALSE(f.getFixedCollections());
+    }
+    {
+        // Legacy - just the default collection
+        boost::optional<cb::const_char_buffer> json;
+        Collections::VB::Filter f(json, vbm);
+        auto fixed = f.getFixedCollections();
+        ASSERT_TRUE(fixed);
+        EXPECT_EQ(std::unordered_set<CollectionID>{CollectionID::Default},
+                  *fixed);
+    }
+    {
+        // Explicit collections, including the default
+        std::string jsonFilter = R"({"collections":["0", "8", "9"]})";
+        boost::optional<cb::const_char_buffer> json(jsonFilter);
+        Collections::VB::Filter f(json, vbm);
+        auto fixed = f.getFixedCollections();
+        ASSERT_TRUE(fixed);
+        EXPECT_EQ(std::unordered_set<CollectionID>{CollectionID::Default, 8, 9},
+                  *fixed);
+    }
+    {
+        // Scope - collections may be added to the scope, no fixed set
+        std::string jsonFilter = R"({"scope":"0"})";
+        boost::optional<cb::const_char_buffer> json(jsonFilter);
+        Collections::VB::Filter f(json, vbm);
+        EXPECT_FALSE(f.getFixedCollections());
+    }
+}
@@ -252,6 +252,17 @@ TEST(ManifestTest, validation) {
                 "scopes":[{"name":"_default", "uid":"0",
                 "collections":[{"name":"_default","uid":"0"},
                                {"name":"brewery","uid":"9","max_ttl":4294967296}]}]})",
+            // memory_quota invalid cases
+            // wrong type
+            R"({"uid" : "0",
+                "scopes":[{"name":"_default", "uid":"0",
+                "collections":[{"name":"_default","uid":"0"},
+                               {"name":"brewery","uid":"9","memory_quota":"1"}]}]})",
+            // negative
+            R"({"uid" : "0",
+                "scopes":[{"name":"_default", "uid":"0",
+                "collections":[{"name":"_default","uid":"0"},
+                               {"name":"brewery","uid":"9","memory_quota":-1}]}]})",
             // Test duplicate scope names
             R"({"uid" : "0",
                 "scopes":[{"name":"_default", "uid":"0",
@@ -362,6 +373,16 @@ TEST(ManifestTest, validation) {
                 "scopes":[{"name":"_default", "uid":"0",
                 "collections":[{"name":"_default","uid":"0"},
                                {"name":"brewery","uid":"9","max_ttl":4294967295}]}]})",
+
+            // memory_quota valid cases
+            R"({"uid" : "0",
+                "scopes":[{"name":"_default", "uid":"0",
+                "collections":[{"name":"_default","uid":"0"},
+                               {"name":"brewery","uid":"9","memory_quota":0}]}]})",
+            R"({"uid" : "0",
+                "scopes":[{"name":"_default", "uid":"0",
+                "collections":[{"name":"_default","uid":"0"},
+                               {"name":"brewery","uid":"9","memory_quota":1073741824}]}]})",
     };
 
     for (auto& manifest : invalidManifests) {
@@ -415,6 +436,28 @@ TEST(ManifestTest, getUid) {
     }
 }
 
+TEST(ManifestTest, getMemoryQuotas) {
+    Collections::Manifest m(R"({"uid" : "0",
+                "scopes":[{"name":"_default", "uid":"0",
+                "collections":[{"name":"_default","uid":"0"},
+                               {"name":"beer", "uid":"8", "memory_quota":0},
+                               {"name":"brewery","uid":"9",
+                                "memory_quota":1048576}]},
+                          {"name":"brewerA", "uid":"8",
+                "collections":[{"name":"meat","uid":"a",
+                                "memory_quota":4096}]}]})");
+
+    // Only collections with a non-zero quota are returned
+    auto quotas = m.getMemoryQuotas();
+    EXPECT_EQ(2, quotas.size());
+    EXPECT_EQ(1048576, quotas.at(9));
+    EXPECT_EQ(4096, quotas.at(0xa));
+
+    // The quota survives a round trip through toJson
+    Collections::Manifest m2(m.toJson());
+    EXPECT_EQ(quotas, m2.getMemoryQuotas());
+}
+
 TEST(ManifestTest, findCollection) {
     std::string manifest =
             R"({"uid" : "0",
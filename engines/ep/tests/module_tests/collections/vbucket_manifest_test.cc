@@ -37,19 +37,19 @@ public:
     }
 
     bool exists(CollectionID identifier) const {
-        std::lock_guard<cb::ReaderLock> readLock(rwlock.reader());
+        auto readLock = rwlock.lockShared();
         return exists_UNLOCKED(identifier);
     }
 
     size_t size() const {
-        std::lock_guard<cb::ReaderLock> readLock(rwlock.reader());
+        auto readLock = rwlock.lockShared();
         return map.size();
     }
 
     bool compareEntry(CollectionID id,
                       const Collections::VB::ManifestEntry& entry,
                       bool ignoreHighSeqno = false) const {
-        std::lock_guard<cb::ReaderLock> readLock(rwlock.reader());
+        auto readLock = rwlock.lockShared();
         if (exists_UNLOCKED(id)) {
             auto itr = map.find(id);
             const auto& myEntry = itr->second;
@@ -75,7 +75,7 @@ public:
     }
 
     bool operator==(const MockVBManifest& rhs) const {
-        std::lock_guard<cb::ReaderLock> readLock(rwlock.reader());
+        auto readLock = rwlock.lockShared();
         if (rhs.size() != size()) {
             return false;
         }
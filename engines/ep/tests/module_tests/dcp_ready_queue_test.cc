@@ -0,0 +1,103 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Unit tests for the DcpReadyQueue class.
+ */
+
+#include "dcp/ready-queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(DcpReadyQueueTest, PushUnique) {
+    DcpReadyQueue queue(1024);
+    EXPECT_TRUE(queue.empty());
+
+    // Only the transition from empty reports true
+    EXPECT_TRUE(queue.pushUnique(Vbid(5)));
+    EXPECT_FALSE(queue.pushUnique(Vbid(5)));
+    EXPECT_FALSE(queue.pushUnique(Vbid(1023)));
+    EXPECT_EQ(2, queue.size());
+    EXPECT_TRUE(queue.exists(Vbid(5)));
+    EXPECT_TRUE(queue.exists(Vbid(1023)));
+    EXPECT_FALSE(queue.exists(Vbid(6)));
+
+    Vbid vbid(0);
+    EXPECT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(5), vbid);
+    EXPECT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(1023), vbid);
+    EXPECT_FALSE(queue.popFront(vbid));
+    EXPECT_TRUE(queue.empty());
+
+    EXPECT_TRUE(queue.pushUnique(Vbid(5)));
+}
+
+TEST(DcpReadyQueueTest, RoundRobin) {
+    DcpReadyQueue queue(200);
+    for (auto id : {3, 70, 150}) {
+        queue.pushUnique(Vbid(Vbid::id_type(id)));
+    }
+
+    Vbid vbid(0);
+    ASSERT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(3), vbid);
+
+    // Re-queueing a vbucket (as getNextItem does after sending an item)
+    // puts it behind the other ready vbuckets
+    queue.pushUnique(Vbid(3));
+    ASSERT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(70), vbid);
+    queue.pushUnique(Vbid(70));
+    ASSERT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(150), vbid);
+    ASSERT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(3), vbid);
+    ASSERT_TRUE(queue.popFront(vbid));
+    EXPECT_EQ(Vbid(70), vbid);
+    EXPECT_FALSE(queue.popFront(vbid));
+}
+
+TEST(DcpReadyQueueTest, ConcurrentPush) {
+    const size_t vbuckets = 1024;
+    DcpReadyQueue queue(vbuckets);
+
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < 4; ++ii) {
+        threads.emplace_back([&queue]() {
+            for (size_t id = 0; id < vbuckets; ++id) {
+                queue.pushUnique(Vbid(Vbid::id_type(id)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(vbuckets, queue.size());
+    Vbid vbid(0);
+    size_t popped = 0;
+    while (queue.popFront(vbid)) {
+        EXPECT_EQ(popped, vbid.get());
+        ++popped;
+    }
+    EXPECT_EQ(vbuckets, popped);
+    EXPECT_TRUE(queue.empty());
+}
@@ -1325,6 +1325,70 @@ TEST_P(CacheCallbackTest, CacheCallback_engine_enomem) {
     EXPECT_EQ(0, stream->public_readyQ().size());
 }
 
+/*
+ * Test that with dcp_backfill_coalescing enabled, the disk backfill of a
+ * second stream (on a different producer) for the same vBucket attaches to
+ * the disk scan opened by the first, and that both streams are sent the
+ * items read by that single scan.
+ */
+TEST_P(CacheCallbackTest, DiskBackfillScanShared) {
+    if (bucketType == "ephemeral") {
+        /* Ephemeral buckets don't do disk backfill */
+        return;
+    }
+    engine->getConfiguration().setDcpBackfillCoalescing(true);
+
+    auto* cookie2 = create_mock_cookie();
+    auto producer2 = std::make_shared<MockDcpProducer>(*engine,
+                                                       cookie2,
+                                                       "test_producer2",
+                                                       /*flags*/ 0,
+                                                       /*startTask*/ false);
+    auto stream2 = std::make_shared<MockActiveStream>(engine,
+                                                      producer2,
+                                                      /*flags*/ 0,
+                                                      /*opaque*/ 0,
+                                                      *vb0,
+                                                      /*st_seqno*/ 0,
+                                                      /*en_seqno*/ ~0,
+                                                      /*vb_uuid*/ 0xabcd,
+                                                      /*snap_start_seqno*/ 0,
+                                                      /*snap_end_seqno*/ ~0);
+    stream2->setActive();
+
+    stream->transitionStateToBackfilling();
+    stream2->transitionStateToBackfilling();
+
+    DCPBackfillDisk backfill1(*engine, stream, 1, numItems);
+    DCPBackfillDisk backfill2(*engine, stream2, 1, numItems);
+
+    // create: the first backfill opens the scan, the second attaches to it.
+    EXPECT_EQ(backfill_success, backfill1.run());
+    EXPECT_EQ(backfill_success, backfill2.run());
+    auto& registry = engine->getDcpConnMap().getDiskBackfillScanRegistry();
+    EXPECT_EQ(1, registry.getNumScansOpened());
+    EXPECT_EQ(1, registry.getNumScansShared());
+
+    // scan: running the first backfill sends the item to both streams.
+    EXPECT_EQ(backfill_success, backfill1.run());
+    EXPECT_EQ(numItems, stream->getNumBackfillItems());
+    EXPECT_EQ(numItems, stream2->getNumBackfillItems());
+
+    // The second backfill finds the shared scan already done; both complete.
+    EXPECT_EQ(backfill_success, backfill2.run());
+    EXPECT_EQ(backfill_success, backfill1.run());
+    EXPECT_EQ(backfill_success, backfill2.run());
+    EXPECT_EQ(backfill_finished, backfill1.run());
+    EXPECT_EQ(backfill_finished, backfill2.run());
+
+    // Snapshot marker + item on each stream
+    EXPECT_EQ(1 + numItems, stream->public_readyQ().size());
+    EXPECT_EQ(1 + numItems, stream2->public_readyQ().size());
+
+    producer2->closeAllStreams();
+    destroy_mock_cookie(cookie2);
+}
+
 // Test cases which run in both Full and Value eviction
 INSTANTIATE_TEST_CASE_P(PersistentAndEphemeral,
                         StreamTest,
@@ -660,6 +660,66 @@ TEST_P(CompressionStreamTest, force_value_compression_enabled) {
     destroy_dcp_stream();
 }
 
+/**
+ * Test adaptive DCP compression
+ *
+ *  - A value which compresses well is sent compressed
+ *  - A value which doesn't compress is sent as is, and the stream then
+ *    sends the next value without trying to compress it
+ *  - Once the backoff has expired values are compressed again
+ */
+TEST_P(CompressionStreamTest, adaptive_value_compression) {
+    std::string compressible;
+    for (int ii = 0; ii < 10; ++ii) {
+        compressible.append(R"({"product": "car","price": "100"},)");
+    }
+    std::string incompressible(
+            "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+    mock_set_datatype_support(cookie, PROTOCOL_BINARY_DATATYPE_SNAPPY);
+    setup_dcp_stream(0,
+                     IncludeValue::Yes,
+                     IncludeXattrs::Yes,
+                     {{"adaptive_value_compression", "true"}});
+    ASSERT_TRUE(producer->isAdaptiveValueCompressionEnabled());
+    ASSERT_TRUE(stream->isAdaptiveValueCompressionEnabled());
+
+    auto makeResponse = [this](const std::string& key,
+                               const std::string& value,
+                               protocol_binary_datatype_t datatype) {
+        queued_item qi = makeCompressibleItem(vbid,
+                                              makeStoredDocKey(key),
+                                              value,
+                                              datatype,
+                                              false, // not compressed
+                                              false); // no xattrs
+        auto response = stream->public_makeResponseFromItem(qi);
+        auto* mutation = dynamic_cast<MutationResponse*>(response.get());
+        EXPECT_NE(nullptr, mutation);
+        return mutation->getItem()->getDataType();
+    };
+
+    using mcbp::datatype::is_snappy;
+    EXPECT_TRUE(is_snappy(
+            makeResponse("key1", compressible, PROTOCOL_BINARY_DATATYPE_JSON)));
+    EXPECT_EQ(1, stream->getNumValuesCompressed());
+
+    EXPECT_FALSE(is_snappy(
+            makeResponse("key2", incompressible, PROTOCOL_BINARY_RAW_BYTES)));
+    EXPECT_EQ(1, stream->getNumValuesRejectedForCompression());
+
+    // Backing off - sent as is without trying
+    EXPECT_FALSE(is_snappy(
+            makeResponse("key3", compressible, PROTOCOL_BINARY_DATATYPE_JSON)));
+    EXPECT_EQ(1, stream->getNumValuesSkippedForCompression());
+
+    EXPECT_TRUE(is_snappy(
+            makeResponse("key4", compressible, PROTOCOL_BINARY_DATATYPE_JSON)));
+    EXPECT_EQ(2, stream->getNumValuesCompressed());
+
+    destroy_dcp_stream();
+}
+
 class ConnectionTest : public DCPTest,
                        public ::testing::WithParamInterface<
                                std::tuple<std::string, std::string>> {
@@ -600,3 +600,90 @@ TEST_F(DurabilityMonitorTest, DontInvalidateIteratorsAtOutOfOrderCommit) {
     // invalid A(m) iterator)
     addSyncWrite(10 /*seqno*/);
 }
+
+/*
+ * Out-of-order commits leave gaps in the tracked SyncWrites; check that the
+ * node tracking stays correct while the tracked SyncWrites grow (and are
+ * then drained) across such gaps.
+ */
+TEST_F(DurabilityMonitorTest, OutOfOrderCommitWithManyTracked) {
+    std::unordered_set<int64_t> persistSeqnos;
+    for (int64_t seqno = 1; seqno <= 32; seqno++) {
+        if (seqno % 2) {
+            addSyncWrite(seqno, {cb::durability::Level::PersistToMajority, 0});
+            persistSeqnos.insert(seqno);
+        } else {
+            addSyncWrite(seqno, {cb::durability::Level::Majority, 0});
+        }
+    }
+    ASSERT_EQ(32, monitor->public_getNumTracked());
+
+    // Replica acks memSeqno:32, all the Majority SyncWrites are committed
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 32 /*memSeqno*/, 0 /*diskSeqno*/));
+    EXPECT_EQ(persistSeqnos, monitor->public_getTrackedSeqnos());
+    assertNodeMemTracking(replica, 32 /*lastWriteSeqno*/, 32 /*lastAckSeqno*/);
+
+    // More SyncWrites behind the (still tracked) PersistToMajority ones
+    EXPECT_EQ(32, addSyncWrites(33 /*seqnoStart*/, 64 /*seqnoEnd*/));
+    ASSERT_EQ(48, monitor->public_getNumTracked());
+    assertNodeMemTracking(active, 64 /*lastWriteSeqno*/, 64 /*lastAckSeqno*/);
+
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 64 /*memSeqno*/, 0 /*diskSeqno*/));
+    EXPECT_EQ(persistSeqnos, monitor->public_getTrackedSeqnos());
+    assertNodeMemTracking(replica, 64 /*lastWriteSeqno*/, 64 /*lastAckSeqno*/);
+
+    // Persist on both nodes, the remaining SyncWrites are committed
+    vb->setPersistenceSeqno(64);
+    monitor->notifyLocalPersistence();
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 64 /*memSeqno*/, 64 /*diskSeqno*/));
+    EXPECT_EQ(0, monitor->public_getNumTracked());
+    assertNodeDiskTracking(active, 31 /*lastWriteSeqno*/, 64 /*lastAckSeqno*/);
+    assertNodeDiskTracking(replica, 31 /*lastWriteSeqno*/, 64 /*lastAckSeqno*/);
+
+    // Tracking continues as normal
+    addSyncWrite(65);
+    assertNodeMemTracking(active, 65 /*lastWriteSeqno*/, 65 /*lastAckSeqno*/);
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 65 /*memSeqno*/, 64 /*diskSeqno*/));
+    EXPECT_EQ(0, monitor->public_getNumTracked());
+}
+
+/*
+ * The tracked SyncWrites buffer grows to hold a burst of SyncWrites, and
+ * shrinks back once they are committed.
+ */
+TEST_F(DurabilityMonitorTest, TrackedWritesShrinkAfterBurst) {
+    ASSERT_EQ(1000, addSyncWrites(1 /*seqnoStart*/, 1000 /*seqnoEnd*/));
+    ASSERT_EQ(1000, monitor->public_getNumTracked());
+    EXPECT_EQ(1024, monitor->public_getTrackedCapacity());
+
+    // Commit the first half, the buffer is still more than a quarter full
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 500 /*memSeqno*/, 0 /*diskSeqno*/));
+    EXPECT_EQ(500, monitor->public_getNumTracked());
+    EXPECT_EQ(1024, monitor->public_getTrackedCapacity());
+
+    // Commit the rest, the buffer is back to its initial capacity
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 1000 /*memSeqno*/, 0 /*diskSeqno*/));
+    EXPECT_EQ(0, monitor->public_getNumTracked());
+    EXPECT_EQ(16, monitor->public_getTrackedCapacity());
+
+    // Tracking continues as normal
+    EXPECT_EQ(1, addSyncWrites(1001 /*seqnoStart*/, 1001 /*seqnoEnd*/));
+    ASSERT_EQ(ENGINE_SUCCESS,
+              monitor->seqnoAckReceived(
+                      replica, 1001 /*memSeqno*/, 0 /*diskSeqno*/));
+    EXPECT_EQ(0, monitor->public_getNumTracked());
+    assertNodeMemTracking(
+            replica, 1001 /*lastWriteSeqno*/, 1001 /*lastAckSeqno*/);
+}
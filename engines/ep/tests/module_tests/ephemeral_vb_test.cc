@@ -645,8 +645,6 @@ TEST_F(EphTombstoneTest, ImmediatePurgeOfAliveStale) {
     // be added for that key.
     auto& seqList = mockEpheVB->getLL()->getSeqList();
     {
-        std::lock_guard<std::mutex> rrGuard(
-                mockEpheVB->getLL()->getRangeReadLock());
         mockEpheVB->registerFakeReadRange(1, 2);
         ASSERT_EQ(MutationStatus::WasClean, setOne(keys.at(1)));
 
@@ -673,7 +671,7 @@ TEST_F(EphTombstoneTest, ImmediatePurgeOfAliveStale) {
         // Clear the ReadRange (so we can actually purge items) and retry the
         // purge which should now succeed.
         mockEpheVB->getLL()->resetReadRange();
-    } // END rrGuard.
+    }
 
     // Scan sequenceList for stale items.
     EXPECT_EQ(1, mockEpheVB->purgeStaleItems());
@@ -30,6 +30,7 @@
 #include "checkpoint_utils.h"
 #include "dcp/active_stream_checkpoint_processor_task.h"
 #include "dcp/backfill-manager.h"
+#include "dcp/backfill_disk.h"
 #include "dcp/dcpconnmap.h"
 #include "ep_time.h"
 #include "ephemeral_tombstone_purger.h"
@@ -1721,6 +1722,104 @@ TEST_F(SingleThreadedEPBucketTest, MB18452_yield_dcp_processor) {
     consumer->closeStream(/*opaque*/0, vbid);
 }
 
+/*
+ * Test that with more than one DCP consumer processor task, each processor
+ * only applies the buffered messages of the vBuckets assigned to it.
+ */
+TEST_F(SingleThreadedEPBucketTest, DcpConsumerProcessorsPartitionVBuckets) {
+    engine->getConfiguration().setDcpConsumerProcessorTasks(2);
+
+    const Vbid vbid0 = Vbid(0);
+    const Vbid vbid1 = Vbid(1);
+    setVBucketStateAndRunPersistTask(vbid0, vbucket_state_replica);
+    setVBucketStateAndRunPersistTask(vbid1, vbucket_state_replica);
+
+    auto consumer = std::make_shared<MockDcpConsumer>(*engine, cookie, "test");
+    EXPECT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid0, /*flags*/ 0));
+    EXPECT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid1, /*flags*/ 0));
+
+    // Force the streams to buffer rather than process messages immediately
+    const ssize_t queueCap =
+            engine->getEpStats().replicationThrottleWriteQueueCap;
+    engine->getEpStats().replicationThrottleWriteQueueCap = 0;
+
+    // The consumer assigns opaques 1 and 2 to the streams of vb:0 and vb:1
+    uint32_t opaque = 1;
+    for (auto vb : {vbid0, vbid1}) {
+        consumer->snapshotMarker(opaque,
+                                 vb,
+                                 /*startseq*/ 0,
+                                 /*endseq*/ 1,
+                                 /*flags*/ 0);
+
+        const DocKey docKey{"key", DocKeyEncodesCollectionId::No};
+        std::string value = "value";
+        consumer->mutation(opaque,
+                           docKey,
+                           {(const uint8_t*)value.c_str(), value.length()},
+                           0, // privileged bytes
+                           PROTOCOL_BINARY_RAW_BYTES, // datatype
+                           0, // cas
+                           vb, // vbucket
+                           0, // flags
+                           1, // bySeqno
+                           0, // revSeqno
+                           0, // exptime
+                           0, // locktime
+                           {}, // meta
+                           0); // nru
+        consumer->public_notifyVbucketReady(vb);
+        opaque++;
+    }
+
+    engine->getEpStats().replicationThrottleWriteQueueCap = queueCap;
+
+    // Processor 0 owns vb:0, so only vb:0 is updated by it.
+    consumer->processBufferedItems(0);
+    EXPECT_EQ(1, store->getVBucket(vbid0)->getHighSeqno());
+    EXPECT_EQ(0, store->getVBucket(vbid1)->getHighSeqno());
+
+    // Processor 1 owns vb:1.
+    consumer->processBufferedItems(1);
+    EXPECT_EQ(1, store->getVBucket(vbid1)->getHighSeqno());
+
+    consumer->closeStream(/*opaque*/ 0, vbid0);
+    consumer->closeStream(/*opaque*/ 0, vbid1);
+}
+
+/*
+ * Test that with more than one DCP consumer processor task, a new set of
+ * tasks isn't created while any task of the previous set still exists.
+ */
+TEST_F(SingleThreadedEPBucketTest, DcpConsumerProcessorTasksCreatedOnce) {
+    engine->getConfiguration().setDcpConsumerProcessorTasks(2);
+
+    const Vbid vbid0 = Vbid(0);
+    const Vbid vbid1 = Vbid(1);
+    setVBucketStateAndRunPersistTask(vbid0, vbucket_state_replica);
+    setVBucketStateAndRunPersistTask(vbid1, vbucket_state_replica);
+
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    const auto initialTasks = lpNonioQ.getFutureQueueSize();
+
+    auto consumer = std::make_shared<MockDcpConsumer>(*engine, cookie, "test");
+    EXPECT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid0, /*flags*/ 0));
+    EXPECT_EQ(initialTasks + 2, lpNonioQ.getFutureQueueSize());
+
+    // Simulate the first of the tasks being destroyed; the second still
+    // exists so no new tasks should be created for the next stream.
+    consumer->taskCancelled();
+    EXPECT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid1, /*flags*/ 0));
+    EXPECT_EQ(initialTasks + 2, lpNonioQ.getFutureQueueSize());
+
+    consumer->closeStream(/*opaque*/ 0, vbid0);
+    consumer->closeStream(/*opaque*/ 0, vbid1);
+}
+
 /**
  * MB-29861: Ensure that a delete time is generated for a document
  * that is received on the consumer side as a result of a disk
@@ -3621,6 +3720,94 @@ TEST_F(SingleThreadedEPBucketTest, ProducerReadyQConnectionLimitOnBackfill) {
     producerReadyQLimitOnBackfill(BackfillBufferLimit::ConnectionByte);
 }
 
+/*
+ * Test that a disk scan shared by two producers' backfills (with
+ * dcp_backfill_coalescing) is driven to the end by one backfill alone when
+ * there are more items than dcp_scan_item_limit: the driver must reset the
+ * other producer's scan buffer each run, and snooze rather than spin while
+ * the other producer's backfill buffer is full.
+ */
+TEST_F(SingleThreadedEPBucketTest, SharedBackfillScanItemLimit) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    engine->getConfiguration().setDcpBackfillCoalescing(true);
+
+    const int numItems = 6;
+    for (int ii = 0; ii < numItems; ++ii) {
+        store_item(vbid, makeStoredDocKey("key_" + std::to_string(ii)), "v");
+    }
+    flush_vbucket_to_disk(vbid, numItems);
+    auto vb = store->getVBuckets().getBucket(vbid);
+
+    auto* cookie2 = create_mock_cookie();
+    auto producer = std::make_shared<MockDcpProducer>(
+            *engine, cookie, "test-producer", 0 /*flags*/, false /*startTask*/);
+    auto producer2 = std::make_shared<MockDcpProducer>(*engine,
+                                                       cookie2,
+                                                       "test-producer2",
+                                                       0 /*flags*/,
+                                                       false /*startTask*/);
+    auto makeStream = [this, &vb](std::shared_ptr<MockDcpProducer> p) {
+        auto s = std::make_shared<MockActiveStream>(
+                engine.get(),
+                p,
+                DCP_ADD_STREAM_FLAG_DISKONLY /* flags */,
+                0 /* opaque */,
+                *vb,
+                0 /* startSeqno */,
+                std::numeric_limits<uint64_t>::max() /* endSeqno */,
+                0 /* vbUuid */,
+                0 /* snapStartSeqno */,
+                0 /* snapEndSeqno */);
+        s->transitionStateToBackfilling();
+        // Fewer items per run than in the vBucket
+        p->public_getBackfillScanBuffer().maxItems = 2;
+        return s;
+    };
+    auto stream = makeStream(producer);
+    auto stream2 = makeStream(producer2);
+
+    DCPBackfillDisk backfill1(*engine, stream, 1, numItems);
+    DCPBackfillDisk backfill2(*engine, stream2, 1, numItems);
+    // create: the second backfill attaches to the scan of the first
+    ASSERT_EQ(backfill_success, backfill1.run());
+    ASSERT_EQ(backfill_success, backfill2.run());
+    ASSERT_EQ(1, engine->getDcpConnMap()
+                         .getDiskBackfillScanRegistry()
+                         .getNumScansShared());
+
+    // Only backfill1 runs from here on; its own BackfillManager resets its
+    // scan buffer between runs, which we do by hand.
+    ASSERT_EQ(backfill_success, backfill1.run());
+    EXPECT_EQ(2, stream->getNumBackfillItems());
+    EXPECT_EQ(2, stream2->getNumBackfillItems());
+
+    // With producer2's backfill buffer full the driver cannot make progress
+    // for stream2, so it must snooze.
+    const auto bufferSize =
+            engine->getConfiguration().getDcpBackfillByteLimit();
+    producer2->setBackfillBufferSize(0);
+    producer2->bytesForceRead(1);
+    producer->getBFM().resetScanBuffer();
+    EXPECT_EQ(backfill_snooze, backfill1.run());
+    EXPECT_EQ(2, stream2->getNumBackfillItems());
+
+    // Drain producer2; the driver then sends every item to both streams.
+    producer2->setBackfillBufferSize(bufferSize);
+    producer2->recordBackfillManagerBytesSent(1);
+    ASSERT_FALSE(producer2->getBackfillBufferFullStatus());
+    for (int ii = 0; ii < numItems && stream2->getNumBackfillItems() < numItems;
+         ++ii) {
+        producer->getBFM().resetScanBuffer();
+        ASSERT_EQ(backfill_success, backfill1.run());
+    }
+    EXPECT_EQ(numItems, stream->getNumBackfillItems());
+    EXPECT_EQ(numItems, stream2->getNumBackfillItems());
+
+    producer2->closeAllStreams();
+    producer->closeAllStreams();
+    destroy_mock_cookie(cookie2);
+}
+
 /*
  * Test to verify that if retain_erroneous_tombstones is set to
  * true, then the compactor will retain the tombstones, and if
@@ -368,6 +368,7 @@ protected:
 
     void TearDown() override {
         EXPECT_EQ(0, ht.getItemMemory());
+        EXPECT_EQ(0, ht.getCollectionItemMemory(CollectionID::Default));
         EXPECT_EQ(0, ht.getUncompressedItemMemory());
         EXPECT_EQ(0, ht.getCacheSize());
         EXPECT_EQ(initialSize, stats.getCurrentSize());
@@ -736,6 +737,57 @@ TEST_P(HashTableStatsTest, CommittedSyncWrite) {
     EXPECT_TRUE(del(ht, key));
 }
 
+/// Check item memory is accounted to the collection of each item.
+TEST_P(HashTableStatsTest, CollectionMemory) {
+    HashTable ht(global_stats, makeFactory(true), 128, 1);
+    const CollectionID fruit = 8;
+    const CollectionID vegetable = 9;
+    auto key1 = makeStoredDocKey("key1", fruit);
+    auto key2 = makeStoredDocKey("key2", fruit);
+    auto key3 = makeStoredDocKey("key3", vegetable);
+    store(ht, key1);
+
+    // Not counted until enabled; enabling counts the existing items.
+    EXPECT_EQ(0, ht.getCollectionItemMemory(fruit));
+    ht.setCollectionMemoryTracking(true);
+    EXPECT_EQ(ht.getItemMemory(), ht.getCollectionItemMemory(fruit));
+
+    store(ht, key2);
+    store(ht, key3);
+
+    const auto fruitMem = ht.getCollectionItemMemory(fruit);
+    const auto vegetableMem = ht.getCollectionItemMemory(vegetable);
+    EXPECT_GT(fruitMem, vegetableMem);
+    EXPECT_EQ(0, ht.getCollectionItemMemory(CollectionID::Default));
+    EXPECT_EQ(ht.getItemMemory(), fruitMem + vegetableMem);
+
+    Collections::Summary summary;
+    summary[fruit] = 1;
+    ht.updateCollectionMemorySummary(summary);
+    EXPECT_EQ(fruitMem + 1, summary[fruit]);
+    EXPECT_EQ(vegetableMem, summary[vegetable]);
+
+    // Ejecting a value reduces only that collection's memory.
+    {
+        auto result = ht.findForWrite(key1);
+        ASSERT_TRUE(result.storedValue);
+        result.storedValue->markClean();
+        EXPECT_TRUE(ht.unlocked_ejectItem(
+                result.lock, result.storedValue, evictionPolicy));
+    }
+    EXPECT_LT(ht.getCollectionItemMemory(fruit), fruitMem);
+    EXPECT_EQ(vegetableMem, ht.getCollectionItemMemory(vegetable));
+
+    // Removing the remaining items returns each collection to zero.
+    if (evictionPolicy == VALUE_ONLY) {
+        EXPECT_TRUE(del(ht, key1));
+    }
+    EXPECT_TRUE(del(ht, key2));
+    EXPECT_TRUE(del(ht, key3));
+    EXPECT_EQ(0, ht.getCollectionItemMemory(fruit));
+    EXPECT_EQ(0, ht.getCollectionItemMemory(vegetable));
+}
+
 INSTANTIATE_TEST_CASE_P(ValueAndFullEviction,
                         HashTableStatsTest,
                         ::testing::Combine(::testing::Values(VALUE_ONLY,
@@ -0,0 +1,94 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Unit tests for the IOBudget class.
+ */
+
+#include "io_budget.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(IOBudgetTest, Unlimited) {
+    IOBudget budget;
+    EXPECT_FALSE(budget.isLimited());
+    const auto now = IOBudget::Clock::now();
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(now, budget.reserve(1024 * 1024, now));
+    }
+}
+
+TEST(IOBudgetTest, BytesPerSec) {
+    IOBudget budget(1000, 0);
+    ASSERT_TRUE(budget.isLimited());
+    const auto now = IOBudget::Clock::now();
+
+    // The first I/O can use the burst allowance and proceeds immediately.
+    EXPECT_LE(budget.reserve(1000, now), now);
+    // The burst allowance is only 100ms, so the next 1000 bytes must wait
+    // until the remaining 900ms of the first second has elapsed.
+    EXPECT_EQ(now + 900ms, budget.reserve(1000, now));
+    EXPECT_EQ(now + 1900ms, budget.reserve(500, now));
+    EXPECT_EQ(now + 2400ms, budget.reserve(1, now));
+}
+
+TEST(IOBudgetTest, OpsPerSec) {
+    IOBudget budget(0, 4);
+    const auto now = IOBudget::Clock::now();
+
+    // The size of each I/O is irrelevant; each costs 250ms of budget.
+    EXPECT_EQ(now - 100ms, budget.reserve(1024 * 1024, now));
+    EXPECT_EQ(now + 150ms, budget.reserve(1, now));
+    EXPECT_EQ(now + 400ms, budget.reserve(1, now));
+
+    // Budget left unused while idle is capped at the burst allowance.
+    const auto later = now + 10s;
+    EXPECT_EQ(later - 100ms, budget.reserve(1, later));
+    EXPECT_EQ(later + 150ms, budget.reserve(1, later));
+}
+
+TEST(IOBudgetTest, AvailableTime) {
+    IOBudget budget(1000, 0);
+    const auto now = IOBudget::Clock::now();
+
+    // Charges within the burst allowance are available immediately.
+    budget.reserve(100, now);
+    EXPECT_LE(budget.getAvailableTime(), now);
+
+    // Further I/O is only available once the charged bytes fit the budget.
+    budget.reserve(1000, now);
+    EXPECT_EQ(now + 1s, budget.getAvailableTime());
+
+    // An unlimited budget is always available.
+    budget.setBytesPerSec(0);
+    EXPECT_LE(budget.getAvailableTime(), now);
+}
+
+TEST(IOBudgetTest, MostRestrictiveLimitApplies) {
+    IOBudget budget(1000, 4);
+    const auto now = IOBudget::Clock::now();
+
+    budget.reserve(1000, now);
+    // 250ms of op budget but 1s of byte budget consumed.
+    EXPECT_EQ(now + 900ms, budget.reserve(1, now));
+
+    // Limits can be changed on the fly.
+    budget.setBytesPerSec(0);
+    EXPECT_EQ(now + 400ms, budget.reserve(1000, now));
+}
@@ -23,6 +23,7 @@
 #include "../mock/mock_paging_visitor.h"
 #include "bgfetcher.h"
 #include "checkpoint_manager.h"
+#include "collections/test_manifest.h"
 #include "ep_time.h"
 #include "evp_store_single_threaded_test.h"
 #include "item.h"
@@ -1105,6 +1106,59 @@ TEST_P(STValueEvictionExpiryPagerTest, MB_25991_ExpiryNonResident) {
     EXPECT_EQ(ENGINE_KEY_ENOENT, result.getStatus());
 }
 
+// Test that when a collection is over its memory quota the ItemPager only
+// evicts the items of that collection, leaving other collections resident.
+TEST_P(STItemPagerTest, CollectionOverMemoryQuotaPagedFirst) {
+    // The Expiry pager (fail_new_data) doesn't evict by collection.
+    if (std::get<1>(GetParam()) == "fail_new_data") {
+        return;
+    }
+
+    // fruit has a (tiny) quota, vegetable has none.
+    const std::string manifest = R"({"uid" : "1",
+        "scopes":[{"name":"_default", "uid":"0",
+        "collections":[{"name":"_default","uid":"0"},
+                       {"name":"fruit","uid":"9","memory_quota":1024},
+                       {"name":"vegetable","uid":"a"}]}]})";
+    ASSERT_EQ(cb::engine_errc::success, store->setCollections(manifest).code());
+
+    std::vector<StoredDocKey> fruitKeys;
+    std::vector<StoredDocKey> vegetableKeys;
+    auto& stats = engine->getEpStats();
+    while (stats.getEstimatedTotalMemoryUsed() <= stats.mem_high_wat.load()) {
+        const auto suffix = std::to_string(fruitKeys.size());
+        fruitKeys.push_back(
+                makeStoredDocKey("fruit_" + suffix, CollectionEntry::fruit));
+        vegetableKeys.push_back(makeStoredDocKey("vegetable_" + suffix,
+                                                 CollectionEntry::vegetable));
+        for (const auto& key : {fruitKeys.back(), vegetableKeys.back()}) {
+            auto item = make_item(vbid, key, {"x", 128}, 0 /*ttl*/);
+            ASSERT_EQ(ENGINE_SUCCESS, storeItem(item));
+        }
+    }
+
+    // Items must be clean, and not referenced by a checkpoint, to be evicted.
+    auto vb = store->getVBucket(vbid);
+    vb->checkpointManager->createNewCheckpoint();
+    flushDirectlyIfPersistent(vbid);
+
+    runHighMemoryPager();
+
+    auto countResident = [&vb](const std::vector<StoredDocKey>& keys) {
+        size_t resident = 0;
+        for (const auto& key : keys) {
+            auto result = vb->ht.findForRead(key, TrackReference::No);
+            if (result.storedValue && result.storedValue->isResident()) {
+                ++resident;
+            }
+        }
+        return resident;
+    };
+
+    EXPECT_LT(countResident(fruitKeys), fruitKeys.size());
+    EXPECT_EQ(vegetableKeys.size(), countResident(vegetableKeys));
+}
+
 // Test that if the eviction policy changes we re-initialise the item pager
 // phase to the correct value.
 TEST_P(STItemPagerTest, phaseWhenPolicyChange) {
@@ -26,6 +26,7 @@
 #include "bgfetcher.h"
 #include "checkpoint.h"
 #include "checkpoint_remover.h"
+#include "collections/manager.h"
 #include "dcp/dcpconnmap.h"
 #include "dcp/flow-control-manager.h"
 #include "ep_engine.h"
@@ -1376,6 +1377,100 @@ TEST_F(ExpiryLimitTest, gat) {
     EXPECT_NE(0, info.exptime);
 }
 
+// Front-end operations are counted against their vBucket and collection.
+TEST_P(KVBucketParamTest, OperationStats) {
+    auto key = makeStoredDocKey("key");
+    store_item(vbid, key, "value");
+    auto item = make_item(vbid, key, "value2");
+    ASSERT_EQ(ENGINE_SUCCESS, store->replace(item, cookie));
+
+    auto options = static_cast<get_options_t>(
+            QUEUE_BG_FETCH | HONOR_STATES | TRACK_REFERENCE | DELETE_TEMP |
+            HIDE_LOCKED_CAS | TRACK_STATISTICS);
+    ASSERT_EQ(ENGINE_SUCCESS,
+              store->get(key, vbid, cookie, options).getStatus());
+    delete_item(vbid, key);
+
+    const auto& vbStats = store->getVBucket(vbid)->opStats;
+    EXPECT_EQ(1, vbStats.getCount(OperationStats::Op::Get));
+    EXPECT_EQ(2, vbStats.getCount(OperationStats::Op::Store));
+    EXPECT_EQ(1, vbStats.getCount(OperationStats::Op::Delete));
+
+    const auto collectionStats =
+            getCollectionsManager().findOperationStats(CollectionID::Default);
+    ASSERT_TRUE(collectionStats);
+    EXPECT_EQ(4, collectionStats->getTotalCount());
+
+    // Other vBuckets are unaffected.
+    store->setVBucketState(Vbid(1), vbucket_state_active);
+    EXPECT_EQ(0, store->getVBucket(Vbid(1))->opStats.getTotalCount());
+}
+
+// A get which has to wait for a background fetch is counted once it
+// completes, timed from when it was first attempted.
+TEST_P(KVBucketParamTest, OperationStatsBGFetchedGet) {
+    if (engine->getConfiguration().getBucketType() != "persistent") {
+        return;
+    }
+    auto key = makeStoredDocKey("key");
+    store_item(vbid, key, "value");
+    flush_vbucket_to_disk(vbid);
+    evict_key(vbid, key);
+
+    auto options = static_cast<get_options_t>(
+            QUEUE_BG_FETCH | HONOR_STATES | TRACK_REFERENCE | DELETE_TEMP |
+            HIDE_LOCKED_CAS | TRACK_STATISTICS);
+    ASSERT_EQ(ENGINE_EWOULDBLOCK,
+              store->get(key, vbid, cookie, options).getStatus());
+    const auto& vbStats = store->getVBucket(vbid)->opStats;
+    EXPECT_EQ(0, vbStats.getCount(OperationStats::Op::Get));
+
+    const auto wait = std::chrono::milliseconds(10);
+    std::this_thread::sleep_for(wait);
+    runBGFetcherTask();
+    ASSERT_EQ(ENGINE_SUCCESS,
+              store->get(key, vbid, cookie, options).getStatus());
+    EXPECT_EQ(1, vbStats.getCount(OperationStats::Op::Get));
+    EXPECT_GE(vbStats.getLatencyAtPercentile(100), wait);
+
+    // The start of the get isn't left behind on the cookie
+    EXPECT_EQ(nullptr, engine->getEngineSpecific(cookie));
+}
+
+// A SyncWrite is counted once it is committed and the front-end has been
+// given its result, timed from when it was first attempted.
+TEST_P(KVBucketParamTest, OperationStatsSyncWrite) {
+    store->setVBucketState(
+            vbid,
+            vbucket_state_active,
+            {{"topology", nlohmann::json::array({{"active", "replica"}})}});
+
+    auto item = makePendingItem(makeStoredDocKey("key"), "value");
+    uint64_t cas = 0;
+    ASSERT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, item.get(), cas, OPERATION_SET));
+    auto vb = store->getVBucket(vbid);
+    EXPECT_EQ(0, vb->opStats.getCount(OperationStats::Op::Store));
+
+    const auto wait = std::chrono::milliseconds(10);
+    std::this_thread::sleep_for(wait);
+    ASSERT_EQ(ENGINE_SUCCESS,
+              vb->seqnoAcknowledged(
+                      "replica", 1 /*memSeqno*/, 1 /*diskSeqno*/));
+
+    // The front-end calls store again once notified of the commit
+    ASSERT_EQ(ENGINE_SUCCESS,
+              engine->storeInner(cookie, item.get(), cas, OPERATION_SET));
+    EXPECT_EQ(1, vb->opStats.getCount(OperationStats::Op::Store));
+    EXPECT_GE(vb->opStats.getLatencyAtPercentile(100), wait);
+    EXPECT_EQ(nullptr, engine->getEngineSpecific(cookie));
+
+    const auto collectionStats =
+            getCollectionsManager().findOperationStats(CollectionID::Default);
+    ASSERT_TRUE(collectionStats);
+    EXPECT_EQ(1, collectionStats->getCount(OperationStats::Op::Store));
+}
+
 // Test cases which run for EP (Full and Value eviction) and Ephemeral
 INSTANTIATE_TEST_CASE_P(EphemeralOrPersistent,
                         KVBucketParamTest,
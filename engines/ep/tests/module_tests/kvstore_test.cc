@@ -1272,6 +1272,38 @@ TEST_F(CouchKVStoreErrorInjectionTest, CompactFailedStatsTest) {
     EXPECT_EQ("1", stats["rw_0:failure_compaction"]);
 }
 
+/**
+ * Verify that a compaction can be cancelled while it runs, leaving the
+ * original file in place and not counting as a failure.
+ */
+TEST_F(CouchKVStoreErrorInjectionTest, CompactCancelled) {
+    populate_items(10);
+
+    CompactionConfig config;
+    {
+        compaction_ctx cctx(config, 0);
+        cctx.curr_time = 0;
+        cctx.isCancelled = []() { return true; };
+        EXPECT_FALSE(kvstore->compactDB(&cctx));
+        EXPECT_TRUE(cctx.cancelled);
+    }
+
+    std::map<std::string, std::string> stats;
+    kvstore->addStats(add_stat_callback, &stats, "");
+    EXPECT_EQ("0", stats["rw_0:failure_compaction"]);
+
+    // The original file is still in use and can be compacted later.
+    EXPECT_EQ(items.size(), kvstore->getItemCount(Vbid(0)));
+    {
+        compaction_ctx cctx(config, 0);
+        cctx.curr_time = 0;
+        cctx.isCancelled = []() { return false; };
+        EXPECT_TRUE(kvstore->compactDB(&cctx));
+        EXPECT_FALSE(cctx.cancelled);
+    }
+    EXPECT_EQ(items.size(), kvstore->getItemCount(Vbid(0)));
+}
+
 /**
  * Injects corruption (invalid header length) during
  * CouchKVStore::readVBState/couchstore_open_local_document
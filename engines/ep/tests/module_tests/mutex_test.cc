@@ -17,6 +17,7 @@
 
 #include "config.h"
 #include "common.h"
+#include "instrumented_mutex.h"
 #include "lock_timer.h"
 #include "locks.h"
 #include <gtest/gtest.h>
@@ -46,3 +47,63 @@ TEST(LockTimerTest, WriterLockHolder) {
         std::this_thread::sleep_for(std::chrono::milliseconds(2));
     }
 }
+
+TEST(InstrumentedMutexTest, SiteNames) {
+    EXPECT_EQ("hash_bucket", to_string(LockSite::HashBucket));
+    EXPECT_EQ("checkpoint_queue", to_string(LockSite::CheckpointQueue));
+    EXPECT_EQ("vbucket_state", to_string(LockSite::VBucketState));
+    EXPECT_EQ("collections_manifest",
+              to_string(LockSite::CollectionsManifest));
+}
+
+#ifdef EP_INSTRUMENT_LOCKS
+TEST(InstrumentedMutexTest, RecordsWaitAndHold) {
+    resetLockSiteHistograms();
+    InstrumentedMutex<std::mutex, LockSite::CheckpointQueue> m;
+    {
+        std::lock_guard<decltype(m)> lh(m);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    ASSERT_TRUE(m.try_lock());
+    m.unlock();
+
+    const auto& histograms = getLockSiteHistograms(LockSite::CheckpointQueue);
+    EXPECT_EQ(2, histograms.wait.total());
+    EXPECT_EQ(2, histograms.hold.total());
+    // Nothing else was recorded against other sites.
+    EXPECT_EQ(0, getLockSiteHistograms(LockSite::HashBucket).wait.total());
+}
+
+TEST(InstrumentedMutexTest, RWLockHolders) {
+    resetLockSiteHistograms();
+    InstrumentedRWLock<LockSite::VBucketState> m;
+    {
+        ReaderLockHolder rlh1(m);
+        ReaderLockHolder rlh2(m);
+    }
+    { WriterLockHolder wlh(m); }
+
+    const auto& histograms = getLockSiteHistograms(LockSite::VBucketState);
+    EXPECT_EQ(3, histograms.wait.total());
+    EXPECT_EQ(3, histograms.hold.total());
+
+    // A plain cb::RWLock is not instrumented.
+    cb::RWLock plain;
+    { ReaderLockHolder rlh(plain); }
+    EXPECT_EQ(3, histograms.wait.total());
+}
+
+TEST(InstrumentedMutexTest, TimerMove) {
+    resetLockSiteHistograms();
+    {
+        LockSiteTimer timer(LockSite::CollectionsManifest);
+        timer.acquired();
+        LockSiteTimer moved(std::move(timer));
+        // Only the timer moved to records the hold.
+    }
+    const auto& histograms =
+            getLockSiteHistograms(LockSite::CollectionsManifest);
+    EXPECT_EQ(1, histograms.wait.total());
+    EXPECT_EQ(1, histograms.hold.total());
+}
+#endif
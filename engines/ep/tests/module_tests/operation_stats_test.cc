@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "operation_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+using namespace std::chrono_literals;
+
+TEST(OperationStatsTest, LatencyBuckets) {
+    EXPECT_EQ(0, OperationStats::getLatencyBucket(0us));
+    EXPECT_EQ(1, OperationStats::getLatencyBucket(1us));
+    EXPECT_EQ(2, OperationStats::getLatencyBucket(2us));
+    EXPECT_EQ(2, OperationStats::getLatencyBucket(3us));
+    EXPECT_EQ(3, OperationStats::getLatencyBucket(4us));
+    EXPECT_EQ(11, OperationStats::getLatencyBucket(1024us));
+    // Everything large lands in the last bucket.
+    EXPECT_EQ(OperationStats::NumLatencyBuckets - 1,
+              OperationStats::getLatencyBucket(std::chrono::hours(1)));
+}
+
+TEST(OperationStatsTest, Counts) {
+    OperationStats stats;
+    stats.record(OperationStats::Op::Get, 1us);
+    stats.record(OperationStats::Op::Get, 1us);
+    stats.record(OperationStats::Op::Store, 1us);
+    EXPECT_EQ(2, stats.getCount(OperationStats::Op::Get));
+    EXPECT_EQ(1, stats.getCount(OperationStats::Op::Store));
+    EXPECT_EQ(0, stats.getCount(OperationStats::Op::Delete));
+    EXPECT_EQ(3, stats.getTotalCount());
+
+    stats.reset();
+    EXPECT_EQ(0, stats.getTotalCount());
+    EXPECT_EQ(0us, stats.getLatencyAtPercentile(50));
+}
+
+TEST(OperationStatsTest, Percentiles) {
+    OperationStats stats;
+    // 98 fast (bucket [8, 16)us), 2 slow (bucket [1024, 2048)us) ops.
+    for (int ii = 0; ii < 98; ++ii) {
+        stats.record(OperationStats::Op::Get, 10us);
+    }
+    stats.record(OperationStats::Op::Store, 1500us);
+    stats.record(OperationStats::Op::Store, 1500us);
+
+    EXPECT_EQ(16us, stats.getLatencyAtPercentile(0));
+    EXPECT_EQ(16us, stats.getLatencyAtPercentile(50));
+    EXPECT_EQ(16us, stats.getLatencyAtPercentile(98));
+    EXPECT_EQ(2048us, stats.getLatencyAtPercentile(99));
+    EXPECT_EQ(2048us, stats.getLatencyAtPercentile(100));
+}
+
+TEST(OperationStatsTest, AddStats) {
+    OperationStats stats;
+    stats.record(OperationStats::Op::Delete, 10us);
+
+    std::map<std::string, std::string> output;
+    stats.addStats("vb_0",
+                   [&output](const char* key,
+                             const uint16_t klen,
+                             const char* val,
+                             const uint32_t vlen,
+                             gsl::not_null<const void*>) {
+                       output[std::string(key, klen)] = std::string(val, vlen);
+                   },
+                   &output);
+
+    EXPECT_EQ("0", output["vb_0:get"]);
+    EXPECT_EQ("0", output["vb_0:store"]);
+    EXPECT_EQ("1", output["vb_0:delete"]);
+    EXPECT_EQ("1", output["vb_0:ops"]);
+    EXPECT_EQ("16", output["vb_0:latency_p50_us"]);
+    EXPECT_EQ("16", output["vb_0:latency_p99_us"]);
+    EXPECT_EQ("16", output["vb_0:latency_p999_us"]);
+}
@@ -0,0 +1,132 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "sharded_rwlock.h"
+#include "thread_gate.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST(ShardedRWLockTest, DefaultShardCount) {
+    ShardedRWLock lock;
+    EXPECT_GE(lock.getNumShards(), 1u);
+    EXPECT_LE(lock.getNumShards(), ShardedRWLock::MaxDefaultShards);
+    EXPECT_THROW(ShardedRWLock(0), std::invalid_argument);
+}
+
+TEST(ShardedRWLockTest, ReadLockMoveAndUnlock) {
+    ShardedRWLock lock(4);
+    ShardedRWLock::ReadLock empty;
+    EXPECT_FALSE(empty.owns_lock());
+
+    auto rl = lock.lockShared();
+    EXPECT_TRUE(rl.owns_lock());
+    empty = std::move(rl);
+    EXPECT_FALSE(rl.owns_lock());
+    EXPECT_TRUE(empty.owns_lock());
+    empty.unlock();
+    EXPECT_FALSE(empty.owns_lock());
+    empty.unlock();
+
+    // All shards released - the write lock must be obtainable.
+    std::lock_guard<ShardedRWLock> wl(lock);
+}
+
+// Readers on many threads may hold the lock at the same time.
+TEST(ShardedRWLockTest, ConcurrentReaders) {
+    ShardedRWLock lock(4);
+    const int numThreads = 8;
+    ThreadGate allLocked(numThreads);
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < numThreads; ii++) {
+        threads.emplace_back([&lock, &allLocked]() {
+            auto rl = lock.lockShared();
+            // Would deadlock if any reader excluded another.
+            allLocked.threadUp();
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_TRUE(allLocked.isComplete());
+}
+
+// A writer must exclude readers on every shard and vice-versa.
+TEST(ShardedRWLockTest, WriterExcludesReaders) {
+    ShardedRWLock lock(4);
+    const int numThreads = 8;
+    const int iterations = 2000;
+    // Protected by lock; written only by writers, checked by readers.
+    int value = 0;
+    std::atomic<bool> torn{false};
+    std::vector<std::thread> threads;
+
+    for (int ii = 0; ii < numThreads; ii++) {
+        threads.emplace_back([&]() {
+            for (int jj = 0; jj < iterations; jj++) {
+                auto rl = lock.lockShared();
+                if ((value % 2) != 0) {
+                    torn = true;
+                }
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        for (int jj = 0; jj < iterations; jj++) {
+            std::lock_guard<ShardedRWLock> wl(lock);
+            value++; // odd: mid-update
+            std::this_thread::yield();
+            value++;
+        }
+    });
+
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_FALSE(torn);
+    EXPECT_EQ(2 * iterations, value);
+}
+
+// A thread holding a read lock may read-lock again while a writer waits;
+// the nested acquisition goes to the same shard so cannot deadlock against
+// the writer.
+TEST(ShardedRWLockTest, RecursiveReadWithWaitingWriter) {
+    ShardedRWLock lock(4);
+    auto outer = lock.lockShared();
+
+    std::atomic<bool> writerDone{false};
+    std::thread writer([&lock, &writerDone]() {
+        std::lock_guard<ShardedRWLock> wl(lock);
+        writerDone = true;
+    });
+
+    // Give the writer a chance to start waiting.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    {
+        auto inner = lock.lockShared();
+        EXPECT_FALSE(writerDone);
+    }
+    EXPECT_FALSE(writerDone);
+    outer.unlock();
+    writer.join();
+    EXPECT_TRUE(writerDone);
+}
@@ -0,0 +1,158 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "stat_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+class StatCacheTest : public ::testing::Test {
+protected:
+    /// @return a snapshot of a single stat, taken at the given time.
+    static StatCache::SnapshotPtr makeSnapshot(StatCache::Clock::time_point at,
+                                               std::string value) {
+        auto snapshot = std::make_shared<StatCache::Snapshot>();
+        snapshot->takenAt = at;
+        snapshot->stats.emplace_back("stat", std::move(value));
+        return snapshot;
+    }
+
+    StatCache cache;
+    const StatCache::Clock::time_point start = StatCache::Clock::now();
+    // Stand-ins for connection cookies; only their addresses are used.
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+};
+
+// Waiters for a group share a single refresh, and collect its snapshot once
+// notified.
+TEST_F(StatCacheTest, WaitersShareRefresh) {
+    bool scheduleRefresh;
+    EXPECT_FALSE(cache.getOrWait("", &cookie1, start, scheduleRefresh));
+    EXPECT_TRUE(scheduleRefresh);
+    EXPECT_FALSE(cache.getOrWait("", &cookie2, start, scheduleRefresh));
+    EXPECT_FALSE(scheduleRefresh);
+
+    // Nothing to collect until the refresh has published.
+    EXPECT_FALSE(cache.collect("", &cookie1));
+
+    bool refreshAgain;
+    auto notified = cache.publish("", makeSnapshot(start, "a"), refreshAgain);
+    EXPECT_FALSE(refreshAgain);
+    EXPECT_THAT(notified,
+                ::testing::UnorderedElementsAre(&cookie1, &cookie2));
+
+    auto snapshot = cache.collect("", &cookie1);
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ("a", snapshot->stats.at(0).second);
+    // Only collected once.
+    EXPECT_FALSE(cache.collect("", &cookie1));
+    EXPECT_TRUE(cache.collect("", &cookie2));
+}
+
+// A snapshot is returned straight away to requests which accept its age.
+TEST_F(StatCacheTest, FreshSnapshot) {
+    bool scheduleRefresh;
+    bool refreshAgain;
+    cache.getOrWait("hash", &cookie1, start, scheduleRefresh);
+    cache.publish("hash", makeSnapshot(start, "a"), refreshAgain);
+
+    auto snapshot = cache.getOrWait("hash", &cookie2, start, scheduleRefresh);
+    ASSERT_TRUE(snapshot);
+    EXPECT_FALSE(scheduleRefresh);
+    EXPECT_EQ("a", snapshot->stats.at(0).second);
+
+    // Groups are cached independently.
+    EXPECT_FALSE(cache.getOrWait("dcp", &cookie2, start, scheduleRefresh));
+    EXPECT_TRUE(scheduleRefresh);
+
+    // Too old for a request which accepts nothing before start + 1s.
+    EXPECT_FALSE(
+            cache.getOrWait("hash", &cookie2, start + 1s, scheduleRefresh));
+    EXPECT_TRUE(scheduleRefresh);
+}
+
+// A waiter which only accepts a snapshot newer than the one being published
+// (it arrived while the refresh was running) needs another refresh.
+TEST_F(StatCacheTest, WaiterDuringRefresh) {
+    bool scheduleRefresh;
+    bool refreshAgain;
+    cache.getOrWait("", &cookie1, start, scheduleRefresh);
+    ASSERT_TRUE(scheduleRefresh);
+    cache.getOrWait("", &cookie2, start + 1s, scheduleRefresh);
+    ASSERT_FALSE(scheduleRefresh);
+
+    auto notified = cache.publish("", makeSnapshot(start, "a"), refreshAgain);
+    EXPECT_THAT(notified, ::testing::ElementsAre(&cookie1));
+    EXPECT_TRUE(refreshAgain);
+
+    // The refresh is still in progress, so no new one is needed.
+    cache.getOrWait("", &cookie1, start + 1s, scheduleRefresh);
+    EXPECT_FALSE(scheduleRefresh);
+
+    notified = cache.publish("", makeSnapshot(start + 1s, "b"), refreshAgain);
+    EXPECT_THAT(notified, ::testing::UnorderedElementsAre(&cookie1, &cookie2));
+    EXPECT_FALSE(refreshAgain);
+    EXPECT_EQ("b", cache.collect("", &cookie2)->stats.at(0).second);
+}
+
+// A disconnected cookie is neither notified nor left behind.
+TEST_F(StatCacheTest, RemoveCookie) {
+    bool scheduleRefresh;
+    bool refreshAgain;
+    cache.getOrWait("", &cookie1, start, scheduleRefresh);
+    cache.getOrWait("", &cookie2, start, scheduleRefresh);
+    cache.removeCookie(&cookie1);
+
+    auto notified = cache.publish("", makeSnapshot(start, "a"), refreshAgain);
+    EXPECT_THAT(notified, ::testing::ElementsAre(&cookie2));
+
+    cache.removeCookie(&cookie2);
+    EXPECT_FALSE(cache.collect("", &cookie2));
+}
+
+// After a reset every group must be computed afresh.
+TEST_F(StatCacheTest, Reset) {
+    bool scheduleRefresh;
+    bool refreshAgain;
+    cache.getOrWait("", &cookie1, start, scheduleRefresh);
+    cache.publish("", makeSnapshot(start, "a"), refreshAgain);
+    ASSERT_TRUE(cache.getOrWait("", &cookie2, start, scheduleRefresh));
+
+    cache.reset();
+    EXPECT_FALSE(cache.getOrWait("", &cookie2, start, scheduleRefresh));
+    EXPECT_TRUE(scheduleRefresh);
+}
+
+TEST_F(StatCacheTest, AddStats) {
+    auto snapshot = std::make_shared<StatCache::Snapshot>();
+    snapshot->stats = {{"a", "1"}, {"b", "2"}};
+    std::vector<std::pair<std::string, std::string>> added;
+    snapshot->addStats(
+            [&added](const char* key,
+                     const uint16_t klen,
+                     const char* val,
+                     const uint32_t vlen,
+                     gsl::not_null<const void*>) {
+                added.emplace_back(std::string(key, klen),
+                                   std::string(val, vlen));
+            },
+            &cookie1);
+    EXPECT_EQ(snapshot->stats, added);
+}
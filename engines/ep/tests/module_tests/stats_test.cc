@@ -200,6 +200,51 @@ TEST_F(StatTest, HashStatsMemUsed) {
     EXPECT_EQ(baselineMemory, engine->getEpStats().getPreciseTotalMemoryUsed());
 }
 
+// With stats_cache_enabled the stat groups which visit every vBucket are
+// computed by a background task and served from its snapshot while that is
+// within stats_cache_max_staleness.
+TEST_F(StatTest, CachedStats) {
+    engine->getConfiguration().setStatsCacheEnabled(true);
+    engine->getConfiguration().setStatsCacheMaxStaleness(
+            std::chrono::milliseconds(std::chrono::hours(1)).count());
+
+    std::map<std::string, std::string> stats;
+    auto addStat = [&stats](const char* key,
+                            const uint16_t klen,
+                            const char* val,
+                            const uint32_t vlen,
+                            gsl::not_null<const void*>) {
+        stats[std::string(key, klen)] = std::string(val, vlen);
+    };
+    const std::string group = "vbucket-seqno";
+    const auto highSeqno = "vb_" + std::to_string(vbid.get()) + ":high_seqno";
+    auto getStats = [this, &group, &addStat]() {
+        return engine->getStats(cookie, group.data(), group.size(), addStat);
+    };
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+
+    // Nothing cached yet - the request must wait for a refresh.
+    ASSERT_EQ(ENGINE_EWOULDBLOCK, getStats());
+    EXPECT_TRUE(stats.empty());
+    runNextTask(lpNonioQ, "Refreshing \"vbucket-seqno\" stats");
+    ASSERT_EQ(ENGINE_SUCCESS, getStats());
+    EXPECT_EQ("0", stats[highSeqno]);
+
+    // A new request is answered straight from the (now stale) snapshot.
+    store_item(vbid, makeStoredDocKey("key"), "value");
+    stats.clear();
+    ASSERT_EQ(ENGINE_SUCCESS, getStats());
+    EXPECT_EQ("0", stats[highSeqno]);
+
+    // With no staleness allowed it must wait for a new snapshot.
+    engine->getConfiguration().setStatsCacheMaxStaleness(0);
+    stats.clear();
+    ASSERT_EQ(ENGINE_EWOULDBLOCK, getStats());
+    runNextTask(lpNonioQ, "Refreshing \"vbucket-seqno\" stats");
+    ASSERT_EQ(ENGINE_SUCCESS, getStats());
+    EXPECT_EQ("1", stats[highSeqno]);
+}
+
 TEST_P(DatatypeStatTest, datatypesInitiallyZero) {
     // Check that the datatype stats initialise to 0
     auto vals = get_stat(nullptr);
@@ -491,3 +536,41 @@ TEST_F(EpStatsTest, memoryAllocated) {
 
     EXPECT_EQ(0, stats.getPreciseTotalMemoryUsed());
 }
+
+// Core-local counters updated concurrently from many threads must sum to the
+// total number of updates when read.
+TEST_F(EpStatsTest, coreLocalCounterTotal) {
+    EPStats stats;
+
+    const int nThreads = 4;
+    const int nOps = 1000;
+    ThreadGate tg(nThreads);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nThreads; i++) {
+        workers.push_back(std::thread([&tg, &stats]() {
+            tg.threadUp();
+            for (int op = 0; op < nOps; op++) {
+                ++stats.coreLocal.get()->numOpsGet;
+                stats.coreLocal.get()->totalEnqueued.fetch_add(2);
+            }
+        }));
+    }
+
+    for (int i = 0; i < nThreads; i++) {
+        workers.at(i).join();
+    }
+
+    EXPECT_EQ(nThreads * nOps,
+              stats.getCoreLocalTotal(&CoreLocalStats::numOpsGet));
+    EXPECT_EQ(2 * nThreads * nOps,
+              stats.getCoreLocalTotal(&CoreLocalStats::totalEnqueued));
+    EXPECT_EQ(0, stats.getCoreLocalTotal(&CoreLocalStats::numOpsStore));
+}
+
+// A core-local total which is transiently negative is reported as zero.
+TEST_F(EpStatsTest, coreLocalCounterNegative) {
+    EPStats stats;
+
+    stats.coreLocal.get()->totalDeduplicated.fetch_sub(10);
+    EXPECT_EQ(0, stats.getCoreLocalTotal(&CoreLocalStats::totalDeduplicated));
+}
@@ -0,0 +1,105 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <nlohmann/json_fwd.hpp>
+#include <platform/sized_buffer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace cb {
+namespace audit {
+
+/**
+ * The payload of an audit event in a compact binary form.
+ *
+ * Building the JSON payload of an audit event (and formatting its
+ * timestamp) on the thread generating the event is expensive compared to
+ * the operation being audited (e.g. a document read). A CompactEvent
+ * instead appends each field to a single buffer, and is only converted to
+ * JSON by the audit daemon's thread (see to_json()).
+ *
+ * Each field is encoded as its Type (one byte), its name (an unsigned
+ * LEB128 length followed by the name) and its value:
+ *
+ *     String:      unsigned LEB128 length followed by the string
+ *     Boolean:     one byte, 0 or 1
+ *     Unsigned:    unsigned LEB128
+ *     Timestamp:   microseconds since the epoch as an unsigned LEB128
+ *     BeginObject: no value; the following fields (until the matching
+ *                  EndObject) are the members of a nested object
+ *     EndObject:   no name and no value
+ */
+class CompactEvent {
+public:
+    enum class Type : uint8_t {
+        String = 0,
+        Boolean = 1,
+        Unsigned = 2,
+        Timestamp = 3,
+        BeginObject = 4,
+        EndObject = 5
+    };
+
+    CompactEvent();
+
+    /// Add a field containing the current time, which is converted to an
+    /// ISO-8601 timestamp (as ISOTime::generatetimestamp) by to_json()
+    void addTimestamp(const char* name);
+
+    void add(const char* name, cb::const_char_buffer value);
+
+    void add(const char* name, const char* value) {
+        add(name, cb::const_char_buffer{value, std::strlen(value)});
+    }
+
+    void add(const char* name, const std::string& value) {
+        add(name, cb::const_char_buffer{value.data(), value.size()});
+    }
+
+    void add(const char* name, bool value);
+
+    void add(const char* name, uint64_t value);
+
+    /// Start a nested object; must be followed by a matching endObject()
+    void beginObject(const char* name);
+
+    void endObject();
+
+    /**
+     * Decode the event into its JSON form
+     *
+     * @throws std::invalid_argument if the encoded data is invalid
+     */
+    nlohmann::json to_json() const;
+
+    /// @return the encoded event
+    const std::string& getData() const {
+        return data;
+    }
+
+private:
+    void addHeader(Type type, const char* name);
+    void addLeb128(uint64_t value);
+
+    std::string data;
+};
+
+} // namespace audit
+} // namespace cb
@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <memcached/audit_compact_event.h>
 #include <memcached/engine.h>
 #include <memory>
 
@@ -80,6 +81,19 @@ public:
      */
     virtual bool put_event(uint32_t eventid, cb::const_char_buffer payload) = 0;
 
+    /**
+     * Put an audit event into the audit trail. The event is only converted
+     * to JSON by the audit daemon's thread, so this is cheaper for the
+     * caller than building and formatting the JSON payload itself.
+     *
+     * @param eventid The identifier for the event to insert
+     * @param event the payload to insert to the audit trail. It is only
+     *              moved from if the event is queued, so the caller may
+     *              still use it (e.g. to log it) if false is returned
+     * @return as put_event(uint32_t, cb::const_char_buffer)
+     */
+    virtual bool put_event(uint32_t eventid, CompactEvent&& event) = 0;
+
     /**
      * Update the audit daemon with the specified configuration file
      *
@@ -0,0 +1,879 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * mcbench - a closed-loop load generator for memcached.
+ *
+ * Each connection is driven by its own thread, which keeps a fixed number of
+ * requests (the pipeline depth) outstanding: a new request is sent as soon as
+ * the response for a previous one is received. The latency of each request
+ * (from the time it was sent until its response was received) is recorded in
+ * a per-thread HdrHistogram for its operation type; the histograms of all
+ * threads are merged and reported once the run completes.
+ */
+
+#include "config.h"
+
+#include <getopt.h>
+#include <mcbp/protocol/framebuilder.h>
+#include <memcached/durability_spec.h>
+#include <memcached/protocol_binary.h>
+#include <nlohmann/json.hpp>
+#include <programs/getpass.h>
+#include <programs/hostname_utils.h>
+#include <protocol/connection/client_connection.h>
+#include <utilities/hdrhistogram.h>
+#include <utilities/terminate_handler.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using cb::mcbp::ClientOpcode;
+using cb::mcbp::Status;
+
+/// The operation types mcbench may issue
+enum class OpType { Get, Set, Subdoc, DurableSet };
+
+static const std::array<OpType, 4> allOpTypes = {
+        {OpType::Get, OpType::Set, OpType::Subdoc, OpType::DurableSet}};
+
+static std::string to_string(OpType type) {
+    switch (type) {
+    case OpType::Get:
+        return "get";
+    case OpType::Set:
+        return "set";
+    case OpType::Subdoc:
+        return "subdoc";
+    case OpType::DurableSet:
+        return "durable";
+    }
+    throw std::invalid_argument("to_string(OpType): invalid type: " +
+                                std::to_string(int(type)));
+}
+
+/// The path read by subdoc operations; all values stored are JSON objects
+/// with this field.
+static const std::string subdocPath = "v";
+
+struct Config {
+    std::string host{"localhost"};
+    std::string port{"11210"};
+    sa_family_t family = AF_UNSPEC;
+    bool secure = false;
+    std::string ssl_cert;
+    std::string ssl_key;
+    std::string user;
+    std::string password;
+    std::string bucket;
+
+    size_t connections = 1;
+    size_t pipeline = 1;
+    std::chrono::seconds duration{10};
+    // Percentage of each OpType in the mix, indexed by OpType
+    std::array<unsigned int, 4> mix = {{80, 20, 0, 0}};
+    cb::durability::Level durabilityLevel = cb::durability::Level::Majority;
+
+    uint64_t numKeys = 100000;
+    std::string keyPrefix{"mcbench_"};
+    // 0 selects a uniform key distribution
+    double zipfTheta = 0;
+    size_t minValueSize = 256;
+    size_t maxValueSize = 256;
+    uint16_t numVbuckets = 1024;
+    bool populate = false;
+    bool json = false;
+};
+
+/**
+ * Generates values in [0, n) with a Zipfian distribution, where value 0 is
+ * the most frequent. Uses the algorithm from "Quickly Generating
+ * Billion-Record Synthetic Databases" (Gray et al), as used by YCSB.
+ */
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(uint64_t n, double theta)
+        : n(n),
+          theta(theta),
+          alpha(1.0 / (1.0 - theta)),
+          zetan(zeta(n, theta)),
+          eta((1.0 - std::pow(2.0 / n, 1.0 - theta)) /
+              (1.0 - zeta(2, theta) / zetan)) {
+    }
+
+    uint64_t operator()(std::mt19937_64& rng) const {
+        const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        const double uz = u * zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta)) {
+            return 1;
+        }
+        const auto value =
+                uint64_t(n * std::pow(eta * u - eta + 1.0, alpha));
+        return std::min(value, n - 1);
+    }
+
+private:
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t ii = 1; ii <= n; ++ii) {
+            sum += 1.0 / std::pow(double(ii), theta);
+        }
+        return sum;
+    }
+
+    const uint64_t n;
+    const double theta;
+    const double alpha;
+    const double zetan;
+    const double eta;
+};
+
+/// The results of one connection, merged into the overall results at the end
+struct Results {
+    Results() {
+        for (size_t ii = 0; ii < allOpTypes.size(); ++ii) {
+            // Track latencies from 1us to 60s, with 3 significant figures
+            latency.emplace_back(1, 60 * 1000 * 1000, 3);
+        }
+    }
+
+    Results& operator+=(const Results& other) {
+        for (size_t ii = 0; ii < latency.size(); ++ii) {
+            latency[ii] += other.latency[ii];
+        }
+        for (const auto& entry : other.status) {
+            status[entry.first] += entry.second;
+        }
+        return *this;
+    }
+
+    // Latency in microseconds, indexed by OpType
+    std::vector<HdrHistogram> latency;
+    // Count of each response status received
+    std::map<Status, uint64_t> status;
+};
+
+/**
+ * Connect to the server, and authenticate / select the bucket as
+ * requested.
+ */
+static std::unique_ptr<MemcachedConnection> createConnection(
+        const Config& config) {
+    in_port_t in_port;
+    sa_family_t family;
+    std::string host;
+    std::tie(host, in_port, family) =
+            cb::inet::parse_hostname(config.host, config.port);
+    if (config.family != AF_UNSPEC) {
+        family = config.family;
+    }
+
+    auto connection = std::make_unique<MemcachedConnection>(
+            host, in_port, family, config.secure);
+    connection->setSslCertFile(config.ssl_cert);
+    connection->setSslKeyFile(config.ssl_key);
+    connection->connect();
+
+    // MEMCACHED_VERSION contains the git sha
+    connection->hello("mcbench", MEMCACHED_VERSION, "load generator");
+    connection->setXerrorSupport(true);
+    if (config.mix[int(OpType::DurableSet)]) {
+        connection->setFeature(cb::mcbp::Feature::AltRequestSupport, true);
+        connection->setFeature(cb::mcbp::Feature::SyncReplication, true);
+    }
+
+    if (!config.user.empty()) {
+        connection->authenticate(config.user,
+                                 config.password,
+                                 connection->getSaslMechanisms());
+    }
+
+    if (!config.bucket.empty()) {
+        connection->selectBucket(config.bucket);
+    }
+
+    return connection;
+}
+
+/**
+ * Map a key to its vBucket the way the Couchbase clients do: bits 16-30 of
+ * the (zlib) CRC32 of the key, modulo the number of vBuckets.
+ */
+static Vbid getVBucket(const std::string& key, uint16_t numVbuckets) {
+    static const auto table = []() {
+        std::array<uint32_t, 256> ret;
+        for (uint32_t ii = 0; ii < ret.size(); ii++) {
+            uint32_t crc = ii;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+            }
+            ret[ii] = crc;
+        }
+        return ret;
+    }();
+
+    uint32_t crc = 0xffffffff;
+    for (const auto c : key) {
+        crc = (crc >> 8) ^ table[(crc ^ uint8_t(c)) & 0xff];
+    }
+    return Vbid(uint16_t(((~crc >> 16) & 0x7fff) % numVbuckets));
+}
+
+/**
+ * Builds the request frames for a single connection.
+ */
+class RequestEncoder {
+public:
+    RequestEncoder(const Config& config) : config(config) {
+        // All values are JSON objects with a single string field, so they
+        // may be accessed with subdoc operations.
+        const std::string prefix = "{\"" + subdocPath + "\":\"";
+        const std::string suffix = "\"}";
+        const auto overhead = prefix.size() + suffix.size();
+        const auto size = std::max(config.maxValueSize, overhead);
+        value = prefix + std::string(size - overhead, 'x') + suffix;
+        scratch.resize(value.size());
+    }
+
+    /**
+     * Encode a request into frame.
+     *
+     * @param type The operation to perform
+     * @param key The document to operate on
+     * @param valueSize The size of the document (for mutations)
+     * @param opaque The opaque for the request
+     */
+    void encode(Frame& frame,
+                OpType type,
+                const std::string& key,
+                size_t valueSize,
+                uint32_t opaque) {
+        frame.payload.resize(sizeof(cb::mcbp::Request) + 255 + 8 +
+                             key.size() + subdocPath.size() + value.size());
+        cb::mcbp::RequestBuilder builder(
+                {frame.payload.data(), frame.payload.size()});
+        builder.setMagic(type == OpType::DurableSet
+                                 ? cb::mcbp::Magic::AltClientRequest
+                                 : cb::mcbp::Magic::ClientRequest);
+        builder.setOpaque(opaque);
+        builder.setVBucket(getVBucket(key, config.numVbuckets));
+        const cb::const_char_buffer keyBuf{key.data(), key.size()};
+
+        switch (type) {
+        case OpType::Get:
+            builder.setOpcode(ClientOpcode::Get);
+            builder.setKey(keyBuf);
+            break;
+        case OpType::DurableSet:
+            builder.setFramingExtras(encodeDurability());
+            // FALLTHROUGH
+        case OpType::Set:
+            builder.setOpcode(ClientOpcode::Set);
+            builder.setExtras(cb::mcbp::request::MutationPayload().getBuffer());
+            builder.setKey(keyBuf);
+            builder.setValue(getValue(valueSize));
+            break;
+        case OpType::Subdoc: {
+            builder.setOpcode(ClientOpcode::SubdocGet);
+            // Extras: path length (network order) and path flags
+            std::array<uint8_t, 3> extras{};
+            const uint16_t pathlen = htons(uint16_t(subdocPath.size()));
+            std::memcpy(extras.data(), &pathlen, sizeof(pathlen));
+            extras[2] = SUBDOC_FLAG_NONE;
+            builder.setExtras({extras.data(), extras.size()});
+            builder.setKey(keyBuf);
+            builder.setValue(cb::const_char_buffer{subdocPath.data(),
+                                                   subdocPath.size()});
+            break;
+        }
+        }
+
+        frame.payload.resize(builder.getFrame()->getFrame().size());
+    }
+
+private:
+    /// Encode the durability requirements as framing extras, using the
+    /// server default timeout
+    cb::const_byte_buffer encodeDurability() {
+        durability[0] = uint8_t(1 << 4) |
+                        uint8_t(cb::mcbp::request::FrameInfoId::
+                                        DurabilityRequirement);
+        durability[1] = uint8_t(config.durabilityLevel);
+        return {durability.data(), durability.size()};
+    }
+
+    /// @return a JSON value of the given size (or as close as possible)
+    cb::const_char_buffer getValue(size_t size) {
+        // Smallest value is {"v":""}
+        size = std::max(size, subdocPath.size() + 7);
+        size = std::min(size, value.size());
+        // Keep the JSON valid by moving the closing quote and brace
+        const auto closing = value.size() - 2;
+        std::copy(value.begin() + closing,
+                  value.end(),
+                  scratch.begin() + (size - 2));
+        std::copy(value.begin(), value.begin() + (size - 2), scratch.begin());
+        return {scratch.data(), size};
+    }
+
+    const Config& config;
+    // A value of the maximum size
+    std::string value;
+    // Scratch space for the value of the current request
+    std::vector<char> scratch;
+    std::array<uint8_t, 2> durability{};
+};
+
+/**
+ * Drives a single connection for the duration of the run.
+ */
+class Worker {
+public:
+    Worker(const Config& config, size_t id)
+        : config(config),
+          rng(std::random_device()() + id),
+          encoder(config) {
+        if (config.zipfTheta > 0) {
+            zipfian = std::make_unique<ZipfianGenerator>(config.numKeys,
+                                                         config.zipfTheta);
+        }
+    }
+
+    /**
+     * Store the keys in [begin, end), so the run doesn't start with an
+     * empty keyspace.
+     */
+    void populate(uint64_t begin, uint64_t end) {
+        auto connection = createConnection(config);
+        Frame frame;
+        for (auto ii = begin; ii < end; ++ii) {
+            encoder.encode(frame,
+                           OpType::Set,
+                           getKey(ii),
+                           config.maxValueSize,
+                           uint32_t(ii));
+            connection->sendFrame(frame);
+            connection->recvFrame(frame);
+            const auto status = frame.getResponse()->getStatus();
+            if (status != Status::Success) {
+                throw std::runtime_error("Failed to populate key " +
+                                         getKey(ii) + ": " + to_string(status));
+            }
+        }
+    }
+
+    void run(std::chrono::steady_clock::time_point deadline) {
+        connection = createConnection(config);
+
+        Frame frame;
+        while (std::chrono::steady_clock::now() < deadline) {
+            // Keep the pipeline full
+            while (inflight.size() < config.pipeline) {
+                send(frame);
+            }
+            receive(frame);
+        }
+
+        // Drain the outstanding requests
+        while (!inflight.empty()) {
+            receive(frame);
+        }
+    }
+
+    const Results& getResults() const {
+        return results;
+    }
+
+private:
+    std::string getKey(uint64_t index) const {
+        return config.keyPrefix + std::to_string(index);
+    }
+
+    uint64_t nextKeyIndex() {
+        if (zipfian) {
+            return (*zipfian)(rng);
+        }
+        return std::uniform_int_distribution<uint64_t>(0, config.numKeys - 1)(
+                rng);
+    }
+
+    OpType nextOpType() {
+        auto value = std::uniform_int_distribution<unsigned int>(0, 99)(rng);
+        for (auto type : allOpTypes) {
+            if (value < config.mix[int(type)]) {
+                return type;
+            }
+            value -= config.mix[int(type)];
+        }
+        return OpType::Get;
+    }
+
+    void send(Frame& frame) {
+        const auto type = nextOpType();
+        const auto valueSize = std::uniform_int_distribution<size_t>(
+                config.minValueSize, config.maxValueSize)(rng);
+        encoder.encode(
+                frame, type, getKey(nextKeyIndex()), valueSize, nextOpaque);
+        inflight.push_back(
+                {nextOpaque++, type, std::chrono::steady_clock::now()});
+        connection->sendFrame(frame);
+    }
+
+    void receive(Frame& frame) {
+        connection->recvFrame(frame);
+        const auto now = std::chrono::steady_clock::now();
+        const auto* response = frame.getResponse();
+
+        // Responses are returned in the order the requests were sent
+        const auto request = inflight.front();
+        inflight.pop_front();
+        if (response->getOpaque() != request.opaque) {
+            throw std::runtime_error(
+                    "Unexpected opaque in response: " +
+                    std::to_string(response->getOpaque()) +
+                    ", expected: " + std::to_string(request.opaque));
+        }
+
+        const auto latency =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        now - request.sent);
+        results.latency[int(request.type)].addValue(
+                std::max(int64_t(1), int64_t(latency.count())));
+        results.status[response->getStatus()]++;
+    }
+
+    struct Request {
+        uint32_t opaque;
+        OpType type;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    const Config& config;
+    std::mt19937_64 rng;
+    std::unique_ptr<ZipfianGenerator> zipfian;
+    RequestEncoder encoder;
+    std::unique_ptr<MemcachedConnection> connection;
+    std::deque<Request> inflight;
+    uint32_t nextOpaque = 0;
+    Results results;
+};
+
+static void report(const Config& config,
+                   const Results& results,
+                   std::chrono::duration<double> elapsed) {
+    const std::array<double, 6> percentiles = {
+            {50.0, 90.0, 99.0, 99.9, 99.99, 100.0}};
+
+    nlohmann::json json;
+    json["connections"] = config.connections;
+    json["pipeline"] = config.pipeline;
+    json["duration_s"] = elapsed.count();
+
+    uint64_t total = 0;
+    for (auto type : allOpTypes) {
+        const auto& histogram = results.latency[int(type)];
+        const auto count = histogram.getValueCount();
+        if (count == 0) {
+            continue;
+        }
+        total += count;
+        nlohmann::json op;
+        op["count"] = count;
+        op["ops_per_sec"] = count / elapsed.count();
+        for (auto pct : percentiles) {
+            std::stringstream name;
+            name << "p" << pct;
+            op["latency_us"][name.str()] =
+                    histogram.getValueAtPercentile(pct);
+        }
+        json["ops"][to_string(type)] = op;
+    }
+    json["total"]["count"] = total;
+    json["total"]["ops_per_sec"] = total / elapsed.count();
+    for (const auto& entry : results.status) {
+        json["status"][to_string(entry.first)] = entry.second;
+    }
+
+    if (config.json) {
+        std::cout << json.dump(1, '\t') << std::endl;
+        return;
+    }
+
+    std::cout << "Ran " << config.connections << " connection(s) with "
+              << config.pipeline << " request(s) in flight each for "
+              << std::fixed << std::setprecision(1) << elapsed.count()
+              << "s" << std::endl
+              << std::endl;
+    std::cout << std::left << std::setw(10) << "op" << std::right
+              << std::setw(12) << "count" << std::setw(12) << "ops/s";
+    for (auto pct : percentiles) {
+        std::stringstream name;
+        name << "p" << pct << "(us)";
+        std::cout << std::setw(12) << name.str();
+    }
+    std::cout << std::endl;
+    for (auto type : allOpTypes) {
+        const auto& histogram = results.latency[int(type)];
+        const auto count = histogram.getValueCount();
+        if (count == 0) {
+            continue;
+        }
+        std::cout << std::left << std::setw(10) << to_string(type)
+                  << std::right << std::setw(12) << count << std::setw(12)
+                  << uint64_t(count / elapsed.count());
+        for (auto pct : percentiles) {
+            std::cout << std::setw(12) << histogram.getValueAtPercentile(pct);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl
+              << "total ops/s: " << uint64_t(total / elapsed.count())
+              << std::endl
+              << std::endl
+              << "Response status:" << std::endl;
+    for (const auto& entry : results.status) {
+        std::cout << "    " << std::left << std::setw(30)
+                  << to_string(entry.first) << std::right << entry.second
+                  << std::endl;
+    }
+}
+
+/**
+ * Parse an operation mix of the form "get=80,set=20".
+ * Operations not listed are not performed; the percentages must add up to
+ * 100.
+ */
+static std::array<unsigned int, 4> parseMix(const std::string& spec) {
+    std::array<unsigned int, 4> mix{};
+    std::stringstream ss(spec);
+    std::string entry;
+    unsigned int sum = 0;
+    while (std::getline(ss, entry, ',')) {
+        const auto idx = entry.find('=');
+        if (idx == std::string::npos) {
+            throw std::invalid_argument("Invalid mix entry: " + entry);
+        }
+        const auto name = entry.substr(0, idx);
+        const auto pct = std::stoul(entry.substr(idx + 1));
+        bool found = false;
+        for (auto type : allOpTypes) {
+            if (to_string(type) == name) {
+                mix[int(type)] = pct;
+                found = true;
+            }
+        }
+        if (!found) {
+            throw std::invalid_argument("Unknown operation in mix: " + name);
+        }
+        sum += pct;
+    }
+    if (sum != 100) {
+        throw std::invalid_argument("Operation mix must add up to 100%, got " +
+                                    std::to_string(sum));
+    }
+    return mix;
+}
+
+static cb::durability::Level parseDurabilityLevel(const std::string& level) {
+    if (level == "majority") {
+        return cb::durability::Level::Majority;
+    } else if (level == "majorityAndPersistActive") {
+        return cb::durability::Level::MajorityAndPersistOnMaster;
+    } else if (level == "persistToMajority") {
+        return cb::durability::Level::PersistToMajority;
+    }
+    throw std::invalid_argument("Invalid durability level: " + level);
+}
+
+static void usage() {
+    std::cerr << R"(Usage: mcbench [options]
+
+Connection options:
+
+  -h or --host hostname[:port]   The host (with an optional port) to connect to
+                                 (for IPv6 use: [address]:port if you'd like to
+                                 specify port)
+  -p or --port port              The port number to connect to
+  -b or --bucket bucketname      The name of the bucket to operate on
+  -u or --user username          The name of the user to authenticate as
+  -P or --password password      The passord to use for authentication
+                                 (use '-' to read from standard input)
+  -s or --ssl                    Connect to the server over SSL
+  -C or --ssl-cert filename      Read the SSL certificate from the specified file
+  -K or --ssl-key filename       Read the SSL private key from the specified file
+  -4 or --ipv4                   Connect over IPv4
+  -6 or --ipv6                   Connect over IPv6
+
+Workload options:
+
+  -c or --connections num        Number of connections (one thread each)
+                                 (default: 1)
+  -d or --pipeline num           Number of requests each connection keeps in
+                                 flight (default: 1)
+  -t or --duration seconds       Length of the run (default: 10)
+  -m or --mix op=pct[,op=pct]    Operation mix, from get, set, subdoc (a
+                                 subdoc lookup) and durable (a set with
+                                 durability requirements). Must add up to 100
+                                 (default: get=80,set=20)
+  -l or --durability level       Level of durable sets: majority,
+                                 majorityAndPersistActive or persistToMajority
+                                 (default: majority)
+  -k or --keys num               Number of keys in the keyspace
+                                 (default: 100000)
+  --key-prefix prefix            Prefix of every key (default: mcbench_)
+  -z or --zipf theta             Use a Zipfian key distribution with the given
+                                 skew (0 < theta < 1, e.g. 0.99) instead of a
+                                 uniform distribution
+  -v or --value-size min[:max]   Size in bytes of stored values, chosen
+                                 uniformly from [min, max] (default: 256)
+  --vbuckets num                 Number of vBuckets keys are spread over
+                                 (default: 1024)
+  --populate                     Store every key before the run starts
+  -j or --json                   Print the results as JSON
+  --help                         This help text
+)";
+
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+    // Make sure that we dump callstacks on the console
+    install_backtrace_terminate_handler();
+
+    Config config;
+    int cmd;
+
+    /* Initialize the socket subsystem */
+    cb_initialize_sockets();
+
+    const int keyPrefixOption = 256;
+    const int vbucketsOption = 257;
+    const int populateOption = 258;
+
+    struct option long_options[] = {
+            {"ipv4", no_argument, nullptr, '4'},
+            {"ipv6", no_argument, nullptr, '6'},
+            {"host", required_argument, nullptr, 'h'},
+            {"port", required_argument, nullptr, 'p'},
+            {"bucket", required_argument, nullptr, 'b'},
+            {"password", required_argument, nullptr, 'P'},
+            {"user", required_argument, nullptr, 'u'},
+            {"ssl", no_argument, nullptr, 's'},
+            {"ssl-cert", required_argument, nullptr, 'C'},
+            {"ssl-key", required_argument, nullptr, 'K'},
+            {"connections", required_argument, nullptr, 'c'},
+            {"pipeline", required_argument, nullptr, 'd'},
+            {"duration", required_argument, nullptr, 't'},
+            {"mix", required_argument, nullptr, 'm'},
+            {"durability", required_argument, nullptr, 'l'},
+            {"keys", required_argument, nullptr, 'k'},
+            {"key-prefix", required_argument, nullptr, keyPrefixOption},
+            {"zipf", required_argument, nullptr, 'z'},
+            {"value-size", required_argument, nullptr, 'v'},
+            {"vbuckets", required_argument, nullptr, vbucketsOption},
+            {"populate", no_argument, nullptr, populateOption},
+            {"json", no_argument, nullptr, 'j'},
+            {"help", no_argument, nullptr, 0},
+            {nullptr, 0, nullptr, 0}};
+
+    try {
+        while ((cmd = getopt_long(argc,
+                                  argv,
+                                  "46h:p:u:b:P:sC:K:c:d:t:m:l:k:z:v:j",
+                                  long_options,
+                                  nullptr)) != EOF) {
+            switch (cmd) {
+            case '6':
+                config.family = AF_INET6;
+                break;
+            case '4':
+                config.family = AF_INET;
+                break;
+            case 'h':
+                config.host.assign(optarg);
+                break;
+            case 'p':
+                config.port.assign(optarg);
+                break;
+            case 'b':
+                config.bucket.assign(optarg);
+                break;
+            case 'u':
+                config.user.assign(optarg);
+                break;
+            case 'P':
+                config.password.assign(optarg);
+                break;
+            case 's':
+                config.secure = true;
+                break;
+            case 'C':
+                config.ssl_cert.assign(optarg);
+                break;
+            case 'K':
+                config.ssl_key.assign(optarg);
+                break;
+            case 'c':
+                config.connections = std::stoul(optarg);
+                break;
+            case 'd':
+                config.pipeline = std::stoul(optarg);
+                break;
+            case 't':
+                config.duration = std::chrono::seconds(std::stoul(optarg));
+                break;
+            case 'm':
+                config.mix = parseMix(optarg);
+                break;
+            case 'l':
+                config.durabilityLevel = parseDurabilityLevel(optarg);
+                break;
+            case 'k':
+                config.numKeys = std::stoull(optarg);
+                break;
+            case keyPrefixOption:
+                config.keyPrefix.assign(optarg);
+                break;
+            case 'z':
+                config.zipfTheta = std::stod(optarg);
+                if (config.zipfTheta <= 0 || config.zipfTheta >= 1) {
+                    throw std::invalid_argument(
+                            "Zipfian theta must be in the range (0, 1)");
+                }
+                break;
+            case 'v': {
+                const std::string spec(optarg);
+                const auto idx = spec.find(':');
+                config.minValueSize = std::stoul(spec.substr(0, idx));
+                config.maxValueSize =
+                        idx == std::string::npos
+                                ? config.minValueSize
+                                : std::stoul(spec.substr(idx + 1));
+                if (config.minValueSize > config.maxValueSize) {
+                    throw std::invalid_argument(
+                            "Minimum value size exceeds the maximum");
+                }
+                break;
+            }
+            case vbucketsOption:
+                config.numVbuckets = uint16_t(std::stoul(optarg));
+                break;
+            case populateOption:
+                config.populate = true;
+                break;
+            case 'j':
+                config.json = true;
+                break;
+            default:
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "mcbench: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (config.connections == 0 || config.pipeline == 0 ||
+        config.numKeys == 0 || config.numVbuckets == 0) {
+        std::cerr << "mcbench: connections, pipeline, keys and vbuckets must "
+                     "be non-zero"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (config.password == "-") {
+        config.password.assign(getpass());
+    } else if (config.password.empty()) {
+        const char* env_password = std::getenv("CB_PASSWORD");
+        if (env_password) {
+            config.password = env_password;
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (size_t ii = 0; ii < config.connections; ++ii) {
+        workers.emplace_back(std::make_unique<Worker>(config, ii));
+    }
+
+    // Any failure in a worker thread is reported and fails the run
+    std::mutex errorMutex;
+    std::string error;
+    auto runAll = [&workers, &errorMutex, &error](
+                          std::function<void(Worker&, size_t)> func) {
+        std::vector<std::thread> threads;
+        for (size_t ii = 0; ii < workers.size(); ++ii) {
+            threads.emplace_back([&workers, &errorMutex, &error, func, ii]() {
+                try {
+                    func(*workers[ii], ii);
+                } catch (const std::exception& ex) {
+                    std::lock_guard<std::mutex> guard(errorMutex);
+                    error = ex.what();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    if (config.populate) {
+        const auto perWorker =
+                (config.numKeys + workers.size() - 1) / workers.size();
+        runAll([&config, perWorker](Worker& worker, size_t ii) {
+            const auto begin = std::min(config.numKeys, ii * perWorker);
+            const auto end = std::min(config.numKeys, begin + perWorker);
+            worker.populate(begin, end);
+        });
+        if (!error.empty()) {
+            std::cerr << "mcbench: " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + config.duration;
+    runAll([deadline](Worker& worker, size_t) { worker.run(deadline); });
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (!error.empty()) {
+        std::cerr << "mcbench: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Results results;
+    for (const auto& worker : workers) {
+        results += worker->getResults();
+    }
+    report(config, results, elapsed);
+
+    return EXIT_SUCCESS;
+}
@@ -29,10 +29,13 @@
 
 #include <strings.h>
 #include <array>
+#include <cinttypes>
 #include <cstdlib>
 #include <gsl/gsl>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #define JSON_DUMP_INDENT_SIZE 4
 
@@ -84,6 +87,20 @@ public:
             dump("s ", 80, 0, wayout[4]);
         }
         std::cout << "Total: " << total << " operations" << std::endl;
+
+        if (!percentiles.empty()) {
+            std::cout << "Latency (us): min " << minUsec << ", mean "
+                      << meanUsec << ", max " << maxUsec << std::endl;
+            for (const auto& p : percentiles) {
+                char buffer[64];
+                snprintf(buffer,
+                         sizeof(buffer),
+                         "    %6.2f%% <= %" PRIu64,
+                         p.first,
+                         p.second);
+                std::cout << buffer << std::endl;
+            }
+        }
     }
 
 private:
@@ -149,6 +166,19 @@ private:
             oldwayout = true;
         }
 
+        // Servers which record timings in a HdrHistogram also report the
+        // precise percentiles (in microseconds)
+        auto iter = root.find("percentiles");
+        if (iter != root.end()) {
+            for (const auto& entry : *iter) {
+                percentiles.emplace_back(entry.at(0).get<double>(),
+                                         entry.at(1).get<uint64_t>());
+            }
+            minUsec = root["min"].get<uint64_t>();
+            maxUsec = root["max"].get<uint64_t>();
+            meanUsec = root["mean"].get<double>();
+        }
+
         // Calculate total and cumulative counts, and find the highest value.
         total = max = 0;
 
@@ -218,6 +248,12 @@ private:
 
     bool oldwayout = false;
 
+    /// (percentile, value in us) pairs, if provided by the server
+    std::vector<std::pair<double, uint64_t>> percentiles;
+    uint64_t minUsec = 0;
+    uint64_t maxUsec = 0;
+    double meanUsec = 0;
+
     uint64_t total{};
 };
 
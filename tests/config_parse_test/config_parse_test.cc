@@ -837,6 +837,36 @@ TEST_F(SettingsTest, max_connections) {
     EXPECT_TRUE(settings.has.max_connections);
 }
 
+TEST_F(SettingsTest, dcp_step_batch_size) {
+    nonNumericValuesShouldFail("dcp_step_batch_size");
+
+    nlohmann::json obj;
+    obj["dcp_step_batch_size"] = size_t(0);
+    expectFail<std::invalid_argument>(obj);
+
+    const size_t batchSize = 64;
+    obj["dcp_step_batch_size"] = batchSize;
+    Settings settings(obj);
+    EXPECT_EQ(batchSize, settings.getDcpStepBatchSize());
+    EXPECT_TRUE(settings.has.dcp_step_batch_size);
+}
+
+TEST_F(SettingsTest, stage_profiling_sample_rate) {
+    nonNumericValuesShouldFail("stage_profiling_sample_rate");
+
+    nlohmann::json obj;
+    obj["stage_profiling_sample_rate"] = size_t(0);
+    {
+        Settings settings(obj);
+        EXPECT_EQ(0, settings.getStageProfilingSampleRate());
+        EXPECT_TRUE(settings.has.stage_profiling_sample_rate);
+    }
+
+    obj["stage_profiling_sample_rate"] = size_t(1000);
+    Settings settings(obj);
+    EXPECT_EQ(1000, settings.getStageProfilingSampleRate());
+}
+
 TEST_F(SettingsTest, system_connections) {
     nonNumericValuesShouldFail("system_connections");
 
@@ -1201,6 +1231,22 @@ TEST(SettingsUpdateTest, MaxConnectionsIsDynamic) {
     EXPECT_EQ(1000, settings.getMaxConnections());
 }
 
+TEST(SettingsUpdateTest, DcpStepBatchSizeIsDynamic) {
+    Settings updated;
+    Settings settings;
+    settings.setDcpStepBatchSize(1);
+    // setting it to the same value should work
+    updated.setDcpStepBatchSize(1);
+    settings.updateSettings(updated, false);
+
+    // changing it should work
+    updated.setDcpStepBatchSize(32);
+    settings.updateSettings(updated, false);
+    EXPECT_EQ(1, settings.getDcpStepBatchSize());
+    settings.updateSettings(updated, true);
+    EXPECT_EQ(32, settings.getDcpStepBatchSize());
+}
+
 TEST(SettingsUpdateTest, SystemConnectionsIsDynamic) {
     Settings updated;
     Settings settings;
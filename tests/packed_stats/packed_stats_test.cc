@@ -0,0 +1,123 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+
+#include "daemon/packed_stats.h"
+
+#include <gtest/gtest.h>
+#include <mcbp/protocol/unsigned_leb128.h>
+
+#include <cstring>
+#include <vector>
+
+/// A decoded value: its type and its payload (for Double the bit pattern)
+using Value = std::pair<PackedStats::Type, uint64_t>;
+
+static std::vector<Value> decode(const std::string& values) {
+    cb::const_byte_buffer buf{
+            reinterpret_cast<const uint8_t*>(values.data()), values.size()};
+    auto count = cb::mcbp::decode_unsigned_leb128<uint64_t>(buf);
+    buf = count.second;
+    std::vector<Value> ret;
+    for (uint64_t ii = 0; ii < count.first; ++ii) {
+        const auto type = PackedStats::Type(buf[0]);
+        buf = {buf.data() + 1, buf.size() - 1};
+        if (type == PackedStats::Type::Double) {
+            uint64_t bits;
+            std::memcpy(&bits, buf.data(), sizeof(bits));
+            ret.emplace_back(type, ntohll(bits));
+            buf = {buf.data() + sizeof(bits), buf.size() - sizeof(bits)};
+        } else {
+            auto value = cb::mcbp::decode_unsigned_leb128<uint64_t>(buf);
+            ret.emplace_back(type, value.first);
+            buf = value.second;
+        }
+    }
+    EXPECT_TRUE(buf.empty()) << "Unexpected data after the last value";
+    return ret;
+}
+
+static uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+TEST(PackedStatsTest, Numbers) {
+    PackedStats packed;
+    packed.add({"zero", 4}, {"0", 1});
+    packed.add({"big", 3}, {"18446744073709551615", 20});
+    packed.add({"negative", 8}, {"-5", 2});
+    packed.add({"ratio", 5}, {"0.25", 4});
+    packed.add({"enabled", 7}, {"true", 4});
+    packed.add({"disabled", 8}, {"false", 5});
+
+    EXPECT_EQ(6u, packed.size());
+    EXPECT_EQ("zero\nbig\nnegative\nratio\nenabled\ndisabled\n",
+              packed.getSchema());
+
+    using Type = PackedStats::Type;
+    const std::vector<Value> expected = {{Type::Unsigned, 0},
+                                         {Type::Unsigned, UINT64_MAX},
+                                         {Type::Negative, 4},
+                                         {Type::Double, doubleBits(0.25)},
+                                         {Type::Unsigned, 1},
+                                         {Type::Unsigned, 0}};
+    EXPECT_EQ(expected, decode(packed.getValues()));
+}
+
+// Stats which aren't (plain decimal) numbers aren't packed
+TEST(PackedStatsTest, NonNumeric) {
+    PackedStats packed;
+    packed.add({"state", 5}, {"active", 6});
+    packed.add({"empty", 5}, {"", 0});
+    packed.add({"minus", 5}, {"-", 1});
+    packed.add({"inf", 3}, {"inf", 3});
+    packed.add({"hex", 3}, {"0x10", 4});
+    packed.add({"overflow", 8}, {"18446744073709551616", 20});
+    packed.add({"embedded", 8}, {"1\0", 2});
+
+    EXPECT_EQ(0u, packed.size());
+    EXPECT_EQ("", packed.getSchema());
+    EXPECT_TRUE(decode(packed.getValues()).empty());
+}
+
+// The schema id only depends on the names of the packed stats
+TEST(PackedStatsTest, SchemaId) {
+    PackedStats a;
+    a.add({"a", 1}, {"1", 1});
+    a.add({"b", 1}, {"2", 1});
+    PackedStats b;
+    b.add({"a", 1}, {"3", 1});
+    b.add({"b", 1}, {"4", 1});
+    b.add({"c", 1}, {"text", 4});
+    EXPECT_EQ(a.getSchemaId(), b.getSchemaId());
+    EXPECT_NE(a.getValues(), b.getValues());
+
+    b.add({"c", 1}, {"5", 1});
+    EXPECT_NE(a.getSchemaId(), b.getSchemaId());
+}
+
+TEST(PackedStatsTest, AddStatFn) {
+    PackedStats packed;
+    const int cookie = 0;
+    auto add_stat = packed.getAddStatFn();
+    add_stat("curr_items", 10, "42", 2, &cookie);
+    EXPECT_EQ("curr_items\n", packed.getSchema());
+    EXPECT_EQ(std::vector<Value>({{PackedStats::Type::Unsigned, 42}}),
+              decode(packed.getValues()));
+}
@@ -128,3 +128,52 @@ TEST_P(DcpTest, UnorderedExecutionNotSupported) {
     EXPECT_FALSE(rsp.isSuccess());
     EXPECT_EQ(cb::mcbp::Status::NotSupported, rsp.getStatus());
 }
+
+/**
+ * Verify that with dcp_step_batch_size set the producer encodes multiple
+ * DCP messages into the write buffer and sends them with a single write
+ * to the network (instead of one per message)
+ */
+TEST_P(DcpTest, StepBatchSendsMultipleMessagesPerWrite) {
+    memcached_cfg["dcp_step_batch_size"] = 32;
+    reconfigure();
+
+    auto& conn = getConnection();
+    conn.hello("DcpStepBatch", "1.0", "dcp step batch test");
+    conn.sendCommand(BinprotDcpOpenCommand{
+            "ewb_internal:32", 0, cb::mcbp::request::DcpOpenPayload::Producer});
+
+    BinprotResponse rsp;
+    conn.recvResponse(rsp);
+    ASSERT_TRUE(rsp.isSuccess());
+
+    BinprotDcpStreamRequestCommand streamReq;
+    conn.sendCommand(streamReq);
+    conn.recvResponse(rsp);
+    ASSERT_TRUE(rsp.isSuccess());
+
+    Frame frame;
+    for (int ii = 0; ii < 32; ++ii) {
+        conn.recvFrame(frame);
+        ASSERT_EQ(cb::mcbp::ClientOpcode::DcpMutation,
+                  frame.getRequest()->getClientOpcode());
+    }
+
+    size_t sendmsg = 0;
+    for (const auto& entry : getAdminConnection().stats("connections")) {
+        auto agent = entry.find("agent_name");
+        if (agent != entry.end() &&
+            agent->get<std::string>() == "DcpStepBatch 1.0") {
+            sendmsg = entry["total_sendmsg"].get<size_t>();
+        }
+    }
+
+    // The connection has also sent the responses to HELLO, SASL,
+    // SELECT_BUCKET etc, but the 32 mutations should only have needed
+    // a few writes
+    EXPECT_NE(0u, sendmsg);
+    EXPECT_GT(16u, sendmsg);
+
+    memcached_cfg["dcp_step_batch_size"] = 1;
+    reconfigure();
+}
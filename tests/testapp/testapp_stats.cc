@@ -453,6 +453,40 @@ TEST_P(StatsTest, TestSubdocExecute) {
     EXPECT_NE(array.end(), array.find("ns"));
 }
 
+TEST_P(StatsTest, TestPacked) {
+    MemcachedConnection& conn = getConnection();
+    std::map<std::string, std::string> stats;
+    conn.stats(
+            [&stats](const std::string& key, const std::string& value) {
+                stats[key] = value;
+            },
+            "packed");
+    ASSERT_EQ(3, stats.size());
+    // The server stats are packed along with the bucket's
+    EXPECT_NE(std::string::npos, stats["schema"].find("uptime\n"));
+    EXPECT_FALSE(stats["values"].empty());
+
+    // The schema is only returned again if the client's id is out of date
+    const auto schemaId = stats["schema_id"];
+    stats.clear();
+    conn.stats(
+            [&stats](const std::string& key, const std::string& value) {
+                stats[key] = value;
+            },
+            "packed_values " + schemaId);
+    EXPECT_EQ(2, stats.size());
+    EXPECT_EQ(schemaId, stats["schema_id"]);
+    EXPECT_EQ(0, stats.count("schema"));
+
+    stats.clear();
+    conn.stats(
+            [&stats](const std::string& key, const std::string& value) {
+                stats[key] = value;
+            },
+            "packed_values 0");
+    EXPECT_EQ(3, stats.size());
+}
+
 TEST_P(StatsTest, TestResponseStats) {
     int successCount = getResponseCount(cb::mcbp::Status::Success);
     // 2 successes expected:
@@ -0,0 +1,112 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "daemon/timing_histogram.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+// Check that samples are reported in the buckets of the legacy format
+TEST(TimingHistogramTest, LegacyBuckets) {
+    TimingHistogram histogram;
+    histogram.add(nanoseconds(500));
+    histogram.add(microseconds(15));
+    histogram.add(microseconds(2500));
+    histogram.add(milliseconds(600));
+    histogram.add(seconds(12));
+    histogram.add(seconds(100));
+
+    auto json = nlohmann::json::parse(histogram.to_string());
+    EXPECT_EQ(1, json["ns"].get<int>());
+    EXPECT_EQ(100, json["us"].size());
+    EXPECT_EQ(1, json["us"][1].get<int>());
+    // "ms" starts at 1ms
+    EXPECT_EQ(49, json["ms"].size());
+    EXPECT_EQ(1, json["ms"][1].get<int>());
+    EXPECT_EQ(10, json["500ms"].size());
+    EXPECT_EQ(1, json["500ms"][1].get<int>());
+    EXPECT_EQ(0, json["5s-9s"].get<int>());
+    EXPECT_EQ(1, json["10s-19s"].get<int>());
+    EXPECT_EQ(1, json["80s-inf"].get<int>());
+    EXPECT_EQ(2, json["wayout"].get<int>());
+    EXPECT_EQ(6, json["total"].get<int>());
+    EXPECT_EQ(6, histogram.get_total());
+}
+
+// Percentiles should be within the 1% precision of the histogram
+TEST(TimingHistogramTest, Percentiles) {
+    TimingHistogram histogram;
+    for (int ii = 1; ii <= 10000; ++ii) {
+        histogram.add(microseconds(ii));
+    }
+    EXPECT_NEAR(5000, histogram.getValueAtPercentile(50.0), 50);
+    EXPECT_NEAR(9900, histogram.getValueAtPercentile(99.0), 99);
+
+    auto json = nlohmann::json::parse(histogram.to_string());
+    EXPECT_EQ(1, json["min"].get<int>());
+    EXPECT_NEAR(10000, json["max"].get<int>(), 100);
+    EXPECT_NEAR(5000, json["mean"].get<double>(), 50);
+    ASSERT_FALSE(json["percentiles"].empty());
+    EXPECT_EQ(50.0, json["percentiles"][0][0].get<double>());
+}
+
+TEST(TimingHistogramTest, CopyAndAggregate) {
+    TimingHistogram a;
+    a.add(microseconds(10));
+    TimingHistogram b(a);
+    b.add(microseconds(20));
+    EXPECT_EQ(1, a.get_total());
+    EXPECT_EQ(2, b.get_total());
+
+    a += b;
+    EXPECT_EQ(3, a.get_total());
+    a += a;
+    EXPECT_EQ(6, a.get_total());
+
+    b = a;
+    EXPECT_EQ(6, b.get_total());
+    b.reset();
+    EXPECT_EQ(0, b.get_total());
+    EXPECT_EQ(0, b.getValueAtPercentile(50.0));
+}
+
+// Samples recorded by many threads (into different shards) are all counted
+TEST(TimingHistogramTest, MultipleThreads) {
+    TimingHistogram histogram;
+    const int numThreads = TimingHistogram::NumShards * 2;
+    const int samplesPerThread = 10000;
+
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < numThreads; ++ii) {
+        threads.emplace_back([&histogram, ii]() {
+            for (int jj = 0; jj < samplesPerThread; ++jj) {
+                histogram.add(microseconds(ii + 1));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(numThreads * samplesPerThread, histogram.get_total());
+    auto json = nlohmann::json::parse(histogram.to_string());
+    EXPECT_EQ(numThreads * samplesPerThread, json["us"][0].get<int>() +
+                                                     json["us"][1].get<int>());
+}
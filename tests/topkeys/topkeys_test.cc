@@ -18,7 +18,9 @@
 #include "daemon/settings.h"
 #include "daemon/topkeys.h"
 #include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
 #include <memory>
+#include <thread>
 
 class TopKeysTest : public ::testing::Test {
 protected:
@@ -46,15 +48,74 @@ TEST_F(TopKeysTest, Basic) {
         keys.emplace_back("topkey_test_" + std::to_string(ii));
     }
 
-    // loop inserting keys
-    for (int jj = 0; jj < 20000; jj++) {
-        for (auto& key : keys) {
-            topkeys->updateKey(key.c_str(), key.size(), jj);
-        }
+    // Each shard is used by its own thread(s); insert the keys from as many
+    // threads as there are shards, each with more keys than a shard holds.
+    std::vector<std::thread> threads;
+    const size_t numThreads = 8;
+    for (size_t ii = 0; ii < numThreads; ii++) {
+        threads.emplace_back([this, &keys, ii]() {
+            const size_t keysPerThread = keys.size() / numThreads;
+            for (int jj = 0; jj < 20000; jj++) {
+                for (size_t kk = ii * keysPerThread;
+                     kk < (ii + 1) * keysPerThread;
+                     kk++) {
+                    topkeys->updateKey(keys[kk].c_str(), keys[kk].size(), jj);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
     }
 
-    // Verify we hit all shards inside TopKeys
+    // Verify we hit all shards inside TopKeys, each holding 10 keys
     size_t count = 0;
     topkeys->stats(&count, 0, dump_key);
     EXPECT_EQ(80, count);
 }
+
+// A key accessed often must not be evicted by a stream of distinct keys
+// which are each only accessed once.
+TEST_F(TopKeysTest, HotKeySurvivesColdKeys) {
+    const std::string hot = "hot_key";
+    for (int ii = 0; ii < 10000; ii++) {
+        topkeys->updateKey(hot.data(), hot.size(), ii);
+        const auto cold = "cold_key_" + std::to_string(ii);
+        topkeys->updateKey(cold.data(), cold.size(), ii);
+    }
+
+    nlohmann::json json;
+    topkeys->json_stats(json, 10000);
+    auto& array = json["topkeys"];
+    // A single thread only updates (the 10 keys of) one shard
+    ASSERT_EQ(10, array.size());
+    // Reported most accessed first; the count of a tracked key is never an
+    // under-estimate.
+    EXPECT_EQ(hot, array[0]["key"]);
+    EXPECT_LE(10000, array[0]["access_count"].get<int>());
+}
+
+// Updates of the same key from different threads are summed.
+TEST_F(TopKeysTest, MultipleThreads) {
+    const std::string key = "shared_key";
+    const int numThreads = 4;
+    const int numUpdates = 1000;
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < numThreads; ii++) {
+        threads.emplace_back([this, &key]() {
+            for (int jj = 0; jj < numUpdates; jj++) {
+                topkeys->updateKey(key.data(), key.size(), 0);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    nlohmann::json json;
+    topkeys->json_stats(json, 0);
+    auto& array = json["topkeys"];
+    ASSERT_EQ(1, array.size());
+    EXPECT_EQ(key, array[0]["key"]);
+    EXPECT_EQ(numThreads * numUpdates, array[0]["access_count"].get<int>());
+}
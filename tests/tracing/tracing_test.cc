@@ -17,10 +17,12 @@
 
 #include "config.h"
 
+#include "daemon/stage_profiler.h"
 #include "tests/mcbp/mock_connection.h"
 #include "tracing/trace_helpers.h"
 
 #include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
 #include <tracing/tracer.h>
 #include <unistd.h>
 #include <algorithm>
@@ -128,3 +130,37 @@ TEST_F(TracingCookieTest, InstantTracerEnd) {
     const auto& durations = cookie.getTracer().getDurations();
     EXPECT_EQ(0u, durations.size());
 }
+
+/// Test that the StageProfiler sums the spans of each stage, and ignores
+/// stages which were never completed.
+TEST(StageProfilerTest, Record) {
+    using cb::tracing::TraceCode;
+    using namespace std::chrono;
+
+    StageProfiler profiler;
+    EXPECT_TRUE(profiler.to_json(cb::mcbp::ClientOpcode::Get).is_null());
+
+    cb::tracing::Tracer tracer;
+    const auto start = steady_clock::now();
+    const auto request = tracer.begin(TraceCode::REQUEST, start);
+    auto span = tracer.begin(TraceCode::EXECUTE, start);
+    tracer.end(span, start + microseconds(10));
+    span = tracer.begin(TraceCode::EXECUTE, start + microseconds(50));
+    tracer.end(span, start + microseconds(70));
+    tracer.begin(TraceCode::BG_LOAD, start + microseconds(20));
+    tracer.end(request, start + microseconds(100));
+
+    profiler.record(cb::mcbp::ClientOpcode::Get, tracer);
+
+    const auto json = profiler.to_json(cb::mcbp::ClientOpcode::Get);
+    ASSERT_FALSE(json.is_null());
+    EXPECT_EQ(1, json["request"]["total"].get<int>());
+    EXPECT_EQ(100, json["request"]["max"].get<int>());
+    EXPECT_EQ(1, json["execute"]["total"].get<int>());
+    EXPECT_EQ(30, json["execute"]["max"].get<int>());
+    EXPECT_EQ(json.end(), json.find("bg.load"));
+    EXPECT_TRUE(profiler.to_json(cb::mcbp::ClientOpcode::Set).is_null());
+
+    profiler.reset();
+    EXPECT_EQ(0, profiler.to_json(cb::mcbp::ClientOpcode::Get).size());
+}
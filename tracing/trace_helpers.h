@@ -36,7 +36,7 @@ class ScopedTracer {
 public:
     ScopedTracer(Cookie& cookie, const cb::tracing::TraceCode code)
         : cookie(cookie) {
-        if (cookie.isTracingEnabled()) {
+        if (cookie.isRecordingSpans()) {
             spanId = cookie.getTracer().begin(code);
         }
     }
@@ -48,7 +48,7 @@ public:
     }
 
     ~ScopedTracer() {
-        if (cookie.isTracingEnabled()) {
+        if (cookie.isRecordingSpans()) {
             cookie.getTracer().end(spanId);
         }
     }
@@ -73,7 +73,7 @@ public:
                   bool begin,
                   std::chrono::steady_clock::time_point time =
                           std::chrono::steady_clock::now()) {
-        if (cookie.isTracingEnabled()) {
+        if (cookie.isRecordingSpans()) {
             auto& tracer = cookie.getTracer();
             if (begin) {
                 tracer.begin(code, time);
@@ -118,13 +118,13 @@ public:
     }
 
     void start(std::chrono::steady_clock::time_point startTime) {
-        if (cookie.isTracingEnabled()) {
+        if (cookie.isRecordingSpans()) {
             spanId = cookie.getTracer().begin(code, startTime);
         }
     }
 
     void stop(std::chrono::steady_clock::time_point stopTime) {
-        if (cookie.isTracingEnabled()) {
+        if (cookie.isRecordingSpans()) {
             cookie.getTracer().end(spanId, stopTime);
         }
     }
@@ -138,6 +138,23 @@ protected:
     cb::tracing::TraceCode code;
 };
 
+/**
+ * Record a Span measured by a thread other than the front-end thread
+ * executing the cookie's command (e.g. a background fetch). The cookie's
+ * tracer isn't thread-safe, so the Span is handed over via
+ * Cookie::addBackgroundSpan() and added to the tracer when the command is
+ * next executed.
+ */
+inline void addBackgroundSpan(const void* ck,
+                              const cb::tracing::TraceCode code,
+                              std::chrono::steady_clock::time_point start,
+                              std::chrono::steady_clock::time_point end) {
+    auto& cookie = *reinterpret_cast<Cookie*>(const_cast<void*>(ck));
+    if (cookie.isRecordingSpans()) {
+        cookie.addBackgroundSpan(code, start, end);
+    }
+}
+
 #define TRACE_SCOPE(ck, code) ScopedTracer __st__##__LINE__(ck, code)
 
 /**
@@ -154,6 +171,12 @@ protected:
 #define TRACE_END(ck, code, ...) \
     InstantTracer(ck, code, /*begin*/ false, __VA_ARGS__)
 
+/**
+ * Add a Span from a background thread; see addBackgroundSpan().
+ */
+#define TRACE_BACKGROUND_SPAN(ck, code, start, end) \
+    addBackgroundSpan(ck, code, start, end)
+
 #else
 /**
  * if DISABLE_SESSION_TRACING is set
@@ -162,5 +185,6 @@ protected:
 #define TRACE_SCOPE(ck, code)
 #define TRACE_BEGIN(ck, code)
 #define TRACE_END(ck, code)
+#define TRACE_BACKGROUND_SPAN(ck, code, start, end)
 
 #endif
@@ -156,6 +156,16 @@ MEMCACHED_PUBLIC_API std::string to_string(
         return "set.with.meta";
     case TraceCode::STORE:
         return "store";
+    case TraceCode::PARSE:
+        return "parse";
+    case TraceCode::EXECUTE:
+        return "execute";
+    case TraceCode::EWB_WAIT:
+        return "ewouldblock.wait";
+    case TraceCode::DURABILITY_WAIT:
+        return "durability.wait";
+    case TraceCode::SEND:
+        return "send";
     }
     return "unknown tracecode";
 }
@@ -35,6 +35,25 @@ enum class TraceCode : uint8_t {
     GETSTATS,
     SETWITHMETA,
     STORE,
+
+    // The following are the stages of a command recorded by the daemon
+    // and ep-engine for the StageProfiler. They are only recorded if the
+    // command is traced or sampled for profiling.
+
+    /// Time from the header being read until the command is executed
+    /// (reading the rest of the packet and validating it).
+    PARSE,
+    /// Time spent executing the command on the front-end thread.
+    EXECUTE,
+    /// Time spent waiting to be notified after the engine returned
+    /// EWOULDBLOCK.
+    EWB_WAIT,
+    /// Time spent waiting for a SyncWrite to meet its durability
+    /// requirements.
+    DURABILITY_WAIT,
+    /// Time from the command completing until its response has been sent.
+    /// Must be the last TraceCode.
+    SEND,
 };
 } // namespace tracing
 } // namespace cb
@@ -41,12 +41,10 @@ HdrHistogram::HdrHistogram(uint64_t lowestTrackableValue,
 
 HdrHistogram& HdrHistogram::operator+=(const HdrHistogram& other) {
     if (other.histogram != nullptr) {
-        Iterator itr = other.makeLinearIterator(1);
-        while (auto pair = other.getNextValueAndCount(itr)) {
-            if (!pair.is_initialized())
-                break;
-            this->addValueAndCount(pair->first, pair->second);
-        }
+        // Both histograms hold biased values, so the counts can be added
+        // directly. hdr_add only visits the recorded values of other, which
+        // is much cheaper than a linear iteration over the whole range.
+        hdr_add(histogram.get(), other.histogram.get());
     }
     return *this;
 }
@@ -81,6 +79,13 @@ uint64_t HdrHistogram::getMaxValue() const {
     return 0;
 }
 
+double HdrHistogram::getMean() const {
+    if (getValueCount()) {
+        return hdr_mean(histogram.get()) - 1;
+    }
+    return 0;
+}
+
 void HdrHistogram::reset() {
     hdr_reset(histogram.get());
 }
@@ -111,6 +116,13 @@ HdrHistogram::Iterator HdrHistogram::makeLogIterator(int64_t firstBucketWidth,
     return iter;
 }
 
+HdrHistogram::Iterator HdrHistogram::makeRecordedIterator() const {
+    HdrHistogram::Iterator iter;
+    iter.type = Iterator::IterMode::Recorded;
+    hdr_iter_recorded_init(&iter, histogram.get());
+    return iter;
+}
+
 boost::optional<std::pair<uint64_t, uint64_t>>
 HdrHistogram::getNextValueAndCount(Iterator& iter) const {
     boost::optional<std::pair<uint64_t, uint64_t>> valueAndCount;
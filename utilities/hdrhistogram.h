@@ -125,6 +125,11 @@ public:
      */
     uint64_t getMaxValue() const;
 
+    /**
+     * Returns the mean of the values stored in the histogram (0 if empty)
+     */
+    double getMean() const;
+
     /**
      * Clears the histogram.
      */
@@ -151,6 +156,12 @@ public:
      */
     Iterator makeLogIterator(int64_t firstBucketWidth, double log_base) const;
 
+    /**
+     * Returns an iterator over every distinct (at the histogram's precision)
+     * value recorded in the histogram, skipping values with no samples.
+     */
+    Iterator makeRecordedIterator() const;
+
     /**
      * Gets the next value and corresponding count from the histogram
      * Returns an optional pair, comprising of:
@@ -0,0 +1,31 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "thread_index.h"
+
+#include <atomic>
+
+namespace cb {
+/// Source of per-thread indices; each thread takes the next value on first use
+static std::atomic<size_t> nextThreadIndex{0};
+
+MCD_UTIL_PUBLIC_API
+size_t getThreadIndex() {
+    static thread_local const size_t threadIndex = nextThreadIndex++;
+    return threadIndex;
+}
+} // namespace cb
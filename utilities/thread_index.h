@@ -0,0 +1,34 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/mcd_util-visibility.h>
+
+#include <cstddef>
+
+namespace cb {
+/**
+ * Get a small integer identifying the calling thread, for selecting which
+ * shard of a per-thread sharded structure the thread should use.
+ *
+ * Each thread is given the next index (starting at 0) the first time it
+ * calls this method, and keeps it for the rest of its life. Callers
+ * typically use the index modulo their number of shards.
+ */
+MCD_UTIL_PUBLIC_API
+size_t getThreadIndex();
+} // namespace cb